@@ -0,0 +1,48 @@
+#include <AssetCooker.hpp>
+
+#include <chrono>
+#include <print>
+#include <string_view>
+
+using namespace Framework;
+
+// AssetCooker <source folder> [--compress] [--force]
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::println(stderr, "usage: AssetCooker <source folder> [--compress] [--force]");
+		return 1;
+	}
+
+	auto settings = CookSettings{};
+	for (auto i = 2; i < argc; i++)
+	{
+		const auto argument = std::string_view{ argv[i] };
+		if (argument == "--compress")
+		{
+			settings.compress = true;
+		}
+		else if (argument == "--force")
+		{
+			settings.force = true;
+		}
+		else
+		{
+			std::println(stderr, "unknown option {}", argument);
+			return 1;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto report = CookFolder(std::filesystem::path{ argv[1] }, settings);
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (const auto& source : report.failedSources)
+	{
+		std::println(stderr, "failed to cook {}", source.generic_string());
+	}
+	std::println("{} cooked, {} up to date, {} failed in {:.2f} s", report.cookedCount, report.upToDateCount,
+				 report.failedSources.size(), seconds);
+	return report.failedSources.empty() ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 
 #extension GL_GOOGLE_include_directive : require
 #include "Common/Skinning.Library.glsl"
+#include "Common/VertexDecoding.Library.glsl"
 
 layout(location = 0) out vec2 uv;
 layout(location = 1) out vec3 normal;
@@ -20,11 +21,11 @@ struct Vertex
 
 layout(scalar, set=0, binding=0) readonly buffer globalGeometryBufferBlock
 {
-	Vertex globalGeometryBuffer[];
+	uint globalGeometryBuffer[];
 };
 layout(scalar, set=0, binding=1) readonly buffer globalGeometryIndexBufferBlock
 {
-	int globalGeometryIndexBuffer[];
+	uint globalGeometryIndexBuffer[];
 };
 
 layout(set=1, binding=0) readonly uniform JointMatricies
@@ -33,11 +34,19 @@ layout(set=1, binding=0) readonly uniform JointMatricies
 };
 
 
+const uint indexFormatUint32 = 0;
+const uint indexFormatUint16 = 1;
+
 struct SubMesh
 {
+	// In 32 bit words, 16 bit indices are packed two per word.
 	uint indexBase;
+	// In 32 bit words.
 	uint vertexBase;
 	uint vertexStride;
+	uint indexFormat;
+	vec4 positionMinimum;
+	vec4 positionExtent;
 };
 
 layout(set=0, binding = 2) readonly buffer registeredSubMeshes
@@ -55,37 +64,37 @@ layout(push_constant) uniform constantsBlock
 } constants;
 
 
-/*Vertex decode(in uint vertexOffset)
+// Position unorm16x4, normal octahedral snorm16x2, uv0 float16x2, joint indices uint8x4 and weights unorm8x4.
+Vertex decode(in uint vertexOffset, in SubMesh subMesh)
 {
-	vec4 v1 = unpackSnorm4x8(globalGeometryBuffer[vertexOffset]);
-	vec4 v2 = unpackSnorm4x8(globalGeometryBuffer[vertexOffset + 1]);
-	
-
-	vec3 position = v1.xyz;
-	vec3 normal = vec3(v1.w, v2.xy);
-	vec2 uv0 = v2.zw;
-	uint jointIndicies = globalGeometryBuffer[vertexOffset + 2];
-	vec4 jointWeights = unpackSnorm4x8(globalGeometryBuffer[vertexOffset + 3]);
-
 	Vertex v;
-	v.position = position;
-	v.normal = normal;
-	v.uv0 = uv0;
-	v.jointIndicies = jointIndicies;
-	v.jointWeights = jointWeights;
+	v.position = decodePosition(globalGeometryBuffer[vertexOffset], globalGeometryBuffer[vertexOffset + 1],
+		subMesh.positionMinimum.xyz, subMesh.positionExtent.xyz);
+	v.normal = decodeOctahedral16(globalGeometryBuffer[vertexOffset + 2]);
+	v.uv0 = decodeTextureCoordinate(globalGeometryBuffer[vertexOffset + 3]);
+	v.jointIndicies = globalGeometryBuffer[vertexOffset + 4];
+	v.jointWeights = decodeJointWeights(globalGeometryBuffer[vertexOffset + 5]);
 	return v;
 }
-*/
+
+uint fetchIndex(in uint vertexIndex, in SubMesh subMesh)
+{
+	if (subMesh.indexFormat == indexFormatUint16)
+	{
+		uint word = globalGeometryIndexBuffer[subMesh.indexBase + vertexIndex / 2];
+		return (vertexIndex & 1) == 0 ? word & 0xFFFF : word >> 16;
+	}
+	return globalGeometryIndexBuffer[subMesh.indexBase + vertexIndex];
+}
+
 void main()
 {
 	SubMesh subMesh = subMeshes[gl_InstanceIndex];
 
-	int index = globalGeometryIndexBuffer[gl_VertexIndex + int(subMesh.indexBase)];
+	uint index = fetchIndex(uint(gl_VertexIndex), subMesh);
 	uint vertexOffset = subMesh.vertexBase + subMesh.vertexStride * index;
 
-	
-	Vertex vertex = globalGeometryBuffer[subMesh.vertexBase + index];
-	//Vertex vertex = decode(vertexOffset);
+	Vertex vertex = decode(vertexOffset, subMesh);
 
 	vec3 position = vertex.position;
 	uv = vertex.uv0;
@@ -0,0 +1,46 @@
+#ifndef VERTEX_DECODING_LIBRARY_GLSL
+#define VERTEX_DECODING_LIBRARY_GLSL
+
+// Decoders for the quantized attribute formats written by the mesh importer, see Framework/VertexQuantization.hpp.
+
+// unorm16x4, the fourth component is padding.
+vec3 decodePosition(uint xy, uint zw, vec3 positionMinimum, vec3 positionExtent)
+{
+	vec3 normalized = vec3(unpackUnorm2x16(xy), unpackUnorm2x16(zw).x);
+	return positionMinimum + normalized * positionExtent;
+}
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+	vec3 direction = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0f);
+	direction.x += direction.x >= 0.0f ? -fold : fold;
+	direction.y += direction.y >= 0.0f ? -fold : fold;
+	return normalize(direction);
+}
+
+// snorm16x2
+vec3 decodeOctahedral16(uint encoded)
+{
+	return decodeOctahedral(unpackSnorm2x16(encoded));
+}
+
+// snorm8x2, stored in the low half of a word.
+vec3 decodeOctahedral8(uint encoded)
+{
+	return decodeOctahedral(unpackSnorm4x8(encoded).xy);
+}
+
+// float16x2
+vec2 decodeTextureCoordinate(uint encoded)
+{
+	return unpackHalf2x16(encoded);
+}
+
+// unorm8x4
+vec4 decodeJointWeights(uint encoded)
+{
+	return unpackUnorm4x8(encoded);
+}
+
+#endif
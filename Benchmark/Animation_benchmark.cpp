@@ -0,0 +1,177 @@
+#include "Benchmark.hpp"
+
+#include <AnimationCache.hpp>
+#include <AnimationSimd.hpp>
+#include <CrowdUpdater.hpp>
+#include <MeshImporter.hpp>
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+RTRG_BENCHMARK(SamplePoseCesiumMan)
+{
+	auto importer = AssetImporter{ Benchmark::AssetPath("Meshes/CesiumMan.glb") };
+	if (not importer.HasLoadedScene())
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	const auto skeleton = importer.ImportSkeleton(0);
+	const auto dataSet = importer.LoadAllAnimations(skeleton, 60);
+	const auto dataSetSoA = ConvertToSoA(dataSet);
+	const auto& clip = dataSet.animations.front();
+
+	auto pose = std::vector<JointAnimationData>(clip.count);
+	constexpr auto iterations = 200000u;
+	const auto timeStep = clip.duration / 997.0f;
+
+	const auto aos = Benchmark::Measure("AoS scalar", iterations, [&](U32 i)
+										{ SamplePose(dataSet, clip, Math::Modulo(i * timeStep, clip.duration), pose); });
+
+	for (const auto [instructionSet, name] :
+		 { std::pair{ SimdInstructionSet::scalar, "SoA scalar" }, std::pair{ SimdInstructionSet::sse, "SoA SSE" },
+		   std::pair{ SimdInstructionSet::avx2, "SoA AVX2" } })
+	{
+		if (not IsInstructionSetSupported(instructionSet))
+		{
+			continue;
+		}
+		const auto soa =
+			Benchmark::Measure(name, iterations,
+							   [&](U32 i)
+							   {
+								   SamplePose(dataSetSoA, clip, Math::Modulo(i * timeStep, clip.duration), pose,
+											  instructionSet);
+							   });
+		Benchmark::ReportSpeedup(aos, soa);
+	}
+}
+
+RTRG_BENCHMARK(SkinningMatricesCesiumMan)
+{
+	auto importer = AssetImporter{ Benchmark::AssetPath("Meshes/CesiumMan.glb") };
+	if (not importer.HasLoadedScene())
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	const auto skeleton = importer.ImportSkeleton(0);
+	const auto dataSet = importer.LoadAllAnimations(skeleton, 60);
+	const auto& clip = dataSet.animations.front();
+	const auto pose = SamplePose(dataSet, clip, 0.5f * clip.duration);
+
+	auto modelSpaceMatrices = std::vector<Math::Matrix4x4>(clip.count);
+	auto modelSpacePose = std::vector<JointAnimationData>(clip.count);
+	auto skinningMatrices = std::vector<Math::Matrix4x4>(clip.count);
+	constexpr auto iterations = 200000u;
+
+	const auto matrices = Benchmark::Measure("ComputeJointsMatrices + ApplyBindPose", iterations,
+											 [&](U32)
+											 {
+												 ComputeJointsMatrices(pose.data, skeleton, modelSpaceMatrices);
+												 ApplyBindPose(modelSpaceMatrices, skeleton, skinningMatrices);
+											 });
+	const auto fused =
+		Benchmark::Measure("ComputeSkinningMatrices", iterations,
+						   [&](U32) { ComputeSkinningMatrices(pose.data, skeleton, modelSpacePose, skinningMatrices); });
+	Benchmark::ReportSpeedup(matrices, fused);
+}
+
+RTRG_BENCHMARK(CrowdLodCesiumMan)
+{
+	auto importer = AssetImporter{ Benchmark::AssetPath("Meshes/CesiumMan.glb") };
+	if (not importer.HasLoadedScene())
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	const auto skeletons = std::vector<Skeleton>{ importer.ImportSkeleton(0) };
+	const auto dataSet = importer.LoadAllAnimations(skeletons[0], 60);
+	const auto camera = Camera{ .position = Math::Vector3{ 0.0f, 0.0f, 0.0f },
+								.forward = Math::Vector3{ 0.0f, 0.0f, 1.0f },
+								.up = Math::Vector3{ 0.0f, 1.0f, 0.0f } };
+
+	for (const auto instancesCount : { 250u, 1000u, 4000u })
+	{
+		// Characters spread evenly between 2 and 100 meters in front of the camera.
+		auto instances = std::vector<CrowdInstance>{};
+		for (auto i = 0u; i < instancesCount; i++)
+		{
+			const auto distance = 2.0f + 98.0f * static_cast<Float>(i) / static_cast<Float>(instancesCount);
+			instances.push_back(CrowdInstance{ .animation = { .data = dataSet.animations.front(),
+															  .playbackRate = 1.0f,
+															  .startTime = 0.001f * i,
+															  .loop = true },
+											   .position = Math::Vector3{ 0.0f, 0.0f, distance } });
+		}
+
+		auto crowdUpdater = CrowdUpdater{};
+		auto skinningMatrices = std::vector<Math::Matrix4x4>(crowdUpdater.Prepare(skeletons, instances));
+		const auto iterations = 400000u / instancesCount;
+
+		const auto offName = runtime_format("{} instances, LOD off", instancesCount);
+		const auto off = Benchmark::Measure(offName, iterations,
+											[&](U32 i)
+											{
+												crowdUpdater.Update(dataSet, skeletons, instances, i / 60.0f,
+																	skinningMatrices);
+											});
+
+		crowdUpdater.SelectLodLevels(camera, instances);
+		const auto onName = runtime_format("{} instances, LOD on", instancesCount);
+		const auto on = Benchmark::Measure(onName, iterations,
+										   [&](U32 i)
+										   {
+											   crowdUpdater.Update(dataSet, skeletons, instances, i / 60.0f,
+																   skinningMatrices);
+										   });
+		Benchmark::ReportSpeedup(off, on);
+	}
+}
+
+RTRG_BENCHMARK(LoadAnimationCesiumMan)
+{
+	const auto assetPath = Benchmark::AssetPath("Meshes/CesiumMan.glb");
+	if (not std::filesystem::exists(assetPath))
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	// Works on a copy, so the benchmark never deletes a cooked file next to the real asset.
+	const auto directory = std::filesystem::temp_directory_path() / "Animation_benchmark";
+	std::filesystem::create_directories(directory);
+	const auto sourcePath = directory / "CesiumMan.glb";
+	std::filesystem::copy_file(assetPath, sourcePath, std::filesystem::copy_options::overwrite_existing);
+	const auto cookedPath = GetCookedAnimationPath(sourcePath, 60);
+	constexpr auto iterations = 20u;
+
+	const auto cold = Benchmark::Measure("Cold: import with Assimp and cook", iterations,
+										 [&](U32)
+										 {
+											 std::filesystem::remove(cookedPath);
+											 const auto cooked = LoadOrCookAnimation(sourcePath, 60);
+										 });
+	const auto warm = Benchmark::Measure("Warm: map cooked file", iterations,
+										 [&](U32) { const auto cooked = LoadOrCookAnimation(sourcePath, 60); });
+	Benchmark::ReportSpeedup(cold, warm);
+
+	std::filesystem::remove_all(directory);
+}
+
+RTRG_BENCHMARK(LoadAllAnimationsCesiumMan)
+{
+	auto importer = AssetImporter{ Benchmark::AssetPath("Meshes/CesiumMan.glb") };
+	if (not importer.HasLoadedScene())
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	const auto skeleton = importer.ImportSkeleton(0);
+	Benchmark::Measure("Resample all clips at 60 Hz", 100,
+					   [&](U32) { const auto dataSet = importer.LoadAllAnimations(skeleton, 60); });
+}
@@ -0,0 +1,54 @@
+#include "Benchmark.hpp"
+
+#include <AssetHelper.hpp>
+
+#include <fstream>
+#include <vector>
+
+using namespace Framework;
+
+RTRG_BENCHMARK(LoadAssetCatalogue)
+{
+	// 10k files of 10 nodes, names and node data repeat from one file to the next as they do in real projects.
+	auto uuidGenerator = uuids::uuid_system_generator{};
+	auto files = std::vector<AssetFile>(10000);
+	for (auto i = 0u; i < files.size(); i++)
+	{
+		files[i] = AssetFile{
+			.uuid = uuidGenerator(), .name = runtime_format("Meshes/Prop_{}.glb", i), .version = 1, .assets = {}
+		};
+		for (auto j = 0u; j < 10; j++)
+		{
+			files[i].assets.push_back(AssetNode{ .uuid = uuidGenerator(),
+												 .name = runtime_format("LOD{}", j),
+												 .type = AssetType::subMesh,
+												 .version = 1,
+												 .assetNodeData = R"({"material":"default"})" });
+		}
+	}
+	{
+		auto stream = std::ofstream{ "benchmark_catalogue.json" };
+		stream << nlohmann::json(files);
+	}
+	WriteAssetMetadata("benchmark_catalogue.assetmeta", files);
+
+	auto namesSize = std::size_t{ 0 };
+	const auto LoadJson = [&](U32)
+	{
+		auto stream = std::ifstream{ "benchmark_catalogue.json" };
+		const auto loaded = nlohmann::json::parse(stream).get<std::vector<AssetFile>>();
+		namesSize += loaded.back().assets.back().name.size();
+	};
+	const auto LoadBinary = [&](U32)
+	{
+		const auto catalogue = AssetCatalogue::Open("benchmark_catalogue.assetmeta");
+		for (const auto& node : catalogue->GetNodes())
+		{
+			namesSize += catalogue->GetName(node).size();
+		}
+	};
+	const auto json = Benchmark::Measure("JSON, 100k nodes", 5, LoadJson);
+	const auto binary = Benchmark::Measure("Binary, 100k nodes", 5, LoadBinary);
+	Benchmark::ReportSpeedup(json, binary);
+	std::println("Names read {}", namesSize);
+}
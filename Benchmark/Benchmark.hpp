@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Core.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <print>
+#include <string_view>
+#include <vector>
+
+namespace Framework
+{
+	namespace Benchmark
+	{
+		struct Result
+		{
+			std::string_view name;
+			double nanosecondsPerIteration{};
+		};
+
+		template <typename Function>
+		Result Measure(std::string_view name, U32 iterations, Function&& function)
+		{
+			for (auto i = 0u; i < iterations / 10 + 1; i++)
+			{
+				function(i);
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (auto i = 0u; i < iterations; i++)
+			{
+				function(i);
+			}
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			const auto result = Result{
+				name, std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations)
+			};
+			std::println("{:<48} {:>12.1f} ns/iteration", result.name, result.nanosecondsPerIteration);
+			return result;
+		}
+
+		inline void ReportSpeedup(const Result& baseline, const Result& result)
+		{
+			std::println("{:<48} {:>12.2f}x vs {}", result.name,
+						 baseline.nanosecondsPerIteration / result.nanosecondsPerIteration, baseline.name);
+		}
+
+		inline std::filesystem::path AssetPath(const std::filesystem::path& relativePath)
+		{
+			return std::filesystem::path{ RTRG_BENCHMARK_ASSETS_DIR } / relativePath;
+		}
+
+		struct Registry
+		{
+			static std::vector<std::pair<std::string_view, std::function<void()>>>& Benchmarks()
+			{
+				static auto benchmarks = std::vector<std::pair<std::string_view, std::function<void()>>>{};
+				return benchmarks;
+			}
+
+			Registry(std::string_view name, std::function<void()> benchmark)
+			{
+				Benchmarks().emplace_back(name, std::move(benchmark));
+			}
+		};
+	} // namespace Benchmark
+} // namespace Framework
+
+#define RTRG_BENCHMARK(name)                                                                                           \
+	static void name();                                                                                                \
+	static const auto name##_registration = Framework::Benchmark::Registry{ #name, name };                              \
+	static void name()
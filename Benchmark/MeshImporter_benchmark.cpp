@@ -0,0 +1,74 @@
+#include "Benchmark.hpp"
+
+#include <MeshCodec.hpp>
+#include <MeshImporter.hpp>
+#include <MeshOptimizer.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+using namespace Framework;
+
+RTRG_BENCHMARK(ImportSkinnedMeshCesiumMan)
+{
+	auto importer = AssetImporter{ Benchmark::AssetPath("Meshes/CesiumMan.glb") };
+	if (not importer.HasLoadedScene())
+	{
+		std::println("CesiumMan.glb not found, skipped");
+		return;
+	}
+
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+												  .hasPosition = true, .hasJointsIndexAndWeights = true } } };
+	Benchmark::Measure("Positions and skin weights", 200,
+					   [&](U32) { const auto meshData = importer.ImportMesh(0, settings); });
+}
+
+RTRG_BENCHMARK(DecodeMeshCodec)
+{
+	// Optimized 512x512 grid with 16 byte quantized vertices, about 4 MiB of indices and 4 MiB of vertices.
+	constexpr auto size = 512u;
+	auto indices = std::vector<U32>{};
+	for (auto y = 0u; y < size; y++)
+	{
+		for (auto x = 0u; x < size; x++)
+		{
+			const auto corner = y * (size + 1) + x;
+			indices.insert(indices.end(),
+						   { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 });
+		}
+	}
+	const auto verticesCount = (size + 1) * (size + 1);
+	Geometry::OptimizeVertexCache(indices, verticesCount);
+	const auto newToOld = Geometry::OptimizeVertexFetch(indices, verticesCount);
+
+	auto vertices = std::vector<std::array<U16, 8>>(newToOld.size());
+	for (auto i = 0u; i < newToOld.size(); i++)
+	{
+		const auto x = static_cast<U16>(newToOld[i] % (size + 1) * 127);
+		const auto y = static_cast<U16>(newToOld[i] / (size + 1) * 127);
+		vertices[i] = { x, y, static_cast<U16>((x ^ y) & 0xFF), 0, 0x7FFF, 0x7FFF, x, y };
+	}
+
+	const auto encodedIndices = Geometry::EncodeIndexBuffer(std::as_bytes(std::span{ indices }), sizeof(U32));
+	const auto encodedVertices = Geometry::EncodeVertexBuffer(std::as_bytes(std::span{ vertices }), 16);
+	std::println("Encoded indices {:.2f} bytes per triangle, vertices {:.1f}% of their size",
+				 static_cast<double>(encodedIndices.size()) / static_cast<double>(indices.size() / 3),
+				 100.0 * static_cast<double>(encodedVertices.size()) / static_cast<double>(vertices.size() * 16));
+
+	auto decodedIndices = std::vector<U32>(indices.size());
+	auto decodedVertices = std::vector<std::array<U16, 8>>(vertices.size());
+	Benchmark::Measure("Decode indices", 50,
+					   [&](U32)
+					   {
+						   Geometry::DecodeIndexBuffer(std::as_writable_bytes(std::span{ decodedIndices }),
+													   encodedIndices);
+					   });
+	Benchmark::Measure("Decode vertices", 50,
+					   [&](U32)
+					   {
+						   Geometry::DecodeVertexBuffer(std::as_writable_bytes(std::span{ decodedVertices }),
+														encodedVertices);
+					   });
+}
@@ -0,0 +1,23 @@
+#include "Benchmark.hpp"
+
+#include <string_view>
+
+using namespace Framework;
+
+// Runs every registered benchmark, or only those whose name contains the first command line argument.
+int main(int argc, char** argv)
+{
+	const auto filter = argc > 1 ? std::string_view{ argv[1] } : std::string_view{};
+
+	for (const auto& [name, benchmark] : Benchmark::Registry::Benchmarks())
+	{
+		if (not filter.empty() and not name.contains(filter))
+		{
+			continue;
+		}
+		std::println("[{}]", name);
+		benchmark();
+		std::println("");
+	}
+	return 0;
+}
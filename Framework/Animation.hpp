@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <span>
 #include <vector>
 
 #include "Core.hpp"
@@ -34,6 +37,7 @@ namespace Framework
 		{
 			Math::Quaternion rotation;
 			Math::Vector3 translation;
+			Math::Vector3 scale{ 1.0f };
 		};
 
 		struct LocalPose
@@ -48,9 +52,18 @@ namespace Framework
 			I32 parentIndex;
 			std::string name; // For debug only
 		};
+		/*
+		 * Joints are stored parent before child with the single root at index 0, so one forward pass over the
+		 * joints visits every parent before its children. parentIndices and inverseBindPoses are packed copies of
+		 * the joint fields for the per-frame loops, filled by BuildSkeletonHierarchy(). Joints are also sorted by
+		 * depth, so the joints up to a given depth are a prefix of the skeleton of length jointsCountUpToDepth[depth].
+		 */
 		struct Skeleton
 		{
 			std::vector<Joint> joints;
+			std::vector<I32> parentIndices;
+			std::vector<Math::Matrix4x4> inverseBindPoses;
+			std::vector<U32> jointsCountUpToDepth;
 		};
 
 		struct AnimationDataSet
@@ -59,6 +72,26 @@ namespace Framework
 			std::vector<JointAnimationData> animationDatabase;
 		};
 
+		// Non-owning form of AnimationDataSet used by sampling, so the database can also live in a mapped file.
+		struct AnimationDataSetView
+		{
+			AnimationDataSetView() = default;
+
+			AnimationDataSetView(const AnimationDataSet& animationDataSet)
+				: animations{ animationDataSet.animations }, animationDatabase{ animationDataSet.animationDatabase }
+			{
+			}
+
+			AnimationDataSetView(std::span<const AnimationData> animations,
+								 std::span<const JointAnimationData> animationDatabase)
+				: animations{ animations }, animationDatabase{ animationDatabase }
+			{
+			}
+
+			std::span<const AnimationData> animations;
+			std::span<const JointAnimationData> animationDatabase;
+		};
+
 
 		namespace Detail
 		{
@@ -66,115 +99,367 @@ namespace Framework
 			{
 				const auto rotor = Math::Matrix4x4::From(joint.rotation);
 				const auto translate = Math::Matrix4x4::TranslationFrom(joint.translation);
-				return translate * rotor;
+				return translate * rotor * Math::Matrix4x4::ScaleFrom(joint.scale);
+			}
+
+			// Model space transform of a joint times its inverse bind pose. The rotation is expanded to 3x3 once and
+			// the implied (0, 0, 0, 1) bottom row of the model space transform is never multiplied.
+			inline Math::Matrix4x4 ComputeSkinningMatrix(const JointAnimationData& modelSpace,
+														 const Math::Matrix4x4& inverseBindPose)
+			{
+				const auto rotation = glm::toMat3(modelSpace.rotation);
+				auto result = Math::Matrix4x4{};
+				for (auto column = 0; column < 4; column++)
+				{
+					const auto& bind = inverseBindPose[column];
+					result[column] = Math::Vector4{
+						rotation * (modelSpace.scale * Math::Vector3{ bind }) + modelSpace.translation * bind.w,
+						bind.w };
+				}
+				return result;
+			}
+
+			struct SampleFrames
+			{
+				U32 first;
+				U32 second;
+				Float rest;
+			};
+
+			inline SampleFrames ComputeSampleFrames(const AnimationData& data, Float time)
+			{
+				Float fps = data.frames / data.duration;
+				Float timePerFrame = data.duration / data.frames;
+				Float index = time * fps;
+
+
+				const auto first = Math::Modulo(As<U32>(Math::Floor(index)), data.frames);
+				auto second = Math::Modulo(As<U32>(Math::Ceil(index)), data.frames);
+
+				Float t1 = first*timePerFrame;
+				Float t2 = second*timePerFrame;
+				Float rest = (time - t1)/(t2-t1);
+
+				return SampleFrames{ first, second, rest };
+			}
+
+			// Clip tables of derived animation layouts keep the source AnimationData in ascending offset order, so
+			// an AnimationInstance created from the dense set can be looked up in any of them.
+			inline U32 FindClipIndex(std::span<const AnimationData> animations, const AnimationData& data)
+			{
+				const auto it = std::lower_bound(animations.begin(), animations.end(), data.offset,
+												 [](const AnimationData& clip, U32 offset)
+												 { return clip.offset < offset; });
+				assert(it != animations.end() and it->offset == data.offset);
+				return static_cast<U32>(std::distance(animations.begin(), it));
 			}
 		} // namespace Detail
 
-		inline std::vector<Math::Matrix4x4> ComputeJointsMatrices(const LocalPose& pose, const Skeleton& skeleton)
+		inline bool IsHierarchyOrdered(const Skeleton& skeleton)
 		{
-			ZoneScoped;
-			assert(pose.data.size() > 0);
-			assert(pose.data.size() == skeleton.joints.size());
+			if (skeleton.joints.empty() or skeleton.joints[0].parentIndex >= 0)
+			{
+				return false;
+			}
+			for (auto i = 1; i < skeleton.joints.size(); i++)
+			{
+				const auto parentIndex = skeleton.joints[i].parentIndex;
+				if (parentIndex < 0 or parentIndex >= i)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
 
-			const auto totalJoints = pose.data.size();
+		// The packed arrays are only filled by BuildSkeletonHierarchy(), the per-frame loops index them directly.
+		inline bool HasPackedHierarchy(const Skeleton& skeleton)
+		{
+			const auto jointsCount = skeleton.joints.size();
+			return jointsCount > 0 and skeleton.parentIndices.size() == jointsCount and
+				skeleton.inverseBindPoses.size() == jointsCount and not skeleton.jointsCountUpToDepth.empty() and
+				skeleton.jointsCountUpToDepth.back() == jointsCount;
+		}
 
-			auto matrices = std::vector<Math::Matrix4x4>{};
-			matrices.resize(totalJoints);
+		// Reorders the joints by depth and fills the packed arrays. Must run before joint indices are handed out,
+		// e.g. to skin weights or animation tracks.
+		inline void BuildSkeletonHierarchy(Skeleton& skeleton)
+		{
+			assert(IsHierarchyOrdered(skeleton));
+			const auto jointsCount = skeleton.joints.size();
+
+			auto depths = std::vector<U32>(jointsCount, 0);
+			for (auto i = 1; i < jointsCount; i++)
+			{
+				depths[i] = depths[skeleton.joints[i].parentIndex] + 1;
+			}
+
+			// A stable sort by depth keeps every parent in front of its children.
+			auto order = std::vector<U32>(jointsCount);
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [&](U32 a, U32 b) { return depths[a] < depths[b]; });
+
+			auto newIndices = std::vector<I32>(jointsCount);
+			for (auto i = 0; i < jointsCount; i++)
+			{
+				newIndices[order[i]] = i;
+			}
+
+			auto joints = std::vector<Joint>{};
+			joints.reserve(jointsCount);
+			for (const auto index : order)
+			{
+				joints.push_back(std::move(skeleton.joints[index]));
+				auto& joint = joints.back();
+				joint.parentIndex = joint.parentIndex >= 0 ? newIndices[joint.parentIndex] : -1;
+			}
+			skeleton.joints = std::move(joints);
+
+			skeleton.parentIndices.resize(jointsCount);
+			skeleton.inverseBindPoses.resize(jointsCount);
+			skeleton.jointsCountUpToDepth.clear();
+			for (auto i = 0; i < jointsCount; i++)
+			{
+				skeleton.parentIndices[i] = skeleton.joints[i].parentIndex;
+				skeleton.inverseBindPoses[i] = skeleton.joints[i].inverseBindPose;
+
+				const auto depth = depths[order[i]];
+				skeleton.jointsCountUpToDepth.resize(depth + 1, i);
+				skeleton.jointsCountUpToDepth[depth] = i + 1;
+			}
+		}
+
+		// Number of joints to evaluate when everything deeper than maxJointDepth follows its parent. The root and
+		// its children are always evaluated, see ComputeSkinningMatrices().
+		inline U32 GetJointsCountUpToDepth(const Skeleton& skeleton, U32 maxJointDepth)
+		{
+			assert(HasPackedHierarchy(skeleton));
+			const auto depth = std::max(maxJointDepth, 1u);
+			return depth < skeleton.jointsCountUpToDepth.size() ? skeleton.jointsCountUpToDepth[depth] :
+																  skeleton.jointsCountUpToDepth.back();
+		}
+
+		/**
+		 * Linear scratch memory for intermediate poses. Reserve it once, then Allocate() poses during the frame
+		 * and Reset() at the end of it. Allocate() never grows the storage, so no heap allocation happens after
+		 * the initial Reserve().
+		 */
+		struct PoseArena
+		{
+			void Reserve(std::size_t jointsCount)
+			{
+				storage.resize(jointsCount);
+				used = 0;
+			}
+
+			std::span<JointAnimationData> Allocate(std::size_t jointsCount)
+			{
+				assert(used + jointsCount <= storage.size());
+				const auto pose = std::span<JointAnimationData>{ storage.data() + used, jointsCount };
+				used += jointsCount;
+				return pose;
+			}
+
+			void Reset()
+			{
+				used = 0;
+			}
+
+			std::vector<JointAnimationData> storage;
+			std::size_t used{ 0 };
+		};
+
+		inline PoseArena& GetThreadPoseArena()
+		{
+			thread_local auto arena = PoseArena{};
+			return arena;
+		}
+
+		inline void ComputeJointsMatrices(std::span<const JointAnimationData> pose, const Skeleton& skeleton,
+										  std::span<Math::Matrix4x4> matrices)
+		{
+			ZoneScoped;
+			assert(HasPackedHierarchy(skeleton));
+			assert(pose.size() > 0);
+			assert(pose.size() == skeleton.parentIndices.size());
+			assert(matrices.size() == pose.size());
 
 			const auto rootIndex = 0;
-			matrices[rootIndex] = Detail::ComputeJointMatrix(pose.data[rootIndex]);
+			matrices[rootIndex] = Detail::ComputeJointMatrix(pose[rootIndex]);
 
 			for (auto i = 1; i < matrices.size(); i++)
 			{
-				matrices[i] = matrices[skeleton.joints[i].parentIndex] * Detail::ComputeJointMatrix(pose.data[i]);
+				matrices[i] = matrices[skeleton.parentIndices[i]] * Detail::ComputeJointMatrix(pose[i]);
 			}
+		}
 
+		inline std::vector<Math::Matrix4x4> ComputeJointsMatrices(const LocalPose& pose, const Skeleton& skeleton)
+		{
+			auto matrices = std::vector<Math::Matrix4x4>{};
+			matrices.resize(pose.data.size());
+			ComputeJointsMatrices(pose.data, skeleton, matrices);
 			return matrices;
 		}
 
-		inline void ApplyBindPose(std::vector<Math::Matrix4x4>& jointsMatrices, const Skeleton& skeleton)
+		inline void ApplyBindPose(std::span<Math::Matrix4x4> jointsMatrices, const Skeleton& skeleton)
 		{
 			ZoneScoped;
+			assert(HasPackedHierarchy(skeleton));
 			assert(jointsMatrices.size() > 0);
-			assert(jointsMatrices.size() == skeleton.joints.size());
+			assert(jointsMatrices.size() == skeleton.inverseBindPoses.size());
 
 			for (auto i = 1; i < jointsMatrices.size(); i++)
 			{
-				jointsMatrices[i] = jointsMatrices[i] * skeleton.joints[i].inverseBindPose;
+				jointsMatrices[i] = jointsMatrices[i] * skeleton.inverseBindPoses[i];
 			}
 		}
 
-		inline LocalPose BlendPose(const LocalPose& pose0, const LocalPose& pose1, Float blendFactor)
+		inline void ApplyBindPose(std::span<const Math::Matrix4x4> jointsMatrices, const Skeleton& skeleton,
+								  std::span<Math::Matrix4x4> skinningMatrices)
 		{
 			ZoneScoped;
-			assert(pose0.data.size() == pose1.data.size());
-
-			auto finalPose = LocalPose{};
-			finalPose.data.resize(pose0.data.size());
+			assert(HasPackedHierarchy(skeleton));
+			assert(jointsMatrices.size() > 0);
+			assert(jointsMatrices.size() == skeleton.inverseBindPoses.size());
+			assert(skinningMatrices.size() == jointsMatrices.size());
 
-			for (auto i = 0; i < pose0.data.size(); i++)
+			skinningMatrices[0] = jointsMatrices[0];
+			for (auto i = 1; i < jointsMatrices.size(); i++)
 			{
-				finalPose.data[i].rotation = Math::Slerp(pose0.data[i].rotation, pose1.data[i].rotation, blendFactor);
-				finalPose.data[i].translation =
-					Math::Mix(pose0.data[i].translation, pose1.data[i].translation, blendFactor);
+				skinningMatrices[i] = jointsMatrices[i] * skeleton.inverseBindPoses[i];
 			}
-			return finalPose;
 		}
 
-		inline LocalPose SamplePose(const AnimationDataSet& animationDataSet, const AnimationData& data, Float time)
+		/**
+		 * Same result as ComputeJointsMatrices() followed by ApplyBindPose(), in a single pass. The local to model
+		 * chain is concatenated as rotation, translation and scale, which is cheaper than a 4x4 product, and each
+		 * joint is turned into a matrix only once, already multiplied with its inverse bind pose. The model space
+		 * pose is read back by the children and should live in cached scratch memory. Scales multiply per axis, so
+		 * under a non-uniformly scaled parent a rotated child is scaled along its own axes instead of being sheared
+		 * like with the matrix product.
+		 *
+		 * The pose may cover only the first joints of the skeleton (see GetJointsCountUpToDepth()). The remaining
+		 * joints keep their bind pose relative to their parent, which makes their skinning matrix equal to the one
+		 * of the parent.
+		 */
+		inline void ComputeSkinningMatrices(std::span<const JointAnimationData> pose, const Skeleton& skeleton,
+											std::span<JointAnimationData> modelSpacePose,
+											std::span<Math::Matrix4x4> skinningMatrices)
 		{
 			ZoneScoped;
-			auto pose = LocalPose{}; // normally this should be allocated outside of the function call
-			pose.data.resize(data.count);
+			assert(HasPackedHierarchy(skeleton));
+			assert(pose.size() > 0);
+			assert(pose.size() <= skeleton.parentIndices.size());
+			assert(modelSpacePose.size() >= pose.size());
+			assert(skinningMatrices.size() == skeleton.parentIndices.size());
 
-			Float fps = data.frames / data.duration;
-			Float timePerFrame = data.duration / data.frames;
-			Float index = time * fps;
+			const auto rootIndex = 0;
+			modelSpacePose[rootIndex] = pose[rootIndex];
+			skinningMatrices[rootIndex] = Detail::ComputeJointMatrix(pose[rootIndex]);
 
+			for (auto i = 1; i < pose.size(); i++)
+			{
+				const auto& parent = modelSpacePose[skeleton.parentIndices[i]];
+				auto& joint = modelSpacePose[i];
+				joint.rotation = parent.rotation * pose[i].rotation;
+				joint.translation = parent.translation + parent.rotation * (parent.scale * pose[i].translation);
+				joint.scale = parent.scale * pose[i].scale;
+				skinningMatrices[i] = Detail::ComputeSkinningMatrix(joint, skeleton.inverseBindPoses[i]);
+			}
 
-			const auto first = Math::Modulo(As<U32>(Math::Floor(index)), data.frames);
-			auto second = Math::Modulo(As<U32>(Math::Ceil(index)), data.frames);
+			for (auto i = pose.size(); i < skinningMatrices.size(); i++)
+			{
+				// The root matrix does not include its inverse bind pose, so it cannot be shared.
+				assert(skeleton.parentIndices[i] > 0);
+				skinningMatrices[i] = skinningMatrices[skeleton.parentIndices[i]];
+			}
+		}
+
+		inline void BlendPose(std::span<const JointAnimationData> pose0, std::span<const JointAnimationData> pose1,
+							  Float blendFactor, std::span<JointAnimationData> finalPose)
+		{
+			ZoneScoped;
+			assert(pose0.size() == pose1.size());
+			assert(finalPose.size() == pose0.size());
+
+			for (auto i = 0; i < pose0.size(); i++)
+			{
+				finalPose[i].rotation = Math::Slerp(pose0[i].rotation, pose1[i].rotation, blendFactor);
+				finalPose[i].translation = Math::Mix(pose0[i].translation, pose1[i].translation, blendFactor);
+				finalPose[i].scale = Math::Mix(pose0[i].scale, pose1[i].scale, blendFactor);
+			}
+		}
+
+		inline LocalPose BlendPose(const LocalPose& pose0, const LocalPose& pose1, Float blendFactor)
+		{
+			auto finalPose = LocalPose{};
+			finalPose.data.resize(pose0.data.size());
+			BlendPose(pose0.data, pose1.data, blendFactor, finalPose.data);
+			return finalPose;
+		}
 
-			Float t1 = first*timePerFrame;
-			Float t2 = second*timePerFrame;
-			Float rest = (time - t1)/(t2-t1);
+		// Samples the first pose.size() joints of the clip, a shorter pose skips the deepest joints.
+		inline void SamplePose(AnimationDataSetView animationDataSet, const AnimationData& data, Float time,
+							   std::span<JointAnimationData> pose)
+		{
+			ZoneScoped;
+			assert(pose.size() <= data.count);
 
+			const auto [first, second, rest] = Detail::ComputeSampleFrames(data, time);
 
 			if (first == second)
 			{
-				for (auto i = 0; i < data.count; i++)
+				for (auto i = 0; i < pose.size(); i++)
 				{
 					const auto& joint = animationDataSet.animationDatabase[data.offset + first * data.count + i];
-					pose.data[i] = joint;
+					pose[i] = joint;
 				}
 			}
 			else
 			{
-				for (auto i = 0; i < data.count; i++)
+				for (auto i = 0; i < pose.size(); i++)
 				{
 					const auto& jointA = animationDataSet.animationDatabase[data.offset + first * data.count + i];
 					const auto& jointB = animationDataSet.animationDatabase[data.offset + second * data.count + i];
 
-					pose.data[i].rotation = Math::Slerp(jointA.rotation, jointB.rotation, rest);
-					pose.data[i].translation = Math::Mix(jointA.translation, jointB.translation, rest);
+					pose[i].rotation = Math::Slerp(jointA.rotation, jointB.rotation, rest);
+					pose[i].translation = Math::Mix(jointA.translation, jointB.translation, rest);
+					pose[i].scale = Math::Mix(jointA.scale, jointB.scale, rest);
 				}
 			}
+		}
 
+		inline LocalPose SamplePose(AnimationDataSetView animationDataSet, const AnimationData& data, Float time)
+		{
+			auto pose = LocalPose{};
+			pose.data.resize(data.count);
+			SamplePose(animationDataSet, data, time, pose.data);
 			return pose;
 		}
 
-		inline LocalPose SamplePose(const AnimationDataSet& animationDataSet, const AnimationInstance& instance,
-									Float globalTime)
+		inline Float ComputeLocalTime(const AnimationInstance& instance, Float globalTime)
 		{
-			ZoneScoped;
 			Float localTime = (globalTime - instance.startTime) * instance.playbackRate;
 
 			if (instance.loop)
 			{
 				localTime = Math::Modulo(localTime, instance.data.duration);
 			}
+			return localTime;
+		}
 
-			return SamplePose(animationDataSet, instance.data, localTime);
+		inline void SamplePose(AnimationDataSetView animationDataSet, const AnimationInstance& instance,
+							   Float globalTime, std::span<JointAnimationData> pose)
+		{
+			ZoneScoped;
+			SamplePose(animationDataSet, instance.data, ComputeLocalTime(instance, globalTime), pose);
+		}
+
+		inline LocalPose SamplePose(AnimationDataSetView animationDataSet, const AnimationInstance& instance,
+									Float globalTime)
+		{
+			ZoneScoped;
+			return SamplePose(animationDataSet, instance.data, ComputeLocalTime(instance, globalTime));
 		}
 
 	} // namespace Animation
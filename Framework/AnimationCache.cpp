@@ -0,0 +1,234 @@
+#include "AnimationCache.hpp"
+
+#include "MeshImporter.hpp"
+#include "Profiler.hpp"
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	constexpr auto cookedAnimationMagic = U32{ 0x43415452 }; // "RTAC"
+	constexpr auto databaseAlignment = U64{ 64 };
+
+	struct CookedAnimationHeader
+	{
+		U32 magic{ 0 };
+		U32 version{ 0 };
+		U64 sourceHash{ 0 };
+		U32 resampleRate{ 0 };
+		U32 jointsCount{ 0 };
+		U32 clipsCount{ 0 };
+		U32 stringsSize{ 0 };
+		U64 jointsOffset{ 0 };
+		U64 clipsOffset{ 0 };
+		U64 stringsOffset{ 0 };
+		U64 databaseOffset{ 0 };
+		U64 databaseCount{ 0 };
+	};
+
+	struct CookedJoint
+	{
+		Float inverseBindPose[16]{};
+		Float inverseTransform[16]{};
+		I32 parentIndex{ 0 };
+		U32 nameOffset{ 0 };
+		U32 nameLength{ 0 };
+	};
+
+	struct CookedClip
+	{
+		U32 offset{ 0 };
+		U32 count{ 0 };
+		U32 frames{ 0 };
+		Float duration{ 0.0f };
+		U32 nameOffset{ 0 };
+		U32 nameLength{ 0 };
+	};
+
+	static_assert(std::is_trivially_copyable_v<JointAnimationData>);
+	static_assert(sizeof(JointAnimationData) == 40);
+	static_assert(sizeof(Math::Matrix4x4) == 16 * sizeof(Float));
+
+	constexpr U64 AlignUp(U64 value, U64 alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+} // namespace
+
+std::filesystem::path Animation::GetCookedAnimationPath(const std::filesystem::path& sourcePath, U32 resampleRate)
+{
+	auto cookedPath = sourcePath;
+	cookedPath += runtime_format(".{}hz.animcache", resampleRate);
+	return cookedPath;
+}
+
+bool Animation::WriteCookedAnimation(const std::filesystem::path& cookedPath, U64 sourceHash, U32 resampleRate,
+									 const Skeleton& skeleton, AnimationDataSetView animationDataSet)
+{
+	ZoneScoped;
+	auto strings = std::string{};
+	auto joints = std::vector<CookedJoint>{};
+	joints.reserve(skeleton.joints.size());
+	for (const auto& joint : skeleton.joints)
+	{
+		auto cookedJoint = CookedJoint{ .parentIndex = joint.parentIndex,
+										.nameOffset = static_cast<U32>(strings.size()),
+										.nameLength = static_cast<U32>(joint.name.size()) };
+		std::memcpy(cookedJoint.inverseBindPose, &joint.inverseBindPose, sizeof(cookedJoint.inverseBindPose));
+		std::memcpy(cookedJoint.inverseTransform, &joint.inverseTransform, sizeof(cookedJoint.inverseTransform));
+		joints.push_back(cookedJoint);
+		strings += joint.name;
+	}
+
+	auto clips = std::vector<CookedClip>{};
+	clips.reserve(animationDataSet.animations.size());
+	for (const auto& clip : animationDataSet.animations)
+	{
+		clips.push_back(CookedClip{ .offset = clip.offset,
+									.count = clip.count,
+									.frames = clip.frames,
+									.duration = clip.duration,
+									.nameOffset = static_cast<U32>(strings.size()),
+									.nameLength = static_cast<U32>(clip.animationName.size()) });
+		strings += clip.animationName;
+	}
+
+	auto header = CookedAnimationHeader{ .magic = cookedAnimationMagic,
+										 .version = cookedAnimationVersion,
+										 .sourceHash = sourceHash,
+										 .resampleRate = resampleRate,
+										 .jointsCount = static_cast<U32>(joints.size()),
+										 .clipsCount = static_cast<U32>(clips.size()),
+										 .stringsSize = static_cast<U32>(strings.size()),
+										 .databaseCount = animationDataSet.animationDatabase.size() };
+	header.jointsOffset = sizeof(CookedAnimationHeader);
+	header.clipsOffset = header.jointsOffset + joints.size() * sizeof(CookedJoint);
+	header.stringsOffset = header.clipsOffset + clips.size() * sizeof(CookedClip);
+	header.databaseOffset = AlignUp(header.stringsOffset + strings.size(), databaseAlignment);
+
+	const auto padding = std::vector<std::byte>(header.databaseOffset - header.stringsOffset - strings.size());
+	const auto pieces = std::array<std::span<const std::byte>, 6>{
+		std::as_bytes(std::span{ &header, 1 }), std::as_bytes(std::span{ joints }), std::as_bytes(std::span{ clips }),
+		std::as_bytes(std::span{ strings }), std::span{ padding }, std::as_bytes(animationDataSet.animationDatabase)
+	};
+	return WriteFileAtomically(cookedPath, pieces);
+}
+
+std::optional<CookedAnimation> Animation::LoadCookedAnimation(const std::filesystem::path& cookedPath,
+															  U64 sourceHash, U32 resampleRate)
+{
+	ZoneScoped;
+	auto file = MappedFile{ cookedPath };
+	if (not file.IsOpen())
+	{
+		return std::nullopt;
+	}
+
+	const auto data = file.GetData();
+	auto header = CookedAnimationHeader{};
+	if (data.size() < sizeof(header))
+	{
+		return std::nullopt;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	if (header.magic != cookedAnimationMagic or header.version != cookedAnimationVersion or
+		header.sourceHash != sourceHash or header.resampleRate != resampleRate)
+	{
+		return std::nullopt;
+	}
+	if (not IsRangeInside(header.jointsOffset, U64{ header.jointsCount } * sizeof(CookedJoint), data.size()) or
+		not IsRangeInside(header.clipsOffset, U64{ header.clipsCount } * sizeof(CookedClip), data.size()) or
+		not IsRangeInside(header.stringsOffset, header.stringsSize, data.size()) or
+		not IsRangeInside(header.databaseOffset, header.databaseCount * sizeof(JointAnimationData), data.size()) or
+		header.databaseOffset % databaseAlignment != 0 or header.jointsCount == 0)
+	{
+		return std::nullopt;
+	}
+
+	const auto strings =
+		std::string_view{ reinterpret_cast<const char*>(data.data() + header.stringsOffset), header.stringsSize };
+	const auto GetString = [&](U32 offset, U32 length)
+	{ return offset <= strings.size() ? strings.substr(offset, length) : std::string_view{}; };
+
+	auto result = CookedAnimation{};
+	result.skeleton.joints.reserve(header.jointsCount);
+	for (auto i = 0u; i < header.jointsCount; i++)
+	{
+		auto cookedJoint = CookedJoint{};
+		std::memcpy(&cookedJoint, data.data() + header.jointsOffset + i * sizeof(CookedJoint), sizeof(CookedJoint));
+
+		auto joint = Joint{ .inverseBindPose = Math::Matrix4x4::Identity(),
+							.inverseTransform = Math::Matrix4x4::Identity(),
+							.parentIndex = cookedJoint.parentIndex,
+							.name = std::string{ GetString(cookedJoint.nameOffset, cookedJoint.nameLength) } };
+		std::memcpy(&joint.inverseBindPose, cookedJoint.inverseBindPose, sizeof(cookedJoint.inverseBindPose));
+		std::memcpy(&joint.inverseTransform, cookedJoint.inverseTransform, sizeof(cookedJoint.inverseTransform));
+		result.skeleton.joints.push_back(std::move(joint));
+	}
+	if (not IsHierarchyOrdered(result.skeleton))
+	{
+		return std::nullopt;
+	}
+	BuildSkeletonHierarchy(result.skeleton);
+
+	result.animations.reserve(header.clipsCount);
+	for (auto i = 0u; i < header.clipsCount; i++)
+	{
+		auto clip = CookedClip{};
+		std::memcpy(&clip, data.data() + header.clipsOffset + i * sizeof(CookedClip), sizeof(CookedClip));
+		if (U64{ clip.offset } + U64{ clip.count } * clip.frames > header.databaseCount)
+		{
+			return std::nullopt;
+		}
+		result.animations.push_back(AnimationData{ .offset = clip.offset,
+												   .count = clip.count,
+												   .frames = clip.frames,
+												   .duration = clip.duration,
+												   .animationName =
+													   std::string{ GetString(clip.nameOffset, clip.nameLength) } });
+	}
+
+	result.animationDatabase = std::span{
+		reinterpret_cast<const JointAnimationData*>(data.data() + header.databaseOffset), header.databaseCount
+	};
+	result.file = std::move(file);
+	return result;
+}
+
+CookedAnimation Animation::LoadOrCookAnimation(const std::filesystem::path& sourcePath, U32 resampleRate)
+{
+	ZoneScoped;
+	const auto sourceHash = HashFile(sourcePath);
+	const auto cookedPath = GetCookedAnimationPath(sourcePath, resampleRate);
+
+	if (auto cooked = LoadCookedAnimation(cookedPath, sourceHash, resampleRate))
+	{
+		return std::move(*cooked);
+	}
+
+	auto importer = AssetImporter{ sourcePath };
+	assert(importer.HasLoadedScene());
+	auto skeleton = importer.ImportSkeleton(0);
+	auto animationDataSet = importer.LoadAllAnimations(skeleton, static_cast<int>(resampleRate));
+
+	if (WriteCookedAnimation(cookedPath, sourceHash, resampleRate, skeleton, animationDataSet))
+	{
+		if (auto cooked = LoadCookedAnimation(cookedPath, sourceHash, resampleRate))
+		{
+			return std::move(*cooked);
+		}
+	}
+
+	auto result = CookedAnimation{};
+	result.skeleton = std::move(skeleton);
+	result.animations = std::move(animationDataSet.animations);
+	result.ownedAnimationDatabase = std::move(animationDataSet.animationDatabase);
+	result.animationDatabase = result.ownedAnimationDatabase;
+	return result;
+}
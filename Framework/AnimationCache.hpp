@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Animation.hpp"
+#include "MappedFile.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		/*
+		 * Skeleton and resampled clips of one source file, cooked into a binary file next to the source. The
+		 * animation database is used in place from the mapped file, only the skeleton and the clip table (which
+		 * hold strings) are unpacked on load. A cooked file is valid for one source content hash and resample rate.
+		 */
+		struct CookedAnimation
+		{
+			AnimationDataSetView GetDataSet() const
+			{
+				return AnimationDataSetView{ animations, animationDatabase };
+			}
+
+			Skeleton skeleton;
+			std::vector<AnimationData> animations;
+			std::span<const JointAnimationData> animationDatabase;
+
+			MappedFile file;
+			// Only used when the cooked file could not be written, e.g. for a read-only asset folder.
+			std::vector<JointAnimationData> ownedAnimationDatabase;
+		};
+
+		// Bump whenever the cooked layout or the importer output changes, older files are then cooked again.
+		inline constexpr U32 cookedAnimationVersion = 3;
+
+		std::filesystem::path GetCookedAnimationPath(const std::filesystem::path& sourcePath, U32 resampleRate);
+
+		bool WriteCookedAnimation(const std::filesystem::path& cookedPath, U64 sourceHash, U32 resampleRate,
+								  const Skeleton& skeleton, AnimationDataSetView animationDataSet);
+
+		// Empty when the file is missing, malformed or was cooked from another source hash or resample rate.
+		std::optional<CookedAnimation> LoadCookedAnimation(const std::filesystem::path& cookedPath, U64 sourceHash,
+														   U32 resampleRate);
+
+		// Loads the cooked file of the first skinned mesh of sourcePath, cooks it with the AssetImporter first when
+		// it is missing or stale.
+		CookedAnimation LoadOrCookAnimation(const std::filesystem::path& sourcePath, U32 resampleRate);
+	} // namespace Animation
+} // namespace Framework
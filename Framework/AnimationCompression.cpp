@@ -0,0 +1,373 @@
+#include "AnimationCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Profiler.hpp"
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	constexpr auto smallestThreeBits = 15u;
+	constexpr auto smallestThreeMaximum = Float((1u << smallestThreeBits) - 1);
+	constexpr auto translationMaximum = Float(0xFFFF);
+	constexpr auto sqrt2 = 1.41421356237f;
+
+	Float RotationError(const Math::Quaternion& a, const Math::Quaternion& b)
+	{
+		// atan2 of the relative rotation stays accurate for tiny angles, unlike acos of the dot product.
+		const auto difference = glm::conjugate(a) * b;
+		const auto sine = glm::length(Math::Vector3{ difference.x, difference.y, difference.z });
+		return 2.0f * std::atan2(sine, std::abs(difference.w));
+	}
+
+	Float TranslationError(const Math::Vector3& a, const Math::Vector3& b)
+	{
+		return glm::length(a - b);
+	}
+
+	/*
+	 * Greedy keyframe reduction: starting at a key, the next key is pushed as far as possible while every frame
+	 * in between is reconstructed within the budget by interpolating the two decoded keys. First and last frame
+	 * are always keys.
+	 */
+	template <typename T, typename Interpolate, typename Error>
+	void ReduceKeys(std::span<const T> source, std::span<const T> decoded, Float budget, Interpolate interpolate,
+					Error error, std::vector<U16>& keyFrames)
+	{
+		const auto framesCount = static_cast<U32>(source.size());
+		const auto fits = [&](U32 a, U32 b)
+		{
+			for (auto k = a + 1; k < b; k++)
+			{
+				const auto factor = static_cast<Float>(k - a) / static_cast<Float>(b - a);
+				if (error(interpolate(decoded[a], decoded[b], factor), source[k]) > budget)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		keyFrames.push_back(0);
+		auto a = 0u;
+		while (a < framesCount - 1)
+		{
+			auto b = a + 1;
+			while (b + 1 < framesCount and fits(a, b + 1))
+			{
+				b++;
+			}
+			keyFrames.push_back(static_cast<U16>(b));
+			a = b;
+		}
+	}
+
+	template <typename Decode, typename Interpolate>
+	auto SampleTrack(const CompressedTrack& track, std::span<const U16> keyFrames, Float framePosition,
+					 Decode decode, Interpolate interpolate)
+	{
+		if (track.keysCount == 1)
+		{
+			return decode(track.firstKey);
+		}
+
+		const auto frames = keyFrames.subspan(track.firstKey, track.keysCount);
+		const auto next = std::upper_bound(frames.begin(), frames.end(), framePosition,
+										   [](Float position, U16 frame) { return position < frame; });
+		if (next == frames.begin())
+		{
+			return decode(track.firstKey);
+		}
+		if (next == frames.end())
+		{
+			return decode(track.firstKey + track.keysCount - 1);
+		}
+
+		const auto b = static_cast<U32>(std::distance(frames.begin(), next));
+		const auto a = b - 1;
+		const auto factor = (framePosition - frames[a]) / static_cast<Float>(frames[b] - frames[a]);
+		return interpolate(decode(track.firstKey + a), decode(track.firstKey + b), factor);
+	}
+
+	void CompressRotationTrack(std::span<const Math::Quaternion> rotations, const AnimationCompressionSettings& settings,
+							   CompressedAnimationDataSet& result, std::vector<Math::Quaternion>& decoded)
+	{
+		decoded.clear();
+		for (const auto& rotation : rotations)
+		{
+			decoded.push_back(Detail::DequantizeRotation(Detail::QuantizeRotation(rotation)));
+		}
+
+		const auto isConstant = std::all_of(rotations.begin(), rotations.end(),
+											[&](const Math::Quaternion& rotation) {
+												return RotationError(decoded.front(), rotation) <=
+													settings.rotationErrorBudget;
+											});
+
+		auto track = CompressedTrack{ .firstKey = static_cast<U32>(result.rotationKeys.size()) };
+		if (isConstant)
+		{
+			result.rotationKeyFrames.push_back(0);
+		}
+		else
+		{
+			ReduceKeys<Math::Quaternion>(rotations, decoded, settings.rotationErrorBudget, Math::Slerp,
+										 RotationError, result.rotationKeyFrames);
+		}
+		track.keysCount = static_cast<U32>(result.rotationKeyFrames.size()) - track.firstKey;
+
+		for (auto i = track.firstKey; i < track.firstKey + track.keysCount; i++)
+		{
+			result.rotationKeys.push_back(Detail::QuantizeRotation(rotations[result.rotationKeyFrames[i]]));
+		}
+		result.rotationTracks.push_back(track);
+	}
+
+	// Where the keys of one kind of vector track go, translations and scales share the encoding.
+	struct VectorTracks
+	{
+		std::vector<CompressedTrack>& tracks;
+		std::vector<TranslationRange>& ranges;
+		std::vector<U16>& keyFrames;
+		std::vector<QuantizedTranslation>& keys;
+	};
+
+	void CompressVectorTrack(std::span<const Math::Vector3> values, Float errorBudget, VectorTracks result,
+							 std::vector<Math::Vector3>& decoded)
+	{
+		const auto isConstant = std::all_of(values.begin(), values.end(),
+											[&](const Math::Vector3& value)
+											{ return TranslationError(values.front(), value) <= errorBudget; });
+
+		auto range = TranslationRange{ .minimum = values.front(), .extent = Math::Vector3{ 0.0f } };
+		if (not isConstant)
+		{
+			auto maximum = values.front();
+			for (const auto& value : values)
+			{
+				range.minimum = glm::min(range.minimum, value);
+				maximum = glm::max(maximum, value);
+			}
+			range.extent = maximum - range.minimum;
+		}
+
+		decoded.clear();
+		for (const auto& value : values)
+		{
+			decoded.push_back(Detail::DequantizeTranslation(Detail::QuantizeTranslation(value, range), range));
+		}
+
+		auto track = CompressedTrack{ .firstKey = static_cast<U32>(result.keys.size()) };
+		if (isConstant)
+		{
+			result.keyFrames.push_back(0);
+		}
+		else
+		{
+			ReduceKeys<Math::Vector3>(values, decoded, errorBudget, Math::Mix, TranslationError, result.keyFrames);
+		}
+		track.keysCount = static_cast<U32>(result.keyFrames.size()) - track.firstKey;
+
+		for (auto i = track.firstKey; i < track.firstKey + track.keysCount; i++)
+		{
+			result.keys.push_back(Detail::QuantizeTranslation(values[result.keyFrames[i]], range));
+		}
+		result.tracks.push_back(track);
+		result.ranges.push_back(range);
+	}
+} // namespace
+
+QuantizedRotation Framework::Animation::Detail::QuantizeRotation(const Math::Quaternion& rotation)
+{
+	const Float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+
+	auto largest = 0u;
+	for (auto i = 1u; i < 4; i++)
+	{
+		if (std::abs(components[i]) > std::abs(components[largest]))
+		{
+			largest = i;
+		}
+	}
+	// q and -q are the same rotation, flipping makes the dropped component positive.
+	const auto sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+	auto packed = U64{ largest };
+	for (auto i = 0u; i < 4; i++)
+	{
+		if (i == largest)
+		{
+			continue;
+		}
+		const auto normalized = std::clamp(components[i] * sign * sqrt2, -1.0f, 1.0f);
+		const auto quantized = static_cast<U64>(std::lround((normalized + 1.0f) * 0.5f * smallestThreeMaximum));
+		packed = (packed << smallestThreeBits) | quantized;
+	}
+
+	return QuantizedRotation{ { static_cast<U16>(packed >> 32), static_cast<U16>(packed >> 16),
+								static_cast<U16>(packed) } };
+}
+
+Math::Quaternion Framework::Animation::Detail::DequantizeRotation(const QuantizedRotation& rotation)
+{
+	auto packed = (U64{ rotation.data[0] } << 32) | (U64{ rotation.data[1] } << 16) | U64{ rotation.data[2] };
+	const auto largest = static_cast<U32>(packed >> (3 * smallestThreeBits)) & 3u;
+
+	Float components[4];
+	auto sumOfSquares = 0.0f;
+	for (auto i = 4u; i-- > 0;)
+	{
+		if (i == largest)
+		{
+			continue;
+		}
+		const auto quantized = static_cast<Float>(packed & ((1u << smallestThreeBits) - 1));
+		packed >>= smallestThreeBits;
+		components[i] = (quantized / smallestThreeMaximum * 2.0f - 1.0f) / sqrt2;
+		sumOfSquares += components[i] * components[i];
+	}
+	components[largest] = std::sqrt(std::max(0.0f, 1.0f - sumOfSquares));
+
+	return Math::Quaternion{ components[3], components[0], components[1], components[2] };
+}
+
+QuantizedTranslation Framework::Animation::Detail::QuantizeTranslation(const Math::Vector3& translation,
+																		const TranslationRange& range)
+{
+	auto result = QuantizedTranslation{};
+	for (auto i = 0; i < 3; i++)
+	{
+		const auto normalized =
+			range.extent[i] > 0.0f ? std::clamp((translation[i] - range.minimum[i]) / range.extent[i], 0.0f, 1.0f) :
+									 0.0f;
+		result.data[i] = static_cast<U16>(std::lround(normalized * translationMaximum));
+	}
+	return result;
+}
+
+Math::Vector3 Framework::Animation::Detail::DequantizeTranslation(const QuantizedTranslation& translation,
+																   const TranslationRange& range)
+{
+	return range.minimum +
+		range.extent *
+		Math::Vector3{ translation.data[0] / translationMaximum, translation.data[1] / translationMaximum,
+					   translation.data[2] / translationMaximum };
+}
+
+std::size_t CompressedAnimationDataSet::GetMemoryFootprint() const
+{
+	return trackOffsets.size() * sizeof(U32) + rotationTracks.size() * sizeof(CompressedTrack) +
+		translationTracks.size() * sizeof(CompressedTrack) + translationRanges.size() * sizeof(TranslationRange) +
+		rotationKeyFrames.size() * sizeof(U16) + rotationKeys.size() * sizeof(QuantizedRotation) +
+		translationKeyFrames.size() * sizeof(U16) + translationKeys.size() * sizeof(QuantizedTranslation) +
+		scaleTracks.size() * sizeof(CompressedTrack) + scaleRanges.size() * sizeof(TranslationRange) +
+		scaleKeyFrames.size() * sizeof(U16) + scaleKeys.size() * sizeof(QuantizedTranslation);
+}
+
+CompressedAnimationDataSet Framework::Animation::Compress(const AnimationDataSet& animationDataSet,
+														  const AnimationCompressionSettings& settings)
+{
+	ZoneScoped;
+	auto result = CompressedAnimationDataSet{};
+	result.animations = animationDataSet.animations;
+
+	auto rotations = std::vector<Math::Quaternion>{};
+	auto translations = std::vector<Math::Vector3>{};
+	auto scales = std::vector<Math::Vector3>{};
+	auto decodedRotations = std::vector<Math::Quaternion>{};
+	auto decodedVectors = std::vector<Math::Vector3>{};
+	const auto translationTracks = VectorTracks{ .tracks = result.translationTracks,
+												 .ranges = result.translationRanges,
+												 .keyFrames = result.translationKeyFrames,
+												 .keys = result.translationKeys };
+	const auto scaleTracks = VectorTracks{ .tracks = result.scaleTracks,
+										   .ranges = result.scaleRanges,
+										   .keyFrames = result.scaleKeyFrames,
+										   .keys = result.scaleKeys };
+
+	for (const auto& clip : animationDataSet.animations)
+	{
+		assert(clip.frames > 0 and clip.frames <= 0xFFFF);
+		result.trackOffsets.push_back(static_cast<U32>(result.rotationTracks.size()));
+
+		for (auto joint = 0u; joint < clip.count; joint++)
+		{
+			rotations.clear();
+			translations.clear();
+			scales.clear();
+			for (auto frame = 0u; frame < clip.frames; frame++)
+			{
+				const auto& source = animationDataSet.animationDatabase[clip.offset + frame * clip.count + joint];
+				rotations.push_back(source.rotation);
+				translations.push_back(source.translation);
+				scales.push_back(source.scale);
+			}
+
+			CompressRotationTrack(rotations, settings, result, decodedRotations);
+			CompressVectorTrack(translations, settings.translationErrorBudget, translationTracks, decodedVectors);
+			CompressVectorTrack(scales, settings.scaleErrorBudget, scaleTracks, decodedVectors);
+		}
+	}
+	return result;
+}
+
+void Framework::Animation::SamplePose(const CompressedAnimationDataSet& animationDataSet, const AnimationData& data,
+									  Float time, std::span<JointAnimationData> pose)
+{
+	ZoneScoped;
+	assert(pose.size() == data.count);
+
+	const auto trackOffset = animationDataSet.trackOffsets[Detail::FindClipIndex(animationDataSet.animations, data)];
+	const auto [first, second, rest] = Detail::ComputeSampleFrames(data, time);
+	// Neighbouring frames are sampled in a single lookup, only the wrap around at the clip end needs two.
+	const auto isSingleLookup = first == second or (second == first + 1 and rest >= 0.0f and rest <= 1.0f);
+	const auto framePosition = first == second ? static_cast<Float>(first) : first + rest;
+
+	for (auto joint = 0u; joint < data.count; joint++)
+	{
+		const auto trackIndex = trackOffset + joint;
+		const auto& range = animationDataSet.translationRanges[trackIndex];
+		const auto& scaleRange = animationDataSet.scaleRanges[trackIndex];
+
+		const auto decodeRotation = [&](U32 key)
+		{ return Detail::DequantizeRotation(animationDataSet.rotationKeys[key]); };
+		const auto decodeTranslation = [&](U32 key)
+		{ return Detail::DequantizeTranslation(animationDataSet.translationKeys[key], range); };
+		const auto decodeScale = [&](U32 key)
+		{ return Detail::DequantizeTranslation(animationDataSet.scaleKeys[key], scaleRange); };
+		const auto sampleRotation = [&](Float position)
+		{
+			return SampleTrack(animationDataSet.rotationTracks[trackIndex], animationDataSet.rotationKeyFrames,
+							   position, decodeRotation, Math::Slerp);
+		};
+		const auto sampleTranslation = [&](Float position)
+		{
+			return SampleTrack(animationDataSet.translationTracks[trackIndex], animationDataSet.translationKeyFrames,
+							   position, decodeTranslation, Math::Mix);
+		};
+		const auto sampleScale = [&](Float position)
+		{
+			return SampleTrack(animationDataSet.scaleTracks[trackIndex], animationDataSet.scaleKeyFrames, position,
+							   decodeScale, Math::Mix);
+		};
+
+		if (isSingleLookup)
+		{
+			pose[joint].rotation = sampleRotation(framePosition);
+			pose[joint].translation = sampleTranslation(framePosition);
+			pose[joint].scale = sampleScale(framePosition);
+		}
+		else
+		{
+			pose[joint].rotation = Math::Slerp(sampleRotation(static_cast<Float>(first)),
+											   sampleRotation(static_cast<Float>(second)), rest);
+			pose[joint].translation = Math::Mix(sampleTranslation(static_cast<Float>(first)),
+												sampleTranslation(static_cast<Float>(second)), rest);
+			pose[joint].scale =
+				Math::Mix(sampleScale(static_cast<Float>(first)), sampleScale(static_cast<Float>(second)), rest);
+		}
+	}
+}
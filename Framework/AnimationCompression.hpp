@@ -0,0 +1,94 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Animation.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		struct AnimationCompressionSettings
+		{
+			// Largest tolerated angle in radians between a decoded and a source rotation.
+			Float rotationErrorBudget{ 0.002f };
+			// Largest tolerated distance between a decoded and a source translation.
+			Float translationErrorBudget{ 0.0005f };
+			// Largest tolerated distance between a decoded and a source scale.
+			Float scaleErrorBudget{ 0.0005f };
+		};
+
+		/*
+		 * A track is the rotation, translation or scale channel of one joint in one clip. Only the frames needed to
+		 * reconstruct the track within the error budget are stored as keys, a constant track keeps a single key.
+		 * Rotations are stored as smallest-three quaternions in 48 bits, translations and scales as 16 bit per
+		 * component relative to the range of their track.
+		 */
+		struct CompressedTrack
+		{
+			U32 firstKey{ 0 };
+			U32 keysCount{ 0 };
+		};
+
+		struct QuantizedRotation
+		{
+			U16 data[3];
+		};
+
+		struct QuantizedTranslation
+		{
+			U16 data[3];
+		};
+
+		struct TranslationRange
+		{
+			Math::Vector3 minimum;
+			Math::Vector3 extent;
+		};
+
+		struct CompressedAnimationDataSet
+		{
+			// Same clip descriptions as the source AnimationDataSet. Joint j of clip i uses the tracks and ranges at
+			// index trackOffsets[i] + j.
+			std::vector<AnimationData> animations;
+			std::vector<U32> trackOffsets;
+
+			std::vector<CompressedTrack> rotationTracks;
+			std::vector<CompressedTrack> translationTracks;
+			std::vector<TranslationRange> translationRanges;
+			std::vector<CompressedTrack> scaleTracks;
+			std::vector<TranslationRange> scaleRanges;
+
+			std::vector<U16> rotationKeyFrames;
+			std::vector<QuantizedRotation> rotationKeys;
+			std::vector<U16> translationKeyFrames;
+			std::vector<QuantizedTranslation> translationKeys;
+			std::vector<U16> scaleKeyFrames;
+			std::vector<QuantizedTranslation> scaleKeys;
+
+			std::size_t GetMemoryFootprint() const;
+		};
+
+		namespace Detail
+		{
+			QuantizedRotation QuantizeRotation(const Math::Quaternion& rotation);
+			Math::Quaternion DequantizeRotation(const QuantizedRotation& rotation);
+			QuantizedTranslation QuantizeTranslation(const Math::Vector3& translation, const TranslationRange& range);
+			Math::Vector3 DequantizeTranslation(const QuantizedTranslation& translation,
+												const TranslationRange& range);
+		} // namespace Detail
+
+		CompressedAnimationDataSet Compress(const AnimationDataSet& animationDataSet,
+											const AnimationCompressionSettings& settings = {});
+
+		void SamplePose(const CompressedAnimationDataSet& animationDataSet, const AnimationData& data, Float time,
+						std::span<JointAnimationData> pose);
+
+		inline void SamplePose(const CompressedAnimationDataSet& animationDataSet, const AnimationInstance& instance,
+							   Float globalTime, std::span<JointAnimationData> pose)
+		{
+			SamplePose(animationDataSet, instance.data, ComputeLocalTime(instance, globalTime), pose);
+		}
+	} // namespace Animation
+} // namespace Framework
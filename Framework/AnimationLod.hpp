@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Animation.hpp"
+#include "Camera.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		struct AnimationLodLevel
+		{
+			// The level is used while the character covers at least this fraction of the viewport height.
+			Float minimumScreenSize{ 0.0f };
+			// The pose is evaluated every updateInterval frames and reused in between.
+			U32 updateInterval{ 1 };
+			// Joints deeper than this keep their bind pose relative to their parent, e.g. fingers.
+			U32 maxJointDepth{ std::numeric_limits<U32>::max() };
+		};
+
+		struct AnimationLodSettings
+		{
+			// Ordered from the most to the least detailed level, the first level the screen size reaches is used.
+			std::vector<AnimationLodLevel> levels{
+				AnimationLodLevel{ .minimumScreenSize = 0.25f },
+				AnimationLodLevel{ .minimumScreenSize = 0.1f, .updateInterval = 2, .maxJointDepth = 6 },
+				AnimationLodLevel{ .minimumScreenSize = 0.0f, .updateInterval = 4, .maxJointDepth = 3 }
+			};
+		};
+
+		// Projected diameter of a bounding sphere as a fraction of the viewport height.
+		inline Float ComputeScreenSize(const Camera& camera, const Math::Vector3& center, Float radius)
+		{
+			const auto distance = glm::length(center - camera.position);
+			if (distance <= radius)
+			{
+				return 1.0f;
+			}
+			return radius / (distance * std::tan(0.5f * camera.verticalFieldOfView));
+		}
+
+		inline U32 SelectLodLevel(const AnimationLodSettings& settings, Float screenSize)
+		{
+			assert(not settings.levels.empty());
+			for (auto i = 0u; i < settings.levels.size(); i++)
+			{
+				if (screenSize >= settings.levels[i].minimumScreenSize)
+				{
+					return i;
+				}
+			}
+			return static_cast<U32>(settings.levels.size() - 1);
+		}
+	} // namespace Animation
+} // namespace Framework
@@ -0,0 +1,374 @@
+#include "AnimationSimd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define RTRG_ANIMATION_SIMD_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RTRG_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define RTRG_TARGET_AVX2
+#endif
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	struct FrameLanes
+	{
+		const Float* frame;
+		U32 laneStride;
+
+		const Float* Lane(SoALane lane) const
+		{
+			return frame + static_cast<U32>(lane) * laneStride;
+		}
+
+		Math::Quaternion Rotation(U32 joint) const
+		{
+			return Math::Quaternion{ Lane(SoALane::rotationW)[joint], Lane(SoALane::rotationX)[joint],
+									 Lane(SoALane::rotationY)[joint], Lane(SoALane::rotationZ)[joint] };
+		}
+
+		Math::Vector3 Translation(U32 joint) const
+		{
+			return Math::Vector3{ Lane(SoALane::translationX)[joint], Lane(SoALane::translationY)[joint],
+								  Lane(SoALane::translationZ)[joint] };
+		}
+
+		Math::Vector3 Scale(U32 joint) const
+		{
+			return Math::Vector3{ Lane(SoALane::scaleX)[joint], Lane(SoALane::scaleY)[joint],
+								  Lane(SoALane::scaleZ)[joint] };
+		}
+	};
+
+	// Kernels compute one block of joints into lane-shaped scratch memory, the block is then transposed back into
+	// the AoS pose. Joints flagged in slerpMask are interpolated again with Math::Slerp.
+	template <U32 Width>
+	struct BlockResult
+	{
+		alignas(soaLaneAlignment) Float lanes[static_cast<U32>(SoALane::count)][Width];
+	};
+
+	template <U32 Width>
+	void StoreBlock(const BlockResult<Width>& block, U32 slerpMask, const FrameLanes& frameA,
+					const FrameLanes& frameB, Float factor, U32 firstJoint, std::span<JointAnimationData> pose)
+	{
+		const auto jointsInBlock = std::min(Width, static_cast<U32>(pose.size()) - firstJoint);
+		for (auto i = 0u; i < jointsInBlock; i++)
+		{
+			auto& joint = pose[firstJoint + i];
+			if (slerpMask & (1u << i))
+			{
+				joint.rotation =
+					Math::Slerp(frameA.Rotation(firstJoint + i), frameB.Rotation(firstJoint + i), factor);
+			}
+			else
+			{
+				joint.rotation = Math::Quaternion{
+					block.lanes[static_cast<U32>(SoALane::rotationW)][i],
+					block.lanes[static_cast<U32>(SoALane::rotationX)][i],
+					block.lanes[static_cast<U32>(SoALane::rotationY)][i],
+					block.lanes[static_cast<U32>(SoALane::rotationZ)][i] };
+			}
+			joint.translation = Math::Vector3{ block.lanes[static_cast<U32>(SoALane::translationX)][i],
+											   block.lanes[static_cast<U32>(SoALane::translationY)][i],
+											   block.lanes[static_cast<U32>(SoALane::translationZ)][i] };
+			joint.scale = Math::Vector3{ block.lanes[static_cast<U32>(SoALane::scaleX)][i],
+										 block.lanes[static_cast<U32>(SoALane::scaleY)][i],
+										 block.lanes[static_cast<U32>(SoALane::scaleZ)][i] };
+		}
+	}
+
+	void CopyFrame(const FrameLanes& frame, std::span<JointAnimationData> pose)
+	{
+		for (auto i = 0u; i < pose.size(); i++)
+		{
+			pose[i].rotation = frame.Rotation(i);
+			pose[i].translation = frame.Translation(i);
+			pose[i].scale = frame.Scale(i);
+		}
+	}
+
+	void InterpolateScalar(const FrameLanes& frameA, const FrameLanes& frameB, Float factor,
+						   std::span<JointAnimationData> pose)
+	{
+		for (auto i = 0u; i < pose.size(); i++)
+		{
+			const auto rotationA = frameA.Rotation(i);
+			auto rotationB = frameB.Rotation(i);
+			const auto cosine = glm::dot(rotationA, rotationB);
+
+			if (std::abs(cosine) < Detail::nlerpMinimumCosine)
+			{
+				pose[i].rotation = Math::Slerp(rotationA, rotationB, factor);
+			}
+			else
+			{
+				rotationB = cosine < 0.0f ? -rotationB : rotationB;
+				pose[i].rotation = glm::normalize(rotationA * (1.0f - factor) + rotationB * factor);
+			}
+			pose[i].translation = Math::Mix(frameA.Translation(i), frameB.Translation(i), factor);
+			pose[i].scale = Math::Mix(frameA.Scale(i), frameB.Scale(i), factor);
+		}
+	}
+
+#ifdef RTRG_ANIMATION_SIMD_X64
+	void InterpolateSse(const FrameLanes& frameA, const FrameLanes& frameB, Float factor,
+						std::span<JointAnimationData> pose)
+	{
+		constexpr auto width = 4u;
+		const auto t = _mm_set1_ps(factor);
+		const auto oneMinusT = _mm_set1_ps(1.0f - factor);
+		const auto one = _mm_set1_ps(1.0f);
+		const auto signBit = _mm_set1_ps(-0.0f);
+		const auto minimumCosine = _mm_set1_ps(Detail::nlerpMinimumCosine);
+
+		auto block = BlockResult<width>{};
+		for (auto joint = 0u; joint < pose.size(); joint += width)
+		{
+			__m128 a[4];
+			__m128 b[4];
+			for (auto c = 0u; c < 4; c++)
+			{
+				a[c] = _mm_load_ps(frameA.Lane(static_cast<SoALane>(c)) + joint);
+				b[c] = _mm_load_ps(frameB.Lane(static_cast<SoALane>(c)) + joint);
+			}
+
+			auto cosine = _mm_mul_ps(a[0], b[0]);
+			for (auto c = 1u; c < 4; c++)
+			{
+				cosine = _mm_add_ps(cosine, _mm_mul_ps(a[c], b[c]));
+			}
+			// Take the shortest arc by flipping the second key where the cosine is negative.
+			const auto flip = _mm_and_ps(cosine, signBit);
+			const auto absoluteCosine = _mm_andnot_ps(signBit, cosine);
+
+			__m128 r[4];
+			auto lengthSquared = _mm_setzero_ps();
+			for (auto c = 0u; c < 4; c++)
+			{
+				r[c] = _mm_add_ps(_mm_mul_ps(a[c], oneMinusT), _mm_mul_ps(_mm_xor_ps(b[c], flip), t));
+				lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(r[c], r[c]));
+			}
+			const auto inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+			for (auto c = 0u; c < 4; c++)
+			{
+				_mm_store_ps(block.lanes[c], _mm_mul_ps(r[c], inverseLength));
+			}
+
+			for (auto c = 4u; c < static_cast<U32>(SoALane::count); c++)
+			{
+				const auto ta = _mm_load_ps(frameA.Lane(static_cast<SoALane>(c)) + joint);
+				const auto tb = _mm_load_ps(frameB.Lane(static_cast<SoALane>(c)) + joint);
+				_mm_store_ps(block.lanes[c], _mm_add_ps(_mm_mul_ps(ta, oneMinusT), _mm_mul_ps(tb, t)));
+			}
+
+			const auto slerpMask =
+				static_cast<U32>(_mm_movemask_ps(_mm_cmplt_ps(absoluteCosine, minimumCosine)));
+			StoreBlock(block, slerpMask, frameA, frameB, factor, joint, pose);
+		}
+	}
+
+	RTRG_TARGET_AVX2 void InterpolateAvx2(const FrameLanes& frameA, const FrameLanes& frameB, Float factor,
+										  std::span<JointAnimationData> pose)
+	{
+		constexpr auto width = 8u;
+		const auto t = _mm256_set1_ps(factor);
+		const auto oneMinusT = _mm256_set1_ps(1.0f - factor);
+		const auto one = _mm256_set1_ps(1.0f);
+		const auto signBit = _mm256_set1_ps(-0.0f);
+		const auto minimumCosine = _mm256_set1_ps(Detail::nlerpMinimumCosine);
+
+		auto block = BlockResult<width>{};
+		for (auto joint = 0u; joint < pose.size(); joint += width)
+		{
+			__m256 a[4];
+			__m256 b[4];
+			for (auto c = 0u; c < 4; c++)
+			{
+				a[c] = _mm256_load_ps(frameA.Lane(static_cast<SoALane>(c)) + joint);
+				b[c] = _mm256_load_ps(frameB.Lane(static_cast<SoALane>(c)) + joint);
+			}
+
+			auto cosine = _mm256_mul_ps(a[0], b[0]);
+			for (auto c = 1u; c < 4; c++)
+			{
+				cosine = _mm256_fmadd_ps(a[c], b[c], cosine);
+			}
+			const auto flip = _mm256_and_ps(cosine, signBit);
+			const auto absoluteCosine = _mm256_andnot_ps(signBit, cosine);
+
+			__m256 r[4];
+			auto lengthSquared = _mm256_setzero_ps();
+			for (auto c = 0u; c < 4; c++)
+			{
+				r[c] = _mm256_fmadd_ps(_mm256_xor_ps(b[c], flip), t, _mm256_mul_ps(a[c], oneMinusT));
+				lengthSquared = _mm256_fmadd_ps(r[c], r[c], lengthSquared);
+			}
+			const auto inverseLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared));
+			for (auto c = 0u; c < 4; c++)
+			{
+				_mm256_store_ps(block.lanes[c], _mm256_mul_ps(r[c], inverseLength));
+			}
+
+			for (auto c = 4u; c < static_cast<U32>(SoALane::count); c++)
+			{
+				const auto ta = _mm256_load_ps(frameA.Lane(static_cast<SoALane>(c)) + joint);
+				const auto tb = _mm256_load_ps(frameB.Lane(static_cast<SoALane>(c)) + joint);
+				_mm256_store_ps(block.lanes[c], _mm256_fmadd_ps(tb, t, _mm256_mul_ps(ta, oneMinusT)));
+			}
+
+			const auto slerpMask = static_cast<U32>(
+				_mm256_movemask_ps(_mm256_cmp_ps(absoluteCosine, minimumCosine, _CMP_LT_OQ)));
+			StoreBlock(block, slerpMask, frameA, frameB, factor, joint, pose);
+		}
+	}
+#endif
+} // namespace
+
+AnimationDataSetSoA Framework::Animation::ConvertToSoA(const AnimationDataSet& animationDataSet)
+{
+	auto result = AnimationDataSetSoA{};
+	result.animations = animationDataSet.animations;
+	result.laneOffsets.reserve(animationDataSet.animations.size());
+
+	auto totalSize = std::size_t{ 0 };
+	for (const auto& clip : animationDataSet.animations)
+	{
+		totalSize += static_cast<std::size_t>(clip.frames) * Detail::SoAFrameStride(clip.count);
+	}
+	result.animationDatabase.resize(totalSize, 0.0f);
+
+	auto laneOffset = U32{ 0 };
+	for (const auto& clip : animationDataSet.animations)
+	{
+		result.laneOffsets.push_back(laneOffset);
+		const auto laneStride = Detail::SoALaneStride(clip.count);
+
+		for (auto frame = 0u; frame < clip.frames; frame++)
+		{
+			auto* lanes = result.animationDatabase.data() + laneOffset + frame * Detail::SoAFrameStride(clip.count);
+			auto lane = [&](SoALane laneIndex) { return lanes + static_cast<U32>(laneIndex) * laneStride; };
+
+			for (auto joint = 0u; joint < clip.count; joint++)
+			{
+				const auto& source = animationDataSet.animationDatabase[clip.offset + frame * clip.count + joint];
+				lane(SoALane::rotationX)[joint] = source.rotation.x;
+				lane(SoALane::rotationY)[joint] = source.rotation.y;
+				lane(SoALane::rotationZ)[joint] = source.rotation.z;
+				lane(SoALane::rotationW)[joint] = source.rotation.w;
+				lane(SoALane::translationX)[joint] = source.translation.x;
+				lane(SoALane::translationY)[joint] = source.translation.y;
+				lane(SoALane::translationZ)[joint] = source.translation.z;
+				lane(SoALane::scaleX)[joint] = source.scale.x;
+				lane(SoALane::scaleY)[joint] = source.scale.y;
+				lane(SoALane::scaleZ)[joint] = source.scale.z;
+			}
+			// Padding joints hold the identity rotation so the vector kernels never normalize a zero quaternion.
+			for (auto joint = clip.count; joint < laneStride; joint++)
+			{
+				lane(SoALane::rotationW)[joint] = 1.0f;
+			}
+		}
+		laneOffset += clip.frames * Detail::SoAFrameStride(clip.count);
+	}
+	return result;
+}
+
+bool Framework::Animation::IsInstructionSetSupported(SimdInstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case SimdInstructionSet::scalar:
+		return true;
+#ifdef RTRG_ANIMATION_SIMD_X64
+	case SimdInstructionSet::sse:
+		return true; // part of the x64 baseline
+	case SimdInstructionSet::avx2:
+	{
+#ifdef _MSC_VER
+		int registers[4];
+		__cpuid(registers, 1);
+		const auto hasFma = (registers[2] & (1 << 12)) != 0;
+		const auto hasOsxsave = (registers[2] & (1 << 27)) != 0;
+		if (not hasFma or not hasOsxsave or (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+#endif
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+SimdInstructionSet Framework::Animation::GetBestSupportedInstructionSet()
+{
+	static const auto best = []
+	{
+		if (IsInstructionSetSupported(SimdInstructionSet::avx2))
+		{
+			return SimdInstructionSet::avx2;
+		}
+		if (IsInstructionSetSupported(SimdInstructionSet::sse))
+		{
+			return SimdInstructionSet::sse;
+		}
+		return SimdInstructionSet::scalar;
+	}();
+	return best;
+}
+
+void Framework::Animation::SamplePose(const AnimationDataSetSoA& animationDataSet, const AnimationData& data,
+									  Float time, std::span<JointAnimationData> pose,
+									  SimdInstructionSet instructionSet)
+{
+	ZoneScoped;
+	assert(pose.size() == data.count);
+	assert(IsInstructionSetSupported(instructionSet));
+
+	const auto clipIndex = Detail::FindClipIndex(animationDataSet.animations, data);
+	const auto* clipLanes = animationDataSet.animationDatabase.data() + animationDataSet.laneOffsets[clipIndex];
+	const auto frameStride = Detail::SoAFrameStride(data.count);
+	const auto laneStride = Detail::SoALaneStride(data.count);
+
+	const auto [first, second, rest] = Detail::ComputeSampleFrames(data, time);
+	const auto frameA = FrameLanes{ clipLanes + first * frameStride, laneStride };
+
+	if (first == second)
+	{
+		CopyFrame(frameA, pose);
+		return;
+	}
+
+	const auto frameB = FrameLanes{ clipLanes + second * frameStride, laneStride };
+	switch (instructionSet)
+	{
+#ifdef RTRG_ANIMATION_SIMD_X64
+	case SimdInstructionSet::avx2:
+		InterpolateAvx2(frameA, frameB, rest, pose);
+		break;
+	case SimdInstructionSet::sse:
+		InterpolateSse(frameA, frameB, rest, pose);
+		break;
+#endif
+	default:
+		InterpolateScalar(frameA, frameB, rest, pose);
+		break;
+	}
+}
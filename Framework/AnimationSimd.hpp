@@ -0,0 +1,92 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Animation.hpp"
+#include "Memory.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		/*
+		 * Structure-of-arrays layout of the animation database. Every frame of a clip is stored as ten lanes
+		 * (rotation x/y/z/w, translation x/y/z, scale x/y/z), each lane holding one float per joint padded to a
+		 * multiple of soaJointsPerBlock. Lanes start on 32 byte boundaries, so a whole AVX register can be loaded
+		 * per lane.
+		 */
+		inline constexpr U32 soaLaneAlignment = 32;
+		inline constexpr U32 soaJointsPerBlock = soaLaneAlignment / sizeof(Float);
+
+		enum class SoALane : U32
+		{
+			rotationX,
+			rotationY,
+			rotationZ,
+			rotationW,
+			translationX,
+			translationY,
+			translationZ,
+			scaleX,
+			scaleY,
+			scaleZ,
+			count
+		};
+
+		using SoALaneBuffer = std::vector<Float, Memory::AlignedAllocator<Float, soaLaneAlignment>>;
+
+		struct AnimationDataSetSoA
+		{
+			// Same clip descriptions as the source AnimationDataSet, so an AnimationInstance can be sampled from
+			// either layout. laneOffsets[i] is the first float of animations[i] in animationDatabase.
+			std::vector<AnimationData> animations;
+			std::vector<U32> laneOffsets;
+			SoALaneBuffer animationDatabase;
+		};
+
+		enum class SimdInstructionSet
+		{
+			scalar,
+			sse,
+			avx2
+		};
+
+		namespace Detail
+		{
+			inline constexpr U32 SoALaneStride(U32 jointsCount)
+			{
+				return (jointsCount + soaJointsPerBlock - 1) / soaJointsPerBlock * soaJointsPerBlock;
+			}
+
+			inline constexpr U32 SoAFrameStride(U32 jointsCount)
+			{
+				return SoALaneStride(jointsCount) * static_cast<U32>(SoALane::count);
+			}
+
+			// Below this cosine between two keys normalized lerp drifts noticeably from slerp, those joints are
+			// re-evaluated with Math::Slerp.
+			inline constexpr Float nlerpMinimumCosine = 0.9f;
+		} // namespace Detail
+
+		AnimationDataSetSoA ConvertToSoA(const AnimationDataSet& animationDataSet);
+
+		SimdInstructionSet GetBestSupportedInstructionSet();
+		bool IsInstructionSetSupported(SimdInstructionSet instructionSet);
+
+		void SamplePose(const AnimationDataSetSoA& animationDataSet, const AnimationData& data, Float time,
+						std::span<JointAnimationData> pose, SimdInstructionSet instructionSet);
+
+		inline void SamplePose(const AnimationDataSetSoA& animationDataSet, const AnimationData& data, Float time,
+							   std::span<JointAnimationData> pose)
+		{
+			SamplePose(animationDataSet, data, time, pose, GetBestSupportedInstructionSet());
+		}
+
+		inline void SamplePose(const AnimationDataSetSoA& animationDataSet, const AnimationInstance& instance,
+							   Float globalTime, std::span<JointAnimationData> pose)
+		{
+			SamplePose(animationDataSet, instance.data, ComputeLocalTime(instance, globalTime), pose);
+		}
+	} // namespace Animation
+} // namespace Framework
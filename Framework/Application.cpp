@@ -1,8 +1,12 @@
 #include "Application.hpp"
 
 #include "Animation.hpp"
+#include "AssetStreamer.hpp"
 #include "BasicRenderPipeline.hpp"
+#include "BlendTree.hpp"
+#include "CrowdUpdater.hpp"
 #include "ImGuiUtils.hpp"
+#include "MeshCache.hpp"
 #include "MiniAssetImporterEditor.hpp"
 #include "SDL3Utils.hpp"
 #include "VulkanRHI.hpp"
@@ -134,7 +138,18 @@ void Framework::Application::Run()
 #pragma endregion
 
 #pragma region Scene preparation
-	basicRenderPipeline.GetScene().Upload("Assets/Meshes/CesiumMan.glb", vulkanContext);
+	const auto levelSource = std::filesystem::path{ "Assets/Meshes/CesiumMan.glb" };
+	basicRenderPipeline.GetScene().LoadAnimation(levelSource);
+
+	// Cooked meshes stream in while the frame loop runs, without a container they are uploaded before the first frame.
+	auto assetRegistry = AssetRegistry{};
+	const auto cookedMeshes = LoadOrCookMeshes(levelSource, GetRuntimeMeshImportSettings());
+	const auto isStreamingMeshes = cookedMeshes and assetRegistry.AddContainer(cookedMeshes->GetPath());
+	if (not isStreamingMeshes)
+	{
+		basicRenderPipeline.GetScene().UploadMeshes(levelSource, vulkanContext);
+	}
+	auto assetStreamer = AssetStreamer{ assetRegistry };
 #pragma endregion
 
 #pragma region Setup Camera
@@ -145,6 +160,40 @@ void Framework::Application::Run()
 						  .sensitivity = 0.2f };
 #pragma endregion
 
+#pragma region Request scene meshes
+	struct StreamedMeshRequest
+	{
+		StreamRequestId request{ invalidStreamRequest };
+		glm::vec3 center{ 0.0f };
+	};
+	auto streamedMeshRequests = std::vector<StreamedMeshRequest>{};
+	if (isStreamingMeshes)
+	{
+		// Paused while the level is requested, so the meshes closest to the camera load first.
+		assetStreamer.SetPaused(true);
+		for (const auto& meshUuid : GetCookedSceneMeshes(*cookedMeshes))
+		{
+			// A mesh the container does not describe is left out, like one whose payloads cannot be read.
+			const auto entry = cookedMeshes->Find(meshUuid);
+			if (entry == nullptr or entry->type != AssetType::subMesh or entry->payloadsCount != 3)
+			{
+				continue;
+			}
+			const auto cookedMesh = ReadCookedMesh(cookedMeshes->GetPayloadData(cookedMeshes->GetPayloads(*entry)[0]));
+			if (not cookedMesh)
+			{
+				continue;
+			}
+			const auto center = cookedMesh->positionMinimum + cookedMesh->positionExtent * 0.5f;
+			const auto request = assetStreamer.Request(
+				meshUuid, glm::distance(camera.position, center), [&](const StreamedAsset& asset)
+				{ basicRenderPipeline.GetScene().UploadStreamedMesh(asset, vulkanContext); });
+			streamedMeshRequests.push_back(StreamedMeshRequest{ .request = request, .center = center });
+		}
+		assetStreamer.SetPaused(false);
+	}
+#pragma endregion
+
 	bool shouldRun = true;
 	static std::vector<AnimationInstance> animationInstances;
 
@@ -159,6 +208,13 @@ void Framework::Application::Run()
 	}
 
 	auto assetImporterEditor = Editor::AssetImporterEditor{};
+	auto crowdUpdater = CrowdUpdater{};
+
+	// Flattened again only when the clips it blends or their playback rates change.
+	auto blendTree = CompiledBlendTree{};
+	auto blendTreeScratch = BlendTreeScratch{};
+	auto compiledBlendClips = std::array{ -1, -1 };
+	auto compiledPlaybackRates = std::array{ 0.0f, 0.0f };
 	while (shouldRun)
 	{
 		ZoneScopedN("GameLoop Tick");
@@ -207,6 +263,18 @@ void Framework::Application::Run()
 			guiSystem.NextFrame();
 			UpdateCamera(camera);
 
+			if (assetStreamer.GetPendingCount() > 0)
+			{
+				ZoneScopedN("Stream Scene Meshes");
+				for (const auto& streamedMeshRequest : streamedMeshRequests)
+				{
+					assetStreamer.UpdatePriority(streamedMeshRequest.request,
+												 glm::distance(camera.position, streamedMeshRequest.center));
+				}
+				// Uploads only wait for copies once a mesh fills the staging ring, one per frame bounds the frame time.
+				assetStreamer.DispatchCompletions(1);
+			}
+
 			static float time = 0.0f;
 			time += ImGui::GetIO().DeltaTime;
 
@@ -220,6 +288,7 @@ void Framework::Application::Run()
 			static int selectedAnimation = 0;
 			static float blendFactor = 0.0f;
 			static bool enableDebugDraw = { false };
+			static bool enableAnimationLod = { true };
 
 
 			ImGui::Begin("Editor");
@@ -254,6 +323,7 @@ void Framework::Application::Run()
 			ImGui::SeparatorText("Animations");
 
 			ImGui::Checkbox("Enable Debug Draw", &enableDebugDraw);
+			ImGui::Checkbox("Enable Animation LOD", &enableAnimationLod);
 
 			if (ImGui::BeginListBox("##animations_list_box",
 									ImVec2(-FLT_MIN, 5 * ImGui::GetTextLineHeightWithSpacing())))
@@ -284,29 +354,58 @@ void Framework::Application::Run()
 			ImGui::End();
 
 			auto& scene = basicRenderPipeline.GetScene();
-			const auto pose0 = SamplePose(scene.animationDataSet, animationInstances[selectedAnimation],
-										  useGlobalTimeInAnimation ? time : animationTime);
-
-			const auto pose1 = SamplePose(scene.animationDataSet,
-										  animationInstances[std::min({ (int)animationInstances.size() - 1, 4 })],
-										  useGlobalTimeInAnimation ? time : animationTime);
-
-			const auto pose = BlendPose(pose0, pose1, blendFactor);
-
-			auto jointMatrices = ComputeJointsMatrices(pose, scene.skeletons[0]);
+			const auto animationTimeToSample = useGlobalTimeInAnimation ? time : animationTime;
+
+			// A two clip blend space between the selected clip and a fixed second one.
+			const auto blendTarget = std::min({ (int)animationInstances.size() - 1, 4 });
+			const auto blendClips = std::array{ selectedAnimation, blendTarget };
+			const auto playbackRates = std::array{ animationInstances[selectedAnimation].playbackRate,
+												   animationInstances[blendTarget].playbackRate };
+			if (blendClips != compiledBlendClips or playbackRates != compiledPlaybackRates)
+			{
+				const auto blendTreeDescription = BlendTreeDescription{
+					.nodes = { BlendTreeNode{ .type = BlendNodeType::blendSpace1D,
+											  .children = { 1, 2 },
+											  .positions = { Math::Vector2{ 0.0f, 0.0f },
+															 Math::Vector2{ 1.0f, 0.0f } },
+											  .parameter = 0 },
+							   BlendTreeNode{ .clip = animationInstances[selectedAnimation] },
+							   BlendTreeNode{ .clip = animationInstances[blendTarget] } },
+					.root = 0,
+					.parametersCount = 1
+				};
+				blendTree = Compile(blendTreeDescription, static_cast<U32>(scene.skeletons[0].joints.size()));
+				blendTreeScratch.Reserve(blendTree);
+				compiledBlendClips = blendClips;
+				compiledPlaybackRates = playbackRates;
+			}
+			const auto blendTreeParameters = std::array{ blendFactor };
 
-			auto offsetMatrices = jointMatrices;
-			ApplyBindPose(offsetMatrices, scene.skeletons[0]);
+			const auto crowd = std::array{ CrowdInstance{ .skeletonIndex = 0,
+														  .blendTree = &blendTree,
+														  .blendTreeParameters = blendTreeParameters } };
 
-			basicRenderPipeline.frameData.UploadJointMatrices(offsetMatrices);
+			const auto crowdMatricesCount = crowdUpdater.Prepare(scene.skeletons, crowd);
+			if (enableAnimationLod)
+			{
+				crowdUpdater.SelectLodLevels(camera, crowd);
+			}
+			crowdUpdater.Update(scene.animationDataSet, scene.skeletons, crowd, animationTimeToSample,
+								basicRenderPipeline.frameData.AllocateJointMatrices(crowdMatricesCount));
 
 			if (enableDebugDraw)
 			{
+				auto pose = LocalPose{};
+				pose.data.resize(blendTree.jointsCount);
+				Evaluate(blendTree, scene.animationDataSet, blendTreeParameters, animationTimeToSample,
+						 blendTreeScratch, pose.data);
+				const auto jointMatrices = ComputeJointsMatrices(pose, scene.skeletons[0]);
+
 				auto model = glm::rotate(glm::identity<glm::mat4>(), glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
 
 				const auto aspectRatio =
 					static_cast<float>(windowViewport.width) / static_cast<float>(windowViewport.height);
-				const auto projection = glm::perspective(glm::radians(60.0f), aspectRatio, 0.001f, 100.0f);
+				const auto projection = glm::perspective(camera.verticalFieldOfView, aspectRatio, 0.001f, 100.0f);
 				const auto view = glm::lookAt(camera.position, camera.position + camera.forward, camera.up);
 
 				auto& drawList = *ImGui::GetBackgroundDrawList();
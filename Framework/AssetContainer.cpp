@@ -0,0 +1,260 @@
+#include "AssetContainer.hpp"
+
+#include "Hash.hpp"
+#include "MeshCodec.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+
+using namespace Framework;
+
+namespace
+{
+	constexpr auto assetContainerMagic = U32{ 0x53415452 }; // "RTAS"
+
+	struct AssetContainerHeader
+	{
+		U32 magic{ 0 };
+		U32 version{ 0 };
+		U64 sourceHash{ 0 };
+		U32 entriesCount{ 0 };
+		U32 payloadsCount{ 0 };
+		U64 entriesOffset{ 0 };
+		U64 payloadsOffset{ 0 };
+	};
+
+	static_assert(std::is_trivially_copyable_v<AssetContainerEntry>);
+	static_assert(std::is_trivially_copyable_v<AssetContainerPayload>);
+	static_assert(sizeof(AssetContainerEntry) == 28);
+	static_assert(sizeof(AssetContainerPayload) == 32);
+
+	constexpr U64 AlignUp(U64 value, U64 alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	bool IsLess(const UuidBytes& a, const UuidBytes& b)
+	{
+		return std::memcmp(a.data(), b.data(), a.size()) < 0;
+	}
+} // namespace
+
+std::vector<std::byte> Framework::EncodeBinary(BinaryEncoding encoding, std::span<const std::byte> data,
+											   U32 elementSize)
+{
+	switch (encoding)
+	{
+	case BinaryEncoding::indexCodec:
+		return Geometry::EncodeIndexBuffer(data, elementSize);
+	case BinaryEncoding::vertexCodec:
+		return Geometry::EncodeVertexBuffer(data, elementSize);
+	case BinaryEncoding::raw:
+		break;
+	}
+	return std::vector<std::byte>(data.begin(), data.end());
+}
+
+bool Framework::DecodeBinary(BinaryEncoding encoding, std::span<std::byte> destination,
+							 std::span<const std::byte> encoded)
+{
+	switch (encoding)
+	{
+	case BinaryEncoding::indexCodec:
+		return Geometry::DecodeIndexBuffer(destination, encoded);
+	case BinaryEncoding::vertexCodec:
+		return Geometry::DecodeVertexBuffer(destination, encoded);
+	case BinaryEncoding::raw:
+		break;
+	}
+	if (destination.size() != encoded.size())
+	{
+		return false;
+	}
+	std::memcpy(destination.data(), encoded.data(), encoded.size());
+	return true;
+}
+
+uuids::uuid Framework::MakeAssetUuid(U64 high, U64 low)
+{
+	auto bytes = std::array<uuids::uuid::value_type, 16>{};
+	std::memcpy(bytes.data(), &high, sizeof(high));
+	std::memcpy(bytes.data() + sizeof(high), &low, sizeof(low));
+	// Version 8, custom data, with the RFC 4122 variant.
+	bytes[6] = static_cast<uuids::uuid::value_type>((bytes[6] & 0x0f) | 0x80);
+	bytes[8] = static_cast<uuids::uuid::value_type>((bytes[8] & 0x3f) | 0x80);
+	return uuids::uuid{ bytes };
+}
+
+UuidBytes Framework::ToUuidBytes(const uuids::uuid& uuid)
+{
+	auto bytes = UuidBytes{};
+	std::memcpy(bytes.data(), uuid.as_bytes().data(), bytes.size());
+	return bytes;
+}
+
+uuids::uuid Framework::FromUuidBytes(const UuidBytes& bytes)
+{
+	auto values = std::array<uuids::uuid::value_type, 16>{};
+	std::memcpy(values.data(), bytes.data(), values.size());
+	return uuids::uuid{ values };
+}
+
+void AssetContainerBuilder::BeginAsset(const uuids::uuid& uuid, AssetType type)
+{
+	assert(std::ranges::none_of(assets, [&](const Asset& asset) { return asset.uuid == uuid; }));
+	assets.push_back(Asset{ .uuid = uuid, .type = type, .firstPayload = static_cast<U32>(payloads.size()) });
+}
+
+void AssetContainerBuilder::AddPayload(std::span<const std::byte> data, BinaryEncoding encoding, U32 elementSize)
+{
+	assert(not assets.empty());
+	payloads.push_back(Payload{ .data = EncodeBinary(encoding, data, elementSize),
+								.decodedSize = data.size(),
+								.encoding = encoding,
+								.elementSize = elementSize });
+}
+
+bool AssetContainerBuilder::Write(const std::filesystem::path& containerPath, U64 sourceHash) const
+{
+	ZoneScoped;
+	// Entries are sorted by uuid for the lookup, payloads stay where they were added.
+	auto order = std::vector<U32>(assets.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::ranges::sort(order, [&](U32 a, U32 b) { return assets[a].uuid < assets[b].uuid; });
+
+	auto header = AssetContainerHeader{ .magic = assetContainerMagic,
+										.version = assetContainerVersion,
+										.sourceHash = sourceHash,
+										.entriesCount = static_cast<U32>(assets.size()),
+										.payloadsCount = static_cast<U32>(payloads.size()) };
+	header.entriesOffset = sizeof(AssetContainerHeader);
+	header.payloadsOffset = AlignUp(header.entriesOffset + assets.size() * sizeof(AssetContainerEntry), 8);
+
+	auto entries = std::vector<AssetContainerEntry>{};
+	entries.reserve(assets.size());
+	for (const auto index : order)
+	{
+		const auto& asset = assets[index];
+		const auto end = index + 1 < assets.size() ? assets[index + 1].firstPayload : static_cast<U32>(payloads.size());
+		entries.push_back(AssetContainerEntry{ .uuid = ToUuidBytes(asset.uuid),
+											   .type = asset.type,
+											   .firstPayload = asset.firstPayload,
+											   .payloadsCount = end - asset.firstPayload });
+	}
+
+	auto records = std::vector<AssetContainerPayload>{};
+	records.reserve(payloads.size());
+	auto offset = header.payloadsOffset + payloads.size() * sizeof(AssetContainerPayload);
+	for (const auto& payload : payloads)
+	{
+		offset = AlignUp(offset, payloadAlignment);
+		records.push_back(AssetContainerPayload{ .offset = offset,
+												 .size = payload.data.size(),
+												 .decodedSize = payload.decodedSize,
+												 .encoding = payload.encoding,
+												 .elementSize = payload.elementSize });
+		offset += payload.data.size();
+	}
+
+	// Zeros fill the gaps up to the aligned offsets.
+	static constexpr auto zeros = std::array<std::byte, payloadAlignment>{};
+	auto pieces = std::vector<std::span<const std::byte>>{};
+	pieces.reserve(4 + 2 * payloads.size());
+	auto size = U64{ 0 };
+	const auto Append = [&](std::span<const std::byte> piece)
+	{
+		pieces.push_back(piece);
+		size += piece.size();
+	};
+	const auto AppendPadding = [&](U64 until)
+	{
+		assert(until - size < zeros.size());
+		Append(std::span{ zeros }.first(until - size));
+	};
+	Append(std::as_bytes(std::span{ &header, 1 }));
+	Append(std::as_bytes(std::span{ entries }));
+	AppendPadding(header.payloadsOffset);
+	Append(std::as_bytes(std::span{ records }));
+	for (auto i = 0u; i < payloads.size(); i++)
+	{
+		AppendPadding(records[i].offset);
+		Append(payloads[i].data);
+	}
+	return WriteFileAtomically(containerPath, pieces);
+}
+
+std::optional<AssetContainer> AssetContainer::Open(const std::filesystem::path& containerPath)
+{
+	ZoneScoped;
+	auto container = AssetContainer{};
+	container.file = MappedFile{ containerPath };
+	if (not container.file.IsOpen())
+	{
+		return std::nullopt;
+	}
+
+	const auto data = container.file.GetData();
+	auto header = AssetContainerHeader{};
+	if (data.size() < sizeof(header))
+	{
+		return std::nullopt;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != assetContainerMagic or header.version != assetContainerVersion)
+	{
+		return std::nullopt;
+	}
+	const auto entriesSize = U64{ header.entriesCount } * sizeof(AssetContainerEntry);
+	const auto payloadsSize = U64{ header.payloadsCount } * sizeof(AssetContainerPayload);
+	if (not IsRangeInside(header.entriesOffset, entriesSize, data.size()) or
+		not IsRangeInside(header.payloadsOffset, payloadsSize, data.size()) or
+		header.entriesOffset % alignof(AssetContainerEntry) != 0 or
+		header.payloadsOffset % alignof(AssetContainerPayload) != 0)
+	{
+		return std::nullopt;
+	}
+
+	container.path = containerPath;
+	container.sourceHash = header.sourceHash;
+	container.entries = { reinterpret_cast<const AssetContainerEntry*>(data.data() + header.entriesOffset),
+						  header.entriesCount };
+	container.payloads = { reinterpret_cast<const AssetContainerPayload*>(data.data() + header.payloadsOffset),
+						   header.payloadsCount };
+	for (const auto& entry : container.entries)
+	{
+		if (not IsRangeInside(entry.firstPayload, entry.payloadsCount, container.payloads.size()))
+		{
+			return std::nullopt;
+		}
+	}
+	for (const auto& payload : container.payloads)
+	{
+		if (not IsRangeInside(payload.offset, payload.size, data.size()))
+		{
+			return std::nullopt;
+		}
+	}
+	return container;
+}
+
+const AssetContainerEntry* AssetContainer::Find(const uuids::uuid& uuid) const
+{
+	const auto bytes = ToUuidBytes(uuid);
+	const auto it = std::ranges::partition_point(entries, [&](const AssetContainerEntry& entry)
+												 { return IsLess(entry.uuid, bytes); });
+	if (it == entries.end() or it->uuid != bytes)
+	{
+		return nullptr;
+	}
+	return &*it;
+}
+
+bool AssetContainer::Decode(const AssetContainerPayload& payload, std::span<std::byte> destination) const
+{
+	assert(destination.size() == payload.decodedSize);
+	return DecodeBinary(payload.encoding, destination, GetPayloadData(payload));
+}
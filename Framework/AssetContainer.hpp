@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stduuid/uuid.h>
+#include <vector>
+
+#include "Core.hpp"
+#include "MappedFile.hpp"
+
+namespace Framework
+{
+	enum class AssetType : U8
+	{
+		subMesh,
+		// Ordered list of the uuids of the assets of a source file.
+		scene
+	};
+
+	enum class BinaryEncoding : U8
+	{
+		raw,
+		// Geometry::EncodeIndexBuffer() and Geometry::EncodeVertexBuffer().
+		indexCodec,
+		vertexCodec
+	};
+
+	// elementSize is the index size for the index codec and the vertex size for the vertex codec.
+	std::vector<std::byte> EncodeBinary(BinaryEncoding encoding, std::span<const std::byte> data, U32 elementSize);
+	// destination has to hold the decoded size, decoding runs in parallel on the shared JobSystem. Returns false when
+	// encoded is truncated or corrupt.
+	bool DecodeBinary(BinaryEncoding encoding, std::span<std::byte> destination, std::span<const std::byte> encoded);
+
+	// Same uuid for the same hashes, so cooked assets keep their uuid from one cook to the next.
+	uuids::uuid MakeAssetUuid(U64 high, U64 low);
+
+	// Raw uuid as stored in binary records, compared with memcmp.
+	using UuidBytes = std::array<std::byte, 16>;
+	UuidBytes ToUuidBytes(const uuids::uuid& uuid);
+	uuids::uuid FromUuidBytes(const UuidBytes& bytes);
+
+	/*
+	 * Records of the container file, used in place from the mapping. Assets are sorted by uuid and refer to a range
+	 * of the payload table, payload data starts on payloadAlignment boundaries so it can be copied to the GPU or
+	 * used as is straight from the mapped file.
+	 */
+	struct AssetContainerEntry
+	{
+		UuidBytes uuid{};
+		AssetType type{ AssetType::subMesh };
+		U8 padding[3]{};
+		U32 firstPayload{ 0 };
+		U32 payloadsCount{ 0 };
+	};
+
+	struct AssetContainerPayload
+	{
+		U64 offset{ 0 };
+		U64 size{ 0 };
+		// Equal to size for raw data.
+		U64 decodedSize{ 0 };
+		BinaryEncoding encoding{ BinaryEncoding::raw };
+		U8 padding[3]{};
+		U32 elementSize{ 0 };
+	};
+
+	inline constexpr U64 payloadAlignment = 256;
+	// Bump whenever the layout of the container file changes.
+	inline constexpr U32 assetContainerVersion = 1;
+
+	/*
+	 * Collects assets and their payloads in memory and writes them as one container file. Payloads keep the order
+	 * they were added in, each asset owns the payloads added after its BeginAsset().
+	 */
+	struct AssetContainerBuilder
+	{
+		void BeginAsset(const uuids::uuid& uuid, AssetType type);
+		void AddPayload(std::span<const std::byte> data, BinaryEncoding encoding = BinaryEncoding::raw,
+						U32 elementSize = 0);
+
+		// sourceHash identifies what the container was cooked from, see AssetContainer::GetSourceHash().
+		bool Write(const std::filesystem::path& containerPath, U64 sourceHash) const;
+
+	private:
+		struct Asset
+		{
+			uuids::uuid uuid;
+			AssetType type;
+			U32 firstPayload;
+		};
+
+		struct Payload
+		{
+			std::vector<std::byte> data;
+			U64 decodedSize;
+			BinaryEncoding encoding;
+			U32 elementSize;
+		};
+
+		std::vector<Asset> assets;
+		std::vector<Payload> payloads;
+	};
+
+	/*
+	 * Read-only container mapped in memory. Opening only validates the header and the tables, payloads are read
+	 * from the mapping on access without any copy.
+	 */
+	struct AssetContainer
+	{
+		// Empty when the file is missing or malformed.
+		static std::optional<AssetContainer> Open(const std::filesystem::path& containerPath);
+
+		const std::filesystem::path& GetPath() const
+		{
+			return path;
+		}
+
+		U64 GetSourceHash() const
+		{
+			return sourceHash;
+		}
+
+		std::span<const AssetContainerEntry> GetEntries() const
+		{
+			return entries;
+		}
+
+		// nullptr when the container has no asset with this uuid.
+		const AssetContainerEntry* Find(const uuids::uuid& uuid) const;
+
+		std::span<const AssetContainerPayload> GetPayloads(const AssetContainerEntry& entry) const
+		{
+			return payloads.subspan(entry.firstPayload, entry.payloadsCount);
+		}
+
+		// Stored bytes, still encoded unless the payload is raw.
+		std::span<const std::byte> GetPayloadData(const AssetContainerPayload& payload) const
+		{
+			return file.GetData().subspan(payload.offset, payload.size);
+		}
+
+		// destination has to hold decodedSize bytes, false when the stored bytes do not decode.
+		bool Decode(const AssetContainerPayload& payload, std::span<std::byte> destination) const;
+
+	private:
+		std::filesystem::path path;
+		MappedFile file;
+		U64 sourceHash{ 0 };
+		std::span<const AssetContainerEntry> entries;
+		std::span<const AssetContainerPayload> payloads;
+	};
+} // namespace Framework
@@ -0,0 +1,363 @@
+#include "AssetCooker.hpp"
+
+#include "AnimationCache.hpp"
+#include "Hash.hpp"
+#include "JobSystem.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace Framework;
+
+namespace
+{
+	constexpr auto cookDatabaseMagic = U32{ 0x42445452 }; // "RTDB"
+	constexpr auto cookDatabaseVersion = U32{ 2 };
+	// Bump whenever the cooker itself changes its output, format changes bump the version of their cooked file.
+	constexpr auto cookerVersion = U64{ 1 };
+
+	struct FileStamp
+	{
+		U64 size{ 0 };
+		I64 writeTime{ 0 };
+
+		bool operator==(const FileStamp&) const = default;
+	};
+
+	struct CookedDependency
+	{
+		std::string path;
+		FileStamp stamp;
+	};
+
+	struct CookRecord
+	{
+		FileStamp stamp;
+		// Source and dependencies content, the source cooks again when it changes.
+		U64 cookHash{ 0 };
+		// Skinned sources also cook their clips.
+		bool hasAnimation{ false };
+		std::vector<CookedDependency> dependencies{};
+	};
+
+	// By source path relative to the cooked folder.
+	using CookDatabase = std::unordered_map<std::string, CookRecord>;
+
+	enum class CookResult : U8
+	{
+		cooked,
+		upToDate,
+		failed
+	};
+
+	std::optional<FileStamp> GetFileStamp(const std::filesystem::path& path)
+	{
+		auto error = std::error_code{};
+		const auto size = std::filesystem::file_size(path, error);
+		if (error)
+		{
+			return std::nullopt;
+		}
+		const auto writeTime = std::filesystem::last_write_time(path, error);
+		if (error)
+		{
+			return std::nullopt;
+		}
+		return FileStamp{ .size = size, .writeTime = static_cast<I64>(writeTime.time_since_epoch().count()) };
+	}
+
+	bool IsStampUnchanged(const std::filesystem::path& path, const FileStamp& stamp)
+	{
+		const auto current = GetFileStamp(path);
+		return current and *current == stamp;
+	}
+
+	U64 HashCookSettings(const CookSettings& settings)
+	{
+		auto hash = Hash::Combine(Hash::fnvOffsetBasis, cookerVersion);
+		// Outputs written in an older format are stale even though the database calls them up to date.
+		hash = Hash::Combine(hash, cookedMeshesVersion);
+		hash = Hash::Combine(hash, Animation::cookedAnimationVersion);
+		hash = Hash::Combine(hash, assetContainerVersion);
+		hash = Hash::Combine(hash, settings.compress);
+		hash = Hash::Combine(hash, settings.animationResampleRate);
+		return Hash::Combine(hash, HashMeshImportSettings(settings.meshImportSettings));
+	}
+
+	// Bounds checked reads of the database, a truncated file fails instead of reading past the mapping.
+	struct DatabaseReader
+	{
+		template <typename T>
+		T Read()
+		{
+			auto value = T{};
+			if (failed or data.size() - offset < sizeof(T))
+			{
+				failed = true;
+				return value;
+			}
+			std::memcpy(&value, data.data() + offset, sizeof(T));
+			offset += sizeof(T);
+			return value;
+		}
+
+		std::string ReadString()
+		{
+			const auto length = Read<U32>();
+			if (failed or data.size() - offset < length)
+			{
+				failed = true;
+				return {};
+			}
+			auto string = std::string{ reinterpret_cast<const char*>(data.data() + offset), length };
+			offset += length;
+			return string;
+		}
+
+		std::span<const std::byte> data;
+		std::size_t offset{ 0 };
+		bool failed{ false };
+	};
+
+	struct DatabaseWriter
+	{
+		template <typename T>
+		void Write(const T& value)
+		{
+			const auto bytes = std::as_bytes(std::span{ &value, 1 });
+			data.insert(data.end(), bytes.begin(), bytes.end());
+		}
+
+		void WriteString(std::string_view string)
+		{
+			Write(static_cast<U32>(string.size()));
+			const auto bytes = std::as_bytes(std::span{ string.data(), string.size() });
+			data.insert(data.end(), bytes.begin(), bytes.end());
+		}
+
+		std::vector<std::byte> data;
+	};
+
+	// Empty when the file is missing, malformed or was written for other settings, every source then cooks again.
+	CookDatabase LoadCookDatabase(const std::filesystem::path& databasePath, U64 settingsHash)
+	{
+		ZoneScoped;
+		const auto file = MappedFile{ databasePath };
+		auto reader = DatabaseReader{ .data = file.GetData() };
+		if (reader.Read<U32>() != cookDatabaseMagic or reader.Read<U32>() != cookDatabaseVersion or
+			reader.Read<U64>() != settingsHash)
+		{
+			return {};
+		}
+		auto database = CookDatabase{};
+		const auto recordsCount = reader.Read<U32>();
+		for (auto i = 0u; i < recordsCount and not reader.failed; i++)
+		{
+			auto source = reader.ReadString();
+			auto record = CookRecord{ .stamp = reader.Read<FileStamp>(),
+									  .cookHash = reader.Read<U64>(),
+									  .hasAnimation = reader.Read<U8>() != 0 };
+			const auto dependenciesCount = reader.Read<U32>();
+			for (auto j = 0u; j < dependenciesCount and not reader.failed; j++)
+			{
+				auto path = reader.ReadString();
+				record.dependencies.push_back(
+					CookedDependency{ .path = std::move(path), .stamp = reader.Read<FileStamp>() });
+			}
+			database.emplace(std::move(source), std::move(record));
+		}
+		return reader.failed ? CookDatabase{} : database;
+	}
+
+	bool WriteCookDatabase(const std::filesystem::path& databasePath, U64 settingsHash, const CookDatabase& database)
+	{
+		ZoneScoped;
+		auto writer = DatabaseWriter{};
+		writer.Write(cookDatabaseMagic);
+		writer.Write(cookDatabaseVersion);
+		writer.Write(settingsHash);
+		writer.Write(static_cast<U32>(database.size()));
+		for (const auto& [source, record] : database)
+		{
+			writer.WriteString(source);
+			writer.Write(record.stamp);
+			writer.Write(record.cookHash);
+			writer.Write(static_cast<U8>(record.hasAnimation));
+			writer.Write(static_cast<U32>(record.dependencies.size()));
+			for (const auto& dependency : record.dependencies)
+			{
+				writer.WriteString(dependency.path);
+				writer.Write(dependency.stamp);
+			}
+		}
+
+		return WriteFileAtomically(databasePath, writer.data);
+	}
+
+	// Cook hash of a source, empty when the source or one of its dependencies cannot be read.
+	std::optional<CookRecord> BuildCookRecord(const std::filesystem::path& sourcePath)
+	{
+		const auto stamp = GetFileStamp(sourcePath);
+		if (not stamp)
+		{
+			return std::nullopt;
+		}
+		auto record = CookRecord{ .stamp = *stamp, .cookHash = HashFile(sourcePath) };
+		for (const auto& dependency : GetSourceDependencies(sourcePath))
+		{
+			const auto dependencyStamp = GetFileStamp(dependency);
+			if (not dependencyStamp)
+			{
+				return std::nullopt;
+			}
+			record.cookHash = Hash::Combine(record.cookHash, HashFile(dependency));
+			record.dependencies.push_back(
+				CookedDependency{ .path = dependency.generic_string(), .stamp = *dependencyStamp });
+		}
+		return record;
+	}
+
+	// Outputs deleted since the last cook make the source cook again, even with unchanged files.
+	bool HasCookedOutputs(const std::filesystem::path& sourcePath, const CookRecord& record,
+						  const CookSettings& settings)
+	{
+		return std::filesystem::exists(GetCookedMeshesPath(sourcePath)) and
+			(not record.hasAnimation or
+			 std::filesystem::exists(Animation::GetCookedAnimationPath(sourcePath, settings.animationResampleRate)));
+	}
+
+	// Meshes and clips are cooked from a single import of the source, record learns whether it has clips.
+	bool CookSource(const std::filesystem::path& sourcePath, const CookSettings& settings, CookRecord& record)
+	{
+		ZoneScoped;
+		auto importer = AssetImporter{ sourcePath };
+		if (not CookMeshes(importer, sourcePath, settings.meshImportSettings, GetCookedMeshesPath(sourcePath),
+						   settings.compress))
+		{
+			return false;
+		}
+
+		const auto& information = importer.GetSceneInformation();
+		record.hasAnimation = information.animationCount > 0 and information.meshCount > 0 and importer.HasBones(0);
+		if (not record.hasAnimation)
+		{
+			return true;
+		}
+		// Same clips Animation::LoadOrCookAnimation() cooks, from the skeleton of the first mesh.
+		const auto skeleton = importer.ImportSkeleton(0);
+		const auto animationDataSet =
+			importer.LoadAllAnimations(skeleton, static_cast<int>(settings.animationResampleRate));
+		return Animation::WriteCookedAnimation(
+			Animation::GetCookedAnimationPath(sourcePath, settings.animationResampleRate), HashFile(sourcePath),
+			settings.animationResampleRate, skeleton, animationDataSet);
+	}
+} // namespace
+
+std::vector<std::filesystem::path> Framework::ScanSourceAssets(const std::filesystem::path& folder)
+{
+	auto sources = std::vector<std::filesystem::path>{};
+	auto error = std::error_code{};
+	for (auto it = std::filesystem::recursive_directory_iterator{ folder, error };
+		 not error and it != std::filesystem::recursive_directory_iterator{}; it.increment(error))
+	{
+		if (not it->is_regular_file())
+		{
+			continue;
+		}
+		const auto extension = GetSourceExtension(it->path());
+		if (extension == ".gltf" or extension == ".glb" or extension == ".obj" or extension == ".fbx")
+		{
+			sources.push_back(it->path());
+		}
+	}
+	std::ranges::sort(sources);
+	return sources;
+}
+
+std::filesystem::path Framework::GetCookDatabasePath(const std::filesystem::path& folder)
+{
+	return folder / "assets.cookdb";
+}
+
+CookReport Framework::CookFolder(const std::filesystem::path& folder, const CookSettings& settings)
+{
+	ZoneScoped;
+	const auto sources = ScanSourceAssets(folder);
+	const auto databasePath = GetCookDatabasePath(folder);
+	const auto settingsHash = HashCookSettings(settings);
+	const auto database = LoadCookDatabase(databasePath, settingsHash);
+
+	auto keys = std::vector<std::string>(sources.size());
+	auto records = std::vector<std::optional<CookRecord>>(sources.size());
+	auto results = std::vector<CookResult>(sources.size(), CookResult::failed);
+	// Sources are independent, each job only reads the previous database and writes its own slot.
+	GetJobSystem().ParallelFor(
+		static_cast<U32>(sources.size()), 1,
+		[&](U32 begin, U32 end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& sourcePath = sources[i];
+				keys[i] = std::filesystem::relative(sourcePath, folder).generic_string();
+				const auto previous = database.find(keys[i]);
+				const auto hasPrevious = not settings.force and previous != database.end() and
+					HasCookedOutputs(sourcePath, previous->second, settings);
+
+				// Nothing is read as long as every file keeps its size and write time.
+				if (hasPrevious and IsStampUnchanged(sourcePath, previous->second.stamp) and
+					std::ranges::all_of(previous->second.dependencies, [](const CookedDependency& dependency)
+										{ return IsStampUnchanged(dependency.path, dependency.stamp); }))
+				{
+					records[i] = previous->second;
+					results[i] = CookResult::upToDate;
+					continue;
+				}
+
+				records[i] = BuildCookRecord(sourcePath);
+				if (not records[i])
+				{
+					continue;
+				}
+				if (hasPrevious and records[i]->cookHash == previous->second.cookHash)
+				{
+					records[i]->hasAnimation = previous->second.hasAnimation;
+					results[i] = CookResult::upToDate;
+					continue;
+				}
+				if (not CookSource(sourcePath, settings, *records[i]))
+				{
+					records[i].reset();
+					continue;
+				}
+				results[i] = CookResult::cooked;
+			}
+		});
+
+	// Sources that failed or disappeared are dropped, they cook again next time.
+	auto report = CookReport{};
+	auto updatedDatabase = CookDatabase{};
+	for (auto i = 0u; i < sources.size(); i++)
+	{
+		switch (results[i])
+		{
+		case CookResult::cooked:
+			report.cookedCount++;
+			break;
+		case CookResult::upToDate:
+			report.upToDateCount++;
+			break;
+		case CookResult::failed:
+			report.failedSources.push_back(sources[i]);
+			continue;
+		}
+		updatedDatabase.emplace(std::move(keys[i]), std::move(*records[i]));
+	}
+	WriteCookDatabase(databasePath, settingsHash, updatedDatabase);
+	return report;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "Core.hpp"
+#include "MeshCache.hpp"
+
+namespace Framework
+{
+	struct CookSettings
+	{
+		MeshImportSettings meshImportSettings{ GetRuntimeMeshImportSettings() };
+		// Index and vertex payloads go through the mesh codecs, smaller files for a decode on load.
+		bool compress{ false };
+		// Cooks every source, even the ones the database has up to date.
+		bool force{ false };
+		U32 animationResampleRate{ 60 };
+	};
+
+	struct CookReport
+	{
+		U32 cookedCount{ 0 };
+		U32 upToDateCount{ 0 };
+		std::vector<std::filesystem::path> failedSources;
+	};
+
+	// Files the importer cooks, in a stable order.
+	std::vector<std::filesystem::path> ScanSourceAssets(const std::filesystem::path& folder);
+
+	std::filesystem::path GetCookDatabasePath(const std::filesystem::path& folder);
+
+	/*
+	 * Cooks every source of folder next to it, meshes with CookMeshes() and the clips of skinned sources with
+	 * Animation::WriteCookedAnimation(), so the runtime finds them where it looks. Sources cook in parallel on the
+	 * shared JobSystem. Both are cooked from a single import. The database keeps the size, write time and content
+	 * hash of every source and dependency: sources whose files all kept their size and write time and whose cooked
+	 * files all exist are skipped without being read, and touched files only cook again when their content or the
+	 * settings changed.
+	 */
+	CookReport CookFolder(const std::filesystem::path& folder, const CookSettings& settings);
+} // namespace Framework
@@ -1,22 +1,26 @@
 #pragma once
 
+#include <AssetContainer.hpp>
+#include <AssetMetadata.hpp>
 #include <Core.hpp>
 #include <assert.h>
 #include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <span>
 #include <stduuid/uuid.h>
 #include <string>
+#include <vector>
 
 namespace nlohmann
 {
-	void to_json(nlohmann::json& json, const uuids::uuid& uuid)
+	inline void to_json(nlohmann::json& json, const uuids::uuid& uuid)
 	{
 		json = nlohmann::json{ { "uuid", uuids::to_string(uuid) } };
 	}
 
 
-	void from_json(const nlohmann::json& json, uuids::uuid& uuid)
+	inline void from_json(const nlohmann::json& json, uuids::uuid& uuid)
 	{
 		auto value = std::string{};
 		json.at("uuid").get_to(value);
@@ -26,12 +30,7 @@ namespace nlohmann
 
 namespace Framework
 {
-	enum class AssetType : U8
-	{
-		subMesh
-	};
-
-	NLOHMANN_JSON_SERIALIZE_ENUM(AssetType, { { AssetType::subMesh, "subMesh" } });
+	NLOHMANN_JSON_SERIALIZE_ENUM(AssetType, { { AssetType::subMesh, "subMesh" }, { AssetType::scene, "scene" } });
 
 	struct AssetNode
 	{
@@ -56,6 +55,44 @@ namespace Framework
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(AssetFile, uuid, name, version, assets);
 	};
 
+	// Binary metadata of the files, read back with AssetCatalogue.
+	inline bool WriteAssetMetadata(const std::filesystem::path& metadataPath, std::span<const AssetFile> files)
+	{
+		auto builder = AssetMetadataBuilder{};
+		for (const auto& file : files)
+		{
+			builder.AddFile(file.uuid, file.name, file.version);
+			for (const auto& node : file.assets)
+			{
+				builder.AddNode(node.uuid, node.name, node.type, node.version, node.assetNodeData);
+			}
+		}
+		return builder.Write(metadataPath);
+	}
+
+	// Copies a catalogue back into AssetFile, only meant for the JSON debug export.
+	inline std::vector<AssetFile> ExportAssetFiles(const AssetCatalogue& catalogue)
+	{
+		auto files = std::vector<AssetFile>{};
+		files.reserve(catalogue.GetFiles().size());
+		for (const auto& fileRecord : catalogue.GetFiles())
+		{
+			auto& file = files.emplace_back(AssetFile{ .uuid = FromUuidBytes(fileRecord.uuid),
+													   .name = std::string{ catalogue.GetName(fileRecord) },
+													   .version = fileRecord.version,
+													   .assets = {} });
+			for (const auto& node : catalogue.GetNodes(fileRecord))
+			{
+				file.assets.push_back(AssetNode{ .uuid = FromUuidBytes(node.uuid),
+												 .name = std::string{ catalogue.GetName(node) },
+												 .type = node.type,
+												 .version = node.version,
+												 .assetNodeData = std::string{ catalogue.GetAssetNodeData(node) } });
+			}
+		}
+		return files;
+	}
+
 	enum class MeshType : U8
 	{
 		skinned
@@ -63,16 +100,68 @@ namespace Framework
 
 	NLOHMANN_JSON_SERIALIZE_ENUM(MeshType, { { MeshType::skinned, "skinned" } });
 
+	NLOHMANN_JSON_SERIALIZE_ENUM(BinaryEncoding, { { BinaryEncoding::raw, "raw" },
+												   { BinaryEncoding::indexCodec, "indexCodec" },
+												   { BinaryEncoding::vertexCodec, "vertexCodec" } });
+
 	struct BinarySourceFile
 	{
 		U32 offset;
 		U32 size;
 		std::string file;
+		BinaryEncoding encoding{ BinaryEncoding::raw };
+		// Size of the range once decoded, equal to size for raw data.
+		U32 decodedSize{ 0 };
 
 	public:
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(BinarySourceFile, offset, size, file);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(BinarySourceFile, offset, size, file, encoding, decodedSize);
 	};
 
+	/*
+	 * Appends data to an opened binary file and returns its range. elementSize is the index size for the index
+	 * codec and the vertex size for the vertex codec, e.g. GetIndexSize(MeshData::indexFormat) and the stride of a
+	 * VertexStream.
+	 */
+	inline BinarySourceFile WriteBinarySource(std::ofstream& stream, const std::string& file,
+											  std::span<const std::byte> data, BinaryEncoding encoding,
+											  U32 elementSize = 0)
+	{
+		auto encoded = std::vector<std::byte>{};
+		if (encoding != BinaryEncoding::raw)
+		{
+			encoded = EncodeBinary(encoding, data, elementSize);
+		}
+		const auto written = encoding == BinaryEncoding::raw ? data : std::span<const std::byte>{ encoded };
+
+		const auto source = BinarySourceFile{ .offset = static_cast<U32>(stream.tellp()),
+											  .size = static_cast<U32>(written.size()),
+											  .file = file,
+											  .encoding = encoding,
+											  .decodedSize = static_cast<U32>(data.size()) };
+		stream.write(reinterpret_cast<const char*>(written.data()), static_cast<std::streamsize>(written.size()));
+		return source;
+	}
+
+	/*
+	 * destination has to hold decodedSize bytes, decoding runs in parallel on the shared JobSystem. Returns false
+	 * when the file is missing or too short, or when its data does not decode.
+	 */
+	inline bool ReadBinarySource(const BinarySourceFile& source, std::span<std::byte> destination)
+	{
+		assert(destination.size() == source.decodedSize);
+		auto stream = std::ifstream{ source.file, std::ios::binary };
+		stream.seekg(source.offset);
+
+		if (source.encoding == BinaryEncoding::raw)
+		{
+			stream.read(reinterpret_cast<char*>(destination.data()), source.size);
+			return stream.good() and source.size == source.decodedSize;
+		}
+		auto encoded = std::vector<std::byte>(source.size);
+		stream.read(reinterpret_cast<char*>(encoded.data()), source.size);
+		return stream.good() and DecodeBinary(source.encoding, destination, encoded);
+	}
+
 	struct MeshAsset
 	{
 		uuids::uuid uuid;
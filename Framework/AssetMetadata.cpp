@@ -0,0 +1,151 @@
+#include "AssetMetadata.hpp"
+
+#include "Profiler.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+using namespace Framework;
+
+namespace
+{
+	constexpr auto assetMetadataMagic = U32{ 0x4d415452 }; // "RTAM"
+	// Bump whenever the layout below changes.
+	constexpr auto assetMetadataVersion = U32{ 1 };
+
+	struct AssetMetadataHeader
+	{
+		U32 magic{ 0 };
+		U32 version{ 0 };
+		U32 filesCount{ 0 };
+		U32 nodesCount{ 0 };
+		U64 filesOffset{ 0 };
+		U64 nodesOffset{ 0 };
+		U64 stringsOffset{ 0 };
+		U64 stringsSize{ 0 };
+	};
+
+	static_assert(std::is_trivially_copyable_v<AssetFileRecord>);
+	static_assert(std::is_trivially_copyable_v<AssetNodeRecord>);
+	static_assert(sizeof(AssetFileRecord) == 36);
+	static_assert(sizeof(AssetNodeRecord) == 40);
+} // namespace
+
+void AssetMetadataBuilder::AddFile(const uuids::uuid& uuid, std::string_view name, U32 version)
+{
+	const auto nameOffset = Intern(name);
+	files.push_back(AssetFileRecord{ .uuid = ToUuidBytes(uuid),
+									 .nameOffset = nameOffset,
+									 .nameSize = static_cast<U32>(name.size()),
+									 .version = version,
+									 .firstNode = static_cast<U32>(nodes.size()) });
+}
+
+void AssetMetadataBuilder::AddNode(const uuids::uuid& uuid, std::string_view name, AssetType type, U32 version,
+								   std::string_view assetNodeData)
+{
+	assert(not files.empty());
+	const auto nameOffset = Intern(name);
+	const auto dataOffset = Intern(assetNodeData);
+	nodes.push_back(AssetNodeRecord{ .uuid = ToUuidBytes(uuid),
+									 .nameOffset = nameOffset,
+									 .nameSize = static_cast<U32>(name.size()),
+									 .dataOffset = dataOffset,
+									 .dataSize = static_cast<U32>(assetNodeData.size()),
+									 .version = version,
+									 .type = type });
+	files.back().nodesCount++;
+}
+
+U32 AssetMetadataBuilder::Intern(std::string_view string)
+{
+	const auto [it, inserted] = stringOffsets.try_emplace(std::string{ string }, static_cast<U32>(strings.size()));
+	if (inserted)
+	{
+		assert(strings.size() + string.size() <= std::numeric_limits<U32>::max());
+		strings.append(string);
+	}
+	return it->second;
+}
+
+bool AssetMetadataBuilder::Write(const std::filesystem::path& metadataPath) const
+{
+	ZoneScoped;
+	auto header = AssetMetadataHeader{ .magic = assetMetadataMagic,
+									   .version = assetMetadataVersion,
+									   .filesCount = static_cast<U32>(files.size()),
+									   .nodesCount = static_cast<U32>(nodes.size()) };
+	header.filesOffset = sizeof(AssetMetadataHeader);
+	header.nodesOffset = header.filesOffset + files.size() * sizeof(AssetFileRecord);
+	header.stringsOffset = header.nodesOffset + nodes.size() * sizeof(AssetNodeRecord);
+	header.stringsSize = strings.size();
+	static_assert(alignof(AssetFileRecord) == alignof(AssetNodeRecord));
+	static_assert(sizeof(AssetFileRecord) % alignof(AssetNodeRecord) == 0);
+
+	const auto pieces = std::array<std::span<const std::byte>, 4>{
+		std::as_bytes(std::span{ &header, 1 }), std::as_bytes(std::span{ files }), std::as_bytes(std::span{ nodes }),
+		std::as_bytes(std::span{ strings })
+	};
+	return WriteFileAtomically(metadataPath, pieces);
+}
+
+std::optional<AssetCatalogue> AssetCatalogue::Open(const std::filesystem::path& metadataPath)
+{
+	ZoneScoped;
+	auto catalogue = AssetCatalogue{};
+	catalogue.file = MappedFile{ metadataPath };
+	if (not catalogue.file.IsOpen())
+	{
+		return std::nullopt;
+	}
+
+	const auto data = catalogue.file.GetData();
+	auto header = AssetMetadataHeader{};
+	if (data.size() < sizeof(header))
+	{
+		return std::nullopt;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != assetMetadataMagic or header.version != assetMetadataVersion)
+	{
+		return std::nullopt;
+	}
+	const auto filesSize = U64{ header.filesCount } * sizeof(AssetFileRecord);
+	const auto nodesSize = U64{ header.nodesCount } * sizeof(AssetNodeRecord);
+	if (not IsRangeInside(header.filesOffset, filesSize, data.size()) or
+		not IsRangeInside(header.nodesOffset, nodesSize, data.size()) or
+		not IsRangeInside(header.stringsOffset, header.stringsSize, data.size()) or
+		header.filesOffset % alignof(AssetFileRecord) != 0 or header.nodesOffset % alignof(AssetNodeRecord) != 0)
+	{
+		return std::nullopt;
+	}
+
+	catalogue.files = { reinterpret_cast<const AssetFileRecord*>(data.data() + header.filesOffset),
+						header.filesCount };
+	catalogue.nodes = { reinterpret_cast<const AssetNodeRecord*>(data.data() + header.nodesOffset),
+						header.nodesCount };
+	catalogue.strings = { reinterpret_cast<const char*>(data.data() + header.stringsOffset),
+						  static_cast<std::size_t>(header.stringsSize) };
+
+	// Validated once here, so the accessors never check.
+	for (const auto& file : catalogue.files)
+	{
+		if (not IsRangeInside(file.nameOffset, file.nameSize, catalogue.strings.size()) or
+			not IsRangeInside(file.firstNode, file.nodesCount, catalogue.nodes.size()))
+		{
+			return std::nullopt;
+		}
+	}
+	for (const auto& node : catalogue.nodes)
+	{
+		if (not IsRangeInside(node.nameOffset, node.nameSize, catalogue.strings.size()) or
+			not IsRangeInside(node.dataOffset, node.dataSize, catalogue.strings.size()))
+		{
+			return std::nullopt;
+		}
+	}
+	return catalogue;
+}
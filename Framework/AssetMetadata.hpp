@@ -0,0 +1,116 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <stduuid/uuid.h>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetContainer.hpp"
+#include "Core.hpp"
+#include "MappedFile.hpp"
+
+namespace Framework
+{
+	/*
+	 * Records of the binary asset metadata, used in place from the mapping. Names and node data live in a string
+	 * table shared by every record, each distinct string is stored once. Files refer to a range of the node table.
+	 */
+	struct AssetFileRecord
+	{
+		UuidBytes uuid{};
+		U32 nameOffset{ 0 };
+		U32 nameSize{ 0 };
+		U32 version{ 0 };
+		U32 firstNode{ 0 };
+		U32 nodesCount{ 0 };
+	};
+
+	struct AssetNodeRecord
+	{
+		UuidBytes uuid{};
+		U32 nameOffset{ 0 };
+		U32 nameSize{ 0 };
+		U32 dataOffset{ 0 };
+		U32 dataSize{ 0 };
+		U32 version{ 0 };
+		AssetType type{ AssetType::subMesh };
+		U8 padding[3]{};
+	};
+
+	/*
+	 * Collects asset files and their nodes in memory and writes them as one metadata file. Nodes belong to the file
+	 * of the last AddFile().
+	 */
+	struct AssetMetadataBuilder
+	{
+		void AddFile(const uuids::uuid& uuid, std::string_view name, U32 version);
+		void AddNode(const uuids::uuid& uuid, std::string_view name, AssetType type, U32 version,
+					 std::string_view assetNodeData);
+
+		bool Write(const std::filesystem::path& metadataPath) const;
+
+	private:
+		U32 Intern(std::string_view string);
+
+		std::vector<AssetFileRecord> files;
+		std::vector<AssetNodeRecord> nodes;
+		std::string strings;
+		std::unordered_map<std::string, U32> stringOffsets;
+	};
+
+	/*
+	 * Read-only metadata mapped in memory. Opening validates every record once, accessors then hand out records and
+	 * views into the mapping without allocating.
+	 */
+	struct AssetCatalogue
+	{
+		// Empty when the file is missing or malformed.
+		static std::optional<AssetCatalogue> Open(const std::filesystem::path& metadataPath);
+
+		std::span<const AssetFileRecord> GetFiles() const
+		{
+			return files;
+		}
+
+		std::span<const AssetNodeRecord> GetNodes() const
+		{
+			return nodes;
+		}
+
+		std::span<const AssetNodeRecord> GetNodes(const AssetFileRecord& file) const
+		{
+			return nodes.subspan(file.firstNode, file.nodesCount);
+		}
+
+		std::string_view GetName(const AssetFileRecord& file) const
+		{
+			return strings.substr(file.nameOffset, file.nameSize);
+		}
+
+		std::string_view GetName(const AssetNodeRecord& node) const
+		{
+			return strings.substr(node.nameOffset, node.nameSize);
+		}
+
+		std::string_view GetAssetNodeData(const AssetNodeRecord& node) const
+		{
+			return strings.substr(node.dataOffset, node.dataSize);
+		}
+
+		// Size of the string table, smaller than the sum of the strings when records share them.
+		std::size_t GetStringsSize() const
+		{
+			return strings.size();
+		}
+
+	private:
+		MappedFile file;
+		std::span<const AssetFileRecord> files;
+		std::span<const AssetNodeRecord> nodes;
+		std::string_view strings;
+	};
+} // namespace Framework
@@ -0,0 +1,290 @@
+#include "AssetRegistry.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace Framework;
+
+struct AssetHandle::LoadedAsset
+{
+	AssetRegistry* registry{ nullptr };
+	UuidBytes uuid{};
+	AssetType type{ AssetType::subMesh };
+	std::vector<std::vector<std::byte>> decodedPayloads;
+	std::vector<std::span<const std::byte>> payloads;
+	std::atomic<U32> referenceCount{ 1 };
+};
+
+namespace
+{
+	U64 HashUuid(const UuidBytes& uuid)
+	{
+		auto low = U64{};
+		auto high = U64{};
+		std::memcpy(&low, uuid.data(), sizeof(low));
+		std::memcpy(&high, uuid.data() + sizeof(low), sizeof(high));
+		// Finalizer of MurmurHash3, version and variant bits sit at fixed places in every uuid.
+		auto hash = low ^ (high * 0x9e3779b97f4a7c15ull);
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+} // namespace
+
+AssetHandle::~AssetHandle()
+{
+	Release();
+}
+
+AssetHandle::AssetHandle(const AssetHandle& other) : asset{ other.asset }
+{
+	if (asset != nullptr)
+	{
+		asset->referenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+AssetHandle& AssetHandle::operator=(const AssetHandle& other)
+{
+	if (this != &other)
+	{
+		Release();
+		asset = other.asset;
+		if (asset != nullptr)
+		{
+			asset->referenceCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return *this;
+}
+
+AssetHandle::AssetHandle(AssetHandle&& other) noexcept : asset{ other.asset }
+{
+	other.asset = nullptr;
+}
+
+AssetHandle& AssetHandle::operator=(AssetHandle&& other) noexcept
+{
+	if (this != &other)
+	{
+		Release();
+		asset = other.asset;
+		other.asset = nullptr;
+	}
+	return *this;
+}
+
+AssetType AssetHandle::GetType() const
+{
+	assert(asset != nullptr);
+	return asset->type;
+}
+
+std::span<const std::span<const std::byte>> AssetHandle::GetPayloads() const
+{
+	assert(asset != nullptr);
+	return asset->payloads;
+}
+
+void AssetHandle::Release()
+{
+	if (asset != nullptr and asset->referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		asset->registry->Unload(asset);
+	}
+	asset = nullptr;
+}
+
+AssetRegistry::~AssetRegistry()
+{
+	assert(loadedAssetsCount == 0);
+}
+
+bool AssetRegistry::AddContainer(const std::filesystem::path& containerPath)
+{
+	ZoneScoped;
+	auto container = AssetContainer::Open(containerPath);
+	if (not container)
+	{
+		return false;
+	}
+
+	const auto lock = std::unique_lock{ tableMutex };
+	const auto containerIndex = static_cast<U32>(containers.size());
+	containers.push_back(std::make_unique<AssetContainer>(std::move(*container)));
+	const auto entries = containers.back()->GetEntries();
+	for (auto i = 0u; i < entries.size(); i++)
+	{
+		if ((assetsCount + 1) * 2 > slots.size())
+		{
+			Grow();
+		}
+		auto& slot = slots[Probe(entries[i].uuid)];
+		if (slot.container == invalidIndex)
+		{
+			slot = Slot{ .uuid = entries[i].uuid, .container = containerIndex, .entry = i };
+			assetsCount++;
+		}
+	}
+	return true;
+}
+
+U32 AssetRegistry::GetAssetsCount() const
+{
+	const auto lock = std::shared_lock{ tableMutex };
+	return assetsCount;
+}
+
+std::optional<AssetLocation> AssetRegistry::Find(const uuids::uuid& uuid) const
+{
+	const auto lock = std::shared_lock{ tableMutex };
+	if (slots.empty())
+	{
+		return std::nullopt;
+	}
+	const auto& slot = slots[Probe(ToUuidBytes(uuid))];
+	if (slot.container == invalidIndex)
+	{
+		return std::nullopt;
+	}
+	const auto& container = *containers[slot.container];
+	return AssetLocation{ .container = &container, .entry = &container.GetEntries()[slot.entry] };
+}
+
+AssetHandle AssetRegistry::Resolve(const uuids::uuid& uuid)
+{
+	const auto tableLock = std::shared_lock{ tableMutex };
+	if (slots.empty())
+	{
+		return AssetHandle{};
+	}
+	auto& slot = slots[Probe(ToUuidBytes(uuid))];
+	if (slot.container == invalidIndex)
+	{
+		return AssetHandle{};
+	}
+	{
+		const auto lock = std::lock_guard{ loadMutex };
+		if (TryAcquire(slot.loadedAsset))
+		{
+			return AssetHandle{ slot.loadedAsset };
+		}
+	}
+
+	// Decoded without holding loadMutex, other assets keep resolving meanwhile.
+	auto loadedAsset = Load(slot);
+	if (loadedAsset == nullptr)
+	{
+		return AssetHandle{};
+	}
+
+	const auto lock = std::lock_guard{ loadMutex };
+	if (TryAcquire(slot.loadedAsset))
+	{
+		return AssetHandle{ slot.loadedAsset };
+	}
+	slot.loadedAsset = loadedAsset.release();
+	loadedAssetsCount++;
+	return AssetHandle{ slot.loadedAsset };
+}
+
+U32 AssetRegistry::GetLoadedAssetsCount() const
+{
+	const auto lock = std::lock_guard{ loadMutex };
+	return loadedAssetsCount;
+}
+
+bool AssetRegistry::TryAcquire(AssetHandle::LoadedAsset* asset)
+{
+	if (asset == nullptr)
+	{
+		return false;
+	}
+	// Once the count reached zero the asset is being unloaded, it never comes back.
+	auto count = asset->referenceCount.load(std::memory_order_relaxed);
+	while (count != 0)
+	{
+		if (asset->referenceCount.compare_exchange_weak(count, count + 1, std::memory_order_acquire))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+U32 AssetRegistry::Probe(const UuidBytes& uuid) const
+{
+	assert(not slots.empty());
+	const auto mask = static_cast<U32>(slots.size() - 1);
+	auto index = static_cast<U32>(HashUuid(uuid)) & mask;
+	while (slots[index].container != invalidIndex and slots[index].uuid != uuid)
+	{
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+void AssetRegistry::Grow()
+{
+	auto previousSlots = std::move(slots);
+	slots = std::vector<Slot>(std::max(std::size_t{ 64 }, previousSlots.size() * 2));
+	for (const auto& slot : previousSlots)
+	{
+		if (slot.container != invalidIndex)
+		{
+			slots[Probe(slot.uuid)] = slot;
+		}
+	}
+}
+
+std::unique_ptr<AssetHandle::LoadedAsset> AssetRegistry::Load(const Slot& slot)
+{
+	ZoneScoped;
+	const auto& container = *containers[slot.container];
+	const auto& entry = container.GetEntries()[slot.entry];
+	const auto payloads = container.GetPayloads(entry);
+
+	auto asset = std::make_unique<AssetHandle::LoadedAsset>();
+	asset->registry = this;
+	asset->uuid = slot.uuid;
+	asset->type = entry.type;
+	asset->decodedPayloads.reserve(payloads.size());
+	asset->payloads.reserve(payloads.size());
+	for (const auto& payload : payloads)
+	{
+		if (payload.encoding == BinaryEncoding::raw)
+		{
+			asset->payloads.push_back(container.GetPayloadData(payload));
+			continue;
+		}
+		auto& decoded = asset->decodedPayloads.emplace_back(payload.decodedSize);
+		if (not container.Decode(payload, decoded))
+		{
+			return nullptr;
+		}
+		asset->payloads.push_back(decoded);
+	}
+	return asset;
+}
+
+void AssetRegistry::Unload(AssetHandle::LoadedAsset* asset)
+{
+	{
+		const auto tableLock = std::shared_lock{ tableMutex };
+		const auto lock = std::lock_guard{ loadMutex };
+		// A resolution may already have replaced the asset while its last handle was going away.
+		auto& slot = slots[Probe(asset->uuid)];
+		if (slot.loadedAsset == asset)
+		{
+			slot.loadedAsset = nullptr;
+		}
+		loadedAssetsCount--;
+	}
+	delete asset;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <stduuid/uuid.h>
+#include <vector>
+
+#include "AssetContainer.hpp"
+#include "Core.hpp"
+
+namespace Framework
+{
+	struct AssetRegistry;
+
+	// Where an asset is stored, valid as long as the registry.
+	struct AssetLocation
+	{
+		const AssetContainer* container{ nullptr };
+		const AssetContainerEntry* entry{ nullptr };
+	};
+
+	/*
+	 * Reference to the payloads of a resolved asset. The payloads stay loaded while a handle refers to them, the
+	 * last handle gone unloads them. Handles must not outlive their registry.
+	 */
+	struct AssetHandle final
+	{
+		AssetHandle() = default;
+		~AssetHandle();
+
+		AssetHandle(const AssetHandle& other);
+		AssetHandle& operator=(const AssetHandle& other);
+		AssetHandle(AssetHandle&& other) noexcept;
+		AssetHandle& operator=(AssetHandle&& other) noexcept;
+
+		explicit operator bool() const
+		{
+			return asset != nullptr;
+		}
+
+		AssetType GetType() const;
+
+		// Decoded payloads of the asset in the order they were added, raw ones point into the mapped container.
+		std::span<const std::span<const std::byte>> GetPayloads() const;
+
+	private:
+		friend struct AssetRegistry;
+
+		struct LoadedAsset;
+
+		explicit AssetHandle(LoadedAsset* asset) : asset{ asset }
+		{
+		}
+
+		void Release();
+
+		LoadedAsset* asset{ nullptr };
+	};
+
+	/*
+	 * Index of every asset of the registered containers, an open addressing table from uuid to container entry.
+	 * Lookups and resolutions are safe from any number of threads, also while containers are added. Payloads are
+	 * only decoded on the first resolution of an asset, concurrent first resolutions may decode it more than once
+	 * but all of them end up with the same payloads.
+	 */
+	struct AssetRegistry final
+	{
+		AssetRegistry() = default;
+		~AssetRegistry();
+
+		AssetRegistry(const AssetRegistry&) = delete;
+		AssetRegistry(AssetRegistry&&) = delete;
+
+		/*
+		 * Maps the container and indexes its assets, false when it cannot be opened. An asset already registered
+		 * from another container keeps its first location, cooked assets with the same uuid have the same content.
+		 */
+		bool AddContainer(const std::filesystem::path& containerPath);
+
+		U32 GetAssetsCount() const;
+
+		std::optional<AssetLocation> Find(const uuids::uuid& uuid) const;
+
+		// Empty handle for unknown uuids and for assets whose payloads do not decode.
+		AssetHandle Resolve(const uuids::uuid& uuid);
+
+		// Assets with at least one handle.
+		U32 GetLoadedAssetsCount() const;
+
+	private:
+		friend struct AssetHandle;
+
+		static constexpr auto invalidIndex = ~U32{ 0 };
+
+		struct Slot
+		{
+			UuidBytes uuid{};
+			U32 container{ invalidIndex };
+			U32 entry{ 0 };
+			// Guarded by loadMutex.
+			AssetHandle::LoadedAsset* loadedAsset{ nullptr };
+		};
+
+		// A handle may only be taken from an asset some other handle still keeps loaded.
+		static bool TryAcquire(AssetHandle::LoadedAsset* asset);
+		// Index of the slot holding uuid or of the empty slot ending its probe sequence.
+		U32 Probe(const UuidBytes& uuid) const;
+		void Grow();
+		std::unique_ptr<AssetHandle::LoadedAsset> Load(const Slot& slot);
+		void Unload(AssetHandle::LoadedAsset* asset);
+
+		mutable std::shared_mutex tableMutex;
+		std::vector<std::unique_ptr<AssetContainer>> containers;
+		// Power of two size, at most half full.
+		std::vector<Slot> slots;
+		U32 assetsCount{ 0 };
+
+		mutable std::mutex loadMutex;
+		U32 loadedAssetsCount{ 0 };
+	};
+} // namespace Framework
@@ -0,0 +1,602 @@
+#include "AssetStreamer.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <span>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace Framework;
+
+namespace
+{
+	// Requests the I/O thread takes at once, a more urgent request waits for at most one batch.
+	constexpr auto maxBatchedRequests = 16u;
+	constexpr auto ioUringEntriesCount = 64u;
+	// Larger payloads are read in several parts.
+	constexpr auto maxReadSize = std::size_t{ 1 } << 30;
+
+#ifdef _WIN32
+	using NativeFile = HANDLE;
+#else
+	using NativeFile = int;
+#endif
+
+	NativeFile OpenForReading(const std::filesystem::path& filePath)
+	{
+#ifdef _WIN32
+		return CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+						   FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+		return open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+	}
+
+	bool IsValid(NativeFile file)
+	{
+#ifdef _WIN32
+		return file != INVALID_HANDLE_VALUE;
+#else
+		return file >= 0;
+#endif
+	}
+
+	void CloseFile(NativeFile file)
+	{
+#ifdef _WIN32
+		CloseHandle(file);
+#else
+		close(file);
+#endif
+	}
+
+	// Blocking read of the whole range, false on errors and when the file ends before it.
+	bool ReadAt(NativeFile file, U64 offset, std::span<std::byte> destination)
+	{
+		while (not destination.empty())
+		{
+			const auto size = std::min(destination.size(), maxReadSize);
+#ifdef _WIN32
+			auto overlapped = OVERLAPPED{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			auto readSize = DWORD{ 0 };
+			if (not ReadFile(file, destination.data(), static_cast<DWORD>(size), &readSize, &overlapped) or
+				readSize == 0)
+			{
+				return false;
+			}
+#else
+			const auto readSize = pread(file, destination.data(), size, static_cast<off_t>(offset));
+			if (readSize < 0 and errno == EINTR)
+			{
+				continue;
+			}
+			if (readSize <= 0)
+			{
+				return false;
+			}
+#endif
+			offset += static_cast<U64>(readSize);
+			destination = destination.subspan(static_cast<std::size_t>(readSize));
+		}
+		return true;
+	}
+
+	struct ReadOperation
+	{
+		NativeFile file;
+		U64 offset{ 0 };
+		std::span<std::byte> destination;
+		// Index of the request in the batch.
+		U32 owner{ 0 };
+		// Set once the ring reported the read, a failed ring leaves the others to blocking reads.
+		bool isCompleted{ false };
+		bool hasFailed{ false };
+	};
+} // namespace
+
+#ifdef __linux__
+/*
+ * Minimal io_uring set up with the raw system calls, only for positional reads. The I/O thread is the only user
+ * of the rings, so the kernel is the only other party to synchronize with.
+ */
+struct AssetStreamer::IoUring
+{
+	~IoUring()
+	{
+		if (submissionEntries != MAP_FAILED)
+		{
+			munmap(submissionEntries, submissionEntriesSize);
+		}
+		if (completionRing != MAP_FAILED and completionRing != submissionRing)
+		{
+			munmap(completionRing, completionRingSize);
+		}
+		if (submissionRing != MAP_FAILED)
+		{
+			munmap(submissionRing, submissionRingSize);
+		}
+		if (ring >= 0)
+		{
+			close(ring);
+		}
+	}
+
+	// False when the kernel is too old or io_uring is disabled, e.g. by a container's seccomp profile.
+	bool Initialize(U32 requestedEntriesCount)
+	{
+		auto parameters = io_uring_params{};
+		ring = static_cast<int>(syscall(__NR_io_uring_setup, requestedEntriesCount, &parameters));
+		if (ring < 0)
+		{
+			return false;
+		}
+		entriesCount = parameters.sq_entries;
+		submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(U32);
+		completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+		const auto isSingleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (isSingleMapping)
+		{
+			submissionRingSize = std::max(submissionRingSize, completionRingSize);
+			completionRingSize = submissionRingSize;
+		}
+
+		submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring,
+							  IORING_OFF_SQ_RING);
+		if (submissionRing == MAP_FAILED)
+		{
+			return false;
+		}
+		completionRing = isSingleMapping ? submissionRing
+										 : mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE,
+												MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+		if (completionRing == MAP_FAILED)
+		{
+			return false;
+		}
+		submissionEntriesSize = entriesCount * sizeof(io_uring_sqe);
+		submissionEntries = mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+								 ring, IORING_OFF_SQES);
+		if (submissionEntries == MAP_FAILED)
+		{
+			return false;
+		}
+
+		const auto At = [](void* base, U32 offset) { return static_cast<std::byte*>(base) + offset; };
+		submissionHead = reinterpret_cast<U32*>(At(submissionRing, parameters.sq_off.head));
+		submissionTail = reinterpret_cast<U32*>(At(submissionRing, parameters.sq_off.tail));
+		submissionMask = reinterpret_cast<U32*>(At(submissionRing, parameters.sq_off.ring_mask));
+		submissionArray = reinterpret_cast<U32*>(At(submissionRing, parameters.sq_off.array));
+		completionHead = reinterpret_cast<U32*>(At(completionRing, parameters.cq_off.head));
+		completionTail = reinterpret_cast<U32*>(At(completionRing, parameters.cq_off.tail));
+		completionMask = reinterpret_cast<U32*>(At(completionRing, parameters.cq_off.ring_mask));
+		completions = reinterpret_cast<io_uring_cqe*>(At(completionRing, parameters.cq_off.cqes));
+		return true;
+	}
+
+	/*
+	 * Keeps up to entriesCount reads in flight until all of them are done. False when io_uring_enter fails for
+	 * another reason than an interruption or a full completion ring, the reads the ring did not complete are then
+	 * done with blocking reads.
+	 */
+	bool Read(std::span<ReadOperation> operations)
+	{
+		const auto entries = static_cast<io_uring_sqe*>(submissionEntries);
+		auto submittedCount = std::size_t{ 0 };
+		auto completedCount = std::size_t{ 0 };
+		auto inFlightCount = U32{ 0 };
+		auto unsubmittedCount = U32{ 0 };
+		while (completedCount < operations.size())
+		{
+			auto tail = *submissionTail;
+			while (submittedCount < operations.size() and inFlightCount < entriesCount)
+			{
+				const auto& operation = operations[submittedCount];
+				const auto index = tail & *submissionMask;
+				auto& entry = entries[index];
+				entry = io_uring_sqe{};
+				entry.opcode = IORING_OP_READ;
+				entry.fd = operation.file;
+				entry.off = operation.offset;
+				entry.addr = reinterpret_cast<U64>(operation.destination.data());
+				entry.len = static_cast<U32>(std::min(operation.destination.size(), maxReadSize));
+				entry.user_data = submittedCount;
+				submissionArray[index] = index;
+				tail++;
+				submittedCount++;
+				inFlightCount++;
+				unsubmittedCount++;
+			}
+			std::atomic_ref{ *submissionTail }.store(tail, std::memory_order_release);
+
+			const auto result = syscall(__NR_io_uring_enter, ring, unsubmittedCount, 1u, IORING_ENTER_GETEVENTS,
+										nullptr, std::size_t{ 0 });
+			const auto hasRingFailed = result < 0 and errno != EINTR and errno != EAGAIN and errno != EBUSY;
+			if (result >= 0)
+			{
+				unsubmittedCount -= static_cast<U32>(result);
+			}
+
+			auto head = *completionHead;
+			const auto completionTailValue = std::atomic_ref{ *completionTail }.load(std::memory_order_acquire);
+			for (; head != completionTailValue; head++)
+			{
+				const auto& completion = completions[head & *completionMask];
+				auto& operation = operations[completion.user_data];
+				// Errors, e.g. of kernels without IORING_OP_READ, and short reads finish with a blocking read.
+				const auto readSize = completion.res < 0 ? std::size_t{ 0 } : static_cast<std::size_t>(completion.res);
+				if (readSize < operation.destination.size())
+				{
+					operation.hasFailed = not ReadAt(operation.file, operation.offset + readSize,
+													 operation.destination.subspan(readSize));
+				}
+				operation.isCompleted = true;
+				inFlightCount--;
+				completedCount++;
+			}
+			std::atomic_ref{ *completionHead }.store(head, std::memory_order_release);
+
+			if (hasRingFailed)
+			{
+				for (auto& operation : operations)
+				{
+					if (not operation.isCompleted)
+					{
+						operation.hasFailed = not ReadAt(operation.file, operation.offset, operation.destination);
+					}
+				}
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int ring{ -1 };
+	U32 entriesCount{ 0 };
+	void* submissionRing{ MAP_FAILED };
+	std::size_t submissionRingSize{ 0 };
+	void* completionRing{ MAP_FAILED };
+	std::size_t completionRingSize{ 0 };
+	void* submissionEntries{ MAP_FAILED };
+	std::size_t submissionEntriesSize{ 0 };
+	U32* submissionHead{ nullptr };
+	U32* submissionTail{ nullptr };
+	U32* submissionMask{ nullptr };
+	U32* submissionArray{ nullptr };
+	U32* completionHead{ nullptr };
+	U32* completionTail{ nullptr };
+	U32* completionMask{ nullptr };
+	io_uring_cqe* completions{ nullptr };
+};
+#else
+struct AssetStreamer::IoUring
+{
+	bool Initialize(U32)
+	{
+		return false;
+	}
+
+	bool Read(std::span<ReadOperation>)
+	{
+		return false;
+	}
+};
+#endif
+
+AssetStreamer::AssetStreamer(const AssetRegistry& registry, StreamingBackend backend) : registry{ registry }
+{
+	if (backend == StreamingBackend::ioUring)
+	{
+		ioUring = std::make_unique<IoUring>();
+		if (ioUring->Initialize(ioUringEntriesCount))
+		{
+			this->backend = StreamingBackend::ioUring;
+		}
+		else
+		{
+			ioUring.reset();
+		}
+	}
+	ioThread = std::thread{ [this] { IoThreadLoop(); } };
+}
+
+AssetStreamer::~AssetStreamer()
+{
+	{
+		const auto lock = std::lock_guard{ mutex };
+		shouldStop = true;
+	}
+	requestsAvailable.notify_one();
+	ioThread.join();
+}
+
+StreamRequestId AssetStreamer::Request(const uuids::uuid& uuid, Float priority, StreamCompletion completion)
+{
+	if (not registry.Find(uuid))
+	{
+		return invalidStreamRequest;
+	}
+	auto request = invalidStreamRequest;
+	{
+		const auto lock = std::lock_guard{ mutex };
+		request = nextRequest++;
+		const auto& pendingRequest =
+			pendingRequests
+				.emplace(request,
+						 PendingRequest{ .uuid = uuid, .priority = priority, .completion = std::move(completion) })
+				.first->second;
+		Enqueue(request, pendingRequest);
+		queuedCount++;
+	}
+	requestsAvailable.notify_one();
+	return request;
+}
+
+void AssetStreamer::UpdatePriority(StreamRequestId request, Float priority)
+{
+	const auto lock = std::lock_guard{ mutex };
+	const auto it = pendingRequests.find(request);
+	if (it == pendingRequests.end() or not it->second.isQueued or it->second.priority == priority)
+	{
+		return;
+	}
+	it->second.priority = priority;
+	it->second.generation++;
+	Enqueue(request, it->second);
+
+	// Priorities changing every frame would otherwise pile up stale entries while the I/O thread is busy.
+	if (queue.size() > 2 * queuedCount + maxBatchedRequests)
+	{
+		queue.clear();
+		for (const auto& [pendingId, pendingRequest] : pendingRequests)
+		{
+			if (pendingRequest.isQueued)
+			{
+				Enqueue(pendingId, pendingRequest);
+			}
+		}
+	}
+}
+
+bool AssetStreamer::Cancel(StreamRequestId request)
+{
+	{
+		const auto lock = std::lock_guard{ mutex };
+		const auto it = pendingRequests.find(request);
+		if (it == pendingRequests.end())
+		{
+			return false;
+		}
+		if (it->second.isQueued)
+		{
+			queuedCount--;
+		}
+		pendingRequests.erase(it);
+		std::erase_if(completedRequests,
+					  [&](const CompletedRequest& completedRequest) { return completedRequest.request == request; });
+	}
+	completionsAvailable.notify_all();
+	return true;
+}
+
+void AssetStreamer::SetPaused(bool isPaused)
+{
+	{
+		const auto lock = std::lock_guard{ mutex };
+		this->isPaused = isPaused;
+	}
+	requestsAvailable.notify_one();
+}
+
+U32 AssetStreamer::GetPendingCount() const
+{
+	const auto lock = std::lock_guard{ mutex };
+	return static_cast<U32>(pendingRequests.size());
+}
+
+U32 AssetStreamer::DispatchCompletions(U32 maxCount)
+{
+	auto completions = std::vector<std::pair<StreamCompletion, StreamedAsset>>{};
+	{
+		const auto lock = std::lock_guard{ mutex };
+		const auto count = std::min(static_cast<std::size_t>(maxCount), completedRequests.size());
+		completions.reserve(count);
+		for (auto i = 0u; i < count; i++)
+		{
+			const auto it = pendingRequests.find(completedRequests[i].request);
+			assert(it != pendingRequests.end());
+			completions.emplace_back(std::move(it->second.completion), std::move(completedRequests[i].asset));
+			pendingRequests.erase(it);
+		}
+		completedRequests.erase(completedRequests.begin(), completedRequests.begin() + count);
+	}
+	// Outside the lock, completions may request or cancel more assets.
+	for (const auto& [completion, asset] : completions)
+	{
+		completion(asset);
+	}
+	if (not completions.empty())
+	{
+		completionsAvailable.notify_all();
+	}
+	return static_cast<U32>(completions.size());
+}
+
+void AssetStreamer::WaitForCompletions() const
+{
+	auto lock = std::unique_lock{ mutex };
+	completionsAvailable.wait(lock, [&] { return not completedRequests.empty() or pendingRequests.empty(); });
+}
+
+bool AssetStreamer::IsLessUrgent(const QueuedRequest& a, const QueuedRequest& b)
+{
+	// Equal priorities load in request order.
+	return a.priority > b.priority or (a.priority == b.priority and a.request > b.request);
+}
+
+void AssetStreamer::Enqueue(StreamRequestId request, const PendingRequest& pendingRequest)
+{
+	queue.push_back(QueuedRequest{
+		.priority = pendingRequest.priority, .request = request, .generation = pendingRequest.generation });
+	std::ranges::push_heap(queue, IsLessUrgent);
+}
+
+void AssetStreamer::IoThreadLoop()
+{
+	struct BatchedRequest
+	{
+		StreamRequestId request{ invalidStreamRequest };
+		StreamedAsset asset;
+		bool hasFailed{ false };
+	};
+
+	// Container files stay open for the lifetime of the thread.
+	auto files = std::unordered_map<const AssetContainer*, NativeFile>{};
+	auto batch = std::vector<BatchedRequest>{};
+	auto operations = std::vector<ReadOperation>{};
+	while (true)
+	{
+		batch.clear();
+		operations.clear();
+		{
+			auto lock = std::unique_lock{ mutex };
+			requestsAvailable.wait(lock, [&] { return shouldStop or (not isPaused and queuedCount > 0); });
+			if (shouldStop)
+			{
+				break;
+			}
+			while (not queue.empty() and batch.size() < maxBatchedRequests)
+			{
+				std::ranges::pop_heap(queue, IsLessUrgent);
+				const auto queued = queue.back();
+				queue.pop_back();
+				// Cancelled requests and older priorities of a request are skipped.
+				const auto it = pendingRequests.find(queued.request);
+				if (it == pendingRequests.end() or it->second.generation != queued.generation)
+				{
+					continue;
+				}
+				it->second.isQueued = false;
+				queuedCount--;
+				batch.push_back(
+					BatchedRequest{ .request = queued.request, .asset = StreamedAsset{ .uuid = it->second.uuid } });
+			}
+		}
+
+		ZoneScopedN("Stream Assets");
+		// The registry never forgets an asset, what was found by Request() is still there.
+		for (auto i = 0u; i < batch.size(); i++)
+		{
+			auto& asset = batch[i].asset;
+			const auto location = registry.Find(asset.uuid);
+			assert(location.has_value());
+			asset.type = location->entry->type;
+			asset.location = *location;
+
+			auto [file, isNew] = files.try_emplace(location->container);
+			if (isNew)
+			{
+				file->second = OpenForReading(location->container->GetPath());
+			}
+			if (not IsValid(file->second))
+			{
+				batch[i].hasFailed = true;
+				continue;
+			}
+			const auto payloads = location->container->GetPayloads(*location->entry);
+			asset.payloads.resize(payloads.size());
+			for (auto j = 0u; j < payloads.size(); j++)
+			{
+				asset.payloads[j].resize(payloads[j].size);
+				operations.push_back(ReadOperation{
+					.file = file->second, .offset = payloads[j].offset, .destination = asset.payloads[j], .owner = i });
+			}
+		}
+
+		if (ioUring)
+		{
+			// A failed ring is not used again, later batches use blocking reads.
+			if (not ioUring->Read(operations))
+			{
+				ioUring.reset();
+				backend = StreamingBackend::pread;
+			}
+		}
+		else
+		{
+			for (auto& operation : operations)
+			{
+				operation.hasFailed = not ReadAt(operation.file, operation.offset, operation.destination);
+			}
+		}
+		for (const auto& operation : operations)
+		{
+			batch[operation.owner].hasFailed = batch[operation.owner].hasFailed or operation.hasFailed;
+		}
+
+		for (auto& batchedRequest : batch)
+		{
+			auto& asset = batchedRequest.asset;
+			if (batchedRequest.hasFailed)
+			{
+				asset.payloads.clear();
+				continue;
+			}
+			const auto payloads = asset.location.container->GetPayloads(*asset.location.entry);
+			for (auto j = 0u; j < payloads.size(); j++)
+			{
+				if (payloads[j].encoding == BinaryEncoding::raw)
+				{
+					continue;
+				}
+				auto decoded = std::vector<std::byte>(payloads[j].decodedSize);
+				if (not DecodeBinary(payloads[j].encoding, decoded, asset.payloads[j]))
+				{
+					asset.payloads.clear();
+					break;
+				}
+				asset.payloads[j] = std::move(decoded);
+			}
+		}
+
+		{
+			const auto lock = std::lock_guard{ mutex };
+			for (auto& batchedRequest : batch)
+			{
+				// Requests cancelled while their reads were in flight are dropped.
+				if (pendingRequests.contains(batchedRequest.request))
+				{
+					completedRequests.push_back(CompletedRequest{ .request = batchedRequest.request,
+																  .asset = std::move(batchedRequest.asset) });
+				}
+			}
+		}
+		completionsAvailable.notify_all();
+	}
+
+	for (const auto& [container, file] : files)
+	{
+		if (IsValid(file))
+		{
+			CloseFile(file);
+		}
+	}
+}
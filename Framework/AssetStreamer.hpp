@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stduuid/uuid.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetContainer.hpp"
+#include "AssetRegistry.hpp"
+#include "Core.hpp"
+
+namespace Framework
+{
+	enum class StreamingBackend : U8
+	{
+		// Linux only, batches of reads go to the kernel with one system call.
+		ioUring,
+		// One blocking positional read per payload, available everywhere.
+		pread
+	};
+
+	struct StreamedAsset
+	{
+		uuids::uuid uuid;
+		AssetType type{ AssetType::subMesh };
+		// Where the payloads were read from, valid as long as the registry.
+		AssetLocation location{};
+		// Decoded payloads in the order they were added to the container, empty when they could not be read or decoded.
+		std::vector<std::vector<std::byte>> payloads{};
+	};
+
+	using StreamRequestId = U64;
+	inline constexpr StreamRequestId invalidStreamRequest = 0;
+
+	using StreamCompletion = std::function<void(const StreamedAsset& asset)>;
+
+	/*
+	 * Loads assets of the registry on a dedicated I/O thread, the urgent ones first. Payloads are read from the
+	 * container files into memory owned by the request and decoded on that thread, completions run on the thread
+	 * calling DispatchCompletions(), e.g. the frame loop owning the GPU uploads. Nothing waits on I/O there.
+	 */
+	struct AssetStreamer final
+	{
+		// The registry has to outlive the streamer. io_uring falls back to pread when the kernel refuses it.
+		explicit AssetStreamer(const AssetRegistry& registry, StreamingBackend backend = StreamingBackend::ioUring);
+		~AssetStreamer();
+
+		AssetStreamer(const AssetStreamer&) = delete;
+		AssetStreamer(AssetStreamer&&) = delete;
+
+		// pread once io_uring failed on the I/O thread.
+		StreamingBackend GetBackend() const
+		{
+			return backend.load(std::memory_order_relaxed);
+		}
+
+		/*
+		 * Lower priorities load first, e.g. the distance of the asset to the camera. invalidStreamRequest for
+		 * uuids the registry does not know, their completion never runs.
+		 */
+		StreamRequestId Request(const uuids::uuid& uuid, Float priority, StreamCompletion completion);
+
+		// Only reorders requests still waiting for the I/O thread.
+		void UpdatePriority(StreamRequestId request, Float priority);
+
+		// False when the completion already ran. Reads already in flight finish and their payloads are dropped.
+		bool Cancel(StreamRequestId request);
+
+		/*
+		 * A paused streamer keeps queueing requests but starts no read, e.g. while the requests of a whole level are
+		 * issued, so they load in priority order rather than in request order.
+		 */
+		void SetPaused(bool isPaused);
+
+		// Requests whose completion has not run yet.
+		U32 GetPendingCount() const;
+
+		// Runs at most maxCount completions on the calling thread, oldest first, and returns how many ran.
+		U32 DispatchCompletions(U32 maxCount = ~0u);
+
+		// Blocks until a completion can be dispatched or nothing is pending anymore.
+		void WaitForCompletions() const;
+
+	private:
+		struct PendingRequest
+		{
+			uuids::uuid uuid;
+			Float priority{ 0.0f };
+			// Bumped by UpdatePriority(), queue entries of an older generation are stale.
+			U32 generation{ 0 };
+			// Cleared once the I/O thread took the request.
+			bool isQueued{ true };
+			StreamCompletion completion;
+		};
+
+		struct QueuedRequest
+		{
+			Float priority{ 0.0f };
+			StreamRequestId request{ invalidStreamRequest };
+			U32 generation{ 0 };
+		};
+
+		struct CompletedRequest
+		{
+			StreamRequestId request{ invalidStreamRequest };
+			StreamedAsset asset;
+		};
+
+		struct IoUring;
+
+		static bool IsLessUrgent(const QueuedRequest& a, const QueuedRequest& b);
+		void Enqueue(StreamRequestId request, const PendingRequest& pendingRequest);
+		void IoThreadLoop();
+
+		const AssetRegistry& registry;
+		std::atomic<StreamingBackend> backend{ StreamingBackend::pread };
+		// Only used by the I/O thread once it runs.
+		std::unique_ptr<IoUring> ioUring;
+
+		mutable std::mutex mutex;
+		std::condition_variable requestsAvailable;
+		mutable std::condition_variable completionsAvailable;
+		std::unordered_map<StreamRequestId, PendingRequest> pendingRequests;
+		// Heap with the most urgent request on top, may hold stale entries.
+		std::vector<QueuedRequest> queue;
+		U32 queuedCount{ 0 };
+		std::vector<CompletedRequest> completedRequests;
+		StreamRequestId nextRequest{ invalidStreamRequest + 1 };
+		bool isPaused{ false };
+		bool shouldStop{ false };
+
+		std::thread ioThread;
+	};
+} // namespace Framework
@@ -214,12 +214,20 @@ void Framework::Graphics::BasicRenderPipeline::Execute(const VulkanContext& cont
 				.pNext = nullptr,
 				.commandBuffer = context.perFrameResources[perFrameResourceIndex].commandBuffer,
 				.deviceMask = 1 } };
-			const auto waitSemaphoreInfos = std::array{ VkSemaphoreSubmitInfo{
-				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-				.pNext = nullptr,
-				.semaphore = context.perFrameResources[perFrameResourceIndex].readyToRender,
-				.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-				.deviceIndex = 1 } };
+			// Meshes drawn this frame may still be copied on the transfer queue.
+			const auto waitSemaphoreInfos = std::array{
+				VkSemaphoreSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+									   .pNext = nullptr,
+									   .semaphore = context.perFrameResources[perFrameResourceIndex].readyToRender,
+									   .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+									   .deviceIndex = 1 },
+				VkSemaphoreSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+									   .pNext = nullptr,
+									   .semaphore = scene.uploadsFinished,
+									   .value = scene.uploadsValue,
+									   .stageMask = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+									   .deviceIndex = 1 }
+			};
 			const auto signalSemaphoreInfos = std::array{ VkSemaphoreSubmitInfo{
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
 				.pNext = nullptr,
@@ -0,0 +1,368 @@
+#include "BlendTree.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	struct BlendTreeCompiler
+	{
+		U32 CompileNode(U32 nodeIndex, U32 destination)
+		{
+			assert(nodeIndex < description.nodes.size());
+			const auto& node = description.nodes[nodeIndex];
+			tree.registersCount = std::max(tree.registersCount, destination + 1);
+
+			auto order = std::vector<U32>(node.children.size());
+			std::iota(order.begin(), order.end(), 0);
+			if (node.type == BlendNodeType::blendSpace1D)
+			{
+				std::stable_sort(order.begin(), order.end(),
+								 [&](U32 a, U32 b) { return node.positions[a].x < node.positions[b].x; });
+			}
+
+			// Child k writes to register destination + k and its own subtree only uses the registers above, so
+			// the results of the previous children stay untouched until this node reads them.
+			auto childInstructions = std::vector<U32>{};
+			for (auto k = 0u; k < order.size(); k++)
+			{
+				childInstructions.push_back(CompileNode(node.children[order[k]], destination + k));
+			}
+
+			auto instruction = BlendInstruction{ .operation = BlendOperation::sampleClip,
+												 .destination = destination,
+												 .firstChild = static_cast<U32>(tree.children.size()),
+												 .childrenCount = static_cast<U32>(childInstructions.size()),
+												 .argument = 0,
+												 .parameter = node.parameter,
+												 .parameterY = node.parameterY };
+			tree.children.insert(tree.children.end(), childInstructions.begin(), childInstructions.end());
+
+			switch (node.type)
+			{
+			case BlendNodeType::clip:
+				assert(node.children.empty());
+				assert(node.clip.data.count == tree.jointsCount);
+				instruction.operation = BlendOperation::sampleClip;
+				instruction.argument = static_cast<U32>(tree.clips.size());
+				tree.clips.push_back(node.clip);
+				break;
+			case BlendNodeType::blendSpace1D:
+			case BlendNodeType::blendSpace2D:
+				assert(not node.children.empty());
+				assert(node.positions.size() == node.children.size());
+				assert(node.parameter < tree.parametersCount);
+				assert(node.type == BlendNodeType::blendSpace1D or node.parameterY < tree.parametersCount);
+				instruction.operation = node.type == BlendNodeType::blendSpace1D ? BlendOperation::blend1D :
+																				   BlendOperation::blend2D;
+				instruction.argument = static_cast<U32>(tree.positions.size());
+				for (const auto k : order)
+				{
+					tree.positions.push_back(node.positions[k]);
+				}
+				break;
+			case BlendNodeType::additive:
+				assert(node.children.size() == 3);
+				assert(node.parameter < tree.parametersCount);
+				instruction.operation = BlendOperation::additive;
+				break;
+			case BlendNodeType::maskedOverride:
+				assert(node.children.size() == 2);
+				assert(node.parameter < tree.parametersCount);
+				assert(node.mask < description.masks.size());
+				assert(description.masks[node.mask].size() == tree.jointsCount);
+				instruction.operation = BlendOperation::maskedOverride;
+				instruction.argument = static_cast<U32>(tree.maskWeights.size());
+				tree.maskWeights.insert(tree.maskWeights.end(), description.masks[node.mask].begin(),
+										description.masks[node.mask].end());
+				break;
+			}
+
+			tree.instructions.push_back(instruction);
+			return static_cast<U32>(tree.instructions.size() - 1);
+		}
+
+		const BlendTreeDescription& description;
+		CompiledBlendTree& tree;
+	};
+
+	void ComputeBlendSpace1DWeights(std::span<const Math::Vector2> positions, Float parameter,
+									std::span<Float> weights)
+	{
+		std::fill(weights.begin(), weights.end(), 0.0f);
+		const auto last = positions.size() - 1;
+		if (parameter <= positions.front().x)
+		{
+			weights.front() = 1.0f;
+			return;
+		}
+		if (parameter >= positions[last].x)
+		{
+			weights[last] = 1.0f;
+			return;
+		}
+		auto i = 0u;
+		while (positions[i + 1].x <= parameter)
+		{
+			i++;
+		}
+		const auto t = (parameter - positions[i].x) / (positions[i + 1].x - positions[i].x);
+		weights[i] = 1.0f - t;
+		weights[i + 1] = t;
+	}
+
+	void ComputeBlendSpace2DWeights(std::span<const Math::Vector2> positions, const Math::Vector2& parameter,
+									std::span<Float> weights)
+	{
+		auto totalWeight = 0.0f;
+		for (auto i = 0u; i < positions.size(); i++)
+		{
+			const auto toParameter = parameter - positions[i];
+			auto weight = 1.0f;
+			for (auto j = 0u; j < positions.size(); j++)
+			{
+				const auto toSample = positions[j] - positions[i];
+				const auto lengthSquared = glm::dot(toSample, toSample);
+				if (j == i or lengthSquared == 0.0f)
+				{
+					continue;
+				}
+				const auto gradient = 1.0f - glm::dot(toParameter, toSample) / lengthSquared;
+				weight = std::min(weight, std::clamp(gradient, 0.0f, 1.0f));
+			}
+			weights[i] = weight;
+			totalWeight += weight;
+		}
+
+		if (totalWeight == 0.0f)
+		{
+			weights[0] = 1.0f;
+			return;
+		}
+		for (auto& weight : weights)
+		{
+			weight /= totalWeight;
+		}
+	}
+
+	// Walks the instructions from the root down and marks the ones that contribute to the result, the local
+	// blend weights of every instruction are written to inputWeights.
+	void ComputeNodeWeights(const CompiledBlendTree& tree, std::span<const Float> parameters,
+							BlendTreeScratch& scratch)
+	{
+		const auto nodeWeights = std::span{ scratch.nodeWeights }.first(tree.instructions.size());
+		std::fill(nodeWeights.begin(), nodeWeights.end(), 0.0f);
+		nodeWeights.back() = 1.0f;
+
+		for (auto i = static_cast<I32>(tree.instructions.size()) - 1; i >= 0; i--)
+		{
+			const auto& instruction = tree.instructions[i];
+			if (nodeWeights[i] == 0.0f or instruction.childrenCount == 0)
+			{
+				continue;
+			}
+
+			const auto inputWeights =
+				std::span{ scratch.inputWeights }.subspan(instruction.firstChild, instruction.childrenCount);
+			switch (instruction.operation)
+			{
+			case BlendOperation::blend1D:
+				ComputeBlendSpace1DWeights(
+					std::span{ tree.positions }.subspan(instruction.argument, instruction.childrenCount),
+					parameters[instruction.parameter], inputWeights);
+				break;
+			case BlendOperation::blend2D:
+				ComputeBlendSpace2DWeights(
+					std::span{ tree.positions }.subspan(instruction.argument, instruction.childrenCount),
+					Math::Vector2{ parameters[instruction.parameter], parameters[instruction.parameterY] },
+					inputWeights);
+				break;
+			case BlendOperation::additive:
+				inputWeights[0] = 1.0f;
+				inputWeights[1] = parameters[instruction.parameter];
+				inputWeights[2] = parameters[instruction.parameter];
+				break;
+			case BlendOperation::maskedOverride:
+				inputWeights[0] = 1.0f;
+				inputWeights[1] = std::clamp(parameters[instruction.parameter], 0.0f, 1.0f);
+				break;
+			case BlendOperation::sampleClip:
+				break;
+			}
+
+			for (auto k = 0u; k < instruction.childrenCount; k++)
+			{
+				nodeWeights[tree.children[instruction.firstChild + k]] = nodeWeights[i] * inputWeights[k];
+			}
+		}
+	}
+
+	// Normalized weighted sum of the inputs. The destination is the register of the first child, so it is only
+	// overwritten by the first input that actually contributes.
+	void BlendInputs(const CompiledBlendTree& tree, const BlendInstruction& instruction,
+					 const BlendTreeScratch& scratch)
+	{
+		const auto destination = scratch.registers[instruction.destination];
+		auto isFirstInput = true;
+		for (auto k = 0u; k < instruction.childrenCount; k++)
+		{
+			const auto weight = scratch.inputWeights[instruction.firstChild + k];
+			if (weight == 0.0f)
+			{
+				continue;
+			}
+
+			const auto input =
+				scratch.registers[tree.instructions[tree.children[instruction.firstChild + k]].destination];
+			if (isFirstInput)
+			{
+				for (auto j = 0u; j < destination.size(); j++)
+				{
+					destination[j].rotation = input[j].rotation * weight;
+					destination[j].translation = input[j].translation * weight;
+					destination[j].scale = input[j].scale * weight;
+				}
+				isFirstInput = false;
+				continue;
+			}
+
+			for (auto j = 0u; j < destination.size(); j++)
+			{
+				// Keep all rotations in the hemisphere of the accumulated one.
+				const auto rotationWeight =
+					glm::dot(destination[j].rotation, input[j].rotation) < 0.0f ? -weight : weight;
+				destination[j].rotation = destination[j].rotation + input[j].rotation * rotationWeight;
+				destination[j].translation += input[j].translation * weight;
+				destination[j].scale += input[j].scale * weight;
+			}
+		}
+
+		for (auto& joint : destination)
+		{
+			joint.rotation = glm::normalize(joint.rotation);
+		}
+	}
+
+	void AddLayer(const CompiledBlendTree& tree, const BlendInstruction& instruction, const BlendTreeScratch& scratch)
+	{
+		const auto weight = scratch.inputWeights[instruction.firstChild + 1];
+		if (weight == 0.0f)
+		{
+			return;
+		}
+
+		const auto destination = scratch.registers[instruction.destination];
+		const auto layer = scratch.registers[tree.instructions[tree.children[instruction.firstChild + 1]].destination];
+		const auto reference =
+			scratch.registers[tree.instructions[tree.children[instruction.firstChild + 2]].destination];
+		const auto identity = Math::Quaternion{ 1.0f, 0.0f, 0.0f, 0.0f };
+
+		for (auto j = 0u; j < destination.size(); j++)
+		{
+			const auto difference = glm::conjugate(reference[j].rotation) * layer[j].rotation;
+			destination[j].rotation = destination[j].rotation * Math::Slerp(identity, difference, weight);
+			destination[j].translation += (layer[j].translation - reference[j].translation) * weight;
+			destination[j].scale += (layer[j].scale - reference[j].scale) * weight;
+		}
+	}
+
+	void OverrideMaskedJoints(const CompiledBlendTree& tree, const BlendInstruction& instruction,
+							  const BlendTreeScratch& scratch)
+	{
+		const auto weight = scratch.inputWeights[instruction.firstChild + 1];
+		if (weight == 0.0f)
+		{
+			return;
+		}
+
+		const auto destination = scratch.registers[instruction.destination];
+		const auto layer = scratch.registers[tree.instructions[tree.children[instruction.firstChild + 1]].destination];
+		const auto mask = std::span{ tree.maskWeights }.subspan(instruction.argument, destination.size());
+
+		for (auto j = 0u; j < destination.size(); j++)
+		{
+			const auto jointWeight = weight * mask[j];
+			if (jointWeight > 0.0f)
+			{
+				destination[j].rotation = Math::Slerp(destination[j].rotation, layer[j].rotation, jointWeight);
+				destination[j].translation = Math::Mix(destination[j].translation, layer[j].translation, jointWeight);
+				destination[j].scale = Math::Mix(destination[j].scale, layer[j].scale, jointWeight);
+			}
+		}
+	}
+} // namespace
+
+CompiledBlendTree Animation::Compile(const BlendTreeDescription& description, U32 jointsCount)
+{
+	ZoneScoped;
+	auto tree = CompiledBlendTree{ .jointsCount = jointsCount, .parametersCount = description.parametersCount };
+	auto compiler = BlendTreeCompiler{ description, tree };
+	compiler.CompileNode(description.root, 0);
+	return tree;
+}
+
+std::vector<Float> Animation::CreateSubtreeMask(const Skeleton& skeleton, U32 jointIndex)
+{
+	assert(HasPackedHierarchy(skeleton));
+	assert(jointIndex < skeleton.parentIndices.size());
+
+	auto mask = std::vector<Float>(skeleton.parentIndices.size(), 0.0f);
+	mask[jointIndex] = 1.0f;
+	// Descendants always come after their ancestors.
+	for (auto i = jointIndex + 1; i < mask.size(); i++)
+	{
+		mask[i] = mask[skeleton.parentIndices[i]];
+	}
+	return mask;
+}
+
+void Animation::Evaluate(const CompiledBlendTree& tree, AnimationDataSetView animationDataSet,
+						 std::span<const Float> parameters, Float globalTime, BlendTreeScratch& scratch,
+						 std::span<JointAnimationData> pose)
+{
+	ZoneScoped;
+	assert(not tree.instructions.empty());
+	assert(pose.size() <= tree.jointsCount);
+	assert(parameters.size() >= tree.parametersCount);
+
+	scratch.Reserve(tree);
+	scratch.registers[0] = pose;
+	for (auto i = 1u; i < tree.registersCount; i++)
+	{
+		scratch.registers[i] = scratch.poses.Allocate(pose.size());
+	}
+
+	ComputeNodeWeights(tree, parameters, scratch);
+
+	for (auto i = 0u; i < tree.instructions.size(); i++)
+	{
+		if (scratch.nodeWeights[i] == 0.0f)
+		{
+			continue;
+		}
+
+		const auto& instruction = tree.instructions[i];
+		switch (instruction.operation)
+		{
+		case BlendOperation::sampleClip:
+			SamplePose(animationDataSet, tree.clips[instruction.argument], globalTime,
+					   scratch.registers[instruction.destination]);
+			break;
+		case BlendOperation::blend1D:
+		case BlendOperation::blend2D:
+			BlendInputs(tree, instruction, scratch);
+			break;
+		case BlendOperation::additive:
+			AddLayer(tree, instruction, scratch);
+			break;
+		case BlendOperation::maskedOverride:
+			OverrideMaskedJoints(tree, instruction, scratch);
+			break;
+		}
+	}
+
+	scratch.poses.Reset();
+}
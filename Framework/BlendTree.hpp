@@ -0,0 +1,132 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Animation.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		enum class BlendNodeType : U8
+		{
+			// Samples clip.
+			clip,
+			// Blends the children placed on a line, parameter is the position on it.
+			blendSpace1D,
+			// Blends the children placed on a plane with gradient band interpolation, (parameter, parameterY) is
+			// the position on it.
+			blendSpace2D,
+			// children = { base, layer, reference }: adds the difference between layer and reference, scaled by
+			// parameter, on top of base.
+			additive,
+			// children = { base, layer }: replaces base by layer on the joints of mask, scaled by parameter.
+			maskedOverride
+		};
+
+		struct BlendTreeNode
+		{
+			BlendNodeType type{ BlendNodeType::clip };
+			std::vector<U32> children;
+			// Blend spaces only, position of each child in parameter space. 1D blend spaces use x.
+			std::vector<Math::Vector2> positions;
+			AnimationInstance clip{};
+			U32 parameter{ 0 };
+			U32 parameterY{ 0 };
+			U32 mask{ 0 };
+		};
+
+		/*
+		 * Authoring form of a blend tree, nodes refer to each other by index. Parameters are plain floats the game
+		 * sets every frame, masks hold one weight per joint of the skeleton the tree is compiled for.
+		 */
+		struct BlendTreeDescription
+		{
+			std::vector<BlendTreeNode> nodes;
+			U32 root{ 0 };
+			U32 parametersCount{ 0 };
+			std::vector<std::vector<Float>> masks;
+		};
+
+		enum class BlendOperation : U8
+		{
+			sampleClip,
+			blend1D,
+			blend2D,
+			additive,
+			maskedOverride
+		};
+
+		// One instruction per node in post order. The inputs of an instruction are the destination registers of
+		// its children, which are always evaluated before it.
+		struct BlendInstruction
+		{
+			BlendOperation operation;
+			U32 destination;
+			U32 firstChild;
+			U32 childrenCount;
+			// Clip index for sampleClip, first position for blend spaces, mask offset for maskedOverride.
+			U32 argument;
+			U32 parameter;
+			U32 parameterY;
+		};
+
+		/*
+		 * Blend tree flattened into a linear instruction stream. Poses live in registers that are assigned like
+		 * a stack, so a tree needs as many pose buffers as its deepest path has pending inputs, and register 0
+		 * always holds the result.
+		 */
+		struct CompiledBlendTree
+		{
+			std::vector<BlendInstruction> instructions;
+			std::vector<U32> children;
+			std::vector<AnimationInstance> clips;
+			std::vector<Math::Vector2> positions;
+			std::vector<Float> maskWeights;
+			U32 jointsCount{ 0 };
+			U32 registersCount{ 0 };
+			U32 parametersCount{ 0 };
+		};
+
+		// Per-thread memory of Evaluate(), reserved once for the largest tree so evaluation does not allocate.
+		struct BlendTreeScratch
+		{
+			void Reserve(const CompiledBlendTree& tree)
+			{
+				const auto posesJointsCount = static_cast<std::size_t>(tree.registersCount - 1) * tree.jointsCount;
+				if (poses.storage.size() < posesJointsCount)
+				{
+					poses.Reserve(posesJointsCount);
+				}
+				if (nodeWeights.size() < tree.instructions.size())
+				{
+					nodeWeights.resize(tree.instructions.size());
+				}
+				if (inputWeights.size() < tree.children.size())
+				{
+					inputWeights.resize(tree.children.size());
+				}
+				if (registers.size() < tree.registersCount)
+				{
+					registers.resize(tree.registersCount);
+				}
+			}
+
+			PoseArena poses;
+			std::vector<Float> nodeWeights;
+			std::vector<Float> inputWeights;
+			std::vector<std::span<JointAnimationData>> registers;
+		};
+
+		CompiledBlendTree Compile(const BlendTreeDescription& description, U32 jointsCount);
+
+		// Joint weights of 1 for jointIndex and all of its descendants, 0 elsewhere.
+		std::vector<Float> CreateSubtreeMask(const Skeleton& skeleton, U32 jointIndex);
+
+		// Evaluates the first pose.size() joints of the tree, see GetJointsCountUpToDepth().
+		void Evaluate(const CompiledBlendTree& tree, AnimationDataSetView animationDataSet,
+					  std::span<const Float> parameters, Float globalTime, BlendTreeScratch& scratch,
+					  std::span<JointAnimationData> pose);
+	} // namespace Animation
+} // namespace Framework
@@ -13,5 +13,6 @@ namespace Framework
 		Float movementSpeed{ 1.0f };
 		Float movementSpeedScale{ 1.0f };
 		Float sensitivity{ 1.0f };
+		Float verticalFieldOfView{ glm::radians(60.0f) };
 	};
 } // namespace Framework
\ No newline at end of file
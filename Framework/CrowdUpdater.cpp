@@ -0,0 +1,152 @@
+#include "CrowdUpdater.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	struct CrowdScratch
+	{
+		PoseArena poses;
+		BlendTreeScratch blendTree;
+		std::vector<JointAnimationData> modelSpacePose;
+
+		void Reserve(std::size_t jointsCount)
+		{
+			if (poses.storage.size() < 3 * jointsCount)
+			{
+				poses.Reserve(3 * jointsCount);
+			}
+			if (modelSpacePose.size() < jointsCount)
+			{
+				modelSpacePose.resize(jointsCount);
+			}
+		}
+	};
+
+	thread_local auto crowdScratch = CrowdScratch{};
+
+	// Only the first evaluatedJointsCount joints are sampled, the deeper ones follow their parents.
+	void UpdateInstance(AnimationDataSetView animationDataSet, const Skeleton& skeleton,
+						const CrowdInstance& instance, Float globalTime, U32 evaluatedJointsCount,
+						std::span<Math::Matrix4x4> skinningMatrices)
+	{
+		const auto jointsCount = skeleton.joints.size();
+		assert(instance.blendTree != nullptr or instance.animation.data.count == jointsCount);
+		assert(evaluatedJointsCount <= jointsCount);
+
+		auto& scratch = crowdScratch;
+		scratch.Reserve(jointsCount);
+
+		auto pose = scratch.poses.Allocate(evaluatedJointsCount);
+		if (instance.blendTree != nullptr)
+		{
+			assert(instance.blendTree->jointsCount == jointsCount);
+			Evaluate(*instance.blendTree, animationDataSet, instance.blendTreeParameters, globalTime,
+					 scratch.blendTree, pose);
+		}
+		else
+		{
+			SamplePose(animationDataSet, instance.animation, globalTime, pose);
+
+			if (instance.blendFactor > 0.0f)
+			{
+				assert(instance.blendAnimation.data.count == jointsCount);
+				const auto blendPose = scratch.poses.Allocate(evaluatedJointsCount);
+				const auto finalPose = scratch.poses.Allocate(evaluatedJointsCount);
+				SamplePose(animationDataSet, instance.blendAnimation, globalTime, blendPose);
+				BlendPose(pose, blendPose, instance.blendFactor, finalPose);
+				pose = finalPose;
+			}
+		}
+
+		// The model space pose is read back while walking the hierarchy, so it is kept in cached scratch memory
+		// and only the final skinning matrices are written to the (possibly write-combined) destination.
+		const auto modelSpacePose = std::span{ scratch.modelSpacePose }.first(evaluatedJointsCount);
+		ComputeSkinningMatrices(pose, skeleton, modelSpacePose, skinningMatrices);
+
+		scratch.poses.Reset();
+	}
+} // namespace
+
+U32 CrowdUpdater::Prepare(std::span<const Skeleton> skeletons, std::span<const CrowdInstance> instances)
+{
+	auto layoutChanged = instanceOffsets.size() != instances.size();
+	instanceOffsets.resize(instances.size());
+
+	auto offset = U32{ 0 };
+	for (auto i = 0u; i < instances.size(); i++)
+	{
+		layoutChanged = layoutChanged or instanceOffsets[i] != offset;
+		instanceOffsets[i] = offset;
+		const auto jointsCount = static_cast<U32>(skeletons[instances[i].skeletonIndex].joints.size());
+		offset += (jointsCount + instanceAlignmentInMatrices - 1) / instanceAlignmentInMatrices *
+			instanceAlignmentInMatrices;
+	}
+
+	lodLevels.assign(instances.size(), 0);
+	if (layoutChanged or cachedSkinningMatrices.size() != offset)
+	{
+		cachedSkinningMatrices.resize(offset);
+		hasCachedSkinningMatrices.assign(instances.size(), 0);
+	}
+	return offset;
+}
+
+void CrowdUpdater::SelectLodLevels(const Camera& camera, std::span<const CrowdInstance> instances)
+{
+	ZoneScoped;
+	assert(lodLevels.size() == instances.size());
+
+	for (auto i = 0u; i < instances.size(); i++)
+	{
+		const auto screenSize = ComputeScreenSize(camera, instances[i].position, instances[i].boundingRadius);
+		lodLevels[i] = SelectLodLevel(lodSettings, screenSize);
+	}
+}
+
+void CrowdUpdater::Update(AnimationDataSetView animationDataSet, std::span<const Skeleton> skeletons,
+						  std::span<const CrowdInstance> instances, Float globalTime,
+						  std::span<Math::Matrix4x4> skinningMatrices)
+{
+	ZoneScoped;
+	assert(instanceOffsets.size() == instances.size());
+	assert(not lodSettings.levels.empty());
+
+	jobSystem->ParallelFor(
+		static_cast<U32>(instances.size()), instancesPerJob,
+		[&](U32 begin, U32 end)
+		{
+			ZoneScopedN("Crowd Update Job");
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& skeleton = skeletons[instances[i].skeletonIndex];
+				const auto& lod = lodSettings.levels[lodLevels[i]];
+				const auto jointsCount = skeleton.joints.size();
+				const auto evaluatedJointsCount = GetJointsCountUpToDepth(skeleton, lod.maxJointDepth);
+				const auto destination = skinningMatrices.subspan(instanceOffsets[i], jointsCount);
+
+				if (lod.updateInterval <= 1)
+				{
+					UpdateInstance(animationDataSet, skeleton, instances[i], globalTime, evaluatedJointsCount,
+								   destination);
+					hasCachedSkinningMatrices[i] = 0;
+					continue;
+				}
+
+				// The destination may be write-combined memory, so the reused matrices are kept in a separate cache.
+				const auto cache = std::span{ cachedSkinningMatrices }.subspan(instanceOffsets[i], jointsCount);
+				if (not hasCachedSkinningMatrices[i] or (frameIndex + i) % lod.updateInterval == 0)
+				{
+					UpdateInstance(animationDataSet, skeleton, instances[i], globalTime, evaluatedJointsCount, cache);
+					hasCachedSkinningMatrices[i] = 1;
+				}
+				std::copy(cache.begin(), cache.end(), destination.begin());
+			}
+		});
+	frameIndex++;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Animation.hpp"
+#include "AnimationLod.hpp"
+#include "BlendTree.hpp"
+#include "JobSystem.hpp"
+
+namespace Framework
+{
+	namespace Animation
+	{
+		struct CrowdInstance
+		{
+			U32 skeletonIndex{ 0 };
+			AnimationInstance animation;
+			AnimationInstance blendAnimation; // only sampled when blendFactor > 0
+			Float blendFactor{ 0.0f };
+			// Replaces animation and blendAnimation when set. Both must outlive Update().
+			const CompiledBlendTree* blendTree{ nullptr };
+			std::span<const Float> blendTreeParameters{};
+			// Bounding sphere of the character in world space, drives the level of detail.
+			Math::Vector3 position{};
+			Float boundingRadius{ 1.0f };
+		};
+
+		/*
+		 * Runs sample -> blend (or a blend tree) -> ComputeSkinningMatrices for many characters on the job system and
+		 * writes the skinning matrices into caller provided memory, usually the mapped uniform buffer of FrameData.
+		 * Intermediate poses live in per-thread scratch memory, so a frame does not allocate once the scratch
+		 * buffers have grown to the largest skeleton.
+		 *
+		 * SelectLodLevels() picks a level of lodSettings per instance from its screen size. Instances on a level
+		 * with an update interval above one are evaluated on every n-th frame only, staggered by instance index,
+		 * and their last skinning matrices are copied in between. Without SelectLodLevels() every instance uses
+		 * level 0.
+		 */
+		struct CrowdUpdater
+		{
+			// Every instance starts on a 256 byte boundary so it can be bound as a uniform buffer range.
+			static constexpr U32 instanceAlignmentInMatrices = 256 / sizeof(Math::Matrix4x4);
+
+			explicit CrowdUpdater(JobSystem& jobSystem = GetJobSystem()) : jobSystem{ &jobSystem }
+			{
+			}
+
+			// Computes where every instance is written to, returns the total number of matrices Update() writes.
+			// Resets all instances to level of detail 0.
+			U32 Prepare(std::span<const Skeleton> skeletons, std::span<const CrowdInstance> instances);
+
+			void SelectLodLevels(const Camera& camera, std::span<const CrowdInstance> instances);
+
+			void Update(AnimationDataSetView animationDataSet, std::span<const Skeleton> skeletons,
+						std::span<const CrowdInstance> instances, Float globalTime,
+						std::span<Math::Matrix4x4> skinningMatrices);
+
+			U32 GetInstanceOffset(U32 instanceIndex) const
+			{
+				return instanceOffsets[instanceIndex];
+			}
+
+			U32 GetInstanceLodLevel(U32 instanceIndex) const
+			{
+				return lodLevels[instanceIndex];
+			}
+
+			JobSystem* jobSystem;
+			U32 instancesPerJob{ 16 };
+			AnimationLodSettings lodSettings{};
+
+			std::vector<U32> instanceOffsets;
+			std::vector<U32> lodLevels;
+			// Skinning matrices of the instances that skip frames, laid out like the Update() destination.
+			std::vector<Math::Matrix4x4> cachedSkinningMatrices;
+			std::vector<U8> hasCachedSkinningMatrices;
+			U32 frameIndex{ 0 };
+		};
+	} // namespace Animation
+} // namespace Framework
@@ -84,15 +84,27 @@ void FrameData::ReleaseResources(const VulkanContext& context)
 void FrameData::UploadJointMatrices(const std::vector<Math::Matrix4x4>& jointMatrices)
 {
 	ZoneScoped;
-	const auto size = jointMatrices.size() * sizeof(Math::Matrix4x4);
+	const auto destination = AllocateJointMatrices(static_cast<U32>(jointMatrices.size()));
+	std::memcpy(destination.data(), jointMatrices.data(), destination.size_bytes());
+}
+
+std::span<Math::Matrix4x4> FrameData::AllocateJointMatrices(U32 matricesCount)
+{
+	const auto size = matricesCount * sizeof(Math::Matrix4x4);
+	assert(size <= uniformMemorySize);
+
+	const auto alignedOffset = (currentPtr - (std::byte*)uniformBuffer.mappedPtr + uniformOffsetAlignment - 1) /
+		uniformOffsetAlignment * uniformOffsetAlignment;
+	currentPtr = (std::byte*)uniformBuffer.mappedPtr + alignedOffset;
 
 	if ((currentPtr + size) >= ((std::byte*)uniformBuffer.mappedPtr + uniformMemorySize))
 	{
 		currentPtr = (std::byte*)uniformBuffer.mappedPtr;
 	}
 
-	std::memcpy(currentPtr, jointMatrices.data(), size);
+	const auto matrices = std::span<Math::Matrix4x4>{ reinterpret_cast<Math::Matrix4x4*>(currentPtr), matricesCount };
 	jointMatricesOffset = currentPtr - (std::byte*)uniformBuffer.mappedPtr;
 	jointMatricesSize = size;
 	currentPtr += size;
+	return matrices;
 }
\ No newline at end of file
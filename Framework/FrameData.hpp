@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "Math.hpp"
 #include "VulkanRHI.hpp"
 
@@ -13,9 +15,13 @@ namespace Framework
 			void CreateResources(const VulkanContext& context, int frameInFlights = 2);
 			void ReleaseResources(const VulkanContext& context);
 			void UploadJointMatrices(const std::vector<Math::Matrix4x4>& jointMatrices);
+			// Reserves mapped uniform memory for matricesCount joint matrices, to be written directly by the caller.
+			std::span<Math::Matrix4x4> AllocateJointMatrices(U32 matricesCount);
 
 			std::byte* currentPtr{ nullptr };
 			static constexpr VkDeviceSize uniformMemorySize{ 16 * 1024 * 1024 };
+			// Upper bound of minUniformBufferOffsetAlignment guaranteed by the Vulkan specification.
+			static constexpr VkDeviceSize uniformOffsetAlignment{ 256 };
 
 			GraphicsBuffer uniformBuffer{};
 			U32 jointMatricesOffset{};
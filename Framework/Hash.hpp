@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "Core.hpp"
+
+namespace Framework
+{
+	namespace Hash
+	{
+		inline constexpr U64 fnvOffsetBasis = 0xcbf29ce484222325ull;
+		inline constexpr U64 fnvPrime = 0x100000001b3ull;
+
+		/*
+		 * FNV-1a over 8 byte words, with the remaining bytes mixed in one at a time. Meant for change detection of
+		 * asset sources and cooked data, not for hash tables or anything security related.
+		 */
+		inline U64 HashBytes(std::span<const std::byte> bytes, U64 seed = fnvOffsetBasis)
+		{
+			auto hash = seed;
+			auto i = std::size_t{ 0 };
+			for (; i + sizeof(U64) <= bytes.size(); i += sizeof(U64))
+			{
+				auto word = U64{};
+				std::memcpy(&word, bytes.data() + i, sizeof(U64));
+				hash = (hash ^ word) * fnvPrime;
+			}
+			for (; i < bytes.size(); i++)
+			{
+				hash = (hash ^ static_cast<U64>(bytes[i])) * fnvPrime;
+			}
+			return hash;
+		}
+
+		inline U64 HashString(std::string_view string, U64 seed = fnvOffsetBasis)
+		{
+			return HashBytes(std::as_bytes(std::span{ string.data(), string.size() }), seed);
+		}
+
+		inline U64 Combine(U64 hash, U64 value)
+		{
+			return (hash ^ value) * fnvPrime;
+		}
+
+		// MurmurHash3 finalizer, every input bit flips each output bit with a probability close to one half.
+		inline constexpr U64 Mix(U64 value)
+		{
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdull;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ull;
+			value ^= value >> 33;
+			return value;
+		}
+
+		inline constexpr U64 CombineContent(U64 hash, U64 value)
+		{
+			return Mix(hash ^ Mix(value));
+		}
+
+		/*
+		 * Content identity, e.g. deduplication keys. Unlike HashBytes() each word is mixed before it is folded in,
+		 * so flips of the same bit in two words do not cancel out. Equal hashes still only name a candidate, the
+		 * bytes are compared before one content is taken for another.
+		 */
+		inline U64 HashContent(std::span<const std::byte> bytes, U64 seed = fnvOffsetBasis)
+		{
+			auto hash = seed;
+			auto i = std::size_t{ 0 };
+			for (; i + sizeof(U64) <= bytes.size(); i += sizeof(U64))
+			{
+				auto word = U64{};
+				std::memcpy(&word, bytes.data() + i, sizeof(U64));
+				hash = CombineContent(hash, word);
+			}
+			auto tail = U64{};
+			if (i < bytes.size())
+			{
+				std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+			}
+			return CombineContent(CombineContent(hash, tail), bytes.size());
+		}
+	} // namespace Hash
+} // namespace Framework
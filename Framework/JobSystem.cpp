@@ -0,0 +1,164 @@
+#include "JobSystem.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+
+using namespace Framework;
+
+bool JobSystem::JobQueue::Pop(Job& job)
+{
+	auto lock = std::lock_guard{ mutex };
+	if (size == 0)
+	{
+		return false;
+	}
+	size--;
+	job = ring[(head + size) % ring.size()];
+	return true;
+}
+
+bool JobSystem::JobQueue::Steal(Job& job)
+{
+	auto lock = std::lock_guard{ mutex };
+	if (size == 0)
+	{
+		return false;
+	}
+	job = ring[head];
+	head = (head + 1) % ring.size();
+	size--;
+	return true;
+}
+
+void JobSystem::JobQueue::Push(const Job& job)
+{
+	auto lock = std::lock_guard{ mutex };
+	if (size == ring.size())
+	{
+		auto grown = std::vector<Job>(std::max<std::size_t>(64, ring.size() * 2));
+		for (auto i = 0u; i < size; i++)
+		{
+			grown[i] = ring[(head + i) % ring.size()];
+		}
+		ring = std::move(grown);
+		head = 0;
+	}
+	ring[(head + size) % ring.size()] = job;
+	size++;
+}
+
+JobSystem::JobSystem(U32 workerCount)
+{
+	// One extra queue is shared by all threads that are not workers, e.g. the main thread.
+	for (auto i = 0u; i < workerCount + 1; i++)
+	{
+		queues.push_back(std::make_unique<JobQueue>());
+	}
+	workers.reserve(workerCount);
+	for (auto i = 0u; i < workerCount; i++)
+	{
+		workers.emplace_back([this, i] { WorkerLoop(i); });
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		auto lock = std::lock_guard{ sleepMutex };
+		shouldStop = true;
+	}
+	wakeUp.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::ParallelFor(U32 count, U32 grainSize, void* context, InvokeFunction invoke)
+{
+	ZoneScoped;
+	if (count == 0)
+	{
+		return;
+	}
+	grainSize = std::max(grainSize, 1u);
+	const auto jobsCount = (count + grainSize - 1) / grainSize;
+
+	if (jobsCount == 1 or workers.empty())
+	{
+		invoke(context, 0, count);
+		return;
+	}
+
+	auto task = Task{ context, invoke, jobsCount };
+
+	// The first range is kept for the calling thread, the rest is dealt round robin to the queues. The counter is
+	// raised first, so it never drops below the number of jobs that are actually queued.
+	queuedJobs.fetch_add(jobsCount - 1, std::memory_order_release);
+	for (auto i = 1u; i < jobsCount; i++)
+	{
+		const auto begin = i * grainSize;
+		const auto queueIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+		queues[queueIndex]->Push(Job{ &task, begin, std::min(begin + grainSize, count) });
+	}
+	{
+		// Pairs with the predicate check in WorkerLoop so a worker that is about to sleep cannot miss the wake up.
+		auto lock = std::lock_guard{ sleepMutex };
+	}
+	wakeUp.notify_all();
+
+	invoke(context, 0, std::min(grainSize, count));
+	task.remainingJobs.fetch_sub(1, std::memory_order_acq_rel);
+
+	while (task.remainingJobs.load(std::memory_order_acquire) != 0)
+	{
+		if (not TryRunJob(static_cast<U32>(workers.size())))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::TryRunJob(U32 preferredQueue)
+{
+	auto job = Job{};
+	auto found = queues[preferredQueue]->Pop(job);
+	for (auto i = 1u; i < queues.size() and not found; i++)
+	{
+		found = queues[(preferredQueue + i) % queues.size()]->Steal(job);
+	}
+	if (not found)
+	{
+		return false;
+	}
+
+	queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	job.task->invoke(job.task->context, job.begin, job.end);
+	job.task->remainingJobs.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+void JobSystem::WorkerLoop(U32 workerIndex)
+{
+	while (true)
+	{
+		if (TryRunJob(workerIndex))
+		{
+			continue;
+		}
+
+		auto lock = std::unique_lock{ sleepMutex };
+		wakeUp.wait(lock, [this] { return shouldStop or queuedJobs.load(std::memory_order_acquire) != 0; });
+		if (shouldStop)
+		{
+			return;
+		}
+	}
+}
+
+JobSystem& Framework::GetJobSystem()
+{
+	static auto jobSystem = JobSystem{};
+	return jobSystem;
+}
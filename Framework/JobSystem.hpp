@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Core.hpp"
+
+namespace Framework
+{
+	/*
+	 * Fixed pool of worker threads with one job queue per worker. A worker pops the newest job of its own queue
+	 * and steals the oldest job of another queue once its own runs dry. The thread calling ParallelFor also steals
+	 * jobs until its range is finished, so nested ParallelFor calls from inside a job never deadlock.
+	 */
+	struct JobSystem final
+	{
+		explicit JobSystem(U32 workerCount = DefaultWorkerCount());
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) = delete;
+
+		// Calls body(begin, end) for consecutive sub-ranges of [0, count) with at most grainSize elements each
+		// and returns once all of them are finished. The body is not copied and must not allocate per call.
+		template <typename Body>
+		void ParallelFor(U32 count, U32 grainSize, Body&& body)
+		{
+			using BodyType = std::remove_reference_t<Body>;
+			const auto invoke = [](void* context, U32 begin, U32 end)
+			{ (*static_cast<BodyType*>(context))(begin, end); };
+			ParallelFor(count, grainSize, const_cast<void*>(static_cast<const void*>(&body)), invoke);
+		}
+
+		U32 GetWorkerCount() const
+		{
+			return static_cast<U32>(workers.size());
+		}
+
+		static U32 DefaultWorkerCount()
+		{
+			const auto hardwareThreads = std::thread::hardware_concurrency();
+			return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+	private:
+		using InvokeFunction = void (*)(void*, U32, U32);
+
+		struct Task
+		{
+			void* context;
+			InvokeFunction invoke;
+			std::atomic<U32> remainingJobs;
+		};
+
+		struct Job
+		{
+			Task* task;
+			U32 begin;
+			U32 end;
+		};
+
+		struct alignas(64) JobQueue
+		{
+			bool Pop(Job& job);
+			bool Steal(Job& job);
+			void Push(const Job& job);
+
+			std::mutex mutex;
+			std::vector<Job> ring;
+			U32 head{ 0 };
+			U32 size{ 0 };
+		};
+
+		void ParallelFor(U32 count, U32 grainSize, void* context, InvokeFunction invoke);
+		bool TryRunJob(U32 preferredQueue);
+		void WorkerLoop(U32 workerIndex);
+
+		std::vector<std::unique_ptr<JobQueue>> queues;
+		std::vector<std::thread> workers;
+
+		std::mutex sleepMutex;
+		std::condition_variable wakeUp;
+		std::atomic<U32> queuedJobs{ 0 };
+		std::atomic<U32> nextQueue{ 0 };
+		bool shouldStop{ false };
+	};
+
+	// Shared pool for animation, importer and asset pipeline work, created on first use.
+	JobSystem& GetJobSystem();
+} // namespace Framework
@@ -0,0 +1,156 @@
+#include "MappedFile.hpp"
+
+#include "Hash.hpp"
+#include "Profiler.hpp"
+
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Framework;
+
+MappedFile::MappedFile(const std::filesystem::path& filePath)
+{
+	ZoneScoped;
+#ifdef _WIN32
+	const auto file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	auto fileSize = LARGE_INTEGER{};
+	if (not GetFileSizeEx(file, &fileSize) or fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+	const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return;
+	}
+	const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const auto file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return;
+	}
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0 or fileStatus.st_size == 0)
+	{
+		close(file);
+		return;
+	}
+	const auto view = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps its own reference to the file.
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return;
+	}
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+#ifdef _WIN32
+		fileHandle = std::exchange(other.fileHandle, nullptr);
+		mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+	}
+	return *this;
+}
+
+void MappedFile::Close()
+{
+	if (data == nullptr)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#else
+	munmap(const_cast<std::byte*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+U64 Framework::HashFile(const std::filesystem::path& filePath)
+{
+	ZoneScoped;
+	const auto file = MappedFile{ filePath };
+	return file.IsOpen() ? Hash::HashBytes(file.GetData()) : 0;
+}
+
+bool Framework::WriteFileAtomically(const std::filesystem::path& filePath,
+									std::span<const std::span<const std::byte>> pieces)
+{
+	ZoneScoped;
+	auto temporaryPath = filePath;
+	temporaryPath += ".tmp";
+	{
+		auto file = std::ofstream{ temporaryPath, std::ios::binary | std::ios::trunc };
+		for (const auto piece : pieces)
+		{
+			file.write(reinterpret_cast<const char*>(piece.data()), static_cast<std::streamsize>(piece.size()));
+		}
+		if (not file)
+		{
+			return false;
+		}
+	}
+
+	auto error = std::error_code{};
+	std::filesystem::rename(temporaryPath, filePath, error);
+	return not error;
+}
+
+bool Framework::WriteFileAtomically(const std::filesystem::path& filePath, std::span<const std::byte> bytes)
+{
+	return WriteFileAtomically(filePath, std::span{ &bytes, 1 });
+}
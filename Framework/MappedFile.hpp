@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+#include "Core.hpp"
+
+namespace Framework
+{
+	/*
+	 * Read-only memory mapping of a whole file. The mapping starts on a page boundary, so data laid out with
+	 * aligned offsets can be used in place. Empty or missing files result in a closed mapping.
+	 */
+	struct MappedFile final
+	{
+		MappedFile() = default;
+		explicit MappedFile(const std::filesystem::path& filePath);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool IsOpen() const
+		{
+			return data != nullptr;
+		}
+
+		std::span<const std::byte> GetData() const
+		{
+			return { data, size };
+		}
+
+	private:
+		void Close();
+
+		const std::byte* data{ nullptr };
+		std::size_t size{ 0 };
+#ifdef _WIN32
+		void* fileHandle{ nullptr };
+		void* mappingHandle{ nullptr };
+#endif
+	};
+
+	// Hash::HashBytes of the file content, 0 when the file cannot be read.
+	U64 HashFile(const std::filesystem::path& filePath);
+
+	// Whether size elements from offset fit in totalSize, without overflowing on corrupt offsets read from a file.
+	inline bool IsRangeInside(U64 offset, U64 size, U64 totalSize)
+	{
+		return offset <= totalSize and size <= totalSize - offset;
+	}
+
+	/*
+	 * Writes the pieces one after the other to a temporary file next to filePath and renames it over filePath, so an
+	 * interrupted write never leaves a valid looking file and the previous one stays until the new one is complete.
+	 */
+	bool WriteFileAtomically(const std::filesystem::path& filePath, std::span<const std::span<const std::byte>> pieces);
+	bool WriteFileAtomically(const std::filesystem::path& filePath, std::span<const std::byte> bytes);
+} // namespace Framework
@@ -59,6 +59,11 @@ namespace Framework
 			{
 				return glm::translate(Matrix4x4::Identity(), translation);
 			}
+
+			static Matrix4x4 ScaleFrom(const Vector3& scale)
+			{
+				return glm::scale(Matrix4x4::Identity(), scale);
+			}
 		};
 
 		inline Float Modulo(Float x, Float y)
@@ -1,15 +1,75 @@
 #pragma once
 
+#include <cstdlib>
 #include <memory>
+#include <new>
 
+#include "Core.hpp"
 #include "Profiler.hpp"
 
 inline const char* const cpuMemoryPoolName = "CPU Memory Pool";
 
-#ifdef RTRG_ENABLE_PROFILER
+namespace Framework
+{
+	namespace Memory
+	{
+		// Only updated when RTRG_ENABLE_ALLOCATION_TRACKING is defined in the translation unit that provides the
+		// operator new hook below, e.g. in the test executable.
+		struct AllocationStatistics
+		{
+			U64 allocationCount{ 0 };
+			U64 allocatedBytes{ 0 };
+		};
+
+		inline thread_local AllocationStatistics threadAllocationStatistics{};
+
+		template <typename T, std::size_t Alignment>
+		struct AlignedAllocator
+		{
+			static_assert(Alignment >= alignof(T));
+
+			using value_type = T;
+
+			template <typename U>
+			struct rebind
+			{
+				using other = AlignedAllocator<U, Alignment>;
+			};
+
+			AlignedAllocator() = default;
+
+			template <typename U>
+			AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+			{
+			}
+
+			T* allocate(std::size_t count)
+			{
+				return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+			}
+
+			void deallocate(T* ptr, std::size_t)
+			{
+				::operator delete(ptr, std::align_val_t{ Alignment });
+			}
+
+			template <typename U>
+			bool operator==(const AlignedAllocator<U, Alignment>&) const
+			{
+				return true;
+			}
+		};
+	} // namespace Memory
+} // namespace Framework
+
+#if defined(RTRG_ENABLE_PROFILER) || defined(RTRG_ENABLE_ALLOCATION_TRACKING)
 inline void* operator new(std::size_t count)
 {
 	auto ptr = std::malloc(count);
+#ifdef RTRG_ENABLE_ALLOCATION_TRACKING
+	Framework::Memory::threadAllocationStatistics.allocationCount++;
+	Framework::Memory::threadAllocationStatistics.allocatedBytes += count;
+#endif
 	TracyAllocNS(ptr, count, RTRG_PROFILER_CALLSTACK_DEPTH, cpuMemoryPoolName);
 	return ptr;
 }
@@ -19,9 +79,3 @@ inline void operator delete(void* ptr) noexcept
 	std::free(ptr);
 }
 #endif
-
-namespace Framework
-{
-
-
-} // namespace Framework
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "MeshCache.hpp"
+
+#include "Hash.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace Framework;
+
+namespace
+{
+	static_assert(std::is_trivially_copyable_v<CookedMesh>);
+
+	// Everything the cooked meshes depend on, a container cooked from other files or settings is cooked again.
+	U64 GetCookedSourceHash(const std::filesystem::path& sourcePath, const MeshImportSettings& meshImportSettings)
+	{
+		auto hash = Hash::Combine(HashFile(sourcePath), cookedMeshesVersion);
+		for (const auto& dependency : GetSourceDependencies(sourcePath))
+		{
+			hash = Hash::Combine(hash, HashFile(dependency));
+		}
+		return Hash::Combine(hash, HashMeshImportSettings(meshImportSettings));
+	}
+
+	uuids::uuid GetSceneUuid(U64 sourceHash)
+	{
+		return MakeAssetUuid(sourceHash, 0);
+	}
+
+	bool HasSameLayout(const CookedMesh& a, const CookedMesh& b)
+	{
+		return a.indicesCount == b.indicesCount and a.verticesCount == b.verticesCount and a.stride == b.stride and
+			a.indexFormat == b.indexFormat and a.positionMinimum == b.positionMinimum and
+			a.positionExtent == b.positionExtent;
+	}
+} // namespace
+
+MeshImportSettings Framework::GetRuntimeMeshImportSettings()
+{
+	return MeshImportSettings{ .applyOptimization = true,
+							   .verticesStreamDeclarations = { VerticesStreamDeclaration{
+								   .hasPosition = true,
+								   .hasNormal = true,
+								   .hasTextureCoordinate0 = true,
+								   .hasJointsIndexAndWeights = true,
+								   .positionEncoding = PositionEncoding::unorm16,
+								   .normalEncoding = DirectionEncoding::octahedral16,
+								   .textureCoordinateEncoding = TextureCoordinateEncoding::float16,
+								   .jointWeightsEncoding = JointWeightsEncoding::unorm8 } },
+							   .compactIndices = true };
+}
+
+std::filesystem::path Framework::GetCookedMeshesPath(const std::filesystem::path& sourcePath)
+{
+	auto cookedPath = sourcePath;
+	cookedPath += ".meshes";
+	return cookedPath;
+}
+
+std::string Framework::GetSourceExtension(const std::filesystem::path& sourcePath)
+{
+	auto extension = sourcePath.extension().string();
+	std::ranges::transform(extension, extension.begin(),
+						   [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+	return extension;
+}
+
+std::vector<std::filesystem::path> Framework::GetSourceDependencies(const std::filesystem::path& sourcePath)
+{
+	auto dependencies = std::vector<std::filesystem::path>{};
+	const auto folder = sourcePath.parent_path();
+	const auto extension = GetSourceExtension(sourcePath);
+	if (extension == ".gltf")
+	{
+		auto file = std::ifstream{ sourcePath };
+		const auto json = nlohmann::json::parse(file, nullptr, false);
+		if (json.is_discarded())
+		{
+			return dependencies;
+		}
+		for (const auto* arrayName : { "buffers", "images" })
+		{
+			if (not json.contains(arrayName))
+			{
+				continue;
+			}
+			for (const auto& element : json[arrayName])
+			{
+				// Embedded data is part of the source itself.
+				if (element.contains("uri") and element["uri"].is_string())
+				{
+					const auto uri = element["uri"].get<std::string>();
+					if (not uri.starts_with("data:"))
+					{
+						dependencies.push_back(folder / uri);
+					}
+				}
+			}
+		}
+	}
+	else if (extension == ".obj")
+	{
+		auto file = std::ifstream{ sourcePath };
+		auto line = std::string{};
+		while (std::getline(file, line))
+		{
+			constexpr auto materialLibrary = std::string_view{ "mtllib " };
+			if (line.starts_with(materialLibrary))
+			{
+				auto name = line.substr(materialLibrary.size());
+				while (not name.empty() and std::isspace(static_cast<unsigned char>(name.back())))
+				{
+					name.pop_back();
+				}
+				dependencies.push_back(folder / name);
+			}
+		}
+	}
+	return dependencies;
+}
+
+bool Framework::CookMeshes(const std::filesystem::path& sourcePath, const MeshImportSettings& meshImportSettings,
+						   const std::filesystem::path& cookedPath, bool compress)
+{
+	auto importer = AssetImporter{ sourcePath };
+	return CookMeshes(importer, sourcePath, meshImportSettings, cookedPath, compress);
+}
+
+bool Framework::CookMeshes(AssetImporter& importer, const std::filesystem::path& sourcePath,
+						   const MeshImportSettings& meshImportSettings, const std::filesystem::path& cookedPath,
+						   bool compress)
+{
+	ZoneScoped;
+	if (not importer.HasLoadedScene())
+	{
+		return false;
+	}
+	importer.PostProcessScene(meshImportSettings);
+
+	// Meshes already in the container, by content hash. The hash only names candidates, the built streams are
+	// compared so a collision cannot drop a distinct mesh.
+	struct CookedStreams
+	{
+		uuids::uuid uuid;
+		CookedMesh cookedMesh;
+		MeshData meshData;
+	};
+	auto cookedStreams = std::unordered_multimap<U64, CookedStreams>{};
+	// Settings the content hash leaves out, e.g. welding or the index format, still change the cooked streams.
+	const auto settingsHash = HashMeshImportSettings(meshImportSettings);
+
+	auto builder = AssetContainerBuilder{};
+	auto meshUuids = std::vector<std::byte>{};
+	for (auto meshIndex = 0u; meshIndex < importer.GetSceneInformation().meshCount; meshIndex++)
+	{
+		const auto contentHash = importer.HashMesh(meshIndex, meshImportSettings);
+		auto meshData = importer.ImportMesh(meshIndex, meshImportSettings);
+		assert(not meshData.streams.empty());
+		const auto& stream = meshData.streams.front();
+		const auto stride = stream.streamDescriptor.attributes.front().stride;
+		const auto cookedMesh =
+			CookedMesh{ .contentHash = contentHash,
+						.indicesCount = static_cast<U32>(meshData.indexStream.size() /
+														 GetIndexSize(meshData.indexFormat)),
+						.verticesCount = static_cast<U32>(stream.data.size() / stride),
+						.stride = stride,
+						.indexFormat = meshData.indexFormat,
+						.positionMinimum = stream.streamDescriptor.positionMinimum,
+						.positionExtent = stream.streamDescriptor.positionExtent };
+
+		const auto [first, last] = cookedStreams.equal_range(contentHash);
+		const auto IsSameMesh = [&](const auto& cooked)
+		{
+			const auto& other = cooked.second;
+			return HasSameLayout(other.cookedMesh, cookedMesh) and
+				std::ranges::equal(other.meshData.indexStream, meshData.indexStream) and
+				std::ranges::equal(other.meshData.streams.front().data, stream.data);
+		};
+		const auto repeated = std::find_if(first, last, IsSameMesh);
+		// Distinct meshes with the same hash are told apart by their order of appearance.
+		const auto collisionsCount = static_cast<U64>(std::distance(first, last));
+		const auto uuid = repeated != last ? repeated->second.uuid
+										   : MakeAssetUuid(Hash::CombineContent(contentHash, settingsHash),
+														   Hash::CombineContent(cookedMeshesVersion, collisionsCount));
+		const auto uuidBytes = ToUuidBytes(uuid);
+		meshUuids.insert(meshUuids.end(), uuidBytes.begin(), uuidBytes.end());
+		if (repeated != last)
+		{
+			continue;
+		}
+
+		builder.BeginAsset(uuid, AssetType::subMesh);
+		builder.AddPayload(std::as_bytes(std::span{ &cookedMesh, 1 }));
+		builder.AddPayload(meshData.indexStream, compress ? BinaryEncoding::indexCodec : BinaryEncoding::raw,
+						   GetIndexSize(meshData.indexFormat));
+		builder.AddPayload(stream.data, compress ? BinaryEncoding::vertexCodec : BinaryEncoding::raw, stride);
+		cookedStreams.emplace(contentHash,
+							  CookedStreams{ .uuid = uuid, .cookedMesh = cookedMesh, .meshData = std::move(meshData) });
+	}
+
+	const auto sourceHash = GetCookedSourceHash(sourcePath, meshImportSettings);
+	builder.BeginAsset(GetSceneUuid(sourceHash), AssetType::scene);
+	builder.AddPayload(meshUuids);
+	return builder.Write(cookedPath, sourceHash);
+}
+
+std::optional<AssetContainer> Framework::LoadOrCookMeshes(const std::filesystem::path& sourcePath,
+														  const MeshImportSettings& meshImportSettings)
+{
+	ZoneScoped;
+	const auto sourceHash = GetCookedSourceHash(sourcePath, meshImportSettings);
+	const auto cookedPath = GetCookedMeshesPath(sourcePath);
+	if (auto container = AssetContainer::Open(cookedPath);
+		container and container->GetSourceHash() == sourceHash and container->Find(GetSceneUuid(sourceHash)))
+	{
+		return container;
+	}
+	if (not CookMeshes(sourcePath, meshImportSettings, cookedPath))
+	{
+		return std::nullopt;
+	}
+	return AssetContainer::Open(cookedPath);
+}
+
+std::vector<uuids::uuid> Framework::GetCookedSceneMeshes(const AssetContainer& container)
+{
+	const auto scene = container.Find(GetSceneUuid(container.GetSourceHash()));
+	if (scene == nullptr or scene->type != AssetType::scene or scene->payloadsCount != 1)
+	{
+		return {};
+	}
+	const auto data = container.GetPayloadData(container.GetPayloads(*scene).front());
+	auto meshUuids = std::vector<uuids::uuid>{};
+	auto bytes = UuidBytes{};
+	meshUuids.reserve(data.size() / bytes.size());
+	for (auto offset = std::size_t{ 0 }; offset + bytes.size() <= data.size(); offset += bytes.size())
+	{
+		std::memcpy(bytes.data(), data.data() + offset, bytes.size());
+		meshUuids.push_back(FromUuidBytes(bytes));
+	}
+	return meshUuids;
+}
+
+std::optional<CookedMesh> Framework::ReadCookedMesh(std::span<const std::byte> description)
+{
+	if (description.size() != sizeof(CookedMesh))
+	{
+		return std::nullopt;
+	}
+	auto cookedMesh = CookedMesh{};
+	std::memcpy(&cookedMesh, description.data(), sizeof(cookedMesh));
+	return cookedMesh;
+}
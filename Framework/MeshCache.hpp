@@ -0,0 +1,69 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AssetContainer.hpp"
+#include "MeshImporter.hpp"
+
+namespace Framework
+{
+	/*
+	 * First payload of every subMesh asset of a cooked mesh container, followed by the index stream and the first
+	 * vertex stream, both raw so they are copied to the GPU straight from the mapped file.
+	 */
+	struct CookedMesh
+	{
+		// AssetImporter::HashMesh() of the source mesh.
+		U64 contentHash{ 0 };
+		U32 indicesCount{ 0 };
+		U32 verticesCount{ 0 };
+		U32 stride{ 0 };
+		IndexFormat indexFormat{ IndexFormat::uint32 };
+		U8 padding[3]{};
+		Math::Vector3 positionMinimum{ 0.0f };
+		Math::Vector3 positionExtent{ 1.0f };
+	};
+
+	// Bump whenever CookedMesh, the payloads or the uuids change, older containers are then cooked again.
+	inline constexpr U64 cookedMeshesVersion = 4;
+
+	// Layout the renderer reads, 24 byte vertices decoded by BasicGeometry.vert.
+	MeshImportSettings GetRuntimeMeshImportSettings();
+
+	std::filesystem::path GetCookedMeshesPath(const std::filesystem::path& sourcePath);
+
+	// Lower case, e.g. ".gltf" for "Scene.GLTF".
+	std::string GetSourceExtension(const std::filesystem::path& sourcePath);
+
+	// Files a source reads besides itself, e.g. the buffers and images of a glTF file or the materials of an OBJ file.
+	std::vector<std::filesystem::path> GetSourceDependencies(const std::filesystem::path& sourcePath);
+
+	/*
+	 * Imports every mesh of sourcePath and writes them as one container. Identical meshes are stored once, the
+	 * scene asset keeps the uuid of each mesh in source order. Only the first vertex stream is stored. Compressed
+	 * index and vertex payloads go through the mesh codecs, raw ones are copied to the GPU without decoding.
+	 */
+	bool CookMeshes(const std::filesystem::path& sourcePath, const MeshImportSettings& meshImportSettings,
+					const std::filesystem::path& cookedPath, bool compress = false);
+	// Same, from the importer of sourcePath, so the other assets of the source can be cooked from the same import.
+	bool CookMeshes(AssetImporter& importer, const std::filesystem::path& sourcePath,
+					const MeshImportSettings& meshImportSettings, const std::filesystem::path& cookedPath,
+					bool compress = false);
+
+	/*
+	 * Opens the cooked container of sourcePath, cooks it first when it is missing or was cooked from another
+	 * content of the source or of its dependencies, or with other settings. Empty when the source cannot be
+	 * imported or the container cannot be written.
+	 */
+	std::optional<AssetContainer> LoadOrCookMeshes(const std::filesystem::path& sourcePath,
+												   const MeshImportSettings& meshImportSettings);
+
+	// Uuid of the subMesh asset of every mesh of the source, in source order.
+	std::vector<uuids::uuid> GetCookedSceneMeshes(const AssetContainer& container);
+
+	// First payload of a subMesh asset, empty when it does not hold a CookedMesh.
+	std::optional<CookedMesh> ReadCookedMesh(std::span<const std::byte> description);
+} // namespace Framework
@@ -0,0 +1,606 @@
+#include "MeshCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+using namespace Framework;
+using namespace Framework::Geometry;
+
+namespace
+{
+	constexpr auto invalidIndex = std::numeric_limits<U32>::max();
+
+	// Header: magic, elements count, element size, blocks count, then the offset of every block in the buffer.
+	constexpr auto indexCodecMagic = U32{ 0x3158'4449 };
+	constexpr auto vertexCodecMagic = U32{ 0x3158'5456 };
+	constexpr auto headerSize = 4 * sizeof(U32);
+
+	// Large enough that block headers are negligible, small enough to spread a single mesh over all workers.
+	constexpr auto indexBlockTriangles = 8192u;
+	constexpr auto vertexBlockVertices = 8192u;
+
+	/*
+	 * A triangle starts with a byte holding the age of its shared edge in the high nibble and the code of its
+	 * third vertex in the low one. Triangles without shared edge use the high nibble as marker and a second byte
+	 * for the codes of their other two vertices.
+	 */
+	constexpr auto fifoSize = 16u;
+	constexpr auto noSharedEdge = 15u;
+	constexpr auto nextVertexCode = 0u;
+	// Codes 1 to 14 are the age of the vertex in the vertex FIFO plus one.
+	constexpr auto vertexFifoCodes = 14u;
+	constexpr auto explicitVertexCode = 15u;
+
+	// Vertices are coded in groups of 16, each group stores the 2 bit width of every byte lane and then the deltas
+	// of each lane. Deltas are taken to the same byte of the previous vertex and zigzag coded.
+	constexpr auto vertexGroupSize = 16u;
+	constexpr auto maxVertexSize = 256u;
+	constexpr auto groupBits = std::array{ 0u, 2u, 4u, 8u };
+
+	void WriteU32(std::vector<std::byte>& buffer, U32 value)
+	{
+		const auto offset = buffer.size();
+		buffer.resize(offset + sizeof(U32));
+		std::memcpy(buffer.data() + offset, &value, sizeof(U32));
+	}
+
+	U32 ReadU32(std::span<const std::byte> buffer, std::size_t offset)
+	{
+		assert(offset + sizeof(U32) <= buffer.size());
+		auto value = U32{};
+		std::memcpy(&value, buffer.data() + offset, sizeof(U32));
+		return value;
+	}
+
+	void WriteVarint(std::vector<std::byte>& buffer, U32 value)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<std::byte>(value));
+	}
+
+	// Fails on truncated varints and on varints longer than a U32.
+	bool ReadVarint(const std::byte*& data, const std::byte* end, U32& value)
+	{
+		value = 0u;
+		for (auto shift = 0u; shift < 32 and data != end; shift += 7)
+		{
+			const auto byte = std::to_integer<U32>(*data++);
+			value |= (byte & 0x7F) << shift;
+			if (byte < 0x80)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	U32 ZigZag(I32 value)
+	{
+		return (static_cast<U32>(value) << 1) ^ static_cast<U32>(value >> 31);
+	}
+
+	I32 UnZigZag(U32 value)
+	{
+		return static_cast<I32>(value >> 1) ^ -static_cast<I32>(value & 1);
+	}
+
+	struct CodecHeader
+	{
+		U32 elementsCount{ 0 };
+		U32 elementSize{ 0 };
+		U32 blocksCount{ 0 };
+	};
+
+	std::vector<std::byte> BeginEncoding(U32 magic, const CodecHeader& header)
+	{
+		auto encoded = std::vector<std::byte>{};
+		WriteU32(encoded, magic);
+		WriteU32(encoded, header.elementsCount);
+		WriteU32(encoded, header.elementSize);
+		WriteU32(encoded, header.blocksCount);
+		encoded.resize(headerSize + header.blocksCount * sizeof(U32));
+		return encoded;
+	}
+
+	void BeginBlock(std::vector<std::byte>& encoded, U32 block)
+	{
+		const auto offset = static_cast<U32>(encoded.size());
+		std::memcpy(encoded.data() + headerSize + block * sizeof(U32), &offset, sizeof(U32));
+	}
+
+	// Checks everything the decoders index with, encoded buffers come from disk and may be truncated or corrupt.
+	std::optional<CodecHeader> ReadHeader(std::span<const std::byte> encoded, U32 magic, U32 blockElements)
+	{
+		if (encoded.size() < headerSize or ReadU32(encoded, 0) != magic)
+		{
+			return std::nullopt;
+		}
+		const auto header = CodecHeader{ .elementsCount = ReadU32(encoded, sizeof(U32)),
+										 .elementSize = ReadU32(encoded, 2 * sizeof(U32)),
+										 .blocksCount = ReadU32(encoded, 3 * sizeof(U32)) };
+		const auto blocksCount = (static_cast<U64>(header.elementsCount) + blockElements - 1) / blockElements;
+		const auto blocksEnd = headerSize + static_cast<U64>(header.blocksCount) * sizeof(U32);
+		if (header.blocksCount != blocksCount or blocksEnd > encoded.size())
+		{
+			return std::nullopt;
+		}
+
+		// Blocks are written in order, so each one ends where the next one starts.
+		auto previousOffset = blocksEnd;
+		for (auto block = 0u; block < header.blocksCount; block++)
+		{
+			const auto offset = ReadU32(encoded, headerSize + block * sizeof(U32));
+			if (offset < previousOffset or offset > encoded.size())
+			{
+				return std::nullopt;
+			}
+			previousOffset = offset;
+		}
+		return header;
+	}
+
+	std::span<const std::byte> GetBlock(std::span<const std::byte> encoded, const CodecHeader& header, U32 block)
+	{
+		const auto begin = ReadU32(encoded, headerSize + block * sizeof(U32));
+		const auto end = block + 1 < header.blocksCount ? ReadU32(encoded, headerSize + (block + 1) * sizeof(U32))
+														: encoded.size();
+		return encoded.subspan(begin, end - begin);
+	}
+
+	U32 ReadIndex(const std::byte* indexStream, U32 indexSize, U32 index)
+	{
+		if (indexSize == sizeof(U16))
+		{
+			auto value = U16{};
+			std::memcpy(&value, indexStream + index * sizeof(U16), sizeof(U16));
+			return value;
+		}
+		auto value = U32{};
+		std::memcpy(&value, indexStream + index * sizeof(U32), sizeof(U32));
+		return value;
+	}
+
+	void WriteIndex(std::byte* indexStream, U32 indexSize, U32 index, U32 value)
+	{
+		if (indexSize == sizeof(U16))
+		{
+			const auto narrowed = static_cast<U16>(value);
+			std::memcpy(indexStream + index * sizeof(U16), &narrowed, sizeof(U16));
+			return;
+		}
+		std::memcpy(indexStream + index * sizeof(U32), &value, sizeof(U32));
+	}
+
+	// Encoder and decoder update it identically, so the decoder sees the same FIFOs the encoder referenced.
+	struct IndexCodecState
+	{
+		explicit IndexCodecState(U32 nextVertex) : next{ nextVertex }, last{ nextVertex }
+		{
+			edges.fill({ invalidIndex, invalidIndex });
+			vertices.fill(invalidIndex);
+		}
+
+		// Age 0 is the most recently pushed entry.
+		const std::array<U32, 2>& GetEdge(U32 age) const
+		{
+			return edges[(edgesHead - 1 - age) % fifoSize];
+		}
+
+		U32 GetVertex(U32 age) const
+		{
+			return vertices[(verticesHead - 1 - age) % fifoSize];
+		}
+
+		void PushEdge(U32 a, U32 b)
+		{
+			edges[edgesHead++ % fifoSize] = { a, b };
+		}
+
+		void PushVertex(U32 vertex)
+		{
+			vertices[verticesHead++ % fifoSize] = vertex;
+		}
+
+		// Edges are stored the way the triangle on their other side walks them.
+		void PushTriangleEdges(U32 a, U32 b, U32 c, bool sharedEdge)
+		{
+			if (not sharedEdge)
+			{
+				PushEdge(b, a);
+			}
+			PushEdge(c, b);
+			PushEdge(a, c);
+		}
+
+		std::array<std::array<U32, 2>, fifoSize> edges;
+		std::array<U32, fifoSize> vertices;
+		U32 edgesHead{ 0 };
+		U32 verticesHead{ 0 };
+		// Vertices are mostly referenced for the first time in increasing order after OptimizeVertexFetch().
+		U32 next{ 0 };
+		// Explicit vertices are coded relative to the previous explicit one.
+		U32 last{ 0 };
+	};
+
+	U32 EncodeVertex(U32 vertex, IndexCodecState& state, std::vector<std::byte>& data)
+	{
+		if (vertex == state.next)
+		{
+			state.next++;
+			state.PushVertex(vertex);
+			return nextVertexCode;
+		}
+		for (auto age = 0u; age < vertexFifoCodes; age++)
+		{
+			if (state.GetVertex(age) == vertex)
+			{
+				return age + 1;
+			}
+		}
+		WriteVarint(data, ZigZag(static_cast<I32>(vertex - state.last)));
+		state.last = vertex;
+		state.next = std::max(state.next, vertex + 1);
+		state.PushVertex(vertex);
+		return explicitVertexCode;
+	}
+
+	bool DecodeVertex(U32 code, IndexCodecState& state, const std::byte*& data, const std::byte* end, U32& vertex)
+	{
+		if (code == nextVertexCode)
+		{
+			vertex = state.next++;
+			state.PushVertex(vertex);
+			return true;
+		}
+		if (code != explicitVertexCode)
+		{
+			vertex = state.GetVertex(code - 1);
+			return true;
+		}
+		auto delta = 0u;
+		if (not ReadVarint(data, end, delta))
+		{
+			return false;
+		}
+		vertex = state.last + static_cast<U32>(UnZigZag(delta));
+		state.last = vertex;
+		state.next = std::max(state.next, vertex + 1);
+		state.PushVertex(vertex);
+		return true;
+	}
+
+	// Rotates the triangle so its first edge is the shared one, returns noSharedEdge when there is none.
+	U32 FindSharedEdge(const IndexCodecState& state, std::array<U32, 3>& triangle)
+	{
+		for (auto age = 0u; age < noSharedEdge; age++)
+		{
+			const auto& edge = state.GetEdge(age);
+			for (auto rotation = 0u; rotation < 3; rotation++)
+			{
+				if (edge[0] == triangle[rotation] and edge[1] == triangle[(rotation + 1) % 3])
+				{
+					std::ranges::rotate(triangle, triangle.begin() + rotation);
+					return age;
+				}
+			}
+		}
+		return noSharedEdge;
+	}
+
+	U8 ZigZag8(U8 delta)
+	{
+		const auto value = static_cast<I8>(delta);
+		return static_cast<U8>((value << 1) ^ (value >> 7));
+	}
+
+	U8 UnZigZag8(U8 value)
+	{
+		return static_cast<U8>((value >> 1) ^ -(value & 1));
+	}
+
+	// Fixed widths let the compiler unroll the extraction of a lane, returns the end of its data.
+	template <U32 bits>
+	const std::byte* UnpackLane(const std::byte* data, std::array<U8, vertexGroupSize>& deltas)
+	{
+		constexpr auto mask = (1u << bits) - 1;
+		for (auto i = 0u; i < vertexGroupSize; i++)
+		{
+			const auto value = bits == 0 ? 0u : (std::to_integer<U32>(data[i * bits / 8]) >> (i * bits % 8)) & mask;
+			deltas[i] = UnZigZag8(static_cast<U8>(value));
+		}
+		return data + vertexGroupSize * bits / 8;
+	}
+
+	// Returns false when the block is truncated, every read is checked against its end.
+	bool DecodeIndexBlock(std::span<const std::byte> block, std::byte* indexStream, U32 indexSize, U32 firstTriangle,
+						  U32 lastTriangle)
+	{
+		auto data = block.data();
+		const auto end = data + block.size();
+		auto next = 0u;
+		if (not ReadVarint(data, end, next))
+		{
+			return false;
+		}
+		auto state = IndexCodecState{ next };
+
+		for (auto triangleIndex = firstTriangle; triangleIndex < lastTriangle; triangleIndex++)
+		{
+			if (data == end)
+			{
+				return false;
+			}
+			const auto code = std::to_integer<U32>(*data++);
+			const auto edgeAge = code >> 4;
+			auto a = 0u;
+			auto b = 0u;
+			auto c = 0u;
+			if (edgeAge != noSharedEdge)
+			{
+				const auto edge = state.GetEdge(edgeAge);
+				a = edge[0];
+				b = edge[1];
+				if (not DecodeVertex(code & 0xF, state, data, end, c))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				if (data == end)
+				{
+					return false;
+				}
+				const auto codes = std::to_integer<U32>(*data++);
+				if (not DecodeVertex(code & 0xF, state, data, end, a) or
+					not DecodeVertex(codes >> 4, state, data, end, b) or
+					not DecodeVertex(codes & 0xF, state, data, end, c))
+				{
+					return false;
+				}
+			}
+			state.PushTriangleEdges(a, b, c, edgeAge != noSharedEdge);
+
+			WriteIndex(indexStream, indexSize, triangleIndex * 3, a);
+			WriteIndex(indexStream, indexSize, triangleIndex * 3 + 1, b);
+			WriteIndex(indexStream, indexSize, triangleIndex * 3 + 2, c);
+		}
+		return true;
+	}
+
+	// Returns false when the block is truncated, lanes are only unpacked once their data is known to be there.
+	bool DecodeVertexBlock(std::span<const std::byte> block, std::byte* vertices, U32 vertexSize, U32 blockVertices)
+	{
+		auto data = block.data();
+		const auto end = data + block.size();
+		const auto widthsSize = static_cast<std::ptrdiff_t>((vertexSize + 3) / 4);
+		auto previous = std::array<U8, maxVertexSize>{};
+
+		for (auto groupVertex = 0u; groupVertex < blockVertices; groupVertex += vertexGroupSize)
+		{
+			if (end - data < widthsSize)
+			{
+				return false;
+			}
+			const auto* widths = data;
+			data += widthsSize;
+			// Left uninitialized, only the lanes of the vertex are unpacked.
+			std::array<std::array<U8, vertexGroupSize>, maxVertexSize> deltas;
+			for (auto lane = 0u; lane < vertexSize; lane++)
+			{
+				const auto widthCode = (std::to_integer<U32>(widths[lane / 4]) >> (lane % 4 * 2)) & 3;
+				if (end - data < static_cast<std::ptrdiff_t>(vertexGroupSize * groupBits[widthCode] / 8))
+				{
+					return false;
+				}
+				switch (widthCode)
+				{
+				case 1:
+					data = UnpackLane<2>(data, deltas[lane]);
+					break;
+				case 2:
+					data = UnpackLane<4>(data, deltas[lane]);
+					break;
+				case 3:
+					data = UnpackLane<8>(data, deltas[lane]);
+					break;
+				default:
+					data = UnpackLane<0>(data, deltas[lane]);
+					break;
+				}
+			}
+
+			// Lanes are independent, so the prefix sums of a vertex run side by side.
+			const auto groupVertices = std::min(vertexGroupSize, blockVertices - groupVertex);
+			auto* destination = vertices + static_cast<std::size_t>(groupVertex) * vertexSize;
+			for (auto i = 0u; i < groupVertices; i++)
+			{
+				for (auto lane = 0u; lane < vertexSize; lane++)
+				{
+					previous[lane] = static_cast<U8>(previous[lane] + deltas[lane][i]);
+				}
+				std::memcpy(destination + static_cast<std::size_t>(i) * vertexSize, previous.data(), vertexSize);
+			}
+		}
+		return true;
+	}
+} // namespace
+
+std::vector<std::byte> Geometry::EncodeIndexBuffer(std::span<const std::byte> indexStream, U32 indexSize)
+{
+	ZoneScoped;
+	assert(indexSize == sizeof(U16) or indexSize == sizeof(U32));
+	assert(indexStream.size() % (3 * indexSize) == 0);
+	const auto indicesCount = static_cast<U32>(indexStream.size() / indexSize);
+	const auto trianglesCount = indicesCount / 3;
+	const auto blocksCount = (trianglesCount + indexBlockTriangles - 1) / indexBlockTriangles;
+
+	auto encoded = BeginEncoding(indexCodecMagic, CodecHeader{ .elementsCount = indicesCount,
+															   .elementSize = indexSize,
+															   .blocksCount = blocksCount });
+	auto next = 0u;
+	for (auto block = 0u; block < blocksCount; block++)
+	{
+		BeginBlock(encoded, block);
+		WriteVarint(encoded, next);
+		auto state = IndexCodecState{ next };
+
+		const auto firstTriangle = block * indexBlockTriangles;
+		const auto lastTriangle = std::min(firstTriangle + indexBlockTriangles, trianglesCount);
+		for (auto triangleIndex = firstTriangle; triangleIndex < lastTriangle; triangleIndex++)
+		{
+			auto triangle = std::array<U32, 3>{};
+			for (auto corner = 0u; corner < 3; corner++)
+			{
+				triangle[corner] = ReadIndex(indexStream.data(), indexSize, triangleIndex * 3 + corner);
+			}
+
+			const auto edgeAge = FindSharedEdge(state, triangle);
+			const auto [a, b, c] = triangle;
+			const auto codeOffset = encoded.size();
+			if (edgeAge != noSharedEdge)
+			{
+				encoded.emplace_back();
+				const auto code = EncodeVertex(c, state, encoded);
+				encoded[codeOffset] = static_cast<std::byte>((edgeAge << 4) | code);
+			}
+			else
+			{
+				encoded.resize(codeOffset + 2);
+				const auto codeA = EncodeVertex(a, state, encoded);
+				const auto codeB = EncodeVertex(b, state, encoded);
+				const auto codeC = EncodeVertex(c, state, encoded);
+				encoded[codeOffset] = static_cast<std::byte>((noSharedEdge << 4) | codeA);
+				encoded[codeOffset + 1] = static_cast<std::byte>((codeB << 4) | codeC);
+			}
+			state.PushTriangleEdges(a, b, c, edgeAge != noSharedEdge);
+		}
+		next = state.next;
+	}
+	return encoded;
+}
+
+bool Geometry::DecodeIndexBuffer(std::span<std::byte> indexStream, std::span<const std::byte> encoded)
+{
+	ZoneScoped;
+	const auto header = ReadHeader(encoded, indexCodecMagic, 3 * indexBlockTriangles);
+	if (not header or (header->elementSize != sizeof(U16) and header->elementSize != sizeof(U32)) or
+		header->elementsCount % 3 != 0 or
+		indexStream.size() != static_cast<std::size_t>(header->elementsCount) * header->elementSize)
+	{
+		return false;
+	}
+	const auto trianglesCount = header->elementsCount / 3;
+
+	auto isCorrupt = std::atomic<bool>{ false };
+	GetJobSystem().ParallelFor(
+		header->blocksCount, 1,
+		[&](U32 beginBlock, U32 endBlock)
+		{
+			for (auto block = beginBlock; block < endBlock and not isCorrupt.load(std::memory_order_relaxed); block++)
+			{
+				const auto firstTriangle = block * indexBlockTriangles;
+				const auto lastTriangle = std::min(firstTriangle + indexBlockTriangles, trianglesCount);
+				if (not DecodeIndexBlock(GetBlock(encoded, *header, block), indexStream.data(), header->elementSize,
+										 firstTriangle, lastTriangle))
+				{
+					isCorrupt.store(true, std::memory_order_relaxed);
+				}
+			}
+		});
+	return not isCorrupt.load();
+}
+
+std::vector<std::byte> Geometry::EncodeVertexBuffer(std::span<const std::byte> vertices, U32 vertexSize)
+{
+	ZoneScoped;
+	assert(vertexSize > 0 and vertexSize <= maxVertexSize);
+	assert(vertices.size() % vertexSize == 0);
+	const auto verticesCount = static_cast<U32>(vertices.size() / vertexSize);
+	const auto blocksCount = (verticesCount + vertexBlockVertices - 1) / vertexBlockVertices;
+
+	auto encoded = BeginEncoding(vertexCodecMagic, CodecHeader{ .elementsCount = verticesCount,
+																.elementSize = vertexSize,
+																.blocksCount = blocksCount });
+	for (auto block = 0u; block < blocksCount; block++)
+	{
+		BeginBlock(encoded, block);
+		const auto firstVertex = block * vertexBlockVertices;
+		const auto blockVertices = std::min(vertexBlockVertices, verticesCount - firstVertex);
+		auto previous = std::array<U8, maxVertexSize>{};
+
+		for (auto groupVertex = 0u; groupVertex < blockVertices; groupVertex += vertexGroupSize)
+		{
+			// 2 bit widths of all lanes first, then their packed deltas.
+			const auto widthsOffset = encoded.size();
+			encoded.resize(widthsOffset + (vertexSize + 3) / 4);
+			const auto groupVertices = std::min(vertexGroupSize, blockVertices - groupVertex);
+			for (auto lane = 0u; lane < vertexSize; lane++)
+			{
+				auto deltas = std::array<U8, vertexGroupSize>{};
+				for (auto i = 0u; i < groupVertices; i++)
+				{
+					const auto vertex = static_cast<std::size_t>(firstVertex + groupVertex + i);
+					const auto value = std::to_integer<U8>(vertices[vertex * vertexSize + lane]);
+					deltas[i] = ZigZag8(static_cast<U8>(value - previous[lane]));
+					previous[lane] = value;
+				}
+
+				const auto largest = *std::ranges::max_element(deltas);
+				const auto widthCode = largest == 0 ? 0u : largest < 4 ? 1u : largest < 16 ? 2u : 3u;
+				encoded[widthsOffset + lane / 4] |= static_cast<std::byte>(widthCode << (lane % 4 * 2));
+
+				const auto bits = groupBits[widthCode];
+				const auto dataOffset = encoded.size();
+				encoded.resize(dataOffset + vertexGroupSize * bits / 8);
+				for (auto i = 0u; bits > 0 and i < vertexGroupSize; i++)
+				{
+					encoded[dataOffset + i * bits / 8] |= static_cast<std::byte>(deltas[i] << (i * bits % 8));
+				}
+			}
+		}
+	}
+	return encoded;
+}
+
+bool Geometry::DecodeVertexBuffer(std::span<std::byte> vertices, std::span<const std::byte> encoded)
+{
+	ZoneScoped;
+	const auto header = ReadHeader(encoded, vertexCodecMagic, vertexBlockVertices);
+	if (not header or header->elementSize == 0 or header->elementSize > maxVertexSize or
+		vertices.size() != static_cast<std::size_t>(header->elementsCount) * header->elementSize)
+	{
+		return false;
+	}
+	const auto vertexSize = header->elementSize;
+
+	auto isCorrupt = std::atomic<bool>{ false };
+	GetJobSystem().ParallelFor(
+		header->blocksCount, 1,
+		[&](U32 beginBlock, U32 endBlock)
+		{
+			for (auto block = beginBlock; block < endBlock and not isCorrupt.load(std::memory_order_relaxed); block++)
+			{
+				const auto firstVertex = block * vertexBlockVertices;
+				const auto blockVertices = std::min(vertexBlockVertices, header->elementsCount - firstVertex);
+				auto* destination = vertices.data() + static_cast<std::size_t>(firstVertex) * vertexSize;
+				if (not DecodeVertexBlock(GetBlock(encoded, *header, block), destination, vertexSize, blockVertices))
+				{
+					isCorrupt.store(true, std::memory_order_relaxed);
+				}
+			}
+		});
+	return not isCorrupt.load();
+}
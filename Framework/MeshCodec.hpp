@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+
+namespace Framework
+{
+	namespace Geometry
+	{
+		/*
+		 * Compact encodings for index and vertex buffers, in the spirit of meshoptimizer's codecs. Both split their
+		 * input in blocks that decode independently, so decoding runs in parallel on the shared JobSystem and keeps
+		 * up with streaming from disk. They compress best after OptimizeVertexCache() and OptimizeVertexFetch().
+		 */
+
+		/*
+		 * Triangles sharing an edge with one of the last 15 triangles cost a single byte when their third vertex is
+		 * new or recently used, others are delta and varint coded. indexStream holds indexSize (2 or 4) bytes per
+		 * index. Decoded triangles may be rotated, which keeps their winding.
+		 */
+		std::vector<std::byte> EncodeIndexBuffer(std::span<const std::byte> indexStream, U32 indexSize);
+		// indexStream has to hold exactly the encoded indices, in the index size they were encoded with. Returns false
+		// when encoded is truncated, corrupt or does not match indexStream, which is then left partially written.
+		bool DecodeIndexBuffer(std::span<std::byte> indexStream, std::span<const std::byte> encoded);
+
+		/*
+		 * Transposes vertices to byte lanes and stores the difference of every byte to the same byte of the previous
+		 * vertex, packed on 0, 2, 4 or 8 bits per group of 16 vertices. Lossless for any vertex layout, quantized
+		 * attributes compress far better than floats.
+		 */
+		std::vector<std::byte> EncodeVertexBuffer(std::span<const std::byte> vertices, U32 vertexSize);
+		// vertices has to hold exactly the encoded vertices. Returns false like DecodeIndexBuffer().
+		bool DecodeVertexBuffer(std::span<std::byte> vertices, std::span<const std::byte> encoded);
+	} // namespace Geometry
+} // namespace Framework
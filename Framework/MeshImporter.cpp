@@ -1,11 +1,23 @@
 #include "MeshImporter.hpp"
+#include "Hash.hpp"
+#include "JobSystem.hpp"
+#include "MeshOptimizer.hpp"
+#include "Profiler.hpp"
+#include "VertexQuantization.hpp"
 
 #include <assimp/cimport.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
 #include <queue>
 #include <set>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 using namespace Framework;
 using namespace Framework::Animation;
@@ -33,564 +45,1349 @@ AssetImporter::~AssetImporter()
 	importer.FreeScene();
 }
 
-MeshData AssetImporter::ImportMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings)
+namespace
 {
-	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
-	assert(currentlyLoadedScene->mMeshes[meshIndex]->HasPositions());
-	bool shouldLoadNormalData = false;
-	bool shouldLoadTangentData = false;
-	bool shouldLoadTextureCoordinate0 = false;
-	bool shouldLoadTextureCoordinate1 = false;
-	bool shouldLoadJointsIndexAndWeight = false;
-
-	for (const auto& streamDeclaration : meshImportSettings.verticesStreamDeclarations)
+	bool ShouldLoadJointsIndexAndWeights(const MeshImportSettings& meshImportSettings)
 	{
-		shouldLoadNormalData |= streamDeclaration.hasNormal;
-		shouldLoadTangentData |= streamDeclaration.hasTangentBitangent;
-		shouldLoadTextureCoordinate0 |= streamDeclaration.hasTextureCoordinate0;
-		shouldLoadTextureCoordinate1 |= streamDeclaration.hasTextureCoordinate1;
-		shouldLoadJointsIndexAndWeight |= streamDeclaration.hasJointsIndexAndWeights;
+		return std::ranges::any_of(meshImportSettings.verticesStreamDeclarations,
+								   [](const VerticesStreamDeclaration& declaration)
+								   { return declaration.hasJointsIndexAndWeights; });
 	}
 
-	unsigned int flags = aiProcess_Triangulate;
-	if (!currentlyLoadedScene->mMeshes[meshIndex]->HasNormals() and shouldLoadNormalData)
+	unsigned int ComputePostProcessingFlags(const aiMesh& mesh, const MeshImportSettings& meshImportSettings)
 	{
-		flags |= aiProcess_GenNormals;
+		bool shouldLoadNormalData = false;
+		bool shouldLoadTangentData = false;
+		bool shouldLoadTextureCoordinate0 = false;
+		bool shouldLoadTextureCoordinate1 = false;
+
+		for (const auto& streamDeclaration : meshImportSettings.verticesStreamDeclarations)
+		{
+			shouldLoadNormalData |= streamDeclaration.hasNormal;
+			shouldLoadTangentData |= streamDeclaration.hasTangentBitangent;
+			shouldLoadTextureCoordinate0 |= streamDeclaration.hasTextureCoordinate0;
+			shouldLoadTextureCoordinate1 |= streamDeclaration.hasTextureCoordinate1;
+		}
+
+		unsigned int flags = aiProcess_Triangulate;
+		if (!mesh.HasNormals() and shouldLoadNormalData)
+		{
+			// Flat normals split every vertex per face, which would leave the optimizer nothing to weld.
+			flags |= meshImportSettings.applyOptimization ? aiProcess_GenSmoothNormals : aiProcess_GenNormals;
+		}
+		if (!mesh.HasTangentsAndBitangents() and shouldLoadTangentData)
+		{
+			flags |= aiProcess_CalcTangentSpace;
+		}
+		if (!mesh.HasTextureCoords(0) and shouldLoadTextureCoordinate0)
+		{
+			flags |= aiProcess_GenUVCoords;
+		}
+		if (!mesh.HasTextureCoords(1) and shouldLoadTextureCoordinate1)
+		{
+			flags |= aiProcess_GenUVCoords;
+		}
+		// Formats like OBJ come with one vertex per face corner, which leaves nothing for the vertex cache to reuse.
+		if (meshImportSettings.applyOptimization)
+		{
+			flags |= aiProcess_JoinIdenticalVertices;
+		}
+		return flags;
 	}
-	if (!currentlyLoadedScene->mMeshes[meshIndex]->HasTangentsAndBitangents() and shouldLoadTangentData)
+
+	struct SkinInfluences
 	{
-		flags |= aiProcess_CalcTangentSpace;
-	}
-	if (!currentlyLoadedScene->mMeshes[meshIndex]->HasTextureCoords(0) and shouldLoadTextureCoordinate0)
+		std::vector<std::array<U8, 4>> jointIndices;
+		std::vector<Math::Vector4> jointWeights;
+	};
+
+	// Joint of each bone of the mesh, -1 for bones that are not part of the skeleton.
+	std::vector<I16> MapBonesToJoints(const aiMesh& mesh, const Skeleton& skeleton)
 	{
-		flags |= aiProcess_GenUVCoords;
+		assert(skeleton.joints.size() <= 256);
+		auto jointNameToIndexMap = std::unordered_map<std::string_view, I16>{};
+		jointNameToIndexMap.reserve(skeleton.joints.size());
+		for (auto i = 0u; i < skeleton.joints.size(); i++)
+		{
+			jointNameToIndexMap.emplace(skeleton.joints[i].name, static_cast<I16>(i));
+		}
+
+		auto boneJoints = std::vector<I16>(mesh.mNumBones, -1);
+		for (auto i = 0u; i < mesh.mNumBones; i++)
+		{
+			const auto it = jointNameToIndexMap.find(std::string_view{ mesh.mBones[i]->mName.C_Str() });
+			if (it != jointNameToIndexMap.end())
+			{
+				boneJoints[i] = it->second;
+			}
+		}
+		return boneJoints;
 	}
-	if (!currentlyLoadedScene->mMeshes[meshIndex]->HasTextureCoords(1) and shouldLoadTextureCoordinate1)
+
+	/*
+	 * Keeps the four strongest influences of each vertex in flat arrays with a sorted insertion, instead of
+	 * collecting every influence in a vector per vertex. Influences below 1% are dropped and the rest renormalized,
+	 * unused slots keep joint 0 with no weight. Fills the vertices from firstVertex on, as many as influences
+	 * holds, so large meshes can be gathered window by window.
+	 */
+	void GatherSkinInfluences(const aiMesh& mesh, std::span<const I16> boneJoints, U32 firstVertex,
+							  SkinInfluences& influences)
 	{
-		flags |= aiProcess_GenUVCoords;
-	}
+		ZoneScoped;
+		assert(influences.jointIndices.size() == influences.jointWeights.size());
+		const auto verticesCount = static_cast<U32>(influences.jointIndices.size());
+		std::ranges::fill(influences.jointIndices, std::array<U8, 4>{});
+		std::ranges::fill(influences.jointWeights, Math::Vector4{ 0.0f });
+		for (auto i = 0u; i < mesh.mNumBones; i++)
+		{
+			if (boneJoints[i] < 0)
+			{
+				continue;
+			}
+			const auto jointIndex = static_cast<U8>(boneJoints[i]);
 
-	currentlyLoadedScene = importer.ApplyPostProcessing(flags);
+			const auto& bone = *mesh.mBones[i];
+			for (auto j = 0u; j < bone.mNumWeights; j++)
+			{
+				const auto& vertexWeight = bone.mWeights[j];
+				// Unsigned, so vertices before the window wrap around and are skipped too.
+				const auto vertex = vertexWeight.mVertexId - firstVertex;
+				if (vertex >= verticesCount or vertexWeight.mWeight <= 0.01f)
+				{
+					continue;
+				}
+				auto& indices = influences.jointIndices[vertex];
+				auto& weights = influences.jointWeights[vertex];
+				if (vertexWeight.mWeight <= weights[3])
+				{
+					continue;
+				}
+				auto slot = 3;
+				while (slot > 0 and weights[slot - 1] < vertexWeight.mWeight)
+				{
+					indices[slot] = indices[slot - 1];
+					weights[slot] = weights[slot - 1];
+					slot--;
+				}
+				indices[slot] = jointIndex;
+				weights[slot] = vertexWeight.mWeight;
+			}
+		}
 
-	const auto& mesh = *currentlyLoadedScene->mMeshes[meshIndex];
+		for (auto& weights : influences.jointWeights)
+		{
+			const auto totalWeight = weights.x + weights.y + weights.z + weights.w;
+			if (totalWeight > 0.0f)
+			{
+				weights /= totalWeight;
+			}
+		}
+	}
 
-	if (shouldLoadJointsIndexAndWeight)
+	Math::Vector3 ToVector3(const aiVector3D& vector)
 	{
-		assert(mesh.HasBones()); // TODO:
+		return Math::Vector3{ vector.x, vector.y, vector.z };
 	}
 
-	auto meshData = MeshData{};
-	meshData.streams.reserve(meshImportSettings.verticesStreamDeclarations.size());
+	Math::Quaternion ToQuaternion(const aiQuaternion& quaternion)
+	{
+		return Math::Quaternion{ quaternion.w, quaternion.x, quaternion.y, quaternion.z };
+	}
 
-	for (const auto& streamDeclaration : meshImportSettings.verticesStreamDeclarations)
+	AttributeFormat GetDirectionsFormat(DirectionEncoding encoding, U32 directionsCount)
 	{
-		auto streamDescriptor = VerticesStreamDescriptor{};
-		auto totalVertexSize = uint32_t{ 0 };
-		auto positionOffset = uint32_t{ 0 };
-		auto normalOffset = uint32_t{ 0 };
-		auto tangentBitangentOffset = uint32_t{ 0 };
-		auto textureCoordinate0Offset = uint32_t{ 0 };
-		auto textureCoordinate1Offset = uint32_t{ 0 };
-		auto jointsIndexOffset = uint32_t{ 0 };
-		auto jointsWeightOffset = uint32_t{ 0 };
-		if (streamDeclaration.hasPosition)
+		assert(directionsCount == 1 or directionsCount == 2);
+		switch (encoding)
 		{
-			positionOffset = totalVertexSize;
-			totalVertexSize += sizeof(aiVector3D);
-			streamDescriptor.attributes.push_back(AttributeDescriptor{ .semantic = AttributeSemantic::position,
-																	   .offset = positionOffset,
-																	   .componentSize = sizeof(ai_real),
-																	   .componentCount = 3 });
+		case DirectionEncoding::octahedral16:
+			return directionsCount == 1 ? AttributeFormat::snorm16x2 : AttributeFormat::snorm16x4;
+		case DirectionEncoding::octahedral8:
+			return directionsCount == 1 ? AttributeFormat::snorm8x2 : AttributeFormat::snorm8x4;
+		case DirectionEncoding::float32:
+			break;
 		}
-		if (streamDeclaration.hasNormal)
+		return directionsCount == 1 ? AttributeFormat::float32x3 : AttributeFormat::float32x6;
+	}
+
+	template <typename Value>
+	void WriteValue(std::byte* destination, const Value& value)
+	{
+		std::memcpy(destination, &value, sizeof(Value));
+	}
+
+	void WritePosition(std::byte* destination, AttributeFormat format, const Math::Vector3& position,
+					   const VerticesStreamDescriptor& descriptor)
+	{
+		if (format == AttributeFormat::float32x3)
 		{
-			normalOffset = totalVertexSize;
-			totalVertexSize += sizeof(aiVector3D);
-			streamDescriptor.attributes.push_back(AttributeDescriptor{ .semantic = AttributeSemantic::normal,
-																	   .offset = normalOffset,
-																	   .componentSize = sizeof(ai_real),
-																	   .componentCount = 3 });
+			WriteValue(destination, position);
+			return;
 		}
-		if (streamDeclaration.hasTangentBitangent)
+		assert(format == AttributeFormat::unorm16x4);
+		const auto normalized = (position - descriptor.positionMinimum) / descriptor.positionExtent;
+		WriteValue(destination, std::array{ Geometry::QuantizeUnorm16(normalized.x),
+											Geometry::QuantizeUnorm16(normalized.y),
+											Geometry::QuantizeUnorm16(normalized.z), U16{ 0 } });
+	}
+
+	template <std::size_t Count>
+	void WriteDirections(std::byte* destination, AttributeFormat format,
+						 const std::array<Math::Vector3, Count>& directions)
+	{
+		for (auto i = 0u; i < Count; i++)
 		{
-			tangentBitangentOffset = totalVertexSize;
-			totalVertexSize += sizeof(aiVector3D) * 2;
-			streamDescriptor.attributes.push_back(
-				AttributeDescriptor{ .semantic = AttributeSemantic::tangentAndBitangent,
-									 .offset = tangentBitangentOffset,
-									 .componentSize = sizeof(ai_real),
-									 .componentCount = 6 });
+			switch (format)
+			{
+			case AttributeFormat::float32x3:
+			case AttributeFormat::float32x6:
+				WriteValue(destination + i * sizeof(Math::Vector3), directions[i]);
+				break;
+			case AttributeFormat::snorm16x2:
+			case AttributeFormat::snorm16x4:
+			{
+				const auto encoded = Geometry::EncodeOctahedral(directions[i]);
+				WriteValue(destination + i * 2 * sizeof(I16),
+						   std::array{ Geometry::QuantizeSnorm16(encoded.x), Geometry::QuantizeSnorm16(encoded.y) });
+				break;
+			}
+			case AttributeFormat::snorm8x2:
+			case AttributeFormat::snorm8x4:
+			{
+				const auto encoded = Geometry::EncodeOctahedral(directions[i]);
+				WriteValue(destination + i * 2 * sizeof(I8),
+						   std::array{ Geometry::QuantizeSnorm8(encoded.x), Geometry::QuantizeSnorm8(encoded.y) });
+				break;
+			}
+			default:
+				assert(false);
+			}
 		}
-		if (streamDeclaration.hasTextureCoordinate0)
+	}
+
+	void WriteTextureCoordinate(std::byte* destination, AttributeFormat format,
+								const Math::Vector2& textureCoordinate)
+	{
+		if (format == AttributeFormat::float32x2)
 		{
-			textureCoordinate0Offset = totalVertexSize;
-			totalVertexSize += sizeof(aiVector2D);
-			streamDescriptor.attributes.push_back(
-				AttributeDescriptor{ .semantic = AttributeSemantic::textureCoordinate0,
-									 .offset = textureCoordinate0Offset,
-									 .componentSize = sizeof(ai_real),
-									 .componentCount = 2 });
+			WriteValue(destination, textureCoordinate);
+			return;
 		}
-		if (streamDeclaration.hasTextureCoordinate1)
+		assert(format == AttributeFormat::float16x2);
+		WriteValue(destination, std::array{ Geometry::FloatToHalf(textureCoordinate.x),
+											Geometry::FloatToHalf(textureCoordinate.y) });
+	}
+
+	void WriteJointWeights(std::byte* destination, AttributeFormat format, const Math::Vector4& weights)
+	{
+		if (format == AttributeFormat::float32x4)
 		{
-			textureCoordinate1Offset = totalVertexSize;
-			totalVertexSize += sizeof(aiVector2D);
-			streamDescriptor.attributes.push_back(
-				AttributeDescriptor{ .semantic = AttributeSemantic::textureCoordinate1,
-									 .offset = textureCoordinate1Offset,
-									 .componentSize = sizeof(ai_real),
-									 .componentCount = 2 });
+			WriteValue(destination, weights);
+			return;
 		}
+		assert(format == AttributeFormat::unorm8x4);
+		WriteValue(destination, Geometry::QuantizeJointWeights(weights));
+	}
 
-		if (streamDeclaration.hasJointsIndexAndWeights)
+	Math::Vector4 ReadJointWeights(const std::byte* source, AttributeFormat format)
+	{
+		if (format == AttributeFormat::float32x4)
 		{
-			jointsIndexOffset = totalVertexSize;
-			totalVertexSize += sizeof(uint32_t);
-			streamDescriptor.attributes.push_back(AttributeDescriptor{ .semantic = AttributeSemantic::jointIndex,
-																	   .offset = jointsIndexOffset,
-																	   .componentSize = sizeof(uint32_t),
-																	   .componentCount = 1 });
-			jointsWeightOffset = totalVertexSize;
-			totalVertexSize += sizeof(float) * 4;
-			streamDescriptor.attributes.push_back(AttributeDescriptor{ .semantic = AttributeSemantic::jointWeight,
-																	   .offset = jointsWeightOffset,
-																	   .componentSize = sizeof(float),
-																	   .componentCount = 4 });
+			auto weights = Math::Vector4{};
+			std::memcpy(&weights, source, sizeof(Math::Vector4));
+			return weights;
 		}
+		assert(format == AttributeFormat::unorm8x4);
+		auto quantized = std::array<U8, 4>{};
+		std::memcpy(quantized.data(), source, sizeof(quantized));
+		return Math::Vector4{ quantized[0], quantized[1], quantized[2], quantized[3] } / 255.0f;
+	}
+
+	U32 GetVertexSize(const VerticesStreamDescriptor& streamDescriptor)
+	{
+		return streamDescriptor.attributes.empty() ? 0 : streamDescriptor.attributes.front().stride;
+	}
 
-		for (auto i = 0; i < streamDescriptor.attributes.size(); i++)
+	std::vector<Math::Vector3> GatherPositions(const aiMesh& mesh, std::span<const U32> vertexSources)
+	{
+		auto positions = std::vector<Math::Vector3>(vertexSources.size());
+		for (auto i = 0u; i < vertexSources.size(); i++)
 		{
-			streamDescriptor.attributes[i].stride = totalVertexSize;
+			const auto& position = mesh.mVertices[vertexSources[i]];
+			positions[i] = Math::Vector3{ position.x, position.y, position.z };
 		}
+		return positions;
+	}
 
-		const auto totalStreamBufferSize = totalVertexSize * mesh.mNumVertices;
-		auto data = StreamDataBuffer{};
-
-		data.resize(totalStreamBufferSize);
-		if (streamDeclaration.hasPosition)
+	// Reorders the vertex streams after the indices were rewritten, vertexSources keeps mapping them to the mesh.
+	void RemapMeshData(std::span<const U32> newToOldVertex, MeshData& meshData, std::vector<U32>& vertexSources)
+	{
+		for (auto& stream : meshData.streams)
 		{
-			for (auto i = 0; i < mesh.mNumVertices; i++)
+			const auto stride = GetVertexSize(stream.streamDescriptor);
+			if (stride > 0)
 			{
-				std::memcpy(&data[i * totalVertexSize + positionOffset], &mesh.mVertices[i], sizeof(aiVector3D));
+				stream.data = Geometry::RemapVertices<std::byte>(stream.data, stride, newToOldVertex);
 			}
 		}
-		if (streamDeclaration.hasNormal)
+		auto remappedSources = std::vector<U32>(newToOldVertex.size());
+		for (auto i = 0u; i < newToOldVertex.size(); i++)
 		{
-			for (auto i = 0; i < mesh.mNumVertices; i++)
-			{
-				std::memcpy(&data[i * totalVertexSize + normalOffset], &mesh.mNormals[i], sizeof(aiVector3D));
-			}
+			remappedSources[i] = vertexSources[newToOldVertex[i]];
 		}
-		if (streamDeclaration.hasTangentBitangent)
+		vertexSources = std::move(remappedSources);
+	}
+
+	std::vector<U32> ReadIndices(const MeshData& meshData)
+	{
+		auto indices = std::vector<U32>(meshData.indexStream.size() / sizeof(U32));
+		std::memcpy(indices.data(), meshData.indexStream.data(), meshData.indexStream.size());
+		return indices;
+	}
+
+	// Narrows the finished index stream, every consumer of the 32 bit indices has run by then.
+	void CompactIndices(U32 verticesCount, MeshData& meshData)
+	{
+		if (verticesCount > std::numeric_limits<U16>::max() + 1u)
 		{
-			for (auto i = 0; i < mesh.mNumVertices; i++)
-			{
-				std::memcpy(&data[i * totalVertexSize + tangentBitangentOffset], &mesh.mTangents[i],
-							sizeof(aiVector3D));
-				std::memcpy(&data[i * totalVertexSize + tangentBitangentOffset + sizeof(aiVector3D)],
-							&mesh.mBitangents[i], sizeof(aiVector3D));
-			}
+			return;
 		}
-		if (streamDeclaration.hasTextureCoordinate0)
+		const auto indices = ReadIndices(meshData);
+		meshData.indexStream.resize(indices.size() * sizeof(U16));
+		for (auto i = 0u; i < indices.size(); i++)
 		{
-			const auto t = mesh.HasTextureCoords(0);
-			for (auto i = 0; i < mesh.mNumVertices; i++)
-			{
-				if (t)
-				{
+			const auto index = static_cast<U16>(indices[i]);
+			std::memcpy(meshData.indexStream.data() + i * sizeof(U16), &index, sizeof(U16));
+		}
+		meshData.indexFormat = IndexFormat::uint16;
+	}
 
-					std::memcpy(&data[i * totalVertexSize + textureCoordinate0Offset], &mesh.mTextureCoords[0][i],
-								sizeof(aiVector2D));
-				}
-				else
+	// Welds over the source attributes of every declared semantic, which is what the streams were encoded from.
+	void WeldMeshData(const aiMesh& mesh, const MeshImportSettings& meshImportSettings,
+					  const SkinInfluences& skinInfluences, MeshData& meshData, std::vector<U32>& vertexSources)
+	{
+		ZoneScoped;
+		auto semantics = std::vector<AttributeSemantic>{};
+		for (const auto& stream : meshData.streams)
+		{
+			for (const auto& attribute : stream.streamDescriptor.attributes)
+			{
+				if (std::ranges::find(semantics, attribute.semantic) == semantics.end())
 				{
-					auto m = aiVector2D{ 0.0f, 0.0f };
-					std::memcpy(&data[i * totalVertexSize + textureCoordinate0Offset], &m, sizeof(aiVector2D));
+					semantics.push_back(attribute.semantic);
 				}
 			}
 		}
-		if (streamDeclaration.hasTextureCoordinate1)
+
+		const auto& weld = meshImportSettings.weld;
+		auto epsilons = std::vector<Float>{};
+		for (const auto semantic : semantics)
 		{
-			for (auto i = 0; i < mesh.mNumVertices; i++)
+			switch (semantic)
 			{
-				std::memcpy(&data[i * totalVertexSize + textureCoordinate1Offset], &mesh.mTextureCoords[1][i],
-							sizeof(aiVector2D));
+			case AttributeSemantic::position:
+				epsilons.insert(epsilons.end(), 3, weld.positionEpsilon);
+				break;
+			case AttributeSemantic::normal:
+				epsilons.insert(epsilons.end(), 3, weld.normalEpsilon);
+				break;
+			case AttributeSemantic::tangentAndBitangent:
+				epsilons.insert(epsilons.end(), 6, weld.tangentBitangentEpsilon);
+				break;
+			case AttributeSemantic::textureCoordinate0:
+			case AttributeSemantic::textureCoordinate1:
+				epsilons.insert(epsilons.end(), 2, weld.textureCoordinateEpsilon);
+				break;
+			case AttributeSemantic::jointIndex:
+				epsilons.insert(epsilons.end(), 4, 0.0f);
+				break;
+			case AttributeSemantic::jointWeight:
+				epsilons.insert(epsilons.end(), 4, weld.jointWeightsEpsilon);
+				break;
 			}
 		}
-		if (streamDeclaration.hasJointsIndexAndWeights)
+		const auto stride = static_cast<U32>(epsilons.size());
+		if (stride == 0)
 		{
-			const auto skeleton = ImportSkeleton(meshIndex);
-			struct JointVertexData
-			{
-				int jointIndex;
-				float weight;
-			};
-			std::vector<std::vector<JointVertexData>> v;
-			v.resize(mesh.mNumVertices);
+			return;
+		}
 
-			for (auto i = 0; i < mesh.mNumBones; i++)
+		auto vertices = std::vector<Float>{};
+		vertices.reserve(vertexSources.size() * stride);
+		const auto AppendVector = [&](const aiVector3D& vector)
+		{ vertices.insert(vertices.end(), { vector.x, vector.y, vector.z }); };
+		for (const auto source : vertexSources)
+		{
+			for (const auto semantic : semantics)
 			{
-				auto& bone = *mesh.mBones[i];
-
-				auto it = std::find_if(skeleton.joints.begin(), skeleton.joints.end(), [&](const Joint& joint)
-									   { return joint.name == std::string{ bone.mName.C_Str() }; });
-				if (it == skeleton.joints.end())
+				switch (semantic)
 				{
-					continue;
-				}
-
-				const auto jointIndex = (int)std::distance(skeleton.joints.begin(), it);
-
-				for (auto j = 0; j < bone.mNumWeights; j++)
+				case AttributeSemantic::position:
+					AppendVector(mesh.mVertices[source]);
+					break;
+				case AttributeSemantic::normal:
+					AppendVector(mesh.mNormals[source]);
+					break;
+				case AttributeSemantic::tangentAndBitangent:
+					AppendVector(mesh.mTangents[source]);
+					AppendVector(mesh.mBitangents[source]);
+					break;
+				case AttributeSemantic::textureCoordinate0:
+				case AttributeSemantic::textureCoordinate1:
 				{
-					if (bone.mWeights[j].mWeight > 0.01)
+					const auto channel = semantic == AttributeSemantic::textureCoordinate0 ? 0 : 1;
+					const auto textureCoordinate =
+						mesh.HasTextureCoords(channel) ? mesh.mTextureCoords[channel][source] : aiVector3D{};
+					vertices.insert(vertices.end(), { textureCoordinate.x, textureCoordinate.y });
+					break;
+				}
+				case AttributeSemantic::jointIndex:
+					for (const auto jointIndex : skinInfluences.jointIndices[source])
 					{
-						v[bone.mWeights[j].mVertexId].push_back(
-							JointVertexData{ jointIndex, bone.mWeights[j].mWeight });
+						vertices.push_back(static_cast<Float>(jointIndex));
 					}
+					break;
+				case AttributeSemantic::jointWeight:
+				{
+					const auto& weights = skinInfluences.jointWeights[source];
+					vertices.insert(vertices.end(), { weights.x, weights.y, weights.z, weights.w });
+					break;
+				}
 				}
 			}
+		}
+
+		auto indices = ReadIndices(meshData);
+		const auto newToOldVertex = Geometry::WeldVertices(indices, vertices, stride, epsilons);
+		std::memcpy(meshData.indexStream.data(), indices.data(), meshData.indexStream.size());
+		RemapMeshData(newToOldVertex, meshData, vertexSources);
+	}
+
+	// Reorders triangles for the post-transform cache and then for overdraw, and vertices in order of first use.
+	// Every stream is remapped the same way, vertices no triangle refers to are dropped.
+	void OptimizeMeshData(const aiMesh& mesh, MeshData& meshData, std::vector<U32>& vertexSources)
+	{
+		ZoneScoped;
+		auto indices = ReadIndices(meshData);
+		const auto verticesCount = static_cast<U32>(vertexSources.size());
+		const auto positions = GatherPositions(mesh, vertexSources);
+
+		Geometry::OptimizeVertexCache(indices, verticesCount);
+		Geometry::OptimizeOverdraw(indices, positions);
+		const auto newToOldVertex = Geometry::OptimizeVertexFetch(indices, verticesCount);
+
+		std::memcpy(meshData.indexStream.data(), indices.data(), meshData.indexStream.size());
+		RemapMeshData(newToOldVertex, meshData, vertexSources);
+	}
 
-			for (auto i = 0; i < v.size(); i++)
+	// Appends one simplified index range per level to the index stream, all of them over the existing vertices.
+	void GenerateLods(const aiMesh& mesh, std::span<const U32> vertexSources, const MeshImportSettings& settings,
+					  MeshData& meshData)
+	{
+		ZoneScoped;
+		const auto& simplification = settings.simplification;
+		const auto verticesCount = static_cast<U32>(vertexSources.size());
+		const auto positions = GatherPositions(mesh, vertexSources);
+
+		// Normals and the first texture coordinate keep shading and texturing close to the full detail mesh.
+		auto attributeWeights = std::vector<Float>{};
+		if (mesh.HasNormals())
+		{
+			attributeWeights.insert(attributeWeights.end(), 3, simplification.normalWeight);
+		}
+		if (mesh.HasTextureCoords(0))
+		{
+			attributeWeights.insert(attributeWeights.end(), 2, simplification.textureCoordinateWeight);
+		}
+		const auto stride = static_cast<U32>(attributeWeights.size());
+		auto attributeValues = std::vector<Float>{};
+		attributeValues.reserve(verticesCount * stride);
+		for (const auto source : vertexSources)
+		{
+			if (mesh.HasNormals())
 			{
-				std::sort(v[i].begin(), v[i].end(),
-						  [](const JointVertexData& s1, const JointVertexData& s2) { return s1.weight > s2.weight; });
+				attributeValues.insert(attributeValues.end(),
+									   { mesh.mNormals[source].x, mesh.mNormals[source].y, mesh.mNormals[source].z });
 			}
-			for (auto i = 0; i < v.size(); i++)
+			if (mesh.HasTextureCoords(0))
 			{
-				v[i].resize(4);
-				auto totalWeight = 0.0f;
-				for (auto j = 0; j < v[i].size(); j++)
-				{
-					totalWeight += v[i][j].weight;
-				}
-				for (auto j = 0; j < v[i].size(); j++)
-				{
-					v[i][j].weight /= totalWeight;
-				}
+				attributeValues.insert(attributeValues.end(),
+									   { mesh.mTextureCoords[0][source].x, mesh.mTextureCoords[0][source].y });
 			}
+		}
 
-			for (auto i = 0; i < mesh.mNumVertices; i++)
+		// Skin weights are read back from the stream that carries them, after the importer picked the top four.
+		auto jointIndices = std::vector<std::array<U8, 4>>{};
+		auto jointWeights = std::vector<Math::Vector4>{};
+		for (const auto& stream : meshData.streams)
+		{
+			const auto indexAttribute =
+				std::ranges::find(stream.streamDescriptor.attributes, AttributeSemantic::jointIndex,
+								  &AttributeDescriptor::semantic);
+			const auto weightAttribute =
+				std::ranges::find(stream.streamDescriptor.attributes, AttributeSemantic::jointWeight,
+								  &AttributeDescriptor::semantic);
+			if (indexAttribute == stream.streamDescriptor.attributes.end() or
+				weightAttribute == stream.streamDescriptor.attributes.end())
 			{
-				const auto jointIndicies = glm::vec<4, uint8_t>{ v[i][0].jointIndex, v[i][1].jointIndex,
-																 v[i][2].jointIndex, v[i][3].jointIndex };
-				const auto jointWeights = glm::vec4{ v[i][0].weight, v[i][1].weight, v[i][2].weight, v[i][3].weight };
-
-				std::memcpy(&data[i * totalVertexSize + jointsIndexOffset], &jointIndicies,
-							sizeof(glm::vec<4, uint8_t>));
-				std::memcpy(&data[i * totalVertexSize + jointsWeightOffset], &jointWeights, sizeof(glm::vec4));
+				continue;
+			}
+			jointIndices.resize(verticesCount);
+			jointWeights.resize(verticesCount);
+			for (auto i = 0u; i < verticesCount; i++)
+			{
+				std::memcpy(&jointIndices[i], &stream.data[i * indexAttribute->stride + indexAttribute->offset],
+							sizeof(std::array<U8, 4>));
+				jointWeights[i] = ReadJointWeights(
+					&stream.data[i * weightAttribute->stride + weightAttribute->offset], weightAttribute->format);
 			}
+			break;
 		}
 
-		meshData.streams.push_back(VertexStream{ .streamDescriptor = streamDescriptor, .data = data });
+		const auto attributes = Geometry::SimplificationAttributes{ .values = attributeValues,
+																   .stride = stride,
+																   .weights = attributeWeights,
+																   .jointIndices = jointIndices,
+																   .jointWeights = jointWeights,
+																   .jointWeightsWeight =
+																	   simplification.jointWeightsWeight };
+
+		auto indices = ReadIndices(meshData);
+		auto error = 0.0f;
+		for (const auto& level : simplification.levels)
+		{
+			const auto targetIndicesCount =
+				static_cast<U32>(static_cast<Float>(indices.size() / 3) * level.targetRatio) * 3;
+			auto simplified =
+				Geometry::Simplify(indices, positions, targetIndicesCount, level.targetError, attributes);
+			if (simplified.indices.size() >= indices.size())
+			{
+				// The error budget is used up, further levels would repeat this one.
+				break;
+			}
+			if (settings.applyOptimization)
+			{
+				Geometry::OptimizeVertexCache(simplified.indices, verticesCount);
+			}
+
+			// Each level is simplified from the previous one, so their errors add up.
+			error += simplified.error;
+			const auto indicesOffset = static_cast<U32>(meshData.indexStream.size() / sizeof(U32));
+			meshData.lods.push_back(MeshLod{ .indicesOffset = indicesOffset,
+											 .indicesCount = static_cast<U32>(simplified.indices.size()),
+											 .error = error });
+			meshData.indexStream.resize(meshData.indexStream.size() + simplified.indices.size() * sizeof(U32));
+			std::memcpy(meshData.indexStream.data() + indicesOffset * sizeof(U32), simplified.indices.data(),
+						simplified.indices.size() * sizeof(U32));
+			indices = std::move(simplified.indices);
+		}
 	}
 
-	if (!meshImportSettings.verticesStreamDeclarations.empty())
+	// Descriptors of the declared streams, they share the bounds quantized positions are relative to.
+	std::vector<VerticesStreamDescriptor> BuildStreamDescriptors(const aiMesh& mesh,
+																 const MeshImportSettings& meshImportSettings)
 	{
-
-		const auto indexBufferSize = mesh.mNumFaces * 3 * sizeof(int);
-		meshData.indexStream.resize(indexBufferSize);
-		for (auto i = 0; i < mesh.mNumFaces; i++)
+		auto positionMinimum = Math::Vector3{ 0.0f };
+		auto positionExtent = Math::Vector3{ 1.0f };
+		if (mesh.mNumVertices > 0)
 		{
-			std::memcpy(meshData.indexStream.data() + 3 * sizeof(int) * i, mesh.mFaces[i].mIndices, 3 * sizeof(int));
+			positionMinimum = ToVector3(mesh.mVertices[0]);
+			auto positionMaximum = positionMinimum;
+			for (auto i = 0u; i < mesh.mNumVertices; i++)
+			{
+				positionMinimum = glm::min(positionMinimum, ToVector3(mesh.mVertices[i]));
+				positionMaximum = glm::max(positionMaximum, ToVector3(mesh.mVertices[i]));
+			}
+			positionExtent = positionMaximum - positionMinimum;
+			for (auto component = 0; component < 3; component++)
+			{
+				positionExtent[component] = positionExtent[component] > 0.0f ? positionExtent[component] : 1.0f;
+			}
 		}
-	}
-	return meshData;
-}
-
-Skeleton AssetImporter::ImportSkeleton(U32 meshIndex)
-{
-	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
 
-	currentlyLoadedScene = importer.ApplyPostProcessing(aiProcess_PopulateArmatureData);
-	const auto& mesh = currentlyLoadedScene->mMeshes[meshIndex];
-
-	assert(mesh->HasBones());
+		auto streamDescriptors = std::vector<VerticesStreamDescriptor>{};
+		streamDescriptors.reserve(meshImportSettings.verticesStreamDeclarations.size());
+		for (const auto& streamDeclaration : meshImportSettings.verticesStreamDeclarations)
+		{
+			auto streamDescriptor = VerticesStreamDescriptor{};
+			streamDescriptor.positionMinimum = positionMinimum;
+			streamDescriptor.positionExtent = positionExtent;
+			auto vertexSize = 0u;
+			const auto AddAttribute = [&](AttributeSemantic semantic, AttributeFormat format)
+			{
+				streamDescriptor.attributes.push_back(
+					AttributeDescriptor{ .semantic = semantic, .offset = vertexSize, .format = format });
+				vertexSize += (GetAttributeFormatSize(format) + 3) / 4 * 4;
+			};
 
-	auto animationRoot = mesh->mBones[0]->mArmature;
+			if (streamDeclaration.hasPosition)
+			{
+				const auto isQuantized = streamDeclaration.positionEncoding == PositionEncoding::unorm16;
+				AddAttribute(AttributeSemantic::position,
+							 isQuantized ? AttributeFormat::unorm16x4 : AttributeFormat::float32x3);
+			}
+			if (streamDeclaration.hasNormal)
+			{
+				AddAttribute(AttributeSemantic::normal, GetDirectionsFormat(streamDeclaration.normalEncoding, 1));
+			}
+			if (streamDeclaration.hasTangentBitangent)
+			{
+				AddAttribute(AttributeSemantic::tangentAndBitangent,
+							 GetDirectionsFormat(streamDeclaration.tangentBitangentEncoding, 2));
+			}
+			const auto textureCoordinateFormat =
+				streamDeclaration.textureCoordinateEncoding == TextureCoordinateEncoding::float16 ?
+				AttributeFormat::float16x2 :
+				AttributeFormat::float32x2;
+			if (streamDeclaration.hasTextureCoordinate0)
+			{
+				AddAttribute(AttributeSemantic::textureCoordinate0, textureCoordinateFormat);
+			}
+			if (streamDeclaration.hasTextureCoordinate1)
+			{
+				AddAttribute(AttributeSemantic::textureCoordinate1, textureCoordinateFormat);
+			}
+			if (streamDeclaration.hasJointsIndexAndWeights)
+			{
+				AddAttribute(AttributeSemantic::jointIndex, AttributeFormat::uint8x4);
+				AddAttribute(AttributeSemantic::jointWeight,
+							 streamDeclaration.jointWeightsEncoding == JointWeightsEncoding::unorm8 ?
+								 AttributeFormat::unorm8x4 :
+								 AttributeFormat::float32x4);
+			}
+			for (auto& attribute : streamDescriptor.attributes)
+			{
+				attribute.stride = vertexSize;
+			}
+			streamDescriptors.push_back(std::move(streamDescriptor));
+		}
+		return streamDescriptors;
+	}
 
-	while (animationRoot->mParent != nullptr)
+	bool HasJointAttributes(const VerticesStreamDescriptor& streamDescriptor)
 	{
-		animationRoot = animationRoot->mParent;
+		return std::ranges::find(streamDescriptor.attributes, AttributeSemantic::jointIndex,
+								 &AttributeDescriptor::semantic) != streamDescriptor.attributes.end();
 	}
-	auto skeleton = Skeleton{};
+
+	// influence is the slot of the vertex in skinInfluences, which may only hold a window of the mesh.
+	void WriteVertex(std::byte* destination, const aiMesh& mesh, U32 vertex,
+					 const VerticesStreamDescriptor& streamDescriptor, const SkinInfluences& skinInfluences,
+					 U32 influence)
 	{
-		std::queue<aiNode*> children;
-		children.push(animationRoot);
-		auto totalJoints = 0;
-		while (!children.empty())
+		for (const auto& attribute : streamDescriptor.attributes)
 		{
-			auto node = children.front();
-			children.pop();
-
-			for (auto i = 0; i < node->mNumChildren; i++)
+			auto* attributeDestination = destination + attribute.offset;
+			switch (attribute.semantic)
 			{
-				children.push(node->mChildren[i]);
+			case AttributeSemantic::position:
+				WritePosition(attributeDestination, attribute.format, ToVector3(mesh.mVertices[vertex]),
+							  streamDescriptor);
+				break;
+			case AttributeSemantic::normal:
+				WriteDirections(attributeDestination, attribute.format,
+								std::array{ ToVector3(mesh.mNormals[vertex]) });
+				break;
+			case AttributeSemantic::tangentAndBitangent:
+				WriteDirections(attributeDestination, attribute.format,
+								std::array{ ToVector3(mesh.mTangents[vertex]), ToVector3(mesh.mBitangents[vertex]) });
+				break;
+			case AttributeSemantic::textureCoordinate0:
+			case AttributeSemantic::textureCoordinate1:
+			{
+				const auto channel = attribute.semantic == AttributeSemantic::textureCoordinate0 ? 0 : 1;
+				const auto textureCoordinate = mesh.HasTextureCoords(channel) ?
+					Math::Vector2{ mesh.mTextureCoords[channel][vertex].x, mesh.mTextureCoords[channel][vertex].y } :
+					Math::Vector2{ 0.0f, 0.0f };
+				WriteTextureCoordinate(attributeDestination, attribute.format, textureCoordinate);
+				break;
+			}
+			case AttributeSemantic::jointIndex:
+				std::memcpy(attributeDestination, &skinInfluences.jointIndices[influence], sizeof(std::array<U8, 4>));
+				break;
+			case AttributeSemantic::jointWeight:
+				WriteJointWeights(attributeDestination, attribute.format, skinInfluences.jointWeights[influence]);
+				break;
 			}
-			totalJoints++;
 		}
 	}
 
-	std::unordered_map<std::string, glm::mat4> boneMatrix;
-	for (auto i = 0; i < mesh->mNumBones; i++)
+	U64 HashMeshContent(const aiMesh& mesh, std::span<const VerticesStreamDescriptor> streamDescriptors,
+						std::span<const I16> boneJoints)
 	{
-		const auto matrix = glm::transpose(glm::mat4{
-			mesh->mBones[i]->mOffsetMatrix.a1, mesh->mBones[i]->mOffsetMatrix.a2, mesh->mBones[i]->mOffsetMatrix.a3,
-			mesh->mBones[i]->mOffsetMatrix.a4, mesh->mBones[i]->mOffsetMatrix.b1, mesh->mBones[i]->mOffsetMatrix.b2,
-			mesh->mBones[i]->mOffsetMatrix.b3, mesh->mBones[i]->mOffsetMatrix.b4, mesh->mBones[i]->mOffsetMatrix.c1,
-			mesh->mBones[i]->mOffsetMatrix.c2, mesh->mBones[i]->mOffsetMatrix.c3, mesh->mBones[i]->mOffsetMatrix.c4,
-			mesh->mBones[i]->mOffsetMatrix.d1, mesh->mBones[i]->mOffsetMatrix.d2, mesh->mBones[i]->mOffsetMatrix.d3,
-			mesh->mBones[i]->mOffsetMatrix.d4 });
-		boneMatrix[std::string{ mesh->mBones[i]->mName.C_Str() }] = matrix;
-	}
+		ZoneScoped;
+		auto hash = Hash::fnvOffsetBasis;
+		const auto HashArray = [&](const auto* values, U32 count)
+		{
+			hash = Hash::CombineContent(hash, values == nullptr ? 0 : count);
+			if (values != nullptr)
+			{
+				hash = Hash::HashContent(std::as_bytes(std::span{ values, count }), hash);
+			}
+		};
 
+		for (const auto& streamDescriptor : streamDescriptors)
+		{
+			hash = Hash::CombineContent(hash, streamDescriptor.attributes.size());
+			for (const auto& attribute : streamDescriptor.attributes)
+			{
+				hash = Hash::CombineContent(hash, static_cast<U64>(attribute.semantic));
+				hash = Hash::CombineContent(hash, static_cast<U64>(attribute.format));
+			}
+		}
+		HashArray(mesh.mVertices, mesh.mNumVertices);
+		HashArray(mesh.mNormals, mesh.mNumVertices);
+		HashArray(mesh.mTangents, mesh.mNumVertices);
+		HashArray(mesh.mBitangents, mesh.mNumVertices);
+		HashArray(mesh.mTextureCoords[0], mesh.mNumVertices);
+		HashArray(mesh.mTextureCoords[1], mesh.mNumVertices);
+		hash = Hash::CombineContent(hash, mesh.mNumFaces);
+		for (auto i = 0u; i < mesh.mNumFaces; i++)
+		{
+			HashArray(mesh.mFaces[i].mIndices, mesh.mFaces[i].mNumIndices);
+		}
+		// Joints rather than bone names, the same names can map to other joints in another skeleton.
+		for (auto i = 0u; i < boneJoints.size(); i++)
+		{
+			hash = Hash::CombineContent(hash, static_cast<U64>(boneJoints[i] + 1));
+			HashArray(mesh.mBones[i]->mWeights, mesh.mBones[i]->mNumWeights);
+		}
+		return hash;
+	}
 
-	std::unordered_set<std::string> animatedBondes;
-	for (auto i = 0; i < mesh->mNumBones; i++)
+	// Compares what HashMeshContent() hashes, equal hashes alone may still come from different meshes.
+	bool HasSameMeshContent(const aiMesh& mesh, std::span<const VerticesStreamDescriptor> streamDescriptors,
+							std::span<const I16> boneJoints, const aiMesh& otherMesh,
+							std::span<const VerticesStreamDescriptor> otherStreamDescriptors,
+							std::span<const I16> otherBoneJoints)
 	{
-		auto bone = mesh->mBones[i]->mNode;
-		animatedBondes.insert(std::string{ bone->mName.C_Str() });
+		ZoneScoped;
+		const auto IsSameArray = [](const auto* values, const auto* otherValues, U32 count)
+		{
+			if (values == nullptr or otherValues == nullptr)
+			{
+				return values == otherValues;
+			}
+			return std::memcmp(values, otherValues, sizeof(*values) * count) == 0;
+		};
 
-		while (bone->mParent->mParent != nullptr)
+		const auto HasSameAttributes = [](const VerticesStreamDescriptor& a, const VerticesStreamDescriptor& b)
 		{
-			bone = bone->mParent;
-			animatedBondes.insert(std::string{ bone->mName.C_Str() });
+			const auto HasSameAttribute = [](const auto& attribute, const auto& other)
+			{ return attribute.semantic == other.semantic and attribute.format == other.format; };
+			return std::ranges::equal(a.attributes, b.attributes, HasSameAttribute);
+		};
+
+		if (not std::ranges::equal(streamDescriptors, otherStreamDescriptors, HasSameAttributes))
+		{
+			return false;
+		}
+		if (mesh.mNumVertices != otherMesh.mNumVertices or mesh.mNumFaces != otherMesh.mNumFaces or
+			not std::ranges::equal(boneJoints, otherBoneJoints))
+		{
+			return false;
 		}
+		const auto verticesCount = mesh.mNumVertices;
+		if (not IsSameArray(mesh.mVertices, otherMesh.mVertices, verticesCount) or
+			not IsSameArray(mesh.mNormals, otherMesh.mNormals, verticesCount) or
+			not IsSameArray(mesh.mTangents, otherMesh.mTangents, verticesCount) or
+			not IsSameArray(mesh.mBitangents, otherMesh.mBitangents, verticesCount) or
+			not IsSameArray(mesh.mTextureCoords[0], otherMesh.mTextureCoords[0], verticesCount) or
+			not IsSameArray(mesh.mTextureCoords[1], otherMesh.mTextureCoords[1], verticesCount))
+		{
+			return false;
+		}
+		for (auto i = 0u; i < mesh.mNumFaces; i++)
+		{
+			const auto& face = mesh.mFaces[i];
+			const auto& otherFace = otherMesh.mFaces[i];
+			if (face.mNumIndices != otherFace.mNumIndices or
+				not IsSameArray(face.mIndices, otherFace.mIndices, face.mNumIndices))
+			{
+				return false;
+			}
+		}
+		for (auto i = 0u; i < boneJoints.size(); i++)
+		{
+			const auto& bone = *mesh.mBones[i];
+			const auto& otherBone = *otherMesh.mBones[i];
+			if (bone.mNumWeights != otherBone.mNumWeights or
+				not IsSameArray(bone.mWeights, otherBone.mWeights, bone.mNumWeights))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
-	struct Node
+	// Only reads the post-processed scene, so several meshes can be built concurrently.
+	MeshData BuildMeshData(const aiMesh& mesh, std::span<const I16> boneJoints,
+						   const MeshImportSettings& meshImportSettings)
 	{
-		aiNode* node;
-		int32_t parentIndex;
-	};
-	std::queue<Node> children;
-	children.push({ animationRoot, -1 });
+		ZoneScoped;
+		auto meshData = MeshData{};
+		meshData.streams.reserve(meshImportSettings.verticesStreamDeclarations.size());
 
-	while (!children.empty())
-	{
-		auto [node, parentIndex] = children.front();
-		children.pop();
-		auto index = (int32_t)skeleton.joints.size();
-		if (animatedBondes.contains(std::string{ node->mName.C_Str() }))
+		// The four strongest joint influences of each vertex, shared by every stream that declares them.
+		auto skinInfluences = SkinInfluences{};
+		if (ShouldLoadJointsIndexAndWeights(meshImportSettings))
 		{
-			const auto inverseTransform = glm::inverse(glm::transpose(glm::mat4{
-				node->mTransformation.a1, node->mTransformation.a2, node->mTransformation.a3, node->mTransformation.a4,
-				node->mTransformation.b1, node->mTransformation.b2, node->mTransformation.b3, node->mTransformation.b4,
-				node->mTransformation.c1, node->mTransformation.c2, node->mTransformation.c3, node->mTransformation.c4,
-				node->mTransformation.d1, node->mTransformation.d2, node->mTransformation.d3,
-				node->mTransformation.d4 }));
+			skinInfluences.jointIndices.resize(mesh.mNumVertices);
+			skinInfluences.jointWeights.resize(mesh.mNumVertices);
+			GatherSkinInfluences(mesh, boneJoints, 0, skinInfluences);
+		}
 
+		for (auto& streamDescriptor : BuildStreamDescriptors(mesh, meshImportSettings))
+		{
+			const auto vertexSize = GetVertexSize(streamDescriptor);
+			auto data = StreamDataBuffer(static_cast<std::size_t>(vertexSize) * mesh.mNumVertices);
+			for (auto vertex = 0u; vertex < mesh.mNumVertices; vertex++)
+			{
+				WriteVertex(data.data() + static_cast<std::size_t>(vertex) * vertexSize, mesh, vertex, streamDescriptor,
+							skinInfluences, vertex);
+			}
+			meshData.streams.push_back(
+				VertexStream{ .streamDescriptor = std::move(streamDescriptor), .data = std::move(data) });
+		}
+
+		if (!meshImportSettings.verticesStreamDeclarations.empty())
+		{
 
-			skeleton.joints.push_back(Joint{ boneMatrix[std::string{ node->mName.C_Str() }], inverseTransform,
-											 parentIndex, node->mName.C_Str() });
+			const auto indexBufferSize = mesh.mNumFaces * 3 * sizeof(int);
+			meshData.indexStream.resize(indexBufferSize);
+			for (auto i = 0; i < mesh.mNumFaces; i++)
+			{
+				std::memcpy(meshData.indexStream.data() + 3 * sizeof(int) * i, mesh.mFaces[i].mIndices,
+							3 * sizeof(int));
+			}
 		}
 
+		if (meshData.indexStream.empty())
+		{
+			return meshData;
+		}
 
-		for (auto i = 0; i < node->mNumChildren; i++)
+		// Source vertex in the mesh of every vertex in the streams.
+		auto vertexSources = std::vector<U32>(mesh.mNumVertices);
+		std::iota(vertexSources.begin(), vertexSources.end(), 0u);
+		if (meshImportSettings.weld.enabled)
+		{
+			WeldMeshData(mesh, meshImportSettings, skinInfluences, meshData, vertexSources);
+		}
+		if (meshImportSettings.applyOptimization)
 		{
+			OptimizeMeshData(mesh, meshData, vertexSources);
+		}
 
-			children.push({ node->mChildren[i], index });
+		meshData.lods.push_back(
+			MeshLod{ .indicesCount = static_cast<U32>(meshData.indexStream.size() / sizeof(U32)) });
+		if (not meshImportSettings.simplification.levels.empty())
+		{
+			GenerateLods(mesh, vertexSources, meshImportSettings, meshData);
 		}
+		if (meshImportSettings.buildMeshlets)
+		{
+			const auto positions = GatherPositions(mesh, vertexSources);
+			const auto indices = std::span{ reinterpret_cast<const U32*>(meshData.indexStream.data()),
+											meshData.indexStream.size() / sizeof(U32) };
+			for (auto& lod : meshData.lods)
+			{
+				lod.meshletOffset = static_cast<U32>(meshData.meshlets.meshlets.size());
+				Geometry::BuildMeshlets(indices.subspan(lod.indicesOffset, lod.indicesCount), positions,
+										meshData.meshlets);
+				lod.meshletCount = static_cast<U32>(meshData.meshlets.meshlets.size()) - lod.meshletOffset;
+			}
+		}
+		if (meshImportSettings.compactIndices)
+		{
+			CompactIndices(static_cast<U32>(vertexSources.size()), meshData);
+		}
+		return meshData;
 	}
 
-	return skeleton;
-}
+	struct ChannelResampling
+	{
+		U32 animationIndex{ 0 };
+		U32 channelIndex{ 0 };
+		U32 joint{ 0 };
+	};
 
-AnimationDataSet AssetImporter::LoadAllAnimations(const Skeleton& skeleton, const int resampleRate)
-{
-	std::vector<JointAnimationData> animationDatabase;
-	std::vector<AnimationData> animationDataResult;
-	std::unordered_map<std::string, int> skeletonJointNameToOffsetMap;
-	for (auto i = 0; i < skeleton.joints.size(); i++)
+	// Assimp leaves the rate at 0 when the file does not specify one.
+	double GetTicksPerSecond(const aiAnimation& animation)
 	{
-		skeletonJointNameToOffsetMap.insert(std::make_pair(skeleton.joints[i].name, i));
+		return animation.mTicksPerSecond != 0.0 ? animation.mTicksPerSecond : 25.0;
 	}
 
-	for (auto i = 0; i < currentlyLoadedScene->mNumAnimations; i++)
+	/*
+	 * Calls write(frame, a, b, factor) for every frame with the keys around its time, clamped to the first and last
+	 * key. Frames are visited in order, so a single cursor moving forward finds the keys.
+	 */
+	template <typename Key, typename Write>
+	void ResampleKeys(std::span<const Key> keys, double secondsPerTick, U32 frames, double timePerFrame,
+					  Write&& write)
+	{
+		if (keys.empty())
+		{
+			return;
+		}
+		auto cursor = std::size_t{ 0 };
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			const auto time = frame * timePerFrame;
+			while (cursor + 1 < keys.size() and keys[cursor + 1].mTime * secondsPerTick <= time)
+			{
+				cursor++;
+			}
+			const auto& a = keys[cursor];
+			const auto startTime = a.mTime * secondsPerTick;
+			if (cursor + 1 == keys.size() or time <= startTime)
+			{
+				write(frame, a, a, 0.0f);
+				continue;
+			}
+			const auto& b = keys[cursor + 1];
+			const auto factor = (time - startTime) / (b.mTime * secondsPerTick - startTime);
+			write(frame, a, b, static_cast<Float>(factor));
+		}
+	}
+	glm::mat4 ToMatrix(const aiMatrix4x4& matrix)
 	{
-		auto& animation = *currentlyLoadedScene->mAnimations[i];
+		return glm::transpose(glm::mat4{ matrix.a1, matrix.a2, matrix.a3, matrix.a4, matrix.b1, matrix.b2, matrix.b3,
+										 matrix.b4, matrix.c1, matrix.c2, matrix.c3, matrix.c4, matrix.d1, matrix.d2,
+										 matrix.d3, matrix.d4 });
+	}
 
+	// Needs the armature data, bones link the nodes they animate so no lookup by name is involved.
+	Skeleton BuildSkeleton(const aiMesh& mesh)
+	{
+		assert(mesh.HasBones());
 
-		const auto durationInSeconds = animation.mDuration / animation.mTicksPerSecond;
+		const aiNode* animationRoot = mesh.mBones[0]->mArmature;
+		while (animationRoot->mParent != nullptr)
+		{
+			animationRoot = animationRoot->mParent;
+		}
 
-		const auto framesPerAnimation = (int)((resampleRate * durationInSeconds * 1001.0f) / 1000.0f);
-		const auto skeletonJointsCount = skeleton.joints.size();
+		auto boneMatrices = std::unordered_map<const aiNode*, glm::mat4>{};
+		boneMatrices.reserve(mesh.mNumBones);
+		for (auto i = 0u; i < mesh.mNumBones; i++)
+		{
+			boneMatrices.emplace(mesh.mBones[i]->mNode, ToMatrix(mesh.mBones[i]->mOffsetMatrix));
+		}
 
-		std::vector<JointAnimationData> animationData{};
-		animationData.resize(framesPerAnimation * skeletonJointsCount);
-		struct PositionSample
+		// Bones and their ancestors up to the root's children become joints.
+		auto jointNodes = std::unordered_set<const aiNode*>{};
+		for (auto i = 0u; i < mesh.mNumBones; i++)
 		{
-			float time;
-			glm::vec3 position;
-		};
+			const aiNode* bone = mesh.mBones[i]->mNode;
+			jointNodes.insert(bone);
+			while (bone->mParent != nullptr and bone->mParent->mParent != nullptr)
+			{
+				bone = bone->mParent;
+				jointNodes.insert(bone);
+			}
+		}
+		// Several joint subtrees below the scene root, e.g. a character and a prop rigged side by side, would each
+		// start a root of their own. The scene root then joins them as the single root joint.
+		const auto topLevelJointsCount =
+			std::ranges::count_if(std::span{ animationRoot->mChildren, animationRoot->mNumChildren },
+								  [&](const aiNode* child) { return jointNodes.contains(child); });
+		if (topLevelJointsCount > 1)
+		{
+			jointNodes.insert(animationRoot);
+		}
 
-		struct RotationSample
+		struct Node
 		{
-			float time;
-			glm::quat rotation;
+			const aiNode* node;
+			int32_t parentIndex;
 		};
-		auto resamplePostion = [](const std::vector<PositionSample>& positionSamples,
-								  int targetFps) -> std::vector<glm::vec3>
+		auto skeleton = Skeleton{};
+		std::queue<Node> children;
+		children.push({ animationRoot, -1 });
+		while (!children.empty())
 		{
-			assert(positionSamples.size() >= 1);
+			auto [node, parentIndex] = children.front();
+			children.pop();
+			// Nodes that are not joints pass their parent on, so every joint refers to its closest joint ancestor.
+			// The breadth first walk pushes a joint only after its parent, which keeps the skeleton hierarchy ordered.
+			auto index = parentIndex;
+			if (jointNodes.contains(node))
+			{
+				index = (int32_t)skeleton.joints.size();
+				const auto inverseTransform = glm::inverse(ToMatrix(node->mTransformation));
+				// Ancestors without a bone of their own get a default offset.
+				const auto boneMatrix = boneMatrices.find(node);
+				skeleton.joints.push_back(Joint{ boneMatrix != boneMatrices.end() ? boneMatrix->second : glm::mat4{},
+												 inverseTransform, parentIndex, node->mName.C_Str() });
+			}
+			for (auto i = 0u; i < node->mNumChildren; i++)
+			{
+				children.push({ node->mChildren[i], index });
+			}
+		}
 
-			const auto start = 0.0f; // positionSamples.front().time;
-			const auto end = positionSamples.back().time;
+		BuildSkeletonHierarchy(skeleton);
+		return skeleton;
+	}
+} // namespace
 
-			const auto duration = end - start;
-			const auto timePerFrame = 1.0f / (float)targetFps;
+U64 Framework::HashMeshImportSettings(const MeshImportSettings& meshImportSettings)
+{
+	auto hash = Hash::fnvOffsetBasis;
+	const auto HashValue = [&](U64 value) { hash = Hash::Combine(hash, value); };
+	const auto HashFloat = [&](Float value)
+	{
+		auto bits = U32{};
+		std::memcpy(&bits, &value, sizeof(bits));
+		HashValue(bits);
+	};
 
-			const auto frames = std::max(1, (int)(((float)targetFps * duration * 1001.0f) / 1000.0f));
+	HashValue(meshImportSettings.applyOptimization);
+	HashValue(meshImportSettings.verticesStreamDeclarations.size());
+	for (const auto& declaration : meshImportSettings.verticesStreamDeclarations)
+	{
+		for (const auto flag :
+			 { declaration.hasPosition, declaration.hasNormal, declaration.hasTangentBitangent,
+			   declaration.hasTextureCoordinate0, declaration.hasTextureCoordinate1, declaration.hasColor,
+			   declaration.hasJointsIndexAndWeights })
+		{
+			HashValue(flag);
+		}
+		HashValue(static_cast<U64>(declaration.positionEncoding));
+		HashValue(static_cast<U64>(declaration.normalEncoding));
+		HashValue(static_cast<U64>(declaration.tangentBitangentEncoding));
+		HashValue(static_cast<U64>(declaration.textureCoordinateEncoding));
+		HashValue(static_cast<U64>(declaration.jointWeightsEncoding));
+	}
+	HashValue(meshImportSettings.simplification.levels.size());
+	for (const auto& level : meshImportSettings.simplification.levels)
+	{
+		HashFloat(level.targetRatio);
+		HashFloat(level.targetError);
+	}
+	HashFloat(meshImportSettings.simplification.normalWeight);
+	HashFloat(meshImportSettings.simplification.textureCoordinateWeight);
+	HashFloat(meshImportSettings.simplification.jointWeightsWeight);
+	HashValue(meshImportSettings.buildMeshlets);
+	HashValue(meshImportSettings.weld.enabled);
+	HashFloat(meshImportSettings.weld.positionEpsilon);
+	HashFloat(meshImportSettings.weld.normalEpsilon);
+	HashFloat(meshImportSettings.weld.tangentBitangentEpsilon);
+	HashFloat(meshImportSettings.weld.textureCoordinateEpsilon);
+	HashFloat(meshImportSettings.weld.jointWeightsEpsilon);
+	HashValue(meshImportSettings.compactIndices);
+	return hash;
+}
 
+MeshData AssetImporter::ImportMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings)
+{
+	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
+	assert(currentlyLoadedScene->mMeshes[meshIndex]->HasPositions());
 
-			std::vector<glm::vec3> result;
-			result.resize(frames);
+	ApplyPostProcessing(ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[meshIndex], meshImportSettings));
 
-			auto t = start;
+	const auto boneJoints = GetBoneJoints(meshIndex, meshImportSettings);
+	return BuildMeshData(*currentlyLoadedScene->mMeshes[meshIndex], boneJoints, meshImportSettings);
+}
 
-			result[0] = positionSamples.front().position;
-			result[frames - 1] = positionSamples.back().position;
-			int a = 0;
-			int b = 1;
+std::vector<MeshData> AssetImporter::ImportMeshes(std::span<const U32> meshIndices,
+												  const MeshImportSettings& meshImportSettings)
+{
+	ZoneScoped;
+	// Post-processing runs over the whole scene, so the steps every mesh needs are applied in a single pass.
+	auto flags = 0u;
+	for (const auto meshIndex : meshIndices)
+	{
+		assert(meshIndex < currentlyLoadedScene->mNumMeshes);
+		assert(currentlyLoadedScene->mMeshes[meshIndex]->HasPositions());
+		flags |= ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[meshIndex], meshImportSettings);
+	}
+	if (ShouldLoadJointsIndexAndWeights(meshImportSettings))
+	{
+		flags |= aiProcess_PopulateArmatureData;
+	}
+	ApplyPostProcessing(flags);
 
-			for (int i = 1; i < frames - 1; i++)
-			{
-				t += timePerFrame;
-				while (positionSamples[a].time + timePerFrame < t)
-				{
-					a++;
-				}
-				a--;
-				a = std::max(a, 0);
-				b = a + 1;
-				// assert(positionSamples[a].time < t && positionSamples[b].time >= t);
-				{
-					const float sa = positionSamples[a].time;
-					const float sb = positionSamples[b].time;
-					const float rest = t - sa;
-					const float factor = rest / (sb - sa);
+	// Skeletons are looked up before the meshes are built in parallel, which only reads the cached tables.
+	auto boneJoints = std::vector<std::span<const I16>>(meshIndices.size());
+	for (auto i = 0u; i < meshIndices.size(); i++)
+	{
+		boneJoints[i] = GetBoneJoints(meshIndices[i], meshImportSettings);
+	}
 
-					const auto attribute1 = positionSamples[a].position;
-					const auto attribute2 = positionSamples[b].position;
+	auto meshes = std::vector<MeshData>(meshIndices.size());
+	GetJobSystem().ParallelFor(static_cast<U32>(meshIndices.size()), 1,
+							   [&](U32 begin, U32 end)
+							   {
+								   for (auto i = begin; i < end; i++)
+								   {
+									   meshes[i] = BuildMeshData(*currentlyLoadedScene->mMeshes[meshIndices[i]],
+																 boneJoints[i], meshImportSettings);
+								   }
+							   });
+	return meshes;
+}
 
+U64 AssetImporter::HashMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings)
+{
+	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
+	ApplyPostProcessing(ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[meshIndex], meshImportSettings));
 
-					result[i] = attribute1 * (1.0f - factor) + factor * attribute2;
-				}
-			}
-			return result;
-		};
+	const auto boneJoints = GetBoneJoints(meshIndex, meshImportSettings);
+	const auto& mesh = *currentlyLoadedScene->mMeshes[meshIndex];
+	return HashMeshContent(mesh, BuildStreamDescriptors(mesh, meshImportSettings), boneJoints);
+}
 
-		auto resampleRotation = [](const std::vector<RotationSample>& rotationSamples,
-								   int targetFps) -> std::vector<glm::quat>
-		{
-			assert(rotationSamples.size() >= 1);
+bool AssetImporter::HasSameMeshContent(U32 meshIndex, U32 otherMeshIndex,
+										const MeshImportSettings& meshImportSettings)
+{
+	assert(meshIndex < currentlyLoadedScene->mNumMeshes and otherMeshIndex < currentlyLoadedScene->mNumMeshes);
+	ApplyPostProcessing(ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[meshIndex], meshImportSettings) |
+						ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[otherMeshIndex], meshImportSettings));
 
-			const auto start = 0.0f; // rotationSamples.front().time;
-			const auto end = rotationSamples.back().time;
+	const auto boneJoints = GetBoneJoints(meshIndex, meshImportSettings);
+	const auto otherBoneJoints = GetBoneJoints(otherMeshIndex, meshImportSettings);
+	const auto& mesh = *currentlyLoadedScene->mMeshes[meshIndex];
+	const auto& otherMesh = *currentlyLoadedScene->mMeshes[otherMeshIndex];
+	return ::HasSameMeshContent(mesh, BuildStreamDescriptors(mesh, meshImportSettings), boneJoints, otherMesh,
+								BuildStreamDescriptors(otherMesh, meshImportSettings), otherBoneJoints);
+}
 
-			const auto duration = end - start;
-			const auto timePerFrame = 1.0f / (float)targetFps;
+StreamedMesh AssetImporter::StreamMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings,
+									   std::span<std::byte> destination, const MeshStreamSink& sink)
+{
+	ZoneScoped;
+	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
+	assert(currentlyLoadedScene->mMeshes[meshIndex]->HasPositions());
+	// These need the whole mesh at once.
+	assert(not meshImportSettings.weld.enabled);
+	assert(not meshImportSettings.applyOptimization);
+	assert(meshImportSettings.simplification.levels.empty());
+	assert(not meshImportSettings.buildMeshlets);
 
-			const auto frames = std::max(1, (int)((targetFps * duration * 1001.0f) / 1000.0f));
+	ApplyPostProcessing(ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[meshIndex], meshImportSettings));
 
+	const auto boneJoints = GetBoneJoints(meshIndex, meshImportSettings);
+	const auto& mesh = *currentlyLoadedScene->mMeshes[meshIndex];
 
-			std::vector<glm::quat> result;
-			result.resize(frames);
+	auto streamedMesh = StreamedMesh{ .streamDescriptors = BuildStreamDescriptors(mesh, meshImportSettings),
+									  .verticesCount = mesh.mNumVertices };
+	if (meshImportSettings.verticesStreamDeclarations.empty())
+	{
+		return streamedMesh;
+	}
 
-			auto t = start;
+	if (meshImportSettings.compactIndices and mesh.mNumVertices <= std::numeric_limits<U16>::max() + 1u)
+	{
+		streamedMesh.indexFormat = IndexFormat::uint16;
+	}
+	const auto indexSize = GetIndexSize(streamedMesh.indexFormat);
+	const auto triangleSize = 3 * indexSize;
+	const auto trianglesPerChunk = static_cast<U32>(destination.size() / triangleSize);
+	assert(trianglesPerChunk > 0);
+	for (auto firstTriangle = 0u; firstTriangle < mesh.mNumFaces; firstTriangle += trianglesPerChunk)
+	{
+		const auto trianglesCount = std::min(trianglesPerChunk, mesh.mNumFaces - firstTriangle);
+		for (auto i = 0u; i < trianglesCount; i++)
+		{
+			const auto& face = mesh.mFaces[firstTriangle + i];
+			if (streamedMesh.indexFormat == IndexFormat::uint32)
+			{
+				std::memcpy(destination.data() + i * triangleSize, face.mIndices, triangleSize);
+				continue;
+			}
+			for (auto corner = 0u; corner < 3; corner++)
+			{
+				const auto index = static_cast<U16>(face.mIndices[corner]);
+				std::memcpy(destination.data() + i * triangleSize + corner * indexSize, &index, indexSize);
+			}
+		}
+		sink(MeshStreamChunk{ .kind = MeshStreamKind::indices,
+							  .offset = static_cast<U64>(firstTriangle) * triangleSize,
+							  .size = static_cast<U64>(trianglesCount) * triangleSize });
+	}
+	streamedMesh.indicesCount = mesh.mNumFaces * 3;
 
-			result[0] = rotationSamples.front().rotation;
-			result[frames - 1] = rotationSamples.back().rotation;
-			int a = 0;
-			int b = 1;
+	// Skin influences are gathered for a window of vertices at a time, which keeps their memory bounded too.
+	constexpr auto skinInfluencesWindow = 64u * 1024u;
+	auto skinInfluences = SkinInfluences{};
+	auto windowFirstVertex = 0u;
+	for (auto streamIndex = 0u; streamIndex < streamedMesh.streamDescriptors.size(); streamIndex++)
+	{
+		const auto& streamDescriptor = streamedMesh.streamDescriptors[streamIndex];
+		const auto vertexSize = GetVertexSize(streamDescriptor);
+		if (vertexSize == 0)
+		{
+			continue;
+		}
+		const auto hasJointAttributes = HasJointAttributes(streamDescriptor);
+		const auto verticesPerChunk = static_cast<U32>(destination.size() / vertexSize);
+		assert(verticesPerChunk > 0);
 
-			for (int i = 1; i < frames - 1; i++)
+		for (auto firstVertex = 0u; firstVertex < mesh.mNumVertices; firstVertex += verticesPerChunk)
+		{
+			const auto verticesCount = std::min(verticesPerChunk, mesh.mNumVertices - firstVertex);
+			for (auto vertex = firstVertex; vertex < firstVertex + verticesCount; vertex++)
 			{
-				t += timePerFrame;
-				while (rotationSamples[a].time + timePerFrame < t)
-				{
-					a++;
-				}
-				a--;
-				a = std::max(a, 0);
-				b = a + 1;
-				// assert(rotationSamples[a].time < t && rotationSamples[b].time >= t);
+				if (hasJointAttributes and
+					(skinInfluences.jointIndices.empty() or vertex - windowFirstVertex >= skinInfluencesWindow))
 				{
-					const float sa = rotationSamples[a].time;
-					const float sb = rotationSamples[b].time;
-					const float rest = t - sa;
-					const float factor = rest / (sb - sa);
-
-					const auto attribute1 = rotationSamples[a].rotation;
-					const auto attribute2 = rotationSamples[b].rotation;
-
-
-					result[i] = glm::slerp(attribute1, attribute2, factor);
+					windowFirstVertex = vertex;
+					const auto windowSize = std::min(skinInfluencesWindow, mesh.mNumVertices - vertex);
+					skinInfluences.jointIndices.resize(windowSize);
+					skinInfluences.jointWeights.resize(windowSize);
+					GatherSkinInfluences(mesh, boneJoints, windowFirstVertex, skinInfluences);
 				}
+				WriteVertex(destination.data() + static_cast<std::size_t>(vertex - firstVertex) * vertexSize, mesh,
+							vertex, streamDescriptor, skinInfluences, vertex - windowFirstVertex);
 			}
-			return result;
-		};
-		const auto seconds = animation.mDuration / animation.mTicksPerSecond;
-		for (auto channelIndex = 0; channelIndex < animation.mNumChannels; channelIndex++)
-		{
-			auto& channel = *animation.mChannels[channelIndex];
-			const auto channelNodeName = std::string{ channel.mNodeName.C_Str() };
+			sink(MeshStreamChunk{ .kind = MeshStreamKind::vertices,
+								  .streamIndex = streamIndex,
+								  .offset = static_cast<U64>(firstVertex) * vertexSize,
+								  .size = static_cast<U64>(verticesCount) * vertexSize });
+		}
+	}
+	return streamedMesh;
+}
 
-			if (skeletonJointNameToOffsetMap.contains(channelNodeName))
-			{
-				const auto offset = skeletonJointNameToOffsetMap[channelNodeName];
+Skeleton AssetImporter::ImportSkeleton(U32 meshIndex)
+{
+	assert(meshIndex < currentlyLoadedScene->mNumMeshes);
+	return GetMeshSkinning(meshIndex).skeleton;
+}
 
-				{
-					auto positionSamples = std::vector<PositionSample>{};
-					positionSamples.resize(channel.mNumPositionKeys);
+void AssetImporter::PostProcessScene(const MeshImportSettings& meshImportSettings)
+{
+	ZoneScoped;
+	auto flags = 0u;
+	auto hasBones = false;
+	for (auto i = 0u; i < currentlyLoadedScene->mNumMeshes; i++)
+	{
+		flags |= ComputePostProcessingFlags(*currentlyLoadedScene->mMeshes[i], meshImportSettings);
+		hasBones |= currentlyLoadedScene->mMeshes[i]->HasBones();
+	}
+	if (ShouldLoadJointsIndexAndWeights(meshImportSettings) and hasBones)
+	{
+		flags |= aiProcess_PopulateArmatureData;
+	}
+	ApplyPostProcessing(flags);
+}
 
-					for (auto t = 0; t < channel.mNumPositionKeys; t++)
-					{
-						positionSamples[t] = { (float)(channel.mPositionKeys[t].mTime / animation.mTicksPerSecond),
-											   glm::vec3{ channel.mPositionKeys[t].mValue.x,
-														  channel.mPositionKeys[t].mValue.y,
-														  channel.mPositionKeys[t].mValue.z } };
-					}
+void AssetImporter::ApplyPostProcessing(unsigned int flags)
+{
+	// Every step runs over the whole scene, so a step applied for one mesh is done for all of them.
+	const auto missingFlags = flags & ~appliedPostProcessingFlags;
+	if (missingFlags == 0)
+	{
+		return;
+	}
+	ZoneScoped;
+	currentlyLoadedScene = importer.ApplyPostProcessing(missingFlags);
+	appliedPostProcessingFlags |= missingFlags;
+	meshSkinnings.clear();
+}
 
-					std::vector<glm::vec3> resampledPositions = resamplePostion(positionSamples, resampleRate);
+const AssetImporter::MeshSkinning& AssetImporter::GetMeshSkinning(U32 meshIndex)
+{
+	ApplyPostProcessing(aiProcess_PopulateArmatureData);
+	if (const auto it = meshSkinnings.find(meshIndex); it != meshSkinnings.end())
+	{
+		return it->second;
+	}
+	ZoneScoped;
+	const auto& mesh = *currentlyLoadedScene->mMeshes[meshIndex];
+	auto skeleton = BuildSkeleton(mesh);
+	auto boneJoints = MapBonesToJoints(mesh, skeleton);
+	return meshSkinnings
+		.emplace(meshIndex, MeshSkinning{ .skeleton = std::move(skeleton), .boneJoints = std::move(boneJoints) })
+		.first->second;
+}
 
-					for (auto i = 0; i < resampledPositions.size(); i++)
-					{
-						animationData[i * skeletonJointsCount + offset].translation = resampledPositions[i];
-					}
-				}
-				{
-					auto rotationSamples = std::vector<RotationSample>{};
-					rotationSamples.resize(channel.mNumRotationKeys);
+std::span<const I16> AssetImporter::GetBoneJoints(U32 meshIndex, const MeshImportSettings& meshImportSettings)
+{
+	// Without bones there is nothing to gather, every vertex keeps joint 0 with no weight like an unused slot.
+	if (not ShouldLoadJointsIndexAndWeights(meshImportSettings) or not HasBones(meshIndex))
+	{
+		return {};
+	}
+	return GetMeshSkinning(meshIndex).boneJoints;
+}
 
-					for (auto t = 0; t < channel.mNumRotationKeys; t++)
-					{
-						rotationSamples[t] = { (float)(channel.mRotationKeys[t].mTime / animation.mTicksPerSecond),
-											   glm::quat{
-												   channel.mRotationKeys[t].mValue.w,
-												   channel.mRotationKeys[t].mValue.x,
-												   channel.mRotationKeys[t].mValue.y,
-												   channel.mRotationKeys[t].mValue.z,
-											   } };
-					}
-					std::vector<glm::quat> resampledRotations = resampleRotation(rotationSamples, resampleRate);
+AnimationDataSet AssetImporter::LoadAllAnimations(const Skeleton& skeleton, const int resampleRate)
+{
+	ZoneScoped;
+	auto jointsByName = std::unordered_map<std::string_view, U32>{};
+	for (auto i = 0u; i < skeleton.joints.size(); i++)
+	{
+		jointsByName.emplace(skeleton.joints[i].name, i);
+	}
+	const auto jointsCount = static_cast<U32>(skeleton.joints.size());
 
-					for (auto i = 0; i < resampledRotations.size(); i++)
-					{
-						animationData[i * skeletonJointsCount + offset].rotation = resampledRotations[i];
-					}
-				}
+	// Clips are laid out first, so every channel can be resampled in parallel straight into its final place.
+	auto result = AnimationDataSet{};
+	auto channels = std::vector<ChannelResampling>{};
+	auto databaseSize = std::size_t{ 0 };
+	for (auto animationIndex = 0u; animationIndex < currentlyLoadedScene->mNumAnimations; animationIndex++)
+	{
+		const auto& animation = *currentlyLoadedScene->mAnimations[animationIndex];
+		const auto durationInSeconds = animation.mDuration / GetTicksPerSecond(animation);
+		const auto frames = std::max(1, static_cast<int>(resampleRate * durationInSeconds * 1001.0 / 1000.0));
+
+		result.animations.push_back(AnimationData{ .offset = static_cast<U32>(databaseSize),
+												   .count = jointsCount,
+												   .frames = static_cast<U32>(frames),
+												   .duration = static_cast<Float>(durationInSeconds),
+												   .animationName = animation.mName.C_Str() });
+		for (auto channelIndex = 0u; channelIndex < animation.mNumChannels; channelIndex++)
+		{
+			const auto& channel = *animation.mChannels[channelIndex];
+			const auto joint = jointsByName.find(std::string_view{ channel.mNodeName.C_Str() });
+			if (joint != jointsByName.end())
+			{
+				channels.push_back(ChannelResampling{ .animationIndex = animationIndex,
+													  .channelIndex = channelIndex,
+													  .joint = joint->second });
 			}
 		}
-
-		animationDataResult.push_back(
-			AnimationData{ .offset = static_cast<uint32_t>(animationDatabase.size()),
-						   .count = static_cast<uint32_t>(skeleton.joints.size()),
-						   .frames = static_cast<uint32_t>(framesPerAnimation),
-						   .duration = (float)(animation.mDuration / animation.mTicksPerSecond),
-						   .animationName = animation.mName.C_Str() });
-		animationDatabase.insert_range(animationDatabase.end(), animationData);
+		databaseSize += static_cast<std::size_t>(frames) * jointsCount;
 	}
+	result.animationDatabase.resize(databaseSize);
 
-	return AnimationDataSet{ animationDataResult, animationDatabase };
-}
\ No newline at end of file
+	GetJobSystem().ParallelFor(
+		static_cast<U32>(channels.size()), 4,
+		[&](U32 begin, U32 end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& animation = *currentlyLoadedScene->mAnimations[channels[i].animationIndex];
+				const auto& channel = *animation.mChannels[channels[i].channelIndex];
+				const auto& clip = result.animations[channels[i].animationIndex];
+				const auto secondsPerTick = 1.0 / GetTicksPerSecond(animation);
+				const auto timePerFrame = 1.0 / resampleRate;
+				const auto first = static_cast<std::size_t>(clip.offset) + channels[i].joint;
+
+				ResampleKeys(std::span<const aiVectorKey>{ channel.mPositionKeys, channel.mNumPositionKeys },
+							 secondsPerTick, clip.frames, timePerFrame,
+							 [&](U32 frame, const aiVectorKey& a, const aiVectorKey& b, Float factor)
+							 {
+								 result.animationDatabase[first + frame * clip.count].translation =
+									 Math::Mix(ToVector3(a.mValue), ToVector3(b.mValue), factor);
+							 });
+				ResampleKeys(std::span<const aiQuatKey>{ channel.mRotationKeys, channel.mNumRotationKeys },
+							 secondsPerTick, clip.frames, timePerFrame,
+							 [&](U32 frame, const aiQuatKey& a, const aiQuatKey& b, Float factor)
+							 {
+								 result.animationDatabase[first + frame * clip.count].rotation =
+									 Math::Slerp(ToQuaternion(a.mValue), ToQuaternion(b.mValue), factor);
+							 });
+				ResampleKeys(std::span<const aiVectorKey>{ channel.mScalingKeys, channel.mNumScalingKeys },
+							 secondsPerTick, clip.frames, timePerFrame,
+							 [&](U32 frame, const aiVectorKey& a, const aiVectorKey& b, Float factor)
+							 {
+								 result.animationDatabase[first + frame * clip.count].scale =
+									 Math::Mix(ToVector3(a.mValue), ToVector3(b.mValue), factor);
+							 });
+			}
+		});
+	return result;
+}
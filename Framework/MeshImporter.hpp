@@ -4,10 +4,14 @@
 #include <assimp/scene.h>
 
 #include <filesystem>
+#include <functional>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Animation.hpp"
+#include "MeshletBuilder.hpp"
 
 
 namespace Framework
@@ -34,6 +38,34 @@ namespace Framework
 		U32 materialCount{};
 	};
 
+	enum class PositionEncoding : U8
+	{
+		float32,
+		// 16 bit per component relative to the bounds of the mesh, see VerticesStreamDescriptor.
+		unorm16
+	};
+
+	enum class DirectionEncoding : U8
+	{
+		float32,
+		// Octahedral mapping with 16 or 8 bit per component, for normals, tangents and bitangents.
+		octahedral16,
+		octahedral8
+	};
+
+	enum class TextureCoordinateEncoding : U8
+	{
+		float32,
+		float16
+	};
+
+	enum class JointWeightsEncoding : U8
+	{
+		float32,
+		// Quantized so the four weights still sum to exactly 1.
+		unorm8
+	};
+
 	struct VerticesStreamDeclaration
 	{
 		bool hasPosition{ false };
@@ -43,16 +75,63 @@ namespace Framework
 		bool hasTextureCoordinate1{ false };
 		bool hasColor{ false };
 		bool hasJointsIndexAndWeights{ false };
-		// Optional: Stream compression
+
+		PositionEncoding positionEncoding{ PositionEncoding::float32 };
+		DirectionEncoding normalEncoding{ DirectionEncoding::float32 };
+		DirectionEncoding tangentBitangentEncoding{ DirectionEncoding::float32 };
+		TextureCoordinateEncoding textureCoordinateEncoding{ TextureCoordinateEncoding::float32 };
+		JointWeightsEncoding jointWeightsEncoding{ JointWeightsEncoding::float32 };
+	};
+
+	struct MeshLodLevelSettings
+	{
+		// Fraction of the triangles of the previous level to keep.
+		Float targetRatio{ 0.5f };
+		// Largest tolerated error relative to the mesh extent, the level keeps more triangles once it is reached.
+		Float targetError{ 0.01f };
+	};
+
+	struct MeshSimplificationSettings
+	{
+		// One entry per LOD after the full detail mesh, each level is simplified from the previous one.
+		std::vector<MeshLodLevelSettings> levels;
+		// Scale of attribute differences relative to the position error, see Geometry::SimplificationAttributes.
+		Float normalWeight{ 0.5f };
+		Float textureCoordinateWeight{ 1.0f };
+		Float jointWeightsWeight{ 1.0f };
+	};
+
+	struct MeshWeldSettings
+	{
+		// Merges duplicated vertices before optimization, e.g. the ones DCC exporters write per face corner.
+		bool enabled{ false };
+		// Per attribute tolerance, vertices merge when every component of every declared attribute agrees within it,
+		// see Geometry::WeldVertices(). Joint indices always have to match exactly.
+		Float positionEpsilon{ 0.0f };
+		Float normalEpsilon{ 0.0f };
+		Float tangentBitangentEpsilon{ 0.0f };
+		Float textureCoordinateEpsilon{ 0.0f };
+		Float jointWeightsEpsilon{ 0.0f };
 	};
 
 	struct MeshImportSettings
 	{
+		// Reorders triangles and vertices for the post-transform vertex cache, overdraw and vertex fetch, see
+		// MeshOptimizer.hpp.
 		bool applyOptimization{ false };
 		std::vector<VerticesStreamDeclaration> verticesStreamDeclarations{};
-		// TODO: add simplification options for LOD mesh generation
+		MeshSimplificationSettings simplification{};
+		// Splits every LOD into clusters of at most Geometry::maxMeshletVertices vertices and
+		// Geometry::maxMeshletTriangles triangles, for cluster culling and mesh shaders.
+		bool buildMeshlets{ false };
+		MeshWeldSettings weld{};
+		// Stores the indices of meshes with at most 65536 vertices on 16 bit, see IndexFormat.
+		bool compactIndices{ false };
 	};
 
+	// Hash of every setting that changes the imported meshes, for the caches of imported data.
+	U64 HashMeshImportSettings(const MeshImportSettings& meshImportSettings);
+
 	enum class AttributeSemantic
 	{
 		position,
@@ -64,31 +143,135 @@ namespace Framework
 		jointWeight
 	};
 
+	enum class AttributeFormat : U8
+	{
+		float32x2,
+		float32x3,
+		float32x4,
+		float32x6,
+		float16x2,
+		// The fourth component is padding, so positions stay 4 byte aligned.
+		unorm16x4,
+		snorm16x2,
+		snorm16x4,
+		snorm8x2,
+		snorm8x4,
+		uint8x4,
+		unorm8x4
+	};
+
+	constexpr U32 GetAttributeFormatSize(AttributeFormat format)
+	{
+		switch (format)
+		{
+		case AttributeFormat::float32x2:
+			return 8;
+		case AttributeFormat::float32x3:
+			return 12;
+		case AttributeFormat::float32x4:
+			return 16;
+		case AttributeFormat::float32x6:
+			return 24;
+		case AttributeFormat::unorm16x4:
+		case AttributeFormat::snorm16x4:
+			return 8;
+		case AttributeFormat::snorm8x2:
+			return 2;
+		case AttributeFormat::float16x2:
+		case AttributeFormat::snorm16x2:
+		case AttributeFormat::snorm8x4:
+		case AttributeFormat::uint8x4:
+		case AttributeFormat::unorm8x4:
+			return 4;
+		}
+		return 0;
+	}
+
 	struct AttributeDescriptor
 	{
 		AttributeSemantic semantic{ AttributeSemantic::position };
+		// Attributes start on 4 byte boundaries, so shaders can fetch vertices as 32 bit words.
 		U32 offset{ 0 };
 		U32 stride{ 12 };
-		U8 componentSize{ 12 };
-		U8 componentCount{ 3 };
+		AttributeFormat format{ AttributeFormat::float32x3 };
 	};
 
 	struct VerticesStreamDescriptor
 	{
 		std::vector<AttributeDescriptor> attributes;
+		// unorm16 positions decode to positionMinimum + value * positionExtent.
+		Math::Vector3 positionMinimum{ 0.0f };
+		Math::Vector3 positionExtent{ 1.0f };
 	};
 
 	using StreamDataBuffer = std::vector<std::byte>;
 
+	enum class IndexFormat : U8
+	{
+		uint32,
+		uint16
+	};
+
+	constexpr U32 GetIndexSize(IndexFormat format)
+	{
+		return format == IndexFormat::uint16 ? 2 : 4;
+	}
+
 	struct VertexStream
 	{
 		VerticesStreamDescriptor streamDescriptor;
 		StreamDataBuffer data;
 	};
+	struct MeshLod
+	{
+		// Range of the LOD in MeshData::indexStream, in indices. All LODs index the same vertex streams.
+		U32 indicesOffset{ 0 };
+		U32 indicesCount{ 0 };
+		// Simplification error relative to the mesh extent, 0 for the full detail mesh.
+		Float error{ 0.0f };
+		// Range of the LOD in MeshData::meshlets when they are built. Together with the error this forms the
+		// cluster hierarchy: each level's clusters cover the whole mesh, coarser levels with fewer clusters.
+		U32 meshletOffset{ 0 };
+		U32 meshletCount{ 0 };
+	};
+
 	struct MeshData
 	{
 		std::vector<VertexStream> streams;
 		StreamDataBuffer indexStream;
+		IndexFormat indexFormat{ IndexFormat::uint32 };
+		// Ordered from the most detailed level, empty when the mesh has no index stream.
+		std::vector<MeshLod> lods;
+		// Meshlet vertices index the vertex streams, like indexStream does.
+		Geometry::Meshlets meshlets;
+	};
+
+	enum class MeshStreamKind : U8
+	{
+		indices,
+		vertices
+	};
+
+	struct MeshStreamChunk
+	{
+		MeshStreamKind kind{ MeshStreamKind::indices };
+		// Vertex stream declaration the chunk belongs to, 0 for indices.
+		U32 streamIndex{ 0 };
+		// Position of the chunk in its stream, in bytes.
+		U64 offset{ 0 };
+		// The chunk occupies the first size bytes of the streaming destination.
+		U64 size{ 0 };
+	};
+
+	// Consumes a chunk from the streaming destination, which is overwritten by the next chunk once this returns.
+	using MeshStreamSink = std::function<void(const MeshStreamChunk&)>;
+
+	struct StreamedMesh
+	{
+		std::vector<VerticesStreamDescriptor> streamDescriptors;
+		U32 verticesCount{ 0 };
+		U32 indicesCount{ 0 };
+		IndexFormat indexFormat{ IndexFormat::uint32 };
 	};
 
 	struct AssetImporter final
@@ -100,7 +283,28 @@ namespace Framework
 		AssetImporter(AssetImporter&&) = delete;
 
 		MeshData ImportMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings);
+		// Same result as calling ImportMesh() for each index, but post-processes the scene once and builds the
+		// meshes in parallel on the shared JobSystem.
+		std::vector<MeshData> ImportMeshes(std::span<const U32> meshIndices,
+										   const MeshImportSettings& meshImportSettings);
+		// Hash of everything the streams of a mesh are built from, identical meshes match even across files.
+		U64 HashMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings);
+		// Whether two meshes of the scene have everything HashMesh() hashes in common, equal hashes may collide.
+		bool HasSameMeshContent(U32 meshIndex, U32 otherMeshIndex, const MeshImportSettings& meshImportSettings);
+		/*
+		 * Writes the interleaved vertices and the indices of a mesh straight into destination, e.g. a mapped staging
+		 * buffer, and hands every filled chunk to sink. The index stream comes first, then the vertex streams in
+		 * declaration order, chunks never split a vertex or a triangle. Besides the scene itself, memory stays
+		 * bounded regardless of the mesh size, so welding, optimization, LODs and meshlets are not supported.
+		 */
+		StreamedMesh StreamMesh(U32 meshIndex, const MeshImportSettings& meshImportSettings,
+								std::span<std::byte> destination, const MeshStreamSink& sink);
 		Animation::Skeleton ImportSkeleton(U32 meshIndex);
+		/*
+		 * Applies in one pass every post-processing step the meshes of the scene need for these settings. Optional,
+		 * imports apply what they miss themselves, but importing mesh by mesh then post-processes the scene repeatedly.
+		 */
+		void PostProcessScene(const MeshImportSettings& meshImportSettings);
 		Animation::AnimationDataSet LoadAllAnimations(const Animation::Skeleton& skeleton, const int resampleRate);
 
 		const SceneInformation& GetSceneInformation() const
@@ -113,9 +317,31 @@ namespace Framework
 			return currentlyLoadedScene != nullptr;
 		}
 
+		// Skinned meshes have bones, ImportSkeleton() needs them.
+		bool HasBones(U32 meshIndex) const
+		{
+			return currentlyLoadedScene->mMeshes[meshIndex]->HasBones();
+		}
+
 	private:
+		struct MeshSkinning
+		{
+			Animation::Skeleton skeleton;
+			// Joint of each bone of the mesh.
+			std::vector<I16> boneJoints;
+		};
+
+		// Applies only the steps that did not run yet, Assimp would run them again.
+		void ApplyPostProcessing(unsigned int flags);
+		const MeshSkinning& GetMeshSkinning(U32 meshIndex);
+		// Empty when the settings need no joints or the mesh has no bones.
+		std::span<const I16> GetBoneJoints(U32 meshIndex, const MeshImportSettings& meshImportSettings);
+
 		const aiScene* currentlyLoadedScene{ nullptr };
 		SceneInformation sceneInformation{};
 		Assimp::Importer importer;
+		unsigned int appliedPostProcessingFlags{ 0 };
+		// Built on first use by mesh, post-processing drops them as it can change the scene.
+		std::unordered_map<U32, MeshSkinning> meshSkinnings;
 	};
 } // namespace Framework
\ No newline at end of file
@@ -0,0 +1,799 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "Profiler.hpp"
+
+using namespace Framework;
+using namespace Framework::Geometry;
+
+namespace
+{
+	constexpr auto invalidIndex = std::numeric_limits<U32>::max();
+
+	// Cache size the Forsyth scores are tuned for, larger than real FIFO caches so the result degrades gracefully.
+	constexpr auto scoringCacheSize = 32u;
+	constexpr auto overdrawCacheSize = 16u;
+
+	Float ComputeVertexScore(I32 cachePosition, U32 remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		auto score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// The vertices of the last triangle get a fixed score, so the next triangle does not just reuse its
+			// edge and produce long strips.
+			score = cachePosition < 3 ?
+				0.75f :
+				std::pow(1.0f - static_cast<Float>(cachePosition - 3) / static_cast<Float>(scoringCacheSize - 3),
+						 1.5f);
+		}
+		// Favours vertices with few remaining triangles so lonely triangles are not left behind.
+		return score + 2.0f / std::sqrt(static_cast<Float>(remainingTriangles));
+	}
+
+	// FIFO cache simulation with timestamps: a vertex is cached while fewer than cacheSize misses happened since
+	// its own.
+	struct FifoCache
+	{
+		FifoCache(U32 verticesCount, U32 cacheSize)
+			: timestamps(verticesCount, 0), time{ cacheSize + 1 }, cacheSize{ cacheSize }
+		{
+		}
+
+		// Returns 1 for a miss.
+		U32 Access(U32 vertex)
+		{
+			if (time - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		U32 AccessTriangle(const U32* triangle)
+		{
+			return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+		}
+
+		void Flush()
+		{
+			time += cacheSize + 1;
+		}
+
+		std::vector<U32> timestamps;
+		U32 time;
+		U32 cacheSize;
+	};
+
+	// Sum of squared distances to a set of weighted planes, stored as the upper half of a symmetric 4x4 matrix.
+	struct Quadric
+	{
+		static Quadric FromTriangle(const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+		{
+			const auto areaNormal = glm::cross(b - a, c - a);
+			const auto doubleArea = glm::length(areaNormal);
+			if (doubleArea == 0.0f)
+			{
+				return Quadric{};
+			}
+			const auto normal = areaNormal / doubleArea;
+			const auto distance = -glm::dot(normal, a);
+			const auto weight = 0.5f * doubleArea;
+			return Quadric{ .xx = weight * normal.x * normal.x,
+							.yy = weight * normal.y * normal.y,
+							.zz = weight * normal.z * normal.z,
+							.xy = weight * normal.x * normal.y,
+							.xz = weight * normal.x * normal.z,
+							.yz = weight * normal.y * normal.z,
+							.xw = weight * normal.x * distance,
+							.yw = weight * normal.y * distance,
+							.zw = weight * normal.z * distance,
+							.ww = weight * distance * distance,
+							.weight = weight };
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			xx += other.xx;
+			yy += other.yy;
+			zz += other.zz;
+			xy += other.xy;
+			xz += other.xz;
+			yz += other.yz;
+			xw += other.xw;
+			yw += other.yw;
+			zw += other.zw;
+			ww += other.ww;
+			weight += other.weight;
+			return *this;
+		}
+
+		// Area weighted mean of the squared plane distances, so the error has the unit of a squared distance.
+		Float Evaluate(const Math::Vector3& p) const
+		{
+			if (weight == 0.0f)
+			{
+				return 0.0f;
+			}
+			const auto error = xx * p.x * p.x + yy * p.y * p.y + zz * p.z * p.z +
+				2.0f * (xy * p.x * p.y + xz * p.x * p.z + yz * p.y * p.z + xw * p.x + yw * p.y + zw * p.z) + ww;
+			return std::max(error, 0.0f) / weight;
+		}
+
+		Float xx{ 0.0f };
+		Float yy{ 0.0f };
+		Float zz{ 0.0f };
+		Float xy{ 0.0f };
+		Float xz{ 0.0f };
+		Float yz{ 0.0f };
+		Float xw{ 0.0f };
+		Float yw{ 0.0f };
+		Float zw{ 0.0f };
+		Float ww{ 0.0f };
+		Float weight{ 0.0f };
+	};
+
+	Float ComputeJointWeightsDistance(const std::array<U8, 4>& jointsA, const Math::Vector4& weightsA,
+									  const std::array<U8, 4>& jointsB, const Math::Vector4& weightsB)
+	{
+		const auto GetJoint = [&](U32 slot) { return slot < 4 ? jointsA[slot] : jointsB[slot - 4]; };
+
+		// Half the L1 distance of the sparse weight vectors: 0 for equal skinning, 1 for disjoint joints. Unused
+		// slots repeat a joint with weight 0, so each joint is summed up once, at its first slot.
+		auto distance = 0.0f;
+		for (auto slot = 0u; slot < 8; slot++)
+		{
+			const auto joint = GetJoint(slot);
+			auto isFirstSlot = true;
+			for (auto previous = 0u; previous < slot; previous++)
+			{
+				isFirstSlot = isFirstSlot and GetJoint(previous) != joint;
+			}
+			if (not isFirstSlot)
+			{
+				continue;
+			}
+
+			auto weightA = 0.0f;
+			auto weightB = 0.0f;
+			for (auto i = 0; i < 4; i++)
+			{
+				weightA += jointsA[i] == joint ? weightsA[i] : 0.0f;
+				weightB += jointsB[i] == joint ? weightsB[i] : 0.0f;
+			}
+			distance += std::abs(weightA - weightB);
+		}
+		return 0.5f * distance;
+	}
+
+	U64 MakeEdgeKey(U32 a, U32 b)
+	{
+		return a < b ? (U64{ a } << 32) | b : (U64{ b } << 32) | a;
+	}
+} // namespace
+
+VertexCacheStatistics Geometry::AnalyzeVertexCache(std::span<const U32> indices, U32 verticesCount, U32 cacheSize)
+{
+	assert(indices.size() % 3 == 0);
+	auto cache = FifoCache{ verticesCount, cacheSize };
+	auto isReferenced = std::vector<U8>(verticesCount, 0);
+	auto misses = 0u;
+	auto referencedCount = 0u;
+	for (const auto index : indices)
+	{
+		assert(index < verticesCount);
+		misses += cache.Access(index);
+		referencedCount += isReferenced[index] == 0 ? 1 : 0;
+		isReferenced[index] = 1;
+	}
+
+	if (indices.empty())
+	{
+		return {};
+	}
+	return VertexCacheStatistics{ .acmr = static_cast<Float>(misses) / static_cast<Float>(indices.size() / 3),
+								  .atvr = static_cast<Float>(misses) / static_cast<Float>(referencedCount) };
+}
+
+void Geometry::OptimizeVertexCache(std::span<U32> indices, U32 verticesCount)
+{
+	ZoneScoped;
+	assert(indices.size() % 3 == 0);
+	const auto trianglesCount = static_cast<U32>(indices.size() / 3);
+	if (trianglesCount == 0)
+	{
+		return;
+	}
+
+	const auto input = std::vector<U32>(indices.begin(), indices.end());
+
+	// Triangles adjacent to each vertex, the first remainingTriangles[v] entries of a range are not emitted yet.
+	auto remainingTriangles = std::vector<U32>(verticesCount, 0);
+	for (const auto index : input)
+	{
+		assert(index < verticesCount);
+		remainingTriangles[index]++;
+	}
+	auto adjacencyOffsets = std::vector<U32>(verticesCount + 1, 0);
+	for (auto vertex = 0u; vertex < verticesCount; vertex++)
+	{
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangles[vertex];
+	}
+	auto adjacency = std::vector<U32>(input.size());
+	{
+		auto cursors = std::vector<U32>(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (auto i = 0u; i < input.size(); i++)
+		{
+			adjacency[cursors[input[i]]++] = i / 3;
+		}
+	}
+
+	auto cachePositions = std::vector<I32>(verticesCount, -1);
+	auto vertexScores = std::vector<Float>(verticesCount);
+	for (auto vertex = 0u; vertex < verticesCount; vertex++)
+	{
+		vertexScores[vertex] = ComputeVertexScore(-1, remainingTriangles[vertex]);
+	}
+
+	const auto ComputeTriangleScore = [&](U32 triangle)
+	{
+		return vertexScores[input[triangle * 3 + 0]] + vertexScores[input[triangle * 3 + 1]] +
+			vertexScores[input[triangle * 3 + 2]];
+	};
+
+	auto triangleScores = std::vector<Float>(trianglesCount);
+	auto isEmitted = std::vector<U8>(trianglesCount, 0);
+	auto bestTriangle = U32{ 0 };
+	for (auto triangle = 0u; triangle < trianglesCount; triangle++)
+	{
+		triangleScores[triangle] = ComputeTriangleScore(triangle);
+		if (triangleScores[triangle] > triangleScores[bestTriangle])
+		{
+			bestTriangle = triangle;
+		}
+	}
+
+	auto cache = std::vector<U32>{};
+	auto nextCache = std::vector<U32>{};
+	cache.reserve(scoringCacheSize + 3);
+	nextCache.reserve(scoringCacheSize + 3);
+	auto fallbackCursor = U32{ 0 };
+
+	for (auto output = 0u; output < trianglesCount; output++)
+	{
+		if (bestTriangle == invalidIndex)
+		{
+			// Nothing adjacent to the cache is left, continue with the next triangle in input order.
+			while (isEmitted[fallbackCursor] != 0)
+			{
+				fallbackCursor++;
+			}
+			bestTriangle = fallbackCursor;
+		}
+
+		const auto* triangle = &input[bestTriangle * 3];
+		std::copy_n(triangle, 3, indices.data() + output * 3);
+		isEmitted[bestTriangle] = 1;
+
+		nextCache.clear();
+		for (auto corner = 0u; corner < 3; corner++)
+		{
+			const auto vertex = triangle[corner];
+			const auto begin = adjacency.begin() + adjacencyOffsets[vertex];
+			const auto end = begin + remainingTriangles[vertex];
+			const auto found = std::find(begin, end, bestTriangle);
+			assert(found != end);
+			std::iter_swap(found, end - 1);
+			remainingTriangles[vertex]--;
+
+			if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+			{
+				nextCache.push_back(vertex);
+			}
+		}
+		const auto emittedCount = nextCache.size();
+		for (const auto vertex : cache)
+		{
+			const auto emittedEnd = nextCache.begin() + emittedCount;
+			if (std::find(nextCache.begin(), emittedEnd, vertex) == emittedEnd)
+			{
+				nextCache.push_back(vertex);
+			}
+		}
+
+		// Entries past the cache size were just evicted and are updated once more to drop their cache bonus.
+		for (auto i = 0u; i < nextCache.size(); i++)
+		{
+			const auto vertex = nextCache[i];
+			cachePositions[vertex] = i < scoringCacheSize ? static_cast<I32>(i) : -1;
+			vertexScores[vertex] = ComputeVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+		}
+
+		bestTriangle = invalidIndex;
+		auto bestScore = -1.0f;
+		for (const auto vertex : nextCache)
+		{
+			const auto begin = adjacencyOffsets[vertex];
+			for (auto i = begin; i < begin + remainingTriangles[vertex]; i++)
+			{
+				const auto adjacent = adjacency[i];
+				triangleScores[adjacent] = ComputeTriangleScore(adjacent);
+				if (triangleScores[adjacent] > bestScore)
+				{
+					bestScore = triangleScores[adjacent];
+					bestTriangle = adjacent;
+				}
+			}
+		}
+
+		if (nextCache.size() > scoringCacheSize)
+		{
+			nextCache.resize(scoringCacheSize);
+		}
+		std::swap(cache, nextCache);
+	}
+}
+
+void Geometry::OptimizeOverdraw(std::span<U32> indices, std::span<const Math::Vector3> positions, Float threshold)
+{
+	ZoneScoped;
+	assert(indices.size() % 3 == 0);
+	const auto trianglesCount = static_cast<U32>(indices.size() / 3);
+	const auto verticesCount = static_cast<U32>(positions.size());
+	if (trianglesCount == 0)
+	{
+		return;
+	}
+
+	// Hard boundaries are the triangles on which the vertex cache starts over, reordering there costs nothing.
+	auto cache = FifoCache{ verticesCount, overdrawCacheSize };
+	auto hardBoundaries = std::vector<U32>{};
+	for (auto triangle = 0u; triangle < trianglesCount; triangle++)
+	{
+		if (cache.AccessTriangle(&indices[triangle * 3]) == 3)
+		{
+			hardBoundaries.push_back(triangle);
+		}
+	}
+	if (hardBoundaries.empty() or hardBoundaries.front() != 0)
+	{
+		hardBoundaries.insert(hardBoundaries.begin(), 0);
+	}
+	hardBoundaries.push_back(trianglesCount);
+
+	// Soft boundaries split hard clusters further as long as the pieces stay within the ACMR budget.
+	auto clusters = std::vector<U32>{};
+	for (auto i = 0u; i + 1 < hardBoundaries.size(); i++)
+	{
+		const auto begin = hardBoundaries[i];
+		const auto end = hardBoundaries[i + 1];
+
+		cache.Flush();
+		auto clusterMisses = 0u;
+		for (auto triangle = begin; triangle < end; triangle++)
+		{
+			clusterMisses += cache.AccessTriangle(&indices[triangle * 3]);
+		}
+		const auto acmrBudget = threshold * static_cast<Float>(clusterMisses) / static_cast<Float>(end - begin);
+
+		cache.Flush();
+		clusters.push_back(begin);
+		auto start = begin;
+		auto misses = 0u;
+		for (auto triangle = begin; triangle < end; triangle++)
+		{
+			misses += cache.AccessTriangle(&indices[triangle * 3]);
+			if (triangle + 1 < end and
+				static_cast<Float>(misses) / static_cast<Float>(triangle + 1 - start) <= acmrBudget)
+			{
+				clusters.push_back(triangle + 1);
+				start = triangle + 1;
+				misses = 0;
+				cache.Flush();
+			}
+		}
+	}
+	clusters.push_back(trianglesCount);
+
+	auto meshCentroid = Math::Vector3{ 0.0f };
+	for (const auto index : indices)
+	{
+		meshCentroid += positions[index];
+	}
+	meshCentroid /= static_cast<Float>(indices.size());
+
+	// Clusters facing away from the center of the mesh are likely to occlude the others and are drawn first.
+	struct Cluster
+	{
+		U32 begin;
+		U32 end;
+		Float sortKey;
+	};
+	auto sortedClusters = std::vector<Cluster>{};
+	sortedClusters.reserve(clusters.size() - 1);
+	for (auto i = 0u; i + 1 < clusters.size(); i++)
+	{
+		auto centroid = Math::Vector3{ 0.0f };
+		auto normal = Math::Vector3{ 0.0f };
+		auto area = 0.0f;
+		for (auto triangle = clusters[i]; triangle < clusters[i + 1]; triangle++)
+		{
+			const auto& a = positions[indices[triangle * 3 + 0]];
+			const auto& b = positions[indices[triangle * 3 + 1]];
+			const auto& c = positions[indices[triangle * 3 + 2]];
+			const auto areaNormal = glm::cross(b - a, c - a);
+			const auto triangleArea = glm::length(areaNormal);
+
+			centroid += (a + b + c) * (triangleArea / 3.0f);
+			normal += areaNormal;
+			area += triangleArea;
+		}
+		const auto normalLength = glm::length(normal);
+		const auto sortKey = area > 0.0f and normalLength > 0.0f ?
+			glm::dot(centroid / area - meshCentroid, normal / normalLength) :
+			std::numeric_limits<Float>::lowest();
+		sortedClusters.push_back(Cluster{ clusters[i], clusters[i + 1], sortKey });
+	}
+	std::ranges::stable_sort(sortedClusters, [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+	const auto input = std::vector<U32>(indices.begin(), indices.end());
+	auto output = indices.begin();
+	for (const auto& cluster : sortedClusters)
+	{
+		output = std::copy(input.begin() + cluster.begin * 3, input.begin() + cluster.end * 3, output);
+	}
+}
+
+std::vector<U32> Geometry::OptimizeVertexFetch(std::span<U32> indices, U32 verticesCount)
+{
+	ZoneScoped;
+	auto oldToNewVertex = std::vector<U32>(verticesCount, invalidIndex);
+	auto newToOldVertex = std::vector<U32>{};
+	newToOldVertex.reserve(verticesCount);
+	for (auto& index : indices)
+	{
+		assert(index < verticesCount);
+		if (oldToNewVertex[index] == invalidIndex)
+		{
+			oldToNewVertex[index] = static_cast<U32>(newToOldVertex.size());
+			newToOldVertex.push_back(index);
+		}
+		index = oldToNewVertex[index];
+	}
+	return newToOldVertex;
+}
+
+std::vector<U32> Geometry::WeldVertices(std::span<U32> indices, std::span<const Float> vertices, U32 stride,
+										 std::span<const Float> epsilons)
+{
+	ZoneScoped;
+	assert(stride > 0 and vertices.size() % stride == 0);
+	assert(epsilons.size() == stride);
+	const auto verticesCount = static_cast<U32>(vertices.size() / stride);
+
+	auto cells = std::vector<I64>(vertices.size());
+	for (auto i = 0u; i < vertices.size(); i++)
+	{
+		const auto epsilon = epsilons[i % stride];
+		// Adding 0 turns -0 into +0, so both get the same bits.
+		cells[i] = epsilon > 0.0f ? static_cast<I64>(std::round(vertices[i] / epsilon)) :
+									static_cast<I64>(std::bit_cast<U32>(vertices[i] + 0.0f));
+	}
+	const auto GetCells = [&](U32 vertex) { return std::span{ cells }.subspan(vertex * stride, stride); };
+
+	// Open addressing over vertex indices, at most half full.
+	const auto tableSize = std::bit_ceil(std::max(verticesCount * 2, 2u));
+	auto table = std::vector<U32>(tableSize, invalidIndex);
+	auto representatives = std::vector<U32>(verticesCount);
+	for (auto vertex = 0u; vertex < verticesCount; vertex++)
+	{
+		auto hash = U64{ 0 };
+		for (const auto cell : GetCells(vertex))
+		{
+			hash = (hash ^ static_cast<U64>(cell)) * 0x9E37'79B9'7F4A'7C15ull;
+		}
+		auto slot = static_cast<U32>(hash ^ (hash >> 32)) & (tableSize - 1);
+		while (table[slot] != invalidIndex and not std::ranges::equal(GetCells(table[slot]), GetCells(vertex)))
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == invalidIndex)
+		{
+			table[slot] = vertex;
+		}
+		representatives[vertex] = table[slot];
+	}
+
+	for (auto& index : indices)
+	{
+		assert(index < verticesCount);
+		index = representatives[index];
+	}
+	return OptimizeVertexFetch(indices, verticesCount);
+}
+
+SimplifiedMesh Geometry::Simplify(std::span<const U32> indices, std::span<const Math::Vector3> positions,
+								  U32 targetIndicesCount, Float targetError, const SimplificationAttributes& attributes)
+{
+	ZoneScoped;
+	assert(indices.size() % 3 == 0);
+	assert(attributes.values.size() == attributes.stride * positions.size());
+	assert(attributes.weights.size() == attributes.stride);
+	assert(attributes.jointIndices.size() == attributes.jointWeights.size());
+	const auto verticesCount = static_cast<U32>(positions.size());
+
+	auto result = SimplifiedMesh{ .indices = std::vector<U32>(indices.begin(), indices.end()) };
+	if (result.indices.size() <= targetIndicesCount)
+	{
+		return result;
+	}
+
+	// Errors are measured on the mesh scaled to a unit extent, so thresholds do not depend on the asset units.
+	auto minimum = positions.empty() ? Math::Vector3{ 0.0f } : positions.front();
+	auto maximum = minimum;
+	for (const auto& position : positions)
+	{
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+	const auto extent = std::max({ maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z });
+	const auto scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+	auto scaledPositions = std::vector<Math::Vector3>(verticesCount);
+	for (auto vertex = 0u; vertex < verticesCount; vertex++)
+	{
+		scaledPositions[vertex] = (positions[vertex] - minimum) * scale;
+	}
+
+	// Vertices sharing a position sit on an attribute seam, moving one of them alone would open a crack.
+	auto isLocked = std::vector<U8>(verticesCount, 0);
+	auto positionRepresentatives = std::vector<U32>(verticesCount);
+	{
+		auto sortedVertices = std::vector<U32>(verticesCount);
+		for (auto vertex = 0u; vertex < verticesCount; vertex++)
+		{
+			sortedVertices[vertex] = vertex;
+		}
+		const auto PositionLess = [&](U32 a, U32 b)
+		{
+			const auto& pa = positions[a];
+			const auto& pb = positions[b];
+			return std::tie(pa.x, pa.y, pa.z) < std::tie(pb.x, pb.y, pb.z);
+		};
+		std::ranges::sort(sortedVertices, PositionLess);
+		for (auto begin = 0u; begin < verticesCount;)
+		{
+			auto end = begin + 1;
+			while (end < verticesCount and positions[sortedVertices[end]] == positions[sortedVertices[begin]])
+			{
+				end++;
+			}
+			for (auto i = begin; i < end; i++)
+			{
+				positionRepresentatives[sortedVertices[i]] = sortedVertices[begin];
+				isLocked[sortedVertices[i]] = end - begin > 1 ? 1 : 0;
+			}
+			begin = end;
+		}
+	}
+
+	// Edges used by a single triangle are on an open border, which keeps its shape.
+	{
+		auto edges = std::vector<U64>{};
+		edges.reserve(indices.size());
+		for (auto i = 0u; i < indices.size(); i += 3)
+		{
+			for (auto corner = 0u; corner < 3; corner++)
+			{
+				edges.push_back(MakeEdgeKey(positionRepresentatives[indices[i + corner]],
+											positionRepresentatives[indices[i + (corner + 1) % 3]]));
+			}
+		}
+		std::ranges::sort(edges);
+		auto isBorderRepresentative = std::vector<U8>(verticesCount, 0);
+		for (auto begin = 0u; begin < edges.size();)
+		{
+			auto end = begin + 1;
+			while (end < edges.size() and edges[end] == edges[begin])
+			{
+				end++;
+			}
+			if (end - begin == 1)
+			{
+				isBorderRepresentative[edges[begin] >> 32] = 1;
+				isBorderRepresentative[edges[begin] & 0xFFFF'FFFF] = 1;
+			}
+			begin = end;
+		}
+		for (auto vertex = 0u; vertex < verticesCount; vertex++)
+		{
+			isLocked[vertex] |= isBorderRepresentative[positionRepresentatives[vertex]];
+		}
+	}
+
+	auto quadrics = std::vector<Quadric>(verticesCount);
+	for (auto i = 0u; i < indices.size(); i += 3)
+	{
+		const auto quadric = Quadric::FromTriangle(scaledPositions[indices[i]], scaledPositions[indices[i + 1]],
+												   scaledPositions[indices[i + 2]]);
+		for (auto corner = 0u; corner < 3; corner++)
+		{
+			quadrics[indices[i + corner]] += quadric;
+		}
+	}
+
+	const auto ComputeCollapseError = [&](U32 from, U32 to)
+	{
+		auto error = quadrics[from].Evaluate(scaledPositions[to]);
+		for (auto i = 0u; i < attributes.stride; i++)
+		{
+			const auto difference =
+				attributes.values[from * attributes.stride + i] - attributes.values[to * attributes.stride + i];
+			error += attributes.weights[i] * difference * difference;
+		}
+		if (not attributes.jointIndices.empty())
+		{
+			const auto distance =
+				ComputeJointWeightsDistance(attributes.jointIndices[from], attributes.jointWeights[from],
+											attributes.jointIndices[to], attributes.jointWeights[to]);
+			error += attributes.jointWeightsWeight * distance * distance;
+		}
+		return error;
+	};
+
+	struct Collapse
+	{
+		U32 from;
+		U32 to;
+		Float error;
+	};
+	auto collapses = std::vector<Collapse>{};
+	auto adjacencyOffsets = std::vector<U32>(verticesCount + 1);
+	auto adjacency = std::vector<U32>{};
+	auto collapseTargets = std::vector<U32>(verticesCount);
+	auto isTouched = std::vector<U8>(verticesCount);
+	const auto maximumError = targetError * targetError;
+	auto largestError = 0.0f;
+
+	// Each pass collapses the cheapest independent edges, then rebuilds the index buffer.
+	while (result.indices.size() > targetIndicesCount)
+	{
+		auto& current = result.indices;
+		const auto trianglesCount = static_cast<U32>(current.size() / 3);
+
+		std::ranges::fill(adjacencyOffsets, 0);
+		for (const auto index : current)
+		{
+			adjacencyOffsets[index + 1]++;
+		}
+		for (auto vertex = 0u; vertex < verticesCount; vertex++)
+		{
+			adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+		}
+		adjacency.resize(current.size());
+		{
+			auto cursors = std::vector<U32>(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (auto i = 0u; i < current.size(); i++)
+			{
+				adjacency[cursors[current[i]]++] = i / 3;
+			}
+		}
+
+		collapses.clear();
+		for (auto i = 0u; i < current.size(); i += 3)
+		{
+			for (auto corner = 0u; corner < 3; corner++)
+			{
+				const auto a = current[i + corner];
+				const auto b = current[i + (corner + 1) % 3];
+				if (isLocked[a] == 0)
+				{
+					collapses.push_back(Collapse{ a, b, ComputeCollapseError(a, b) });
+				}
+				if (isLocked[b] == 0)
+				{
+					collapses.push_back(Collapse{ b, a, ComputeCollapseError(b, a) });
+				}
+			}
+		}
+		std::ranges::sort(collapses, [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+		// A collapse must not flip any of the remaining triangles around the vertex it removes.
+		const auto IsCollapseValid = [&](U32 from, U32 to, U32& removedTriangles)
+		{
+			removedTriangles = 0;
+			for (auto i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++)
+			{
+				const auto* triangle = &current[adjacency[i] * 3];
+				if (triangle[0] == to or triangle[1] == to or triangle[2] == to)
+				{
+					removedTriangles++;
+					continue;
+				}
+				auto moved = std::array{ scaledPositions[triangle[0]], scaledPositions[triangle[1]],
+										 scaledPositions[triangle[2]] };
+				const auto before = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				for (auto corner = 0u; corner < 3; corner++)
+				{
+					moved[corner] = triangle[corner] == from ? scaledPositions[to] : moved[corner];
+				}
+				const auto after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				if (glm::dot(before, after) <= 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		std::ranges::fill(isTouched, 0);
+		for (auto vertex = 0u; vertex < verticesCount; vertex++)
+		{
+			collapseTargets[vertex] = vertex;
+		}
+		const auto trianglesToRemove = trianglesCount - targetIndicesCount / 3;
+		auto removedTriangles = 0u;
+		for (const auto& collapse : collapses)
+		{
+			if (collapse.error > maximumError or removedTriangles >= trianglesToRemove)
+			{
+				break;
+			}
+			if (isTouched[collapse.from] != 0 or isTouched[collapse.to] != 0)
+			{
+				continue;
+			}
+			auto collapseRemovedTriangles = 0u;
+			if (not IsCollapseValid(collapse.from, collapse.to, collapseRemovedTriangles))
+			{
+				continue;
+			}
+
+			collapseTargets[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			removedTriangles += collapseRemovedTriangles;
+			largestError = std::max(largestError, collapse.error);
+
+			// The triangles around the removed vertex changed, collapses checked against them are stale.
+			for (auto i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; i++)
+			{
+				const auto* triangle = &current[adjacency[i] * 3];
+				isTouched[triangle[0]] = 1;
+				isTouched[triangle[1]] = 1;
+				isTouched[triangle[2]] = 1;
+			}
+		}
+		if (removedTriangles == 0)
+		{
+			break;
+		}
+
+		auto write = 0u;
+		for (auto i = 0u; i < current.size(); i += 3)
+		{
+			const auto a = collapseTargets[current[i]];
+			const auto b = collapseTargets[current[i + 1]];
+			const auto c = collapseTargets[current[i + 2]];
+			if (a != b and b != c and a != c)
+			{
+				current[write++] = a;
+				current[write++] = b;
+				current[write++] = c;
+			}
+		}
+		current.resize(write);
+	}
+
+	result.error = std::sqrt(largestError);
+	return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+#include "Math.hpp"
+
+namespace Framework
+{
+	namespace Geometry
+	{
+		struct VertexCacheStatistics
+		{
+			// Average cache miss ratio: transformed vertices per triangle, 0.5 is the best a regular grid reaches.
+			Float acmr{ 0.0f };
+			// Average transform to vertex ratio: transformed vertices per referenced vertex, 1 is optimal.
+			Float atvr{ 0.0f };
+		};
+
+		// Simulates a FIFO post-transform cache, which is what most hardware behaves closest to.
+		VertexCacheStatistics AnalyzeVertexCache(std::span<const U32> indices, U32 verticesCount,
+												 U32 cacheSize = 16);
+
+		// Reorders triangles with Forsyth's linear-speed vertex cache optimization.
+		void OptimizeVertexCache(std::span<U32> indices, U32 verticesCount);
+
+		/*
+		 * Reorders the clusters of a vertex cache optimized index buffer so the ones facing outwards are drawn first,
+		 * following Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw". Clusters are
+		 * split further as long as their ACMR stays below threshold times the ACMR of the input, so a threshold of
+		 * 1.05 trades at most 5% vertex cache efficiency for less overdraw.
+		 */
+		void OptimizeOverdraw(std::span<U32> indices, std::span<const Math::Vector3> positions,
+							  Float threshold = 1.05f);
+
+		// Renumbers vertices in order of first use and rewrites indices accordingly. Returns the old index of each
+		// new vertex, unreferenced vertices are dropped.
+		std::vector<U32> OptimizeVertexFetch(std::span<U32> indices, U32 verticesCount);
+
+		/*
+		 * Merges vertices whose attributes agree within a per component epsilon. vertices holds stride floats per
+		 * vertex and epsilons one value per float. Components are rounded to multiples of epsilon and hashed, so
+		 * merged vertices differ by at most epsilon, while two vertices closer than that can still round apart. An
+		 * epsilon of 0 merges exactly equal components only. Rewrites indices like OptimizeVertexFetch() and returns
+		 * the old index of each new vertex, the first one of every merged group.
+		 */
+		std::vector<U32> WeldVertices(std::span<U32> indices, std::span<const Float> vertices, U32 stride,
+									  std::span<const Float> epsilons);
+
+		struct SimplificationAttributes
+		{
+			// stride floats per vertex, e.g. normal and texture coordinate.
+			std::span<const Float> values;
+			U32 stride{ 0 };
+			// One weight per float of stride, scales its squared difference relative to the position error.
+			std::span<const Float> weights;
+
+			// Optional skinning, a collapse then also costs the squared amount of joint weight it moves.
+			std::span<const std::array<U8, 4>> jointIndices;
+			std::span<const Math::Vector4> jointWeights;
+			Float jointWeightsWeight{ 1.0f };
+		};
+
+		struct SimplifiedMesh
+		{
+			std::vector<U32> indices;
+			// Largest collapse error, relative to the extent of the mesh.
+			Float error{ 0.0f };
+		};
+
+		/*
+		 * Quadric error metric simplification with half edge collapses, so the result indexes a subset of the input
+		 * vertices and LODs can share one vertex buffer. Vertices on open borders or attribute seams (vertices
+		 * sharing a position) keep their place. Stops once the result has at most targetIndicesCount indices or the
+		 * next collapse would exceed targetError, relative to the extent of the mesh.
+		 */
+		SimplifiedMesh Simplify(std::span<const U32> indices, std::span<const Math::Vector3> positions,
+								U32 targetIndicesCount, Float targetError,
+								const SimplificationAttributes& attributes = {});
+
+		// Reorders an interleaved vertex buffer with the result of OptimizeVertexFetch().
+		template <typename Element>
+		std::vector<Element> RemapVertices(std::span<const Element> vertices, U32 stride,
+										   std::span<const U32> newToOldVertex)
+		{
+			auto result = std::vector<Element>(newToOldVertex.size() * stride);
+			for (auto i = 0u; i < newToOldVertex.size(); i++)
+			{
+				std::copy_n(vertices.data() + static_cast<std::size_t>(newToOldVertex[i]) * stride, stride,
+							result.data() + static_cast<std::size_t>(i) * stride);
+			}
+			return result;
+		}
+	} // namespace Geometry
+} // namespace Framework
@@ -0,0 +1,206 @@
+#include "MeshletBuilder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "Profiler.hpp"
+
+using namespace Framework;
+using namespace Framework::Geometry;
+
+namespace
+{
+	constexpr auto invalidIndex = std::numeric_limits<U32>::max();
+	constexpr auto unusedLocalVertex = U8{ 0xFF };
+} // namespace
+
+void Geometry::BuildMeshlets(std::span<const U32> indices, std::span<const Math::Vector3> positions,
+							 Meshlets& meshlets, U32 maxVertices, U32 maxTriangles)
+{
+	ZoneScoped;
+	assert(indices.size() % 3 == 0);
+	assert(maxVertices >= 3 and maxVertices < unusedLocalVertex);
+	assert(maxTriangles >= 1);
+	const auto verticesCount = static_cast<U32>(positions.size());
+	const auto trianglesCount = static_cast<U32>(indices.size() / 3);
+
+	auto adjacencyOffsets = std::vector<U32>(verticesCount + 1, 0);
+	for (const auto index : indices)
+	{
+		assert(index < verticesCount);
+		adjacencyOffsets[index + 1]++;
+	}
+	for (auto vertex = 0u; vertex < verticesCount; vertex++)
+	{
+		adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+	}
+	auto adjacency = std::vector<U32>(indices.size());
+	{
+		auto cursors = std::vector<U32>(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (auto i = 0u; i < indices.size(); i++)
+		{
+			adjacency[cursors[indices[i]]++] = i / 3;
+		}
+	}
+
+	auto isEmitted = std::vector<U8>(trianglesCount, 0);
+	auto localVertices = std::vector<U8>(verticesCount, unusedLocalVertex);
+	auto seedCursor = 0u;
+	auto emittedCount = 0u;
+
+	while (emittedCount < trianglesCount)
+	{
+		while (isEmitted[seedCursor] != 0)
+		{
+			seedCursor++;
+		}
+
+		auto meshlet = Meshlet{ .vertexOffset = static_cast<U32>(meshlets.vertices.size()),
+								.triangleOffset = static_cast<U32>(meshlets.triangles.size()) };
+		auto centroidSum = Math::Vector3{ 0.0f };
+
+		const auto AppendTriangle = [&](U32 triangle)
+		{
+			for (auto corner = 0u; corner < 3; corner++)
+			{
+				const auto vertex = indices[triangle * 3 + corner];
+				if (localVertices[vertex] == unusedLocalVertex)
+				{
+					localVertices[vertex] = static_cast<U8>(meshlet.vertexCount++);
+					meshlets.vertices.push_back(vertex);
+					centroidSum += positions[vertex];
+				}
+				meshlets.triangles.push_back(localVertices[vertex]);
+			}
+			meshlet.triangleCount++;
+			isEmitted[triangle] = 1;
+			emittedCount++;
+		};
+
+		AppendTriangle(seedCursor);
+		while (meshlet.triangleCount < maxTriangles)
+		{
+			const auto centroid = centroidSum / static_cast<Float>(meshlet.vertexCount);
+
+			// Candidates are the triangles around the vertices of the cluster, so it grows over connected surface.
+			auto bestTriangle = invalidIndex;
+			auto bestNewVertices = 3u;
+			auto bestDistance = std::numeric_limits<Float>::max();
+			for (auto local = 0u; local < meshlet.vertexCount; local++)
+			{
+				const auto vertex = meshlets.vertices[meshlet.vertexOffset + local];
+				for (auto i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; i++)
+				{
+					const auto triangle = adjacency[i];
+					if (isEmitted[triangle] != 0)
+					{
+						continue;
+					}
+					const auto* corners = &indices[triangle * 3];
+					auto newVertices = 0u;
+					for (auto corner = 0u; corner < 3; corner++)
+					{
+						newVertices += localVertices[corners[corner]] == unusedLocalVertex ? 1 : 0;
+					}
+					if (meshlet.vertexCount + newVertices > maxVertices)
+					{
+						continue;
+					}
+					const auto distance = glm::length(
+						(positions[corners[0]] + positions[corners[1]] + positions[corners[2]]) / 3.0f - centroid);
+					if (newVertices < bestNewVertices or (newVertices == bestNewVertices and distance < bestDistance))
+					{
+						bestTriangle = triangle;
+						bestNewVertices = newVertices;
+						bestDistance = distance;
+					}
+				}
+			}
+			if (bestTriangle == invalidIndex)
+			{
+				break;
+			}
+			AppendTriangle(bestTriangle);
+		}
+
+		for (auto local = 0u; local < meshlet.vertexCount; local++)
+		{
+			localVertices[meshlets.vertices[meshlet.vertexOffset + local]] = unusedLocalVertex;
+		}
+		meshlets.meshlets.push_back(meshlet);
+		meshlets.bounds.push_back(ComputeMeshletBounds(meshlets, meshlet, positions));
+	}
+}
+
+MeshletBounds Geometry::ComputeMeshletBounds(const Meshlets& meshlets, const Meshlet& meshlet,
+											 std::span<const Math::Vector3> positions)
+{
+	const auto GetPosition = [&](U32 triangle, U32 corner) -> const Math::Vector3&
+	{
+		const auto local = meshlets.triangles[meshlet.triangleOffset + triangle * 3 + corner];
+		return positions[meshlets.vertices[meshlet.vertexOffset + local]];
+	};
+
+	auto bounds = MeshletBounds{};
+	auto minimum = Math::Vector3{ std::numeric_limits<Float>::max() };
+	auto maximum = Math::Vector3{ std::numeric_limits<Float>::lowest() };
+	for (auto local = 0u; local < meshlet.vertexCount; local++)
+	{
+		minimum = glm::min(minimum, positions[meshlets.vertices[meshlet.vertexOffset + local]]);
+		maximum = glm::max(maximum, positions[meshlets.vertices[meshlet.vertexOffset + local]]);
+	}
+	bounds.center = 0.5f * (minimum + maximum);
+	for (auto local = 0u; local < meshlet.vertexCount; local++)
+	{
+		const auto& position = positions[meshlets.vertices[meshlet.vertexOffset + local]];
+		bounds.radius = std::max(bounds.radius, glm::length(position - bounds.center));
+	}
+
+	auto normals = std::vector<Math::Vector3>{};
+	normals.reserve(meshlet.triangleCount);
+	auto axis = Math::Vector3{ 0.0f };
+	for (auto triangle = 0u; triangle < meshlet.triangleCount; triangle++)
+	{
+		const auto& a = GetPosition(triangle, 0);
+		const auto normal = glm::cross(GetPosition(triangle, 1) - a, GetPosition(triangle, 2) - a);
+		const auto length = glm::length(normal);
+		normals.push_back(length > 0.0f ? normal / length : Math::Vector3{ 0.0f });
+		axis += normals.back();
+	}
+	const auto axisLength = glm::length(axis);
+	if (axisLength == 0.0f)
+	{
+		return bounds;
+	}
+	axis /= axisLength;
+
+	auto minimumDot = 1.0f;
+	for (const auto& normal : normals)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(normal, axis));
+	}
+	// Past roughly 85 degrees of spread the cone test would practically never cull and the apex runs away.
+	if (minimumDot <= 0.1f)
+	{
+		return bounds;
+	}
+
+	// The apex is the point on the axis behind every triangle plane, seen from it all triangles face away.
+	auto maximumOffset = 0.0f;
+	for (auto triangle = 0u; triangle < meshlet.triangleCount; triangle++)
+	{
+		const auto& normal = normals[triangle];
+		const auto normalDot = glm::dot(axis, normal);
+		if (normalDot > 0.0f)
+		{
+			maximumOffset =
+				std::max(maximumOffset, glm::dot(bounds.center - GetPosition(triangle, 0), normal) / normalDot);
+		}
+	}
+	bounds.coneApex = bounds.center - axis * maximumOffset;
+	bounds.coneAxis = axis;
+	bounds.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+	return bounds;
+}
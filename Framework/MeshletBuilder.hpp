@@ -0,0 +1,65 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+#include "Math.hpp"
+
+namespace Framework
+{
+	namespace Geometry
+	{
+		// Limits of NVIDIA's recommended mesh shader output, 124 keeps the primitive indices in 372 bytes.
+		constexpr auto maxMeshletVertices = 64u;
+		constexpr auto maxMeshletTriangles = 124u;
+
+		struct Meshlet
+		{
+			// First entry in Meshlets::vertices, which maps local to mesh vertices.
+			U32 vertexOffset{ 0 };
+			// First entry in Meshlets::triangles, three local vertex indices per triangle.
+			U32 triangleOffset{ 0 };
+			U32 vertexCount{ 0 };
+			U32 triangleCount{ 0 };
+		};
+
+		struct MeshletBounds
+		{
+			Math::Vector3 center{ 0.0f };
+			Float radius{ 0.0f };
+			/*
+			 * All triangles face away from a camera at position p when
+			 * dot(normalize(coneApex - p), coneAxis) >= coneCutoff. The cutoff is above 1 for clusters whose normals
+			 * spread too much to be culled as a whole.
+			 */
+			Math::Vector3 coneApex{ 0.0f };
+			Math::Vector3 coneAxis{ 0.0f };
+			Float coneCutoff{ 2.0f };
+		};
+
+		struct Meshlets
+		{
+			std::vector<Meshlet> meshlets;
+			std::vector<MeshletBounds> bounds;
+			std::vector<U32> vertices;
+			std::vector<U8> triangles;
+		};
+
+		/*
+		 * Greedily grows clusters over shared edges, preferring the triangles that add the fewest new vertices and
+		 * then the closest ones, so clusters are compact enough for bounds culling. Appends to meshlets, so several
+		 * index ranges (e.g. LODs) can share one Meshlets.
+		 */
+		void BuildMeshlets(std::span<const U32> indices, std::span<const Math::Vector3> positions, Meshlets& meshlets,
+						   U32 maxVertices = maxMeshletVertices, U32 maxTriangles = maxMeshletTriangles);
+
+		MeshletBounds ComputeMeshletBounds(const Meshlets& meshlets, const Meshlet& meshlet,
+										   std::span<const Math::Vector3> positions);
+
+		inline bool IsMeshletBackFacing(const MeshletBounds& bounds, const Math::Vector3& cameraPosition)
+		{
+			return glm::dot(glm::normalize(bounds.coneApex - cameraPosition), bounds.coneAxis) >= bounds.coneCutoff;
+		}
+	} // namespace Geometry
+} // namespace Framework
@@ -55,7 +55,7 @@ void BasicGeometryPass::Execute(const VkCommandBuffer& cmd, VkImageView colorTar
 	ConstantsData constantsData = ConstantsData{};
 
 	const auto aspectRatio = static_cast<float>(windowViewport.width) / static_cast<float>(windowViewport.height);
-	const auto projection = glm::perspective(glm::radians(60.0f), aspectRatio, 0.001f, 100.0f);
+	const auto projection = glm::perspective(camera.verticalFieldOfView, aspectRatio, 0.001f, 100.0f);
 	const auto view = glm::lookAt(camera.position, camera.position + camera.forward, camera.up);
 	constantsData.viewProjection = projection * view;
 	constantsData.view = view;
@@ -1,11 +1,81 @@
 #include "Scene.hpp"
+#include "AssetStreamer.hpp"
+#include "MeshCache.hpp"
 #include "MeshImporter.hpp"
 
-#include <queue>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <span>
 
 using namespace Framework;
 using namespace Framework::Graphics;
 
+namespace
+{
+	// Matches SubMesh in BasicGeometry.vert with std430 layout.
+	struct SubMesh
+	{
+		// In 32 bit words, 16 bit indices are packed two per word.
+		U32 indexBase;
+		// In 32 bit words.
+		U32 vertexBase;
+		U32 vertexStride;
+		// IndexFormat, the shader checks it per vertex.
+		U32 indexFormat;
+		Math::Vector4 positionMinimum;
+		Math::Vector4 positionExtent;
+	};
+	static_assert(sizeof(SubMesh) == 48);
+	constexpr auto subMeshesCapacity = U32{ 1024 };
+
+	// The mesh as it is drawn, its place in the geometry buffers is only known once it is uploaded.
+	IndexedStaticMesh DescribeCookedMesh(const CookedMesh& cookedMesh)
+	{
+		return IndexedStaticMesh{ .indicesOffset = 0,
+								  .indicesCount = cookedMesh.indicesCount,
+								  .indexFormat = cookedMesh.indexFormat,
+								  .verticesOffset = 0,
+								  .verticesCount = cookedMesh.verticesCount,
+								  .stride = cookedMesh.stride,
+								  .positionMinimum = cookedMesh.positionMinimum,
+								  .positionExtent = cookedMesh.positionExtent };
+	}
+
+	bool HasSameGeometryLayout(const IndexedStaticMesh& a, const IndexedStaticMesh& b)
+	{
+		return a.indicesCount == b.indicesCount and a.indexFormat == b.indexFormat and
+			a.verticesCount == b.verticesCount and a.stride == b.stride and a.positionMinimum == b.positionMinimum and
+			a.positionExtent == b.positionExtent;
+	}
+
+	// Streams that do not match their description would be drawn out of bounds.
+	bool HasDescribedSize(const CookedMesh& cookedMesh, std::span<const std::byte> indices,
+						  std::span<const std::byte> vertices)
+	{
+		return indices.size() == std::size_t{ cookedMesh.indicesCount } * GetIndexSize(cookedMesh.indexFormat) and
+			vertices.size() == std::size_t{ cookedMesh.verticesCount } * cookedMesh.stride;
+	}
+
+	// Compares the stored bytes, a mesh stored raw in one container and compressed in another is uploaded twice.
+	bool HasSameGeometry(const AssetLocation& a, const AssetLocation& b)
+	{
+		const auto payloads = a.container->GetPayloads(*a.entry);
+		const auto otherPayloads = b.container->GetPayloads(*b.entry);
+		for (auto i = 1u; i < 3; i++)
+		{
+			const auto data = a.container->GetPayloadData(payloads[i]);
+			const auto otherData = b.container->GetPayloadData(otherPayloads[i]);
+			if (payloads[i].encoding != otherPayloads[i].encoding or data.size() != otherData.size() or
+				std::memcmp(data.data(), otherData.data(), data.size()) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
 void Scene::CreateResources(const VulkanContext& context)
 {
 	{
@@ -80,33 +150,45 @@ void Scene::CreateResources(const VulkanContext& context)
 			.pNext = nullptr,
 			.commandPool = commandPool,
 			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount = 1,
+			.commandBufferCount = stagingSlotsCount,
 		};
 
-		const auto result = vkAllocateCommandBuffers(context.device, &allocateCreateInfo, &commandBuffer);
+		auto commandBuffers = std::array<VkCommandBuffer, stagingSlotsCount>{};
+		const auto result = vkAllocateCommandBuffers(context.device, &allocateCreateInfo, commandBuffers.data());
 		assert(result == VK_SUCCESS);
+		for (auto i = 0u; i < stagingSlotsCount; i++)
+		{
+			stagingSlots[i].commandBuffer = commandBuffers[i];
+		}
 	}
 
+	// Filled on the transfer queue while the graphics queue draws the meshes uploaded before.
 	geometryBuffer =
 		context.CreateBuffer({ 128 * 1024 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-							   MemoryUsage::gpu, "Global Vertex Buffer" });
+							   MemoryUsage::gpu, "Global Vertex Buffer", true });
 	geometryIndexBuffer =
 		context.CreateBuffer({ 128 * 1024 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-							   MemoryUsage::gpu, "Global Index Buffer" });
+							   MemoryUsage::gpu, "Global Index Buffer", true });
 	stagingBuffer = context.CreateBuffer(
-		{ stagingBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::upload, "Geometry Staging Buffer" });
-	subMeshesBuffer = context.CreateBuffer({ sizeof(U32) * 2 * 1024,
+		{ stagingSlotsCount * stagingSlotSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::upload,
+		  "Geometry Staging Buffer" });
+	subMeshesBuffer = context.CreateBuffer({ sizeof(SubMesh) * subMeshesCapacity,
 											 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-											 MemoryUsage::gpu, "SubMeshes Buffer" });
+											 MemoryUsage::gpu, "SubMeshes Buffer", true });
 
 
 	{
-		const auto fenceCreateInfo = VkFenceCreateInfo{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-														.pNext = nullptr,
-														.flags = VK_FENCE_CREATE_SIGNALED_BIT };
-		const auto result = vkCreateFence(context.device, &fenceCreateInfo, nullptr, &stagingBufferReuse);
+		const auto semaphoreTypeCreateInfo =
+			VkSemaphoreTypeCreateInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+									   .pNext = nullptr,
+									   .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+									   .initialValue = uploadsValue };
+		const auto semaphoreCreateInfo = VkSemaphoreCreateInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+																.pNext = &semaphoreTypeCreateInfo,
+																.flags = 0 };
+		const auto result = vkCreateSemaphore(context.device, &semaphoreCreateInfo, nullptr, &uploadsFinished);
 		assert(result == VK_SUCCESS);
-		context.SetObjectDebugName(VK_OBJECT_TYPE_FENCE, (uint64_t)stagingBufferReuse, "Staging Buffer Reuse Fence");
+		context.SetObjectDebugName(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)uploadsFinished, "Uploads Finished Semaphore");
 	}
 
 	{
@@ -159,7 +241,7 @@ void Scene::CreateResources(const VulkanContext& context)
 
 void Scene::ReleaseResources(const VulkanContext& context)
 {
-	vkDestroyFence(context.device, stagingBufferReuse, nullptr);
+	vkDestroySemaphore(context.device, uploadsFinished, nullptr);
 
 	context.DestroyBuffer(geometryBuffer);
 	context.DestroyBuffer(geometryIndexBuffer);
@@ -174,192 +256,197 @@ void Scene::ReleaseResources(const VulkanContext& context)
 
 void Scene::Upload(const std::string_view mesh, const VulkanContext& context)
 {
+	const auto sourcePath = std::filesystem::path{ mesh };
+	LoadAnimation(sourcePath);
+	UploadMeshes(sourcePath, context);
+}
 
-	auto importer = Framework::AssetImporter(std::filesystem::path{ mesh });
-
-	const auto importSettings = Framework::MeshImportSettings{
-		.verticesStreamDeclarations = { Framework::VerticesStreamDeclaration{
-			.hasPosition = true, .hasNormal = true, .hasTextureCoordinate0 = true, .hasJointsIndexAndWeights = true } }
-	};
-
-	const auto& info = importer.GetSceneInformation();
-
-	auto indexOffset = 0u;
-	auto vertexOffset = 0u;
-	const auto skeleton = importer.ImportSkeleton(0);
-	skeletons.push_back(skeleton);
-	animationDataSet = importer.LoadAllAnimations(skeleton, 60);
-
-	struct DataUploadRegion
-	{
-		uint64_t memoryPtr;
-		uint32_t offset;
-		uint32_t size;
-		bool isIndexData{ false };
-	};
-
-	std::queue<DataUploadRegion> uploadRequests;
-	auto requestMeshUpload = [&](const MeshData& mesh)
-	{
-		auto buckets = (mesh.indexStream.size() + stagingBufferSize) / stagingBufferSize;
-		for (auto i = 0; i < buckets; i++)
-		{
-			const auto uploadSize = i < buckets - 1 ? stagingBufferSize : mesh.indexStream.size() % stagingBufferSize;
-			uploadRequests.push(DataUploadRegion{ (uint64_t)mesh.indexStream.data(), (uint32_t)(i * stagingBufferSize),
-												  (uint32_t)uploadSize, true });
-		}
-
-		buckets = (mesh.streams[0].data.size() + stagingBufferSize) / stagingBufferSize;
-		for (auto i = 0; i < buckets; i++)
-		{
-			const auto uploadSize =
-				i < buckets - 1 ? stagingBufferSize : mesh.streams[0].data.size() % stagingBufferSize;
-			uploadRequests.push(DataUploadRegion{ (uint64_t)mesh.streams[0].data.data(),
-												  (uint32_t)(i * stagingBufferSize), (uint32_t)uploadSize, false });
-		}
-	};
+void Scene::LoadAnimation(const std::filesystem::path& sourcePath)
+{
+	// Skeleton and clips come from the cooked animation file, meshes from the cooked mesh container.
+	cookedAnimation = Animation::LoadOrCookAnimation(sourcePath, 60);
+	skeletons.push_back(cookedAnimation.skeleton);
+	animationDataSet = cookedAnimation.GetDataSet();
+}
 
+void Scene::UploadMeshes(const std::filesystem::path& sourcePath, const VulkanContext& context)
+{
+	const auto importSettings = GetRuntimeMeshImportSettings();
 
-	for (auto i = 0; i < info.meshCount; i++)
+	if (auto cookedMeshes = LoadOrCookMeshes(sourcePath, importSettings))
 	{
-		const auto meshData = importer.ImportMesh(i, importSettings);
-		requestMeshUpload(meshData);
-
-		auto vertexSize = 0u;
-		for (auto j = 0; j < meshData.streams[0].streamDescriptor.attributes.size(); j++)
-		{
-			vertexSize += meshData.streams[0].streamDescriptor.attributes[j].componentCount *
-				meshData.streams[0].streamDescriptor.attributes[j].componentSize;
-		}
-
-		this->meshes.push_back(
-			IndexedStaticMesh{ .indicesOffset = indexOffset,
-							   .indicesCount = static_cast<uint32_t>(meshData.indexStream.size() / 4),
-							   .verticesOffset = vertexOffset,
-							   .verticesCount = static_cast<uint32_t>(meshData.streams[0].data.size() / vertexSize),
-							   .stride = vertexSize });
-		indexOffset += static_cast<uint32_t>(meshData.indexStream.size() / 4);
-		vertexOffset += static_cast<uint32_t>(meshData.streams[0].data.size() / vertexSize);
-
-
-		while (!uploadRequests.empty())
+		const auto& container =
+			meshContainers.emplace_back(std::make_unique<AssetContainer>(std::move(*cookedMeshes)));
+		// Raw payloads are copied from the mapped container straight into the staging buffer, compressed ones are
+		// decoded first.
+		const auto DecodePayload = [&](const AssetContainerPayload& payload,
+									   std::vector<std::byte>& decoded) -> std::optional<std::span<const std::byte>>
 		{
+			if (payload.encoding == BinaryEncoding::raw)
 			{
-				const auto result = vkWaitForFences(context.device, 1, &stagingBufferReuse, VK_TRUE, ~0ull);
-				assert(result == VK_SUCCESS);
+				return container->GetPayloadData(payload);
 			}
+			decoded.resize(payload.decodedSize);
+			if (not container->Decode(payload, decoded))
 			{
-				const auto result = vkResetFences(context.device, 1, &stagingBufferReuse);
-				assert(result == VK_SUCCESS);
+				return std::nullopt;
 			}
+			return std::span<const std::byte>{ decoded };
+		};
 
-			const auto request = uploadRequests.front();
-			uploadRequests.pop();
-
-
-			const auto isIndexData = request.isIndexData;
-
-			std::memcpy(stagingBuffer.mappedPtr, (char*)request.memoryPtr + request.offset, request.size);
-			vmaFlushAllocation(context.allocator,
-							   isIndexData ? geometryIndexBuffer.allocation : geometryBuffer.allocation, 0,
-							   stagingBufferSize);
-			const auto region =
-				VkBufferCopy2{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
-							   .pNext = nullptr,
-							   .srcOffset = 0,
-							   .dstOffset = isIndexData ? geometryIndexBufferFreeOffset : geometryBufferFreeOffset,
-							   .size = request.size };
-
-			const auto copyBufferInfo =
-				VkCopyBufferInfo2{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
-								   .pNext = nullptr,
-								   .srcBuffer = stagingBuffer.buffer,
-								   .dstBuffer = isIndexData ? geometryIndexBuffer.buffer : geometryBuffer.buffer,
-								   .regionCount = 1,
-								   .pRegions = &region };
-
+		auto decodedIndices = std::vector<std::byte>{};
+		auto decodedVertices = std::vector<std::byte>{};
+		for (const auto& meshUuid : GetCookedSceneMeshes(*container))
+		{
+			// Like unreadable streamed payloads, a mesh that is missing or does not decode is left out of the scene.
+			const auto entry = container->Find(meshUuid);
+			if (entry == nullptr or entry->type != AssetType::subMesh or entry->payloadsCount != 3)
 			{
-				const auto beginInfo = VkCommandBufferBeginInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-																 .pNext = nullptr,
-																 .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-																 .pInheritanceInfo = nullptr };
-				const auto result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
-				assert(result == VK_SUCCESS);
+				continue;
 			}
-
-			vkCmdCopyBuffer2(commandBuffer, &copyBufferInfo);
-
+			const auto payloads = container->GetPayloads(*entry);
+			const auto description = ReadCookedMesh(container->GetPayloadData(payloads[0]));
+			if (not description)
 			{
-				const auto result = vkEndCommandBuffer(commandBuffer);
-				assert(result == VK_SUCCESS);
+				continue;
 			}
-
-			const auto bufferSubmitInfos =
-				std::array{ VkCommandBufferSubmitInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-													   .pNext = nullptr,
-													   .commandBuffer = commandBuffer,
-													   .deviceMask = 1 } };
-
-			const auto submit = VkSubmitInfo2{
-				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-				.pNext = nullptr,
-				.flags = 0,
-				.waitSemaphoreInfoCount = 0,
-				.pWaitSemaphoreInfos = nullptr,
-				.commandBufferInfoCount = static_cast<uint32_t>(bufferSubmitInfos.size()),
-				.pCommandBufferInfos = bufferSubmitInfos.data(),
-				.signalSemaphoreInfoCount = 0,
-				.pSignalSemaphoreInfos = nullptr,
-			};
-			const auto result = vkQueueSubmit2(context.transferQueue, 1, &submit, stagingBufferReuse);
-			assert(result == VK_SUCCESS);
-
-			if (isIndexData)
+			const auto& cookedMesh = *description;
+			const auto location = AssetLocation{ .container = container.get(), .entry = entry };
+			if (ReuseUploadedMesh(cookedMesh.contentHash, DescribeCookedMesh(cookedMesh), location))
 			{
-				geometryIndexBufferFreeOffset += request.size;
+				continue;
 			}
-			else
+			const auto indices = DecodePayload(payloads[1], decodedIndices);
+			const auto vertices = DecodePayload(payloads[2], decodedVertices);
+			if (indices and vertices and HasDescribedSize(cookedMesh, *indices, *vertices))
 			{
-				geometryBufferFreeOffset += request.size;
+				UploadCookedMesh(cookedMesh, *indices, *vertices, location, context);
 			}
 		}
 	}
+	else
+	{
+		// The container could not be written, e.g. for a read-only asset folder, so the meshes are streamed from
+		// the importer instead. Hashing and streaming mesh by mesh would otherwise post-process the scene for each.
+		// Streaming cannot reorder a whole mesh, the cooked container is the optimized path.
+		// The importer refills the same slot after each chunk, so this path waits for every copy. It only runs
+		// before the first frame.
+		const auto stagingSlot = AcquireStagingSlot(context);
+		const auto destination = GetStagingSlotData(stagingSlot);
+		const auto uploadChunk = [&](const MeshStreamChunk& chunk)
+		{
+			UploadChunk(chunk, stagingSlot, context);
+			WaitForUploads(uploadsValue, context);
+		};
+		auto streamSettings = importSettings;
+		streamSettings.applyOptimization = false;
+		auto importer = AssetImporter{ sourcePath };
+		importer.PostProcessScene(streamSettings);
+		// Imported meshes are only compared within their importer, repeats across files are uploaded again.
+		struct ImportedMesh
+		{
+			U32 importerMeshIndex{ 0 };
+			U32 meshIndex{ 0 };
+		};
+		auto importedMeshes = std::unordered_multimap<U64, ImportedMesh>{};
+		for (auto meshIndex = 0u; meshIndex < importer.GetSceneInformation().meshCount; meshIndex++)
+		{
+			// Earlier uploads keep their place in the geometry buffers.
+			const auto indexFreeOffset = geometryIndexBufferFreeOffset;
+			const auto vertexFreeOffset = geometryBufferFreeOffset;
+			const auto streamedMesh = importer.StreamMesh(meshIndex, streamSettings, destination, uploadChunk);
+			// An odd count of 16 bit indices leaves half a word, the next mesh starts on a word boundary.
+			geometryIndexBufferFreeOffset = (geometryIndexBufferFreeOffset + 3u) & ~3u;
+
+			const auto& streamDescriptor = streamedMesh.streamDescriptors.front();
+			const auto mesh = IndexedStaticMesh{ .indicesOffset = indexFreeOffset / static_cast<U32>(sizeof(U32)),
+												 .indicesCount = streamedMesh.indicesCount,
+												 .indexFormat = streamedMesh.indexFormat,
+												 .verticesOffset = vertexFreeOffset,
+												 .verticesCount = streamedMesh.verticesCount,
+												 .stride = streamDescriptor.attributes.front().stride,
+												 .positionMinimum = streamDescriptor.positionMinimum,
+												 .positionExtent = streamDescriptor.positionExtent };
+			// The layout is only known once the mesh is streamed, a repeated mesh gives its space back.
+			const auto contentHash = importer.HashMesh(meshIndex, streamSettings);
+			const auto [first, last] = importedMeshes.equal_range(contentHash);
+			const auto isRepeated = [&](const auto& importedMesh)
+			{ return importer.HasSameMeshContent(importedMesh.second.importerMeshIndex, meshIndex, streamSettings); };
+			const auto repeated = std::find_if(first, last, isRepeated);
+			if (repeated != last)
+			{
+				geometryIndexBufferFreeOffset = indexFreeOffset;
+				geometryBufferFreeOffset = vertexFreeOffset;
+				this->meshes.push_back(this->meshes[repeated->second.meshIndex]);
+				continue;
+			}
+			this->meshes.push_back(mesh);
+			importedMeshes.emplace(contentHash, ImportedMesh{ .importerMeshIndex = meshIndex,
+															  .meshIndex = static_cast<U32>(this->meshes.size() - 1) });
+		}
+	}
+	UploadSubMeshes(context);
+}
 
+void Scene::UploadStreamedMesh(const StreamedAsset& asset, const VulkanContext& context)
+{
+	// Payloads that could not be read or do not describe a mesh leave the scene as it is.
+	if (asset.type != AssetType::subMesh or asset.payloads.size() != 3)
 	{
-		const auto result = vkWaitForFences(context.device, 1, &stagingBufferReuse, VK_TRUE, ~0ull);
-		assert(result == VK_SUCCESS);
+		return;
 	}
+	const auto description = ReadCookedMesh(asset.payloads[0]);
+	if (not description or not HasDescribedSize(*description, asset.payloads[1], asset.payloads[2]))
 	{
-		const auto result = vkResetFences(context.device, 1, &stagingBufferReuse);
-		assert(result == VK_SUCCESS);
+		return;
 	}
-	struct SubMesh
+	const auto& cookedMesh = *description;
+
+	if (not ReuseUploadedMesh(cookedMesh.contentHash, DescribeCookedMesh(cookedMesh), asset.location))
 	{
-		U32 indexBase;
-		U32 vertexBase;
-		U32 vertexStride;
-	};
+		UploadCookedMesh(cookedMesh, asset.payloads[1], asset.payloads[2], asset.location, context);
+	}
+	UploadSubMeshes(context);
+}
 
+U32 Scene::AcquireStagingSlot(const VulkanContext& context)
+{
+	const auto stagingSlot = nextStagingSlot;
+	nextStagingSlot = (nextStagingSlot + 1) % stagingSlotsCount;
+	WaitForUploads(stagingSlots[stagingSlot].uploadsValue, context);
+	return stagingSlot;
+}
 
-	auto subMeshes = std::vector<SubMesh>{};
+std::span<std::byte> Scene::GetStagingSlotData(U32 stagingSlot)
+{
+	return std::span{ static_cast<std::byte*>(stagingBuffer.mappedPtr) + stagingSlot * stagingSlotSize,
+					  static_cast<std::size_t>(stagingSlotSize) };
+}
 
-	for (auto i = 0; i < meshes.size(); i++)
-	{
-		subMeshes.push_back({ meshes[i].indicesOffset, meshes[i].verticesOffset, meshes[i].stride });
-	}
+void Scene::UploadChunk(const MeshStreamChunk& chunk, U32 stagingSlot, const VulkanContext& context)
+{
+	const auto isIndexData = chunk.kind == MeshStreamKind::indices;
+	auto& freeOffset = isIndexData ? geometryIndexBufferFreeOffset : geometryBufferFreeOffset;
+	SubmitCopy(stagingSlot, isIndexData ? geometryIndexBuffer.buffer : geometryBuffer.buffer, freeOffset, chunk.size,
+			   context);
+	freeOffset += static_cast<U32>(chunk.size);
+}
 
-	std::memcpy(stagingBuffer.mappedPtr, (char*)subMeshes.data(), subMeshes.size() * sizeof(SubMesh));
-	vmaFlushAllocation(context.allocator, subMeshesBuffer.allocation, 0, stagingBufferSize);
+void Scene::SubmitCopy(U32 stagingSlot, VkBuffer destination, VkDeviceSize destinationOffset, VkDeviceSize size,
+					   const VulkanContext& context)
+{
+	auto& slot = stagingSlots[stagingSlot];
+	vmaFlushAllocation(context.allocator, stagingBuffer.allocation, stagingSlot * stagingSlotSize, size);
 	const auto region = VkBufferCopy2{ .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
 									   .pNext = nullptr,
-									   .srcOffset = 0,
-									   .dstOffset = 0,
-									   .size = subMeshes.size() * sizeof(SubMesh) };
+									   .srcOffset = stagingSlot * stagingSlotSize,
+									   .dstOffset = destinationOffset,
+									   .size = size };
 
 	const auto copyBufferInfo = VkCopyBufferInfo2{ .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
 												   .pNext = nullptr,
 												   .srcBuffer = stagingBuffer.buffer,
-												   .dstBuffer = subMeshesBuffer.buffer,
+												   .dstBuffer = destination,
 												   .regionCount = 1,
 												   .pRegions = &region };
 
@@ -368,22 +455,33 @@ void Scene::Upload(const std::string_view mesh, const VulkanContext& context)
 														 .pNext = nullptr,
 														 .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
 														 .pInheritanceInfo = nullptr };
-		const auto result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		const auto result = vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
 		assert(result == VK_SUCCESS);
 	}
 
-	vkCmdCopyBuffer2(commandBuffer, &copyBufferInfo);
+	vkCmdCopyBuffer2(slot.commandBuffer, &copyBufferInfo);
 
 	{
-		const auto result = vkEndCommandBuffer(commandBuffer);
+		const auto result = vkEndCommandBuffer(slot.commandBuffer);
 		assert(result == VK_SUCCESS);
 	}
 
+	uploadsValue++;
+	slot.uploadsValue = uploadsValue;
 	const auto bufferSubmitInfos =
 		std::array{ VkCommandBufferSubmitInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
 											   .pNext = nullptr,
-											   .commandBuffer = commandBuffer,
+											   .commandBuffer = slot.commandBuffer,
 											   .deviceMask = 1 } };
+	// The graphics queue waits for this value before reading the copied range, the buffers are shared between
+	// both queue families.
+	const auto signalSemaphoreInfos =
+		std::array{ VkSemaphoreSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+										   .pNext = nullptr,
+										   .semaphore = uploadsFinished,
+										   .value = uploadsValue,
+										   .stageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+										   .deviceIndex = 1 } };
 
 	const auto submit = VkSubmitInfo2{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
@@ -393,9 +491,100 @@ void Scene::Upload(const std::string_view mesh, const VulkanContext& context)
 		.pWaitSemaphoreInfos = nullptr,
 		.commandBufferInfoCount = static_cast<uint32_t>(bufferSubmitInfos.size()),
 		.pCommandBufferInfos = bufferSubmitInfos.data(),
-		.signalSemaphoreInfoCount = 0,
-		.pSignalSemaphoreInfos = nullptr,
+		.signalSemaphoreInfoCount = static_cast<uint32_t>(signalSemaphoreInfos.size()),
+		.pSignalSemaphoreInfos = signalSemaphoreInfos.data(),
 	};
-	const auto result = vkQueueSubmit2(context.transferQueue, 1, &submit, stagingBufferReuse);
+	const auto result = vkQueueSubmit2(context.transferQueue, 1, &submit, VK_NULL_HANDLE);
 	assert(result == VK_SUCCESS);
-}
\ No newline at end of file
+}
+
+void Scene::WaitForUploads(U64 value, const VulkanContext& context)
+{
+	const auto waitInfo = VkSemaphoreWaitInfo{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+											   .pNext = nullptr,
+											   .flags = 0,
+											   .semaphoreCount = 1,
+											   .pSemaphores = &uploadsFinished,
+											   .pValues = &value };
+	const auto result = vkWaitSemaphores(context.device, &waitInfo, ~0ull);
+	assert(result == VK_SUCCESS);
+}
+
+void Scene::UploadPayload(std::span<const std::byte> payload, MeshStreamKind kind, const VulkanContext& context)
+{
+	// Copies are only submitted, the slot of a chunk is written again once the ring wraps around to it.
+	for (auto offset = std::size_t{ 0 }; offset < payload.size(); offset += stagingSlotSize)
+	{
+		const auto size = std::min(static_cast<std::size_t>(stagingSlotSize), payload.size() - offset);
+		const auto stagingSlot = AcquireStagingSlot(context);
+		std::memcpy(GetStagingSlotData(stagingSlot).data(), payload.data() + offset, size);
+		UploadChunk(MeshStreamChunk{ .kind = kind, .offset = offset, .size = size }, stagingSlot, context);
+	}
+}
+
+bool Scene::ReuseUploadedMesh(U64 contentHash, const IndexedStaticMesh& mesh, const AssetLocation& location)
+{
+	// Meshes repeated within or across files share their geometry. The hash only picks the candidates, a collision
+	// must not draw the geometry of another mesh.
+	const auto [first, last] = uploadedMeshes.equal_range(contentHash);
+	for (auto it = first; it != last; ++it)
+	{
+		const auto& uploadedMesh = it->second;
+		if (HasSameGeometryLayout(this->meshes[uploadedMesh.meshIndex], mesh) and
+			HasSameGeometry(uploadedMesh.location, location))
+		{
+			this->meshes.push_back(this->meshes[uploadedMesh.meshIndex]);
+			return true;
+		}
+	}
+	return false;
+}
+
+void Scene::UploadCookedMesh(const CookedMesh& cookedMesh, std::span<const std::byte> indices,
+							 std::span<const std::byte> vertices, const AssetLocation& location,
+							 const VulkanContext& context)
+{
+	// Earlier uploads keep their place in the geometry buffers.
+	const auto indexOffset = geometryIndexBufferFreeOffset / static_cast<U32>(sizeof(U32));
+	const auto vertexOffset = geometryBufferFreeOffset;
+	UploadPayload(indices, MeshStreamKind::indices, context);
+	// An odd count of 16 bit indices leaves half a word, the next mesh starts on a word boundary.
+	geometryIndexBufferFreeOffset = (geometryIndexBufferFreeOffset + 3u) & ~3u;
+	UploadPayload(vertices, MeshStreamKind::vertices, context);
+
+	auto& mesh = this->meshes.emplace_back(DescribeCookedMesh(cookedMesh));
+	mesh.indicesOffset = indexOffset;
+	mesh.verticesOffset = vertexOffset;
+	const auto meshIndex = static_cast<U32>(this->meshes.size() - 1);
+	uploadedMeshes.emplace(cookedMesh.contentHash, UploadedMesh{ .meshIndex = meshIndex, .location = location });
+}
+
+void Scene::UploadSubMeshes(const VulkanContext& context)
+{
+	// Frames in flight only draw meshes that were there when they were recorded, their entries stay untouched.
+	const auto firstSubMesh = uploadedSubMeshesCount;
+	const auto subMeshesCount = static_cast<U32>(meshes.size()) - firstSubMesh;
+	if (subMeshesCount == 0)
+	{
+		return;
+	}
+	assert(meshes.size() <= subMeshesCapacity);
+	assert(subMeshesCount * sizeof(SubMesh) <= stagingSlotSize);
+
+	const auto stagingSlot = AcquireStagingSlot(context);
+	auto subMeshes = reinterpret_cast<SubMesh*>(GetStagingSlotData(stagingSlot).data());
+	for (auto i = 0u; i < subMeshesCount; i++)
+	{
+		const auto& mesh = meshes[firstSubMesh + i];
+		subMeshes[i] = SubMesh{ .indexBase = mesh.indicesOffset,
+								.vertexBase = mesh.verticesOffset / 4,
+								.vertexStride = mesh.stride / 4,
+								.indexFormat = static_cast<U32>(mesh.indexFormat),
+								.positionMinimum = Math::Vector4{ mesh.positionMinimum, 0.0f },
+								.positionExtent = Math::Vector4{ mesh.positionExtent, 0.0f } };
+	}
+
+	SubmitCopy(stagingSlot, subMeshesBuffer.buffer, firstSubMesh * sizeof(SubMesh), subMeshesCount * sizeof(SubMesh),
+			   context);
+	uploadedSubMeshesCount = static_cast<U32>(meshes.size());
+}
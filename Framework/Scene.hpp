@@ -1,21 +1,38 @@
 #pragma once
 
 #include "Animation.hpp"
+#include "AnimationCache.hpp"
+#include "AssetRegistry.hpp"
+#include "MeshImporter.hpp"
 #include "VulkanRHI.hpp"
 
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <span>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace Framework
 {
+	struct CookedMesh;
+	struct StreamedAsset;
+
 	struct IndexedStaticMesh
 	{
 		// has only one stream position
+		// In 32 bit words of the index buffer, every mesh starts on a word boundary whatever its index format.
 		U32 indicesOffset;
 		U32 indicesCount;
+		IndexFormat indexFormat{ IndexFormat::uint32 };
+		// In bytes, vertex strides differ between meshes.
 		U32 verticesOffset;
 		U32 verticesCount;
 		U32 stride;
+		// Range the quantized positions decode to.
+		Math::Vector3 positionMinimum{ 0.0f };
+		Math::Vector3 positionExtent{ 1.0f };
 	};
 
 	struct Scene
@@ -25,6 +42,13 @@ namespace Framework
 
 		void Upload(const std::string_view mesh, const Graphics::VulkanContext& context);
 
+		// Skeleton and clips of a source, without its meshes.
+		void LoadAnimation(const std::filesystem::path& sourcePath);
+		// Every mesh of a source at once, from its cooked container or straight from the importer.
+		void UploadMeshes(const std::filesystem::path& sourcePath, const Graphics::VulkanContext& context);
+		// Completion of an AssetStreamer request for a subMesh asset of a cooked mesh container.
+		void UploadStreamedMesh(const StreamedAsset& asset, const Graphics::VulkanContext& context);
+
 
 		/*struct GpuSubMesh
 		{
@@ -45,9 +69,21 @@ namespace Framework
 			Graphics::GraphicsBuffer subMeshes;
 		};*/
 
-		static constexpr VkDeviceSize stagingBufferSize{ 1 * 1024 * 1024 };
+		// Ring of staging slots, a slot is only waited for when the transfer queue is a whole ring behind.
+		static constexpr U32 stagingSlotsCount{ 4 };
+		static constexpr VkDeviceSize stagingSlotSize{ 1 * 1024 * 1024 };
 		Graphics::GraphicsBuffer stagingBuffer{};
-		VkFence stagingBufferReuse;
+		struct StagingSlot
+		{
+			VkCommandBuffer commandBuffer{};
+			// uploadsFinished reaches it once the last copy from the slot is done.
+			U64 uploadsValue{ 0 };
+		};
+		std::array<StagingSlot, stagingSlotsCount> stagingSlots{};
+		U32 nextStagingSlot{ 0 };
+		// Timeline signaled by every transfer submit, a frame waits for uploadsValue before drawing the meshes.
+		VkSemaphore uploadsFinished;
+		U64 uploadsValue{ 0 };
 
 		VkDescriptorPool geometryDescriptorPool;
 		VkDescriptorSet geometryDescriptorSet;
@@ -55,7 +91,6 @@ namespace Framework
 
 
 		VkCommandPool commandPool;
-		VkCommandBuffer commandBuffer;
 
 		Graphics::GraphicsBuffer geometryBuffer{};
 		U32 geometryBufferFreeOffset{ 0 };
@@ -63,10 +98,43 @@ namespace Framework
 		U32 geometryIndexBufferFreeOffset{ 0 };
 
 		Graphics::GraphicsBuffer subMeshesBuffer{};
+		// Entries already written, frames in flight may read them so only appended meshes are written.
+		U32 uploadedSubMeshesCount{ 0 };
 
 		std::vector<IndexedStaticMesh> meshes;
+		struct UploadedMesh
+		{
+			U32 meshIndex{ 0 };
+			// Asset the mesh was uploaded from, its payloads are compared with those of a mesh with the same hash.
+			AssetLocation location{};
+		};
+		// Meshes of cooked containers whose content was already uploaded, by AssetImporter::HashMesh().
+		std::unordered_multimap<U64, UploadedMesh> uploadedMeshes;
+		// Containers of UploadMeshes(), the ones of streamed meshes are kept mapped by the registry.
+		std::vector<std::unique_ptr<AssetContainer>> meshContainers;
 		std::vector<Animation::Skeleton> skeletons;
-		Animation::AnimationDataSet animationDataSet;
+		Animation::CookedAnimation cookedAnimation;
+		Animation::AnimationDataSetView animationDataSet;
+
+	private:
+		// Waits until the next slot of the ring can be written again.
+		U32 AcquireStagingSlot(const Graphics::VulkanContext& context);
+		std::span<std::byte> GetStagingSlotData(U32 stagingSlot);
+		// Copies the first chunk.size bytes of the staging slot to the free space of its geometry buffer.
+		void UploadChunk(const MeshStreamChunk& chunk, U32 stagingSlot, const Graphics::VulkanContext& context);
+		// Submits the copy on the transfer queue, signaling the next uploadsFinished value, without waiting for it.
+		void SubmitCopy(U32 stagingSlot, VkBuffer destination, VkDeviceSize destinationOffset, VkDeviceSize size,
+						const Graphics::VulkanContext& context);
+		void WaitForUploads(U64 value, const Graphics::VulkanContext& context);
+		void UploadPayload(std::span<const std::byte> payload, MeshStreamKind kind,
+						   const Graphics::VulkanContext& context);
+		// Appends the uploaded mesh with the same content as the asset at location, false when there is none.
+		bool ReuseUploadedMesh(U64 contentHash, const IndexedStaticMesh& mesh, const AssetLocation& location);
+		void UploadCookedMesh(const CookedMesh& cookedMesh, std::span<const std::byte> indices,
+							  std::span<const std::byte> vertices, const AssetLocation& location,
+							  const Graphics::VulkanContext& context);
+		// Writes the SubMesh entries of the meshes appended since the last call.
+		void UploadSubMeshes(const Graphics::VulkanContext& context);
 	};
 
 } // namespace Framework
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+#include "Core.hpp"
+#include "Math.hpp"
+
+namespace Framework
+{
+	namespace Geometry
+	{
+		/*
+		 * Encoders matching the GLSL unpack functions, see Assets/Shaders/Common/VertexDecoding.Library.glsl. Each
+		 * rounds to the nearest representable value, so decoding is within half a step of the source.
+		 */
+
+		inline U16 QuantizeUnorm16(Float value)
+		{
+			return static_cast<U16>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		inline I16 QuantizeSnorm16(Float value)
+		{
+			return static_cast<I16>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		inline I8 QuantizeSnorm8(Float value)
+		{
+			return static_cast<I8>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+		}
+
+		// Maps a unit vector to the [-1, 1] square: the upper hemisphere is projected on the octahedron and the
+		// lower one folded over its diagonals.
+		inline Math::Vector2 EncodeOctahedral(const Math::Vector3& direction)
+		{
+			const auto norm = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+			if (norm == 0.0f)
+			{
+				return Math::Vector2{ 0.0f };
+			}
+			const auto projected = direction / norm;
+			if (projected.z >= 0.0f)
+			{
+				return Math::Vector2{ projected.x, projected.y };
+			}
+			return Math::Vector2{ (1.0f - std::abs(projected.y)) * (projected.x >= 0.0f ? 1.0f : -1.0f),
+								  (1.0f - std::abs(projected.x)) * (projected.y >= 0.0f ? 1.0f : -1.0f) };
+		}
+
+		inline Math::Vector3 DecodeOctahedral(const Math::Vector2& encoded)
+		{
+			auto direction = Math::Vector3{ encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+			const auto fold = std::max(-direction.z, 0.0f);
+			direction.x += direction.x >= 0.0f ? -fold : fold;
+			direction.y += direction.y >= 0.0f ? -fold : fold;
+			return glm::normalize(direction);
+		}
+
+		// IEEE 754 binary16 with round to nearest even, out of range values become infinity.
+		inline U16 FloatToHalf(Float value)
+		{
+			const auto bits = std::bit_cast<U32>(value);
+			const auto sign = static_cast<U16>((bits >> 16) & 0x8000u);
+			const auto biasedExponent = (bits >> 23) & 0xFFu;
+			auto mantissa = bits & 0x7F'FFFFu;
+
+			if (biasedExponent == 0xFFu)
+			{
+				return static_cast<U16>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+			}
+			const auto exponent = static_cast<I32>(biasedExponent) - 127 + 15;
+			if (exponent >= 31)
+			{
+				return static_cast<U16>(sign | 0x7C00u);
+			}
+			if (exponent <= 0)
+			{
+				if (exponent < -10)
+				{
+					return sign;
+				}
+				// Subnormal half, the implicit leading one becomes explicit.
+				mantissa |= 0x80'0000u;
+				const auto shift = static_cast<U32>(14 - exponent);
+				auto half = mantissa >> shift;
+				const auto remainder = mantissa & ((1u << shift) - 1);
+				const auto halfway = 1u << (shift - 1);
+				half += remainder > halfway or (remainder == halfway and (half & 1u) != 0) ? 1u : 0u;
+				return static_cast<U16>(sign | half);
+			}
+
+			// A carry out of the mantissa correctly increments the exponent.
+			auto half = (static_cast<U32>(exponent) << 10) | (mantissa >> 13);
+			const auto remainder = mantissa & 0x1FFFu;
+			half += remainder > 0x1000u or (remainder == 0x1000u and (half & 1u) != 0) ? 1u : 0u;
+			return static_cast<U16>(sign | half);
+		}
+
+		inline Float HalfToFloat(U16 half)
+		{
+			const auto sign = static_cast<U32>(half & 0x8000u) << 16;
+			const auto exponent = (half >> 10) & 0x1Fu;
+			const auto mantissa = static_cast<U32>(half & 0x3FFu);
+			if (exponent == 0)
+			{
+				const auto magnitude = std::ldexp(static_cast<Float>(mantissa), -24);
+				return sign != 0 ? -magnitude : magnitude;
+			}
+			if (exponent == 0x1F)
+			{
+				return std::bit_cast<Float>(sign | 0x7F80'0000u | (mantissa << 13));
+			}
+			return std::bit_cast<Float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+		}
+
+		// Rounds the weights to 8 bit and gives the rounding error to the largest one, so they still sum to 1.
+		inline std::array<U8, 4> QuantizeJointWeights(const Math::Vector4& weights)
+		{
+			auto result = std::array<U8, 4>{};
+			auto sum = 0;
+			auto largest = 0;
+			for (auto i = 0; i < 4; i++)
+			{
+				result[i] = static_cast<U8>(std::lround(std::clamp(weights[i], 0.0f, 1.0f) * 255.0f));
+				sum += result[i];
+				largest = weights[i] > weights[largest] ? i : largest;
+			}
+			result[largest] = static_cast<U8>(std::clamp(result[largest] + 255 - sum, 0, 255));
+			return result;
+		}
+	} // namespace Geometry
+} // namespace Framework
@@ -275,6 +275,7 @@ void Framework::Graphics::VulkanContext::Initialize(std::string_view application
 		physicalDeviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 		physicalDeviceFeatures12.pNext = &physicalDeviceFeatures13;
 		physicalDeviceFeatures12.scalarBlockLayout = VK_TRUE;
+		physicalDeviceFeatures12.timelineSemaphore = VK_TRUE;
 #ifdef RTRG_ENABLE_PROFILER
 		physicalDeviceFeatures12.hostQueryReset = VK_TRUE;
 #else
@@ -541,12 +542,17 @@ GraphicsBuffer VulkanContext::CreateBuffer(const BufferDesc&& desc) const
 {
 	auto buffer = GraphicsBuffer{};
 
-	const auto bufferInfo = VkBufferCreateInfo{ .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-												.pNext = nullptr,
-												.flags = 0,
-												.size = VkDeviceSize{ desc.size },
-												.usage = desc.usage,
-												.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	const auto queueFamilyIndices = std::array{ graphicsQueueFamilyIndex, transferQueueFamilyIndex };
+	const auto bufferInfo = VkBufferCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.size = VkDeviceSize{ desc.size },
+		.usage = desc.usage,
+		.sharingMode = desc.isSharedWithTransferQueue ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = desc.isSharedWithTransferQueue ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0,
+		.pQueueFamilyIndices = desc.isSharedWithTransferQueue ? queueFamilyIndices.data() : nullptr
+	};
 
 	const auto allocationInfo = mapMemoryUsageToAllocationInfo(desc.memoryUsage);
 
@@ -57,6 +57,8 @@ namespace Framework
 			VkBufferUsageFlags usage{ 0 };
 			MemoryUsage memoryUsage{ MemoryUsage::gpu };
 			const char* debugName = "";
+			// Written on the transfer queue and read on the graphics queue, without queue family ownership transfers.
+			bool isSharedWithTransferQueue{ false };
 		};
 
 		enum class Format
@@ -0,0 +1,711 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <Animation.hpp>
+#include <AnimationCache.hpp>
+#include <AnimationCompression.hpp>
+#include <AnimationSimd.hpp>
+#include <BlendTree.hpp>
+#include <CrowdUpdater.hpp>
+#include <Memory.hpp>
+
+using namespace Framework;
+using namespace Framework::Animation;
+
+namespace
+{
+	constexpr auto jointsCount = 32u;
+	constexpr auto framesCount = 30u;
+
+	Skeleton CreateChainSkeleton()
+	{
+		auto skeleton = Skeleton{};
+		for (auto i = 0u; i < jointsCount; i++)
+		{
+			skeleton.joints.push_back(Joint{ .inverseBindPose = Math::Matrix4x4::Identity(),
+											 .inverseTransform = Math::Matrix4x4::Identity(),
+											 .parentIndex = static_cast<I32>(i) - 1,
+											 .name = runtime_format("joint_{}", i) });
+		}
+		BuildSkeletonHierarchy(skeleton);
+		return skeleton;
+	}
+
+	// Binary tree with rotated and translated bind poses, so the fused skinning path sees every matrix column.
+	Skeleton CreateTreeSkeleton()
+	{
+		auto skeleton = Skeleton{};
+		for (auto i = 0u; i < jointsCount; i++)
+		{
+			const auto angle = 0.3f * static_cast<Float>(i);
+			const auto bindPose = Math::Matrix4x4::TranslationFrom(Math::Vector3{ 0.1f * i, -0.2f, 0.05f * i }) *
+				Math::Matrix4x4::From(Math::Quaternion{ std::cos(angle), std::sin(angle), 0.0f, 0.0f });
+			skeleton.joints.push_back(Joint{ .inverseBindPose = bindPose,
+											 .inverseTransform = Math::Matrix4x4::Identity(),
+											 .parentIndex = static_cast<I32>(i + 1) / 2 - 1,
+											 .name = runtime_format("joint_{}", i) });
+		}
+		BuildSkeletonHierarchy(skeleton);
+		return skeleton;
+	}
+
+	// Relative to the largest entry, long chains accumulate translations far away from the origin.
+	bool MatricesNear(const Math::Matrix4x4& a, const Math::Matrix4x4& b, Float tolerance)
+	{
+		auto scale = 1.0f;
+		for (auto column = 0; column < 4; column++)
+		{
+			for (auto row = 0; row < 4; row++)
+			{
+				scale = std::max(scale, std::abs(a[column][row]));
+			}
+		}
+		for (auto column = 0; column < 4; column++)
+		{
+			for (auto row = 0; row < 4; row++)
+			{
+				if (std::abs(a[column][row] - b[column][row]) > tolerance * scale)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	AnimationDataSet CreateAnimationDataSet(U32 clipsCount)
+	{
+		auto dataSet = AnimationDataSet{};
+		for (auto clip = 0u; clip < clipsCount; clip++)
+		{
+			dataSet.animations.push_back(
+				AnimationData{ .offset = static_cast<U32>(dataSet.animationDatabase.size()),
+							   .count = jointsCount,
+							   .frames = framesCount,
+							   .duration = 1.0f,
+							   .animationName = runtime_format("clip_{}", clip) });
+
+			for (auto frame = 0u; frame < framesCount; frame++)
+			{
+				for (auto joint = 0u; joint < jointsCount; joint++)
+				{
+					const auto angle = 0.05f * static_cast<Float>(frame + joint + clip);
+					// Uniform, so the fused skinning path concatenates it exactly like the matrix path.
+					const auto scale = 1.0f + 0.001f * static_cast<Float>(frame + joint % 3);
+					dataSet.animationDatabase.push_back(JointAnimationData{
+						.rotation = Math::Quaternion{ std::cos(angle), 0.0f, std::sin(angle), 0.0f },
+						.translation = Math::Vector3{ 0.0f, 0.1f * static_cast<Float>(frame), 1.0f },
+						.scale = Math::Vector3{ scale } });
+				}
+			}
+		}
+		return dataSet;
+	}
+
+	// Resembles a 60 Hz motion capture clip: smooth rotations, a few static joints and only the root translating.
+	AnimationDataSet CreateMotionCaptureDataSet(U32 joints, U32 frames)
+	{
+		auto dataSet = AnimationDataSet{};
+		dataSet.animations.push_back(AnimationData{ .offset = 0,
+													.count = joints,
+													.frames = frames,
+													.duration = static_cast<Float>(frames) / 60.0f,
+													.animationName = "motion_capture" });
+
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			const auto time = static_cast<Float>(frame) / 60.0f;
+			for (auto joint = 0u; joint < joints; joint++)
+			{
+				const auto isStatic = joint % 4 == 3;
+				const auto frequency = 0.5f + 0.1f * static_cast<Float>(joint % 7);
+				const auto angle = isStatic ? 0.3f : 0.6f * std::sin(2.0f * 3.14159265f * frequency * time + joint);
+				const auto axis = glm::normalize(Math::Vector3{ 1.0f, static_cast<Float>(joint % 3), 0.5f });
+				const auto translation = joint == 0 ?
+					Math::Vector3{ 0.8f * time, 0.05f * std::sin(6.0f * time), 0.0f } :
+					Math::Vector3{ 0.0f, 0.1f + 0.01f * joint, 0.0f };
+				// Only the root breathes, the other scales are constant.
+				const auto scale = joint == 0 ? Math::Vector3{ 1.0f, 1.0f + 0.05f * std::sin(3.0f * time), 1.0f } :
+												Math::Vector3{ 1.0f };
+
+				dataSet.animationDatabase.push_back(JointAnimationData{
+					.rotation = glm::angleAxis(angle, axis), .translation = translation, .scale = scale });
+			}
+		}
+		return dataSet;
+	}
+
+	Float RotationAngle(const Math::Quaternion& a, const Math::Quaternion& b)
+	{
+		const auto difference = glm::conjugate(a) * b;
+		return 2.0f * std::atan2(glm::length(Math::Vector3{ difference.x, difference.y, difference.z }),
+								 std::abs(difference.w));
+	}
+} // namespace
+
+TEST(Animation, SpanOverloadsMatchReturningVersions)
+{
+	const auto skeleton = CreateChainSkeleton();
+	const auto dataSet = CreateAnimationDataSet(2);
+	const auto time = 0.37f;
+
+	const auto pose0 = SamplePose(dataSet, dataSet.animations[0], time);
+	const auto pose1 = SamplePose(dataSet, dataSet.animations[1], time);
+	const auto blended = BlendPose(pose0, pose1, 0.25f);
+	auto matrices = ComputeJointsMatrices(blended, skeleton);
+	ApplyBindPose(matrices, skeleton);
+
+	auto arena = PoseArena{};
+	arena.Reserve(3 * jointsCount);
+	const auto spanPose0 = arena.Allocate(jointsCount);
+	const auto spanPose1 = arena.Allocate(jointsCount);
+	const auto spanBlended = arena.Allocate(jointsCount);
+	auto spanMatrices = std::vector<Math::Matrix4x4>(jointsCount);
+
+	SamplePose(dataSet, dataSet.animations[0], time, spanPose0);
+	SamplePose(dataSet, dataSet.animations[1], time, spanPose1);
+	BlendPose(spanPose0, spanPose1, 0.25f, spanBlended);
+	ComputeJointsMatrices(spanBlended, skeleton, spanMatrices);
+	ApplyBindPose(spanMatrices, skeleton);
+
+	for (auto i = 0u; i < jointsCount; i++)
+	{
+		EXPECT_EQ(blended.data[i].rotation, spanBlended[i].rotation);
+		EXPECT_EQ(blended.data[i].translation, spanBlended[i].translation);
+		EXPECT_EQ(blended.data[i].scale, spanBlended[i].scale);
+		EXPECT_TRUE(matrices[i] == spanMatrices[i]);
+	}
+}
+
+TEST(Animation, SkeletonHierarchyIsParentBeforeChild)
+{
+	const auto skeleton = CreateTreeSkeleton();
+	EXPECT_TRUE(IsHierarchyOrdered(skeleton));
+	ASSERT_EQ(skeleton.parentIndices.size(), jointsCount);
+	ASSERT_EQ(skeleton.inverseBindPoses.size(), jointsCount);
+	for (auto i = 0u; i < jointsCount; i++)
+	{
+		EXPECT_EQ(skeleton.parentIndices[i], skeleton.joints[i].parentIndex);
+		EXPECT_LT(skeleton.parentIndices[i], static_cast<I32>(i));
+	}
+
+	auto unordered = skeleton;
+	unordered.joints[3].parentIndex = 7;
+	EXPECT_FALSE(IsHierarchyOrdered(unordered));
+}
+
+TEST(Animation, SkeletonIsSortedByDepth)
+{
+	// Depth first order: root, a chain of two under it and a second child of the root.
+	auto skeleton = Skeleton{};
+	for (const auto [parentIndex, name] : { std::pair{ -1, "joint_0" }, std::pair{ 0, "joint_1" },
+											std::pair{ 1, "joint_2" }, std::pair{ 0, "joint_3" } })
+	{
+		skeleton.joints.push_back(Joint{ .inverseBindPose = Math::Matrix4x4::Identity(),
+										 .inverseTransform = Math::Matrix4x4::Identity(),
+										 .parentIndex = parentIndex,
+										 .name = name });
+	}
+	BuildSkeletonHierarchy(skeleton);
+
+	EXPECT_EQ(skeleton.joints[1].name, "joint_1");
+	EXPECT_EQ(skeleton.joints[2].name, "joint_3");
+	EXPECT_EQ(skeleton.joints[3].name, "joint_2");
+	EXPECT_EQ(skeleton.parentIndices, (std::vector<I32>{ -1, 0, 0, 1 }));
+	EXPECT_EQ(skeleton.jointsCountUpToDepth, (std::vector<U32>{ 1, 3, 4 }));
+	EXPECT_EQ(GetJointsCountUpToDepth(skeleton, 0), 3);
+	EXPECT_EQ(GetJointsCountUpToDepth(skeleton, 100), 4);
+}
+
+TEST(Animation, SkippedJointsFollowTheirParent)
+{
+	const auto skeleton = CreateTreeSkeleton();
+	const auto dataSet = CreateAnimationDataSet(1);
+	const auto evaluatedJointsCount = GetJointsCountUpToDepth(skeleton, 2);
+	ASSERT_LT(evaluatedJointsCount, jointsCount);
+
+	auto fullPose = std::vector<JointAnimationData>(jointsCount);
+	auto pose = std::vector<JointAnimationData>(evaluatedJointsCount);
+	SamplePose(dataSet, dataSet.animations[0], 0.4f, fullPose);
+	SamplePose(dataSet, dataSet.animations[0], 0.4f, pose);
+
+	auto modelSpacePose = std::vector<JointAnimationData>(jointsCount);
+	auto fullMatrices = std::vector<Math::Matrix4x4>(jointsCount);
+	auto matrices = std::vector<Math::Matrix4x4>(jointsCount);
+	ComputeSkinningMatrices(fullPose, skeleton, modelSpacePose, fullMatrices);
+	ComputeSkinningMatrices(pose, skeleton, modelSpacePose, matrices);
+
+	for (auto i = 0u; i < jointsCount; i++)
+	{
+		if (i < evaluatedJointsCount)
+		{
+			EXPECT_TRUE(matrices[i] == fullMatrices[i]);
+		}
+		else
+		{
+			EXPECT_TRUE(matrices[i] == matrices[skeleton.parentIndices[i]]);
+		}
+	}
+}
+
+TEST(Animation, FusedSkinningMatchesMatrixPath)
+{
+	const auto dataSet = CreateAnimationDataSet(1);
+	auto modelSpacePose = std::vector<JointAnimationData>(jointsCount);
+	auto skinningMatrices = std::vector<Math::Matrix4x4>(jointsCount);
+
+	for (const auto& skeleton : { CreateChainSkeleton(), CreateTreeSkeleton() })
+	{
+		for (auto time = 0.0f; time < 1.0f; time += 0.07f)
+		{
+			const auto pose = SamplePose(dataSet, dataSet.animations[0], time);
+			auto expected = ComputeJointsMatrices(pose, skeleton);
+			ApplyBindPose(expected, skeleton);
+
+			ComputeSkinningMatrices(pose.data, skeleton, modelSpacePose, skinningMatrices);
+
+			for (auto i = 0u; i < jointsCount; i++)
+			{
+				EXPECT_TRUE(MatricesNear(expected[i], skinningMatrices[i], 1e-4f));
+			}
+		}
+	}
+}
+
+TEST(Animation, SampledFrameDoesNotAllocate)
+{
+	const auto skeleton = CreateChainSkeleton();
+	const auto dataSet = CreateAnimationDataSet(2);
+	const auto instance0 =
+		AnimationInstance{ .data = dataSet.animations[0], .playbackRate = 1.0f, .startTime = 0.0f, .loop = true };
+	const auto instance1 =
+		AnimationInstance{ .data = dataSet.animations[1], .playbackRate = 1.5f, .startTime = 0.0f, .loop = true };
+
+	auto& arena = GetThreadPoseArena();
+	arena.Reserve(3 * jointsCount);
+	auto matrices = std::vector<Math::Matrix4x4>(jointsCount);
+
+	const auto allocationsBefore = Memory::threadAllocationStatistics.allocationCount;
+
+	for (auto frame = 0; frame < 120; frame++)
+	{
+		const auto globalTime = static_cast<Float>(frame) / 60.0f;
+
+		const auto pose0 = arena.Allocate(jointsCount);
+		const auto pose1 = arena.Allocate(jointsCount);
+		const auto pose = arena.Allocate(jointsCount);
+
+		SamplePose(dataSet, instance0, globalTime, pose0);
+		SamplePose(dataSet, instance1, globalTime, pose1);
+		BlendPose(pose0, pose1, 0.5f, pose);
+		ComputeJointsMatrices(pose, skeleton, matrices);
+		ApplyBindPose(matrices, skeleton);
+
+		arena.Reset();
+	}
+
+	EXPECT_EQ(allocationsBefore, Memory::threadAllocationStatistics.allocationCount);
+}
+
+TEST(Animation, SoASamplingMatchesAoSForAllInstructionSets)
+{
+	const auto dataSet = CreateAnimationDataSet(3);
+	const auto dataSetSoA = ConvertToSoA(dataSet);
+
+	auto reference = std::vector<JointAnimationData>(jointsCount);
+	auto pose = std::vector<JointAnimationData>(jointsCount);
+
+	for (const auto instructionSet : { SimdInstructionSet::scalar, SimdInstructionSet::sse, SimdInstructionSet::avx2 })
+	{
+		if (not IsInstructionSetSupported(instructionSet))
+		{
+			continue;
+		}
+		for (const auto& clip : dataSet.animations)
+		{
+			for (auto time = 0.0f; time < clip.duration; time += 0.013f)
+			{
+				SamplePose(dataSet, clip, time, reference);
+				SamplePose(dataSetSoA, clip, time, pose, instructionSet);
+
+				for (auto i = 0u; i < jointsCount; i++)
+				{
+					// nlerp and slerp agree up to the sign of the quaternion and a small angular error
+					EXPECT_NEAR(std::abs(glm::dot(reference[i].rotation, pose[i].rotation)), 1.0f, 1e-4f);
+					EXPECT_NEAR(glm::distance(reference[i].translation, pose[i].translation), 0.0f, 1e-5f);
+					EXPECT_NEAR(glm::distance(reference[i].scale, pose[i].scale), 0.0f, 1e-5f);
+				}
+			}
+		}
+	}
+}
+
+TEST(Animation, CrowdUpdaterMatchesSerialEvaluation)
+{
+	const auto skeletons = std::vector<Skeleton>{ CreateChainSkeleton() };
+	const auto dataSet = CreateAnimationDataSet(2);
+
+	auto instances = std::vector<CrowdInstance>{};
+	for (auto i = 0u; i < 1000; i++)
+	{
+		instances.push_back(CrowdInstance{ .skeletonIndex = 0,
+										   .animation = { .data = dataSet.animations[i % 2],
+														  .playbackRate = 1.0f,
+														  .startTime = 0.01f * i,
+														  .loop = true },
+										   .blendAnimation = { .data = dataSet.animations[(i + 1) % 2],
+															   .playbackRate = 0.5f,
+															   .startTime = 0.0f,
+															   .loop = true },
+										   .blendFactor = (i % 5) * 0.25f });
+	}
+
+	auto jobSystem = JobSystem{ 4 };
+	auto crowdUpdater = CrowdUpdater{ jobSystem };
+	auto skinningMatrices = std::vector<Math::Matrix4x4>(crowdUpdater.Prepare(skeletons, instances));
+
+	const auto globalTime = 2.75f;
+	crowdUpdater.Update(dataSet, skeletons, instances, globalTime, skinningMatrices);
+
+	for (auto i = 0u; i < instances.size(); i++)
+	{
+		const auto& instance = instances[i];
+		auto pose = SamplePose(dataSet, instance.animation, globalTime);
+		if (instance.blendFactor > 0.0f)
+		{
+			pose = BlendPose(pose, SamplePose(dataSet, instance.blendAnimation, globalTime), instance.blendFactor);
+		}
+		auto expected = ComputeJointsMatrices(pose, skeletons[0]);
+		ApplyBindPose(expected, skeletons[0]);
+
+		const auto offset = crowdUpdater.GetInstanceOffset(i);
+		EXPECT_EQ(offset % CrowdUpdater::instanceAlignmentInMatrices, 0);
+		for (auto j = 0u; j < jointsCount; j++)
+		{
+			// Slerp results are unit length only up to ~1e-5, which the matrix and quaternion chains amplify
+			// differently over the depth of the skeleton.
+			EXPECT_TRUE(MatricesNear(expected[j], skinningMatrices[offset + j], 1e-3f));
+		}
+	}
+}
+
+TEST(Animation, SmallestThreeQuaternionRoundTrip)
+{
+	for (auto i = 0; i < 1000; i++)
+	{
+		const auto axis = glm::normalize(Math::Vector3{ std::sin(0.7f * i), std::cos(1.3f * i), 0.3f });
+		const auto rotation = glm::angleAxis(0.011f * i, axis);
+		const auto decoded = Detail::DequantizeRotation(Detail::QuantizeRotation(rotation));
+		EXPECT_LT(RotationAngle(rotation, decoded), 2e-4f);
+	}
+}
+
+TEST(Animation, CompressedClipSizeAndError)
+{
+	const auto motionCaptureJoints = 40u;
+	const auto dataSet = CreateMotionCaptureDataSet(motionCaptureJoints, 600);
+	const auto settings = AnimationCompressionSettings{};
+	const auto compressed = Compress(dataSet, settings);
+
+	const auto denseSize = dataSet.animationDatabase.size() * sizeof(JointAnimationData);
+	const auto compressionRatio =
+		static_cast<Float>(denseSize) / static_cast<Float>(compressed.GetMemoryFootprint());
+
+	const auto& clip = dataSet.animations.front();
+	auto reference = std::vector<JointAnimationData>(motionCaptureJoints);
+	auto pose = std::vector<JointAnimationData>(motionCaptureJoints);
+
+	auto maxRotationErrorOnFrames = 0.0f;
+	auto maxTranslationErrorOnFrames = 0.0f;
+	auto maxScaleErrorOnFrames = 0.0f;
+	for (auto frame = 0u; frame < clip.frames; frame++)
+	{
+		const auto time = static_cast<Float>(frame) * clip.duration / clip.frames;
+		SamplePose(dataSet, clip, time, reference);
+		SamplePose(compressed, clip, time, pose);
+		for (auto i = 0u; i < motionCaptureJoints; i++)
+		{
+			maxRotationErrorOnFrames =
+				std::max(maxRotationErrorOnFrames, RotationAngle(reference[i].rotation, pose[i].rotation));
+			maxTranslationErrorOnFrames = std::max(maxTranslationErrorOnFrames,
+												   glm::distance(reference[i].translation, pose[i].translation));
+			maxScaleErrorOnFrames =
+				std::max(maxScaleErrorOnFrames, glm::distance(reference[i].scale, pose[i].scale));
+		}
+	}
+
+	auto maxRotationError = 0.0f;
+	auto maxTranslationError = 0.0f;
+	for (auto time = 0.0f; time < clip.duration; time += 0.0037f)
+	{
+		SamplePose(dataSet, clip, time, reference);
+		SamplePose(compressed, clip, time, pose);
+		for (auto i = 0u; i < motionCaptureJoints; i++)
+		{
+			maxRotationError = std::max(maxRotationError, RotationAngle(reference[i].rotation, pose[i].rotation));
+			maxTranslationError =
+				std::max(maxTranslationError, glm::distance(reference[i].translation, pose[i].translation));
+		}
+	}
+
+	RecordProperty("compression_ratio", std::to_string(compressionRatio));
+	RecordProperty("max_rotation_error_radians", std::to_string(maxRotationError));
+	RecordProperty("max_translation_error", std::to_string(maxTranslationError));
+
+	EXPECT_GE(compressionRatio, 5.0f);
+	EXPECT_LE(maxRotationErrorOnFrames, settings.rotationErrorBudget * 1.01f);
+	EXPECT_LE(maxTranslationErrorOnFrames, settings.translationErrorBudget * 1.01f);
+	EXPECT_LE(maxScaleErrorOnFrames, settings.scaleErrorBudget * 1.01f);
+	EXPECT_LE(maxRotationError, 2.0f * settings.rotationErrorBudget);
+	EXPECT_LE(maxTranslationError, 2.0f * settings.translationErrorBudget);
+}
+
+TEST(Animation, CrowdLodReusesPosesOfDistantInstances)
+{
+	const auto skeletons = std::vector<Skeleton>{ CreateTreeSkeleton() };
+	const auto dataSet = CreateAnimationDataSet(1);
+	const auto camera = Camera{ .position = Math::Vector3{ 0.0f, 0.0f, 0.0f },
+								.forward = Math::Vector3{ 0.0f, 0.0f, 1.0f },
+								.up = Math::Vector3{ 0.0f, 1.0f, 0.0f } };
+
+	auto instances = std::vector<CrowdInstance>{};
+	for (auto i = 0u; i < 64; i++)
+	{
+		instances.push_back(CrowdInstance{
+			.animation = { .data = dataSet.animations[0], .playbackRate = 1.0f, .startTime = 0.0f, .loop = true },
+			.position = Math::Vector3{ 0.0f, 0.0f, i < 32 ? 2.0f : 500.0f } });
+	}
+
+	auto jobSystem = JobSystem{ 4 };
+	auto crowdUpdater = CrowdUpdater{ jobSystem };
+	const auto farLevel = static_cast<U32>(crowdUpdater.lodSettings.levels.size() - 1);
+	const auto updateInterval = crowdUpdater.lodSettings.levels[farLevel].updateInterval;
+	ASSERT_GT(updateInterval, 1);
+
+	auto previous = std::vector<Math::Matrix4x4>(crowdUpdater.Prepare(skeletons, instances));
+	crowdUpdater.SelectLodLevels(camera, instances);
+	crowdUpdater.Update(dataSet, skeletons, instances, 0.1f, previous);
+
+	for (auto frame = 1u; frame < 2 * updateInterval; frame++)
+	{
+		auto current = std::vector<Math::Matrix4x4>(crowdUpdater.Prepare(skeletons, instances));
+		crowdUpdater.SelectLodLevels(camera, instances);
+		crowdUpdater.Update(dataSet, skeletons, instances, 0.1f + 0.05f * frame, current);
+
+		for (auto i = 0u; i < instances.size(); i++)
+		{
+			const auto offset = crowdUpdater.GetInstanceOffset(i);
+			const auto isFar = i >= 32;
+			EXPECT_EQ(crowdUpdater.GetInstanceLodLevel(i), isFar ? farLevel : 0);
+
+			const auto updated = not isFar or (frame + i) % updateInterval == 0;
+			const auto unchanged =
+				std::equal(current.begin() + offset, current.begin() + offset + jointsCount, previous.begin() + offset,
+						   [](const Math::Matrix4x4& a, const Math::Matrix4x4& b) { return a == b; });
+			EXPECT_NE(updated, unchanged);
+		}
+		previous = std::move(current);
+	}
+}
+
+namespace
+{
+	AnimationInstance CreateInstance(const AnimationData& data)
+	{
+		return AnimationInstance{ .data = data, .playbackRate = 1.0f, .startTime = 0.0f, .loop = true };
+	}
+
+	void ExpectPosesNear(std::span<const JointAnimationData> a, std::span<const JointAnimationData> b)
+	{
+		ASSERT_EQ(a.size(), b.size());
+		for (auto i = 0u; i < a.size(); i++)
+		{
+			EXPECT_NEAR(std::abs(glm::dot(a[i].rotation, b[i].rotation)), 1.0f, 1e-5f);
+			EXPECT_NEAR(glm::distance(a[i].translation, b[i].translation), 0.0f, 1e-5f);
+		}
+	}
+} // namespace
+
+TEST(Animation, BlendSpacesMatchDirectSampling)
+{
+	const auto dataSet = CreateAnimationDataSet(3);
+	const auto time = 0.43f;
+
+	// Positions are given out of order on purpose, the compiler sorts 1D blend spaces.
+	const auto description = BlendTreeDescription{
+		.nodes = { BlendTreeNode{ .type = BlendNodeType::blendSpace1D,
+								  .children = { 1, 2, 3 },
+								  .positions = { Math::Vector2{ 1.0f, 0.0f }, Math::Vector2{ -1.0f, 0.0f },
+												 Math::Vector2{ 0.0f, 0.0f } },
+								  .parameter = 0 },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[0]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[1]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[2]) } },
+		.parametersCount = 1
+	};
+	const auto tree = Compile(description, jointsCount);
+	EXPECT_EQ(tree.instructions.size(), 4);
+	EXPECT_EQ(tree.registersCount, 3);
+
+	auto scratch = BlendTreeScratch{};
+	auto pose = std::vector<JointAnimationData>(jointsCount);
+	const auto clip1 = SamplePose(dataSet, dataSet.animations[1], time);
+	const auto clip2 = SamplePose(dataSet, dataSet.animations[2], time);
+
+	Evaluate(tree, dataSet, std::array{ -3.0f }, time, scratch, pose);
+	ExpectPosesNear(pose, clip1.data);
+
+	Evaluate(tree, dataSet, std::array{ -0.5f }, time, scratch, pose);
+	const auto halfway = BlendPose(clip1, clip2, 0.5f);
+	ExpectPosesNear(pose, halfway.data);
+
+	const auto description2D = BlendTreeDescription{
+		.nodes = { BlendTreeNode{ .type = BlendNodeType::blendSpace2D,
+								  .children = { 1, 2, 3 },
+								  .positions = { Math::Vector2{ 0.0f, 0.0f }, Math::Vector2{ 1.0f, 0.0f },
+												 Math::Vector2{ 0.0f, 1.0f } },
+								  .parameter = 0,
+								  .parameterY = 1 },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[0]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[1]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[2]) } },
+		.parametersCount = 2
+	};
+	const auto tree2D = Compile(description2D, jointsCount);
+	Evaluate(tree2D, dataSet, std::array{ 0.0f, 1.0f }, time, scratch, pose);
+	ExpectPosesNear(pose, clip2.data);
+}
+
+TEST(Animation, AdditiveAndMaskedOverrideLayers)
+{
+	const auto skeleton = CreateTreeSkeleton();
+	const auto dataSet = CreateAnimationDataSet(2);
+	const auto time = 0.61f;
+	const auto base = SamplePose(dataSet, dataSet.animations[0], time);
+	const auto layer = SamplePose(dataSet, dataSet.animations[1], time);
+
+	// Adding the difference between layer and base on top of base gives layer back.
+	const auto additive = BlendTreeDescription{
+		.nodes = { BlendTreeNode{ .type = BlendNodeType::additive, .children = { 1, 2, 1 }, .parameter = 0 },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[0]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[1]) } },
+		.parametersCount = 1
+	};
+	const auto additiveTree = Compile(additive, jointsCount);
+
+	auto scratch = BlendTreeScratch{};
+	auto pose = std::vector<JointAnimationData>(jointsCount);
+	Evaluate(additiveTree, dataSet, std::array{ 1.0f }, time, scratch, pose);
+	ExpectPosesNear(pose, layer.data);
+	Evaluate(additiveTree, dataSet, std::array{ 0.0f }, time, scratch, pose);
+	ExpectPosesNear(pose, base.data);
+
+	const auto maskRoot = 2u;
+	const auto masked = BlendTreeDescription{
+		.nodes = { BlendTreeNode{ .type = BlendNodeType::maskedOverride, .children = { 1, 2 }, .parameter = 0 },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[0]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[1]) } },
+		.parametersCount = 1,
+		.masks = { CreateSubtreeMask(skeleton, maskRoot) }
+	};
+	const auto maskedTree = Compile(masked, jointsCount);
+	Evaluate(maskedTree, dataSet, std::array{ 1.0f }, time, scratch, pose);
+
+	for (auto i = 0u; i < jointsCount; i++)
+	{
+		auto isInSubtree = false;
+		for (auto joint = static_cast<I32>(i); joint >= 0; joint = skeleton.parentIndices[joint])
+		{
+			isInSubtree = isInSubtree or joint == static_cast<I32>(maskRoot);
+		}
+		const auto& expected = isInSubtree ? layer.data[i] : base.data[i];
+		EXPECT_NEAR(std::abs(glm::dot(pose[i].rotation, expected.rotation)), 1.0f, 1e-5f);
+		EXPECT_NEAR(glm::distance(pose[i].translation, expected.translation), 0.0f, 1e-5f);
+	}
+}
+
+TEST(Animation, BlendTreeEvaluationDoesNotAllocate)
+{
+	const auto skeleton = CreateTreeSkeleton();
+	const auto dataSet = CreateAnimationDataSet(3);
+	const auto description = BlendTreeDescription{
+		.nodes = { BlendTreeNode{ .type = BlendNodeType::maskedOverride, .children = { 1, 4 }, .parameter = 1 },
+				   BlendTreeNode{ .type = BlendNodeType::blendSpace1D,
+								  .children = { 2, 3 },
+								  .positions = { Math::Vector2{ 0.0f, 0.0f }, Math::Vector2{ 1.0f, 0.0f } },
+								  .parameter = 0 },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[0]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[1]) },
+				   BlendTreeNode{ .clip = CreateInstance(dataSet.animations[2]) } },
+		.parametersCount = 2,
+		.masks = { CreateSubtreeMask(skeleton, 1) }
+	};
+	const auto tree = Compile(description, jointsCount);
+
+	auto scratch = BlendTreeScratch{};
+	scratch.Reserve(tree);
+	auto pose = std::vector<JointAnimationData>(jointsCount);
+	const auto allocationsBefore = Memory::threadAllocationStatistics.allocationCount;
+
+	for (auto frame = 0; frame < 120; frame++)
+	{
+		const auto parameters = std::array{ frame / 120.0f, 0.5f };
+		Evaluate(tree, dataSet, parameters, frame / 60.0f, scratch, pose);
+	}
+
+	EXPECT_EQ(allocationsBefore, Memory::threadAllocationStatistics.allocationCount);
+}
+
+TEST(Animation, CookedAnimationRoundTripAndInvalidation)
+{
+	const auto skeleton = CreateTreeSkeleton();
+	const auto dataSet = CreateAnimationDataSet(3);
+	const auto directory = std::filesystem::temp_directory_path() / "Framework_test_animation_cache";
+	std::filesystem::create_directories(directory);
+	const auto cookedPath = GetCookedAnimationPath(directory / "clips.glb", 60);
+	constexpr auto sourceHash = U64{ 0x1234'5678'9abc'def0 };
+
+	ASSERT_TRUE(WriteCookedAnimation(cookedPath, sourceHash, 60, skeleton, dataSet));
+	{
+		const auto cooked = LoadCookedAnimation(cookedPath, sourceHash, 60);
+		ASSERT_TRUE(cooked.has_value());
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(cooked->animationDatabase.data()) % 64, 0u);
+
+		ASSERT_EQ(cooked->skeleton.joints.size(), skeleton.joints.size());
+		EXPECT_EQ(cooked->skeleton.jointsCountUpToDepth, skeleton.jointsCountUpToDepth);
+		for (auto i = 0u; i < skeleton.joints.size(); i++)
+		{
+			EXPECT_EQ(cooked->skeleton.joints[i].parentIndex, skeleton.joints[i].parentIndex);
+			EXPECT_EQ(cooked->skeleton.joints[i].name, skeleton.joints[i].name);
+			EXPECT_TRUE(MatricesNear(cooked->skeleton.inverseBindPoses[i], skeleton.inverseBindPoses[i], 0.0f));
+		}
+
+		ASSERT_EQ(cooked->animations.size(), dataSet.animations.size());
+		for (auto i = 0u; i < dataSet.animations.size(); i++)
+		{
+			EXPECT_EQ(cooked->animations[i].animationName, dataSet.animations[i].animationName);
+
+			// Sampling in place from the mapping gives the same pose as the source data set.
+			const auto instance = CreateInstance(dataSet.animations[i]);
+			const auto expected = SamplePose(dataSet, instance, 0.37f);
+			const auto actual = SamplePose(cooked->GetDataSet(), CreateInstance(cooked->animations[i]), 0.37f);
+			for (auto joint = 0u; joint < jointsCount; joint++)
+			{
+				EXPECT_EQ(actual.data[joint].rotation, expected.data[joint].rotation);
+				EXPECT_EQ(actual.data[joint].translation, expected.data[joint].translation);
+			}
+		}
+	}
+
+	EXPECT_FALSE(LoadCookedAnimation(cookedPath, sourceHash + 1, 60).has_value());
+	EXPECT_FALSE(LoadCookedAnimation(cookedPath, sourceHash, 30).has_value());
+	EXPECT_FALSE(LoadCookedAnimation(directory / "missing.animcache", sourceHash, 60).has_value());
+
+	std::filesystem::resize_file(cookedPath, std::filesystem::file_size(cookedPath) - 1);
+	EXPECT_FALSE(LoadCookedAnimation(cookedPath, sourceHash, 60).has_value());
+
+	std::filesystem::remove_all(directory);
+}
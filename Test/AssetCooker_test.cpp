@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <AssetCooker.hpp>
+
+using namespace Framework;
+
+namespace
+{
+	void WriteTriangle(const std::filesystem::path& folder, Float x)
+	{
+		const auto positions = std::array{ 0.0f, 0.0f, 0.0f, x, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+		{
+			auto binary = std::ofstream{ folder / "triangle.bin", std::ios::binary };
+			binary.write(reinterpret_cast<const char*>(positions.data()), sizeof(positions));
+		}
+		auto gltf = std::ofstream{ folder / "triangle.gltf" };
+		gltf << R"({
+			"asset": { "version": "2.0" },
+			"scene": 0,
+			"scenes": [ { "nodes": [ 0 ] } ],
+			"nodes": [ { "mesh": 0 } ],
+			"meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],
+			"buffers": [ { "byteLength": 36, "uri": "triangle.bin" } ],
+			"bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 36 } ],
+			"accessors": [ { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+							 "min": [ 0, 0, 0 ], "max": [ 2, 1, 0 ] } ]
+		})";
+	}
+} // namespace
+
+TEST(AssetCooker, CooksOnlyChangedSources)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto folder = std::filesystem::path{ "cook_folder" };
+	std::filesystem::remove_all(folder);
+	std::filesystem::create_directories(folder / "nested");
+	std::filesystem::copy_file(std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj",
+							   folder / "nested" / "bunny.obj");
+	WriteTriangle(folder, 1.0f);
+
+	const auto sources = ScanSourceAssets(folder);
+	ASSERT_EQ(sources.size(), 2);
+	const auto dependencies = GetSourceDependencies(folder / "triangle.gltf");
+	ASSERT_EQ(dependencies.size(), 1);
+	EXPECT_EQ(dependencies.front(), folder / "triangle.bin");
+
+	auto settings = CookSettings{};
+	settings.meshImportSettings = MeshImportSettings{
+		.verticesStreamDeclarations = { VerticesStreamDeclaration{ .hasPosition = true } }, .compactIndices = true
+	};
+	auto report = CookFolder(folder, settings);
+	EXPECT_TRUE(report.failedSources.empty());
+	EXPECT_EQ(report.cookedCount, 2);
+	for (const auto& source : sources)
+	{
+		EXPECT_TRUE(AssetContainer::Open(GetCookedMeshesPath(source)).has_value());
+	}
+	// The runtime keeps what the cooker wrote for the same files and settings.
+	const auto cookedPath = GetCookedMeshesPath(folder / "triangle.gltf");
+	const auto cookedTime = std::filesystem::last_write_time(cookedPath);
+	EXPECT_TRUE(LoadOrCookMeshes(folder / "triangle.gltf", settings.meshImportSettings).has_value());
+	EXPECT_EQ(std::filesystem::last_write_time(cookedPath), cookedTime);
+
+	report = CookFolder(folder, settings);
+	EXPECT_EQ(report.cookedCount, 0);
+	EXPECT_EQ(report.upToDateCount, 2);
+
+	// A deleted output cooks its source again.
+	std::filesystem::remove(cookedPath);
+	report = CookFolder(folder, settings);
+	EXPECT_EQ(report.cookedCount, 1);
+	EXPECT_EQ(report.upToDateCount, 1);
+	const auto cookedSourceHash = AssetContainer::Open(cookedPath)->GetSourceHash();
+
+	// A touched dependency with the same content is hashed, not cooked.
+	const auto Touch = [](const std::filesystem::path& path, int seconds)
+	{
+		const auto writeTime = std::filesystem::last_write_time(path);
+		std::filesystem::last_write_time(path, writeTime + std::chrono::seconds{ seconds });
+	};
+	Touch(folder / "triangle.bin", 5);
+	report = CookFolder(folder, settings);
+	EXPECT_EQ(report.cookedCount, 0);
+	EXPECT_EQ(report.upToDateCount, 2);
+
+	// Changing the buffer of the glTF file cooks it again, only it.
+	WriteTriangle(folder, 2.0f);
+	// Same size, the write time has to differ even on file systems with a coarse clock.
+	Touch(folder / "triangle.bin", 10);
+	report = CookFolder(folder, settings);
+	EXPECT_EQ(report.cookedCount, 1);
+	EXPECT_EQ(report.upToDateCount, 1);
+	// The buffer is part of what the container was cooked from.
+	EXPECT_NE(AssetContainer::Open(cookedPath)->GetSourceHash(), cookedSourceHash);
+
+	settings.compress = true;
+	report = CookFolder(folder, settings);
+	EXPECT_EQ(report.cookedCount, 2);
+}
+
+TEST(AssetCooker, CooksStaticSourcesWithDefaultSettings)
+{
+	const auto folder = std::filesystem::path{ "cook_static_folder" };
+	std::filesystem::remove_all(folder);
+	std::filesystem::create_directories(folder);
+	WriteTriangle(folder, 1.0f);
+
+	// The runtime layout has joint attributes, meshes without bones get no influences instead of failing.
+	const auto report = CookFolder(folder, CookSettings{});
+	EXPECT_TRUE(report.failedSources.empty());
+	EXPECT_EQ(report.cookedCount, 1);
+}
@@ -1,10 +1,21 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <set>
+#include <span>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <AssetHelper.hpp>
+#include <AssetRegistry.hpp>
+#include <Hash.hpp>
+#include <Memory.hpp>
 
 
 using namespace Framework;
@@ -28,3 +39,295 @@ TEST(AssetStoringAndLoading, StoreAsset)
 
 	ASSERT_TRUE(true);
 }
+
+TEST(AssetStoringAndLoading, StoreEncodedBinarySources)
+{
+	// Strip of quads, with 16 bit indices and 8 byte vertices.
+	auto indices = std::vector<U16>{};
+	auto vertices = std::vector<U16>{};
+	for (auto i = U16{ 0 }; i < 1000; i++)
+	{
+		vertices.insert(vertices.end(), { static_cast<U16>(i * 3), 0, 0, 0, static_cast<U16>(i * 3), 1000, 0, 0 });
+		const auto corner = static_cast<U16>(i * 2);
+		if (i + 1 < 1000)
+		{
+			indices.insert(indices.end(), { corner, static_cast<U16>(corner + 1), static_cast<U16>(corner + 2),
+											static_cast<U16>(corner + 2), static_cast<U16>(corner + 1),
+											static_cast<U16>(corner + 3) });
+		}
+	}
+	const auto raw = std::vector<std::byte>(16, std::byte{ 42 });
+
+	const auto file = std::string{ "test_encoded_sources.bin" };
+	auto sources = std::vector<BinarySourceFile>{};
+	{
+		auto stream = std::ofstream{ file, std::ios::binary };
+		sources.push_back(WriteBinarySource(stream, file, raw, BinaryEncoding::raw));
+		sources.push_back(
+			WriteBinarySource(stream, file, std::as_bytes(std::span{ indices }), BinaryEncoding::indexCodec, 2));
+		sources.push_back(
+			WriteBinarySource(stream, file, std::as_bytes(std::span{ vertices }), BinaryEncoding::vertexCodec, 8));
+	}
+	EXPECT_LT(sources[1].size, sources[1].decodedSize / 4);
+	EXPECT_LT(sources[2].size, sources[2].decodedSize / 2);
+
+	// Ranges survive the JSON metadata.
+	const auto json = nlohmann::json(sources);
+	sources = json.get<std::vector<BinarySourceFile>>();
+
+	auto decodedRaw = std::vector<std::byte>(raw.size());
+	EXPECT_TRUE(ReadBinarySource(sources[0], decodedRaw));
+	EXPECT_EQ(decodedRaw, raw);
+
+	auto decodedIndices = std::vector<U16>(indices.size());
+	EXPECT_TRUE(ReadBinarySource(sources[1], std::as_writable_bytes(std::span{ decodedIndices })));
+	// Triangles may come back rotated.
+	for (auto i = 0u; i < indices.size(); i += 3)
+	{
+		auto triangle = std::array{ indices[i], indices[i + 1], indices[i + 2] };
+		auto decodedTriangle = std::array{ decodedIndices[i], decodedIndices[i + 1], decodedIndices[i + 2] };
+		std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+		std::ranges::rotate(decodedTriangle, std::ranges::min_element(decodedTriangle));
+		EXPECT_EQ(decodedTriangle, triangle);
+	}
+
+	auto decodedVertices = std::vector<U16>(vertices.size());
+	EXPECT_TRUE(ReadBinarySource(sources[2], std::as_writable_bytes(std::span{ decodedVertices })));
+	EXPECT_EQ(decodedVertices, vertices);
+}
+
+TEST(AssetStoringAndLoading, AssetContainerRoundTrip)
+{
+	auto vertices = std::vector<U16>{};
+	for (auto i = U16{ 0 }; i < 1000; i++)
+	{
+		vertices.insert(vertices.end(), { static_cast<U16>(i * 3), 0, 0, 0, static_cast<U16>(i * 3), 1000, 0, 0 });
+	}
+	const auto description = std::vector<std::byte>(20, std::byte{ 7 });
+	const auto meshUuid = MakeAssetUuid(1, 2);
+	const auto sceneUuid = MakeAssetUuid(3, 4);
+
+	auto builder = AssetContainerBuilder{};
+	builder.BeginAsset(sceneUuid, AssetType::scene);
+	builder.AddPayload(std::as_bytes(std::span{ &meshUuid, 1 }));
+	builder.BeginAsset(meshUuid, AssetType::subMesh);
+	builder.AddPayload(description);
+	builder.AddPayload(std::as_bytes(std::span{ vertices }), BinaryEncoding::vertexCodec, 8);
+	ASSERT_TRUE(builder.Write("test_container.assets", 42));
+
+	const auto container = AssetContainer::Open("test_container.assets");
+	ASSERT_TRUE(container.has_value());
+	EXPECT_EQ(container->GetSourceHash(), 42);
+	EXPECT_EQ(container->GetEntries().size(), 2);
+	EXPECT_EQ(container->Find(MakeAssetUuid(5, 6)), nullptr);
+
+	const auto scene = container->Find(sceneUuid);
+	ASSERT_NE(scene, nullptr);
+	EXPECT_EQ(scene->type, AssetType::scene);
+	ASSERT_EQ(scene->payloadsCount, 1);
+
+	const auto mesh = container->Find(meshUuid);
+	ASSERT_NE(mesh, nullptr);
+	EXPECT_EQ(mesh->type, AssetType::subMesh);
+	const auto payloads = container->GetPayloads(*mesh);
+	ASSERT_EQ(payloads.size(), 2);
+	for (const auto& payload : payloads)
+	{
+		// Aligned in the file and in memory, the mapping starts on a page boundary.
+		EXPECT_EQ(payload.offset % payloadAlignment, 0);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(container->GetPayloadData(payload).data()) % payloadAlignment, 0);
+	}
+
+	// Raw payloads are used in place.
+	const auto storedDescription = container->GetPayloadData(payloads[0]);
+	EXPECT_TRUE(std::ranges::equal(storedDescription, description));
+
+	EXPECT_LT(payloads[1].size, payloads[1].decodedSize);
+	auto decodedVertices = std::vector<U16>(vertices.size());
+	EXPECT_TRUE(container->Decode(payloads[1], std::as_writable_bytes(std::span{ decodedVertices })));
+	EXPECT_EQ(decodedVertices, vertices);
+
+	// A truncated file is rejected rather than read out of bounds.
+	std::filesystem::resize_file("test_container.assets", payloads[1].offset + 1);
+	EXPECT_FALSE(AssetContainer::Open("test_container.assets").has_value());
+}
+
+TEST(AssetStoringAndLoading, ContentHashSeparatesCancellingBitFlips)
+{
+	// Sign flips of two words cancel out in the FNV change detection hash, not in the content hash.
+	const auto values = std::array{ 0.1, 0.2, 0.3, 0.4, 0.5, 0.6 };
+	const auto flippedValues = std::array{ 0.1, -0.2, 0.3, -0.4, 0.5, 0.6 };
+	EXPECT_EQ(Hash::HashBytes(std::as_bytes(std::span{ values })),
+			  Hash::HashBytes(std::as_bytes(std::span{ flippedValues })));
+	EXPECT_NE(Hash::HashContent(std::as_bytes(std::span{ values })),
+			  Hash::HashContent(std::as_bytes(std::span{ flippedValues })));
+
+	// The length is part of the content, trailing zero bytes do not vanish.
+	const auto bytes = std::array<std::byte, 11>{};
+	EXPECT_NE(Hash::HashContent(std::span{ bytes }), Hash::HashContent(std::span{ bytes }.first(10)));
+	EXPECT_NE(Hash::HashContent(std::span{ bytes }.first(8)), Hash::HashContent(std::span{ bytes }.first(0)));
+}
+
+TEST(AssetStoringAndLoading, AssetMetadataRoundTrip)
+{
+	auto uuidGenerator = uuids::uuid_system_generator{};
+	auto files = std::vector<AssetFile>{};
+	for (auto i = 0; i < 3; i++)
+	{
+		auto& file = files.emplace_back(AssetFile{
+			.uuid = uuidGenerator(), .name = runtime_format("test_asset_file_{}", i), .version = 1, .assets = {} });
+		for (auto j = 0; j < 4; j++)
+		{
+			file.assets.push_back(AssetNode{ .uuid = uuidGenerator(),
+											 .name = runtime_format("test_subMesh_{}", j),
+											 .type = j == 0 ? AssetType::scene : AssetType::subMesh,
+											 .version = 2,
+											 .assetNodeData = "{}" });
+		}
+	}
+	ASSERT_TRUE(WriteAssetMetadata("test_metadata.assetmeta", files));
+
+	const auto catalogue = AssetCatalogue::Open("test_metadata.assetmeta");
+	ASSERT_TRUE(catalogue.has_value());
+	ASSERT_EQ(catalogue->GetFiles().size(), files.size());
+	EXPECT_EQ(catalogue->GetNodes().size(), 12);
+	// Node names and data repeat in every file, they are stored once.
+	auto strings = std::set<std::string>{};
+	for (const auto& file : files)
+	{
+		strings.insert(file.name);
+		for (const auto& node : file.assets)
+		{
+			strings.insert(node.name);
+			strings.insert(node.assetNodeData);
+		}
+	}
+	auto stringsSize = std::size_t{ 0 };
+	for (const auto& string : strings)
+	{
+		stringsSize += string.size();
+	}
+	EXPECT_EQ(catalogue->GetStringsSize(), stringsSize);
+
+	// Walking the records only hands out views into the mapping.
+	const auto allocationsBefore = Memory::threadAllocationStatistics.allocationCount;
+	auto matchingNodes = 0u;
+	for (auto i = 0u; i < files.size(); i++)
+	{
+		const auto& fileRecord = catalogue->GetFiles()[i];
+		EXPECT_EQ(catalogue->GetName(fileRecord), files[i].name);
+		EXPECT_EQ(FromUuidBytes(fileRecord.uuid), files[i].uuid);
+		const auto nodes = catalogue->GetNodes(fileRecord);
+		for (auto j = 0u; j < nodes.size(); j++)
+		{
+			const auto& node = files[i].assets[j];
+			if (FromUuidBytes(nodes[j].uuid) == node.uuid and catalogue->GetName(nodes[j]) == node.name and
+				catalogue->GetAssetNodeData(nodes[j]) == node.assetNodeData and nodes[j].type == node.type and
+				nodes[j].version == node.version)
+			{
+				matchingNodes++;
+			}
+		}
+	}
+	EXPECT_EQ(allocationsBefore, Memory::threadAllocationStatistics.allocationCount);
+	EXPECT_EQ(matchingNodes, 12);
+
+	// The JSON debug export matches what was written.
+	EXPECT_EQ(nlohmann::json(ExportAssetFiles(*catalogue)), nlohmann::json(files));
+
+	// A truncated file is rejected rather than read out of bounds.
+	std::filesystem::resize_file("test_metadata.assetmeta", std::filesystem::file_size("test_metadata.assetmeta") - 1);
+	EXPECT_FALSE(AssetCatalogue::Open("test_metadata.assetmeta").has_value());
+}
+
+TEST(AssetStoringAndLoading, AssetRegistryResolvesLazily)
+{
+	auto vertices = std::vector<U16>{};
+	for (auto i = U16{ 0 }; i < 1000; i++)
+	{
+		vertices.insert(vertices.end(), { static_cast<U16>(i * 3), 0, 0, 0, static_cast<U16>(i * 3), 1000, 0, 0 });
+	}
+	constexpr auto assetsCount = 10000u;
+	// MakeAssetUuid() keeps all the bits of small values only in its first argument.
+	const auto AssetUuid = [](U64 file, U64 asset) { return MakeAssetUuid(asset, file); };
+	const auto paths = std::array{ "test_registry_0.assets", "test_registry_1.assets" };
+	for (auto file = 0u; file < paths.size(); file++)
+	{
+		auto builder = AssetContainerBuilder{};
+		for (auto i = 0u; i < assetsCount; i++)
+		{
+			builder.BeginAsset(AssetUuid(file, i), AssetType::subMesh);
+			builder.AddPayload(std::as_bytes(std::span{ &i, 1 }));
+		}
+		builder.BeginAsset(AssetUuid(file, assetsCount), AssetType::scene);
+		builder.AddPayload(std::as_bytes(std::span{ vertices }), BinaryEncoding::vertexCodec, 8);
+		ASSERT_TRUE(builder.Write(paths[file], file));
+	}
+
+	auto registry = AssetRegistry{};
+	EXPECT_FALSE(registry.AddContainer("test_registry_missing.assets"));
+	ASSERT_TRUE(registry.AddContainer(paths[0]));
+	ASSERT_TRUE(registry.AddContainer(paths[1]));
+	EXPECT_EQ(registry.GetAssetsCount(), 2 * (assetsCount + 1));
+	EXPECT_FALSE(registry.Find(AssetUuid(2, 0)).has_value());
+	EXPECT_FALSE(registry.Resolve(AssetUuid(2, 0)));
+
+	for (auto i = 0u; i < assetsCount; i += 97)
+	{
+		const auto location = registry.Find(AssetUuid(1, i));
+		ASSERT_TRUE(location.has_value());
+		EXPECT_EQ(location->container->GetSourceHash(), 1);
+		EXPECT_EQ(FromUuidBytes(location->entry->uuid), AssetUuid(1, i));
+	}
+	// Finding assets loads nothing.
+	EXPECT_EQ(registry.GetLoadedAssetsCount(), 0);
+
+	{
+		const auto scene = registry.Resolve(AssetUuid(0, assetsCount));
+		ASSERT_TRUE(scene);
+		EXPECT_EQ(scene.GetType(), AssetType::scene);
+		ASSERT_EQ(scene.GetPayloads().size(), 1);
+		EXPECT_TRUE(std::ranges::equal(scene.GetPayloads()[0], std::as_bytes(std::span{ vertices })));
+
+		auto copy = scene;
+		EXPECT_EQ(copy.GetPayloads()[0].data(), scene.GetPayloads()[0].data());
+		EXPECT_EQ(registry.GetLoadedAssetsCount(), 1);
+	}
+	// The last handle unloads the asset.
+	EXPECT_EQ(registry.GetLoadedAssetsCount(), 0);
+
+	// Loader threads resolving the same assets share them.
+	auto threads = std::vector<std::thread>{};
+	auto mismatchesCount = std::atomic<U32>{ 0 };
+	auto handles = std::vector<std::vector<AssetHandle>>(4);
+	for (auto t = 0u; t < handles.size(); t++)
+	{
+		threads.emplace_back(
+			[&, t]
+			{
+				for (auto i = 0u; i < assetsCount; i += 7)
+				{
+					auto handle = registry.Resolve(AssetUuid(i % 2, i));
+					auto value = U32{};
+					std::memcpy(&value, handle.GetPayloads()[0].data(), sizeof(value));
+					if (value != i)
+					{
+						mismatchesCount++;
+					}
+					handles[t].push_back(std::move(handle));
+				}
+			});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	EXPECT_EQ(mismatchesCount, 0);
+	EXPECT_EQ(registry.GetLoadedAssetsCount(), (assetsCount + 6) / 7);
+	for (auto i = 0u; i < handles[0].size(); i++)
+	{
+		EXPECT_EQ(handles[0][i].GetPayloads()[0].data(), handles[3][i].GetPayloads()[0].data());
+	}
+	handles.clear();
+	EXPECT_EQ(registry.GetLoadedAssetsCount(), 0);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <AssetStreamer.hpp>
+#include <MeshCache.hpp>
+
+using namespace Framework;
+
+namespace
+{
+	void WaitForAll(AssetStreamer& streamer)
+	{
+		while (streamer.GetPendingCount() > 0)
+		{
+			streamer.WaitForCompletions();
+			streamer.DispatchCompletions();
+		}
+	}
+} // namespace
+
+TEST(AssetStreamer, StreamsInPriorityOrder)
+{
+	auto vertices = std::vector<U16>{};
+	for (auto i = U16{ 0 }; i < 1000; i++)
+	{
+		vertices.insert(vertices.end(), { static_cast<U16>(i * 3), 0, 0, 0, static_cast<U16>(i * 3), 1000, 0, 0 });
+	}
+	constexpr auto assetsCount = 40u;
+	auto builder = AssetContainerBuilder{};
+	for (auto i = 0u; i < assetsCount; i++)
+	{
+		builder.BeginAsset(MakeAssetUuid(i, 0), AssetType::subMesh);
+		builder.AddPayload(std::as_bytes(std::span{ &i, 1 }));
+		builder.AddPayload(std::as_bytes(std::span{ vertices }), BinaryEncoding::vertexCodec, 8);
+	}
+	ASSERT_TRUE(builder.Write("test_streamer.assets", 0));
+	auto registry = AssetRegistry{};
+	ASSERT_TRUE(registry.AddContainer("test_streamer.assets"));
+
+	for (const auto backend : { StreamingBackend::ioUring, StreamingBackend::pread })
+	{
+		auto streamer = AssetStreamer{ registry, backend };
+		if (backend == StreamingBackend::pread)
+		{
+			EXPECT_EQ(streamer.GetBackend(), StreamingBackend::pread);
+		}
+		EXPECT_EQ(streamer.Request(MakeAssetUuid(assetsCount, 0), 0.0f, [](const StreamedAsset&) {}),
+				  invalidStreamRequest);
+
+		// Later requests are closer, so more urgent.
+		streamer.SetPaused(true);
+		auto order = std::vector<U32>{};
+		auto requests = std::vector<StreamRequestId>{};
+		for (auto i = 0u; i < assetsCount; i++)
+		{
+			requests.push_back(streamer.Request(MakeAssetUuid(i, 0), static_cast<Float>(assetsCount - i),
+												[&](const StreamedAsset& asset)
+												{
+													ASSERT_EQ(asset.payloads.size(), 2);
+													auto value = U32{};
+													std::memcpy(&value, asset.payloads[0].data(), sizeof(value));
+													EXPECT_EQ(asset.uuid, MakeAssetUuid(value, 0));
+													EXPECT_TRUE(std::ranges::equal(
+														asset.payloads[1], std::as_bytes(std::span{ vertices })));
+													order.push_back(value);
+												}));
+		}
+		EXPECT_TRUE(streamer.Cancel(requests[5]));
+		EXPECT_FALSE(streamer.Cancel(requests[5]));
+		streamer.UpdatePriority(requests[0], -1.0f);
+		EXPECT_EQ(streamer.GetPendingCount(), assetsCount - 1);
+		EXPECT_EQ(streamer.DispatchCompletions(), 0);
+
+		streamer.SetPaused(false);
+		WaitForAll(streamer);
+		auto expectedOrder = std::vector<U32>{ 0 };
+		for (auto i = assetsCount - 1; i > 0; i--)
+		{
+			if (i != 5)
+			{
+				expectedOrder.push_back(i);
+			}
+		}
+		EXPECT_EQ(order, expectedOrder);
+		EXPECT_FALSE(streamer.Cancel(requests[0]));
+	}
+}
+
+TEST(AssetStreamer, StreamsCookedMeshes)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto sourcePath = std::filesystem::path{ "streamed_bunny.obj" };
+	std::filesystem::copy_file(std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj", sourcePath,
+							   std::filesystem::copy_options::overwrite_existing);
+	const auto cookedPath = GetCookedMeshesPath(sourcePath);
+	const auto settings = MeshImportSettings{
+		.verticesStreamDeclarations = { VerticesStreamDeclaration{ .hasPosition = true } }, .compactIndices = true
+	};
+	ASSERT_TRUE(CookMeshes(sourcePath, settings, cookedPath, true));
+	const auto container = AssetContainer::Open(cookedPath);
+	ASSERT_TRUE(container.has_value());
+
+	auto registry = AssetRegistry{};
+	ASSERT_TRUE(registry.AddContainer(cookedPath));
+	auto streamer = AssetStreamer{ registry };
+
+	const auto meshUuids = GetCookedSceneMeshes(*container);
+	auto streamedCount = 0u;
+	for (const auto& meshUuid : meshUuids)
+	{
+		streamer.Request(meshUuid, 0.0f,
+						 [&](const StreamedAsset& asset)
+						 {
+							 const auto payloads = container->GetPayloads(*container->Find(asset.uuid));
+							 ASSERT_EQ(asset.payloads.size(), payloads.size());
+							 for (auto i = 0u; i < payloads.size(); i++)
+							 {
+								 auto decoded = std::vector<std::byte>(payloads[i].decodedSize);
+								 EXPECT_TRUE(container->Decode(payloads[i], decoded));
+								 EXPECT_EQ(asset.payloads[i], decoded);
+							 }
+							 streamedCount++;
+						 });
+	}
+	WaitForAll(streamer);
+	EXPECT_EQ(streamedCount, meshUuids.size());
+}
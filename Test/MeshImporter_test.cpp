@@ -1,12 +1,44 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <set>
 #include <string>
+#include <vector>
 
+#include <Memory.hpp>
+#include <MeshCache.hpp>
+#include <MeshCodec.hpp>
 #include <MeshImporter.hpp>
+#include <MeshOptimizer.hpp>
+#include <VertexQuantization.hpp>
 
 using namespace Framework;
 
+namespace
+{
+	// Folder for the sources a test writes, removed with its content when the test ends.
+	struct TemporaryDirectory
+	{
+		explicit TemporaryDirectory(const std::string& name) : path{ std::filesystem::temp_directory_path() / name }
+		{
+			std::filesystem::remove_all(path);
+			std::filesystem::create_directories(path);
+		}
+
+		~TemporaryDirectory()
+		{
+			auto error = std::error_code{};
+			std::filesystem::remove_all(path, error);
+		}
+
+		std::filesystem::path path;
+	};
+} // namespace
+
 TEST(AssetImporter, LoadMissingFile)
 {
 	auto unitTest = testing::UnitTest::GetInstance();
@@ -49,3 +81,768 @@ TEST(AssetImporter, ImportMeshWithDefaulStream)
 	const auto meshData0 = importer.ImportMesh(0, settings0);
 	EXPECT_EQ(2, meshData0.streams.size());
 }
+
+TEST(AssetImporter, ImportMeshesMatchesImportMesh)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto path = std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj";
+
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = {
+												  VerticesStreamDeclaration{ .hasPosition = true, .hasNormal = true },
+												  VerticesStreamDeclaration{ .hasTextureCoordinate0 = true } } };
+	AssetImporter singleImporter{ path };
+	const auto expected = singleImporter.ImportMesh(0, settings);
+
+	AssetImporter batchImporter{ path };
+	const auto meshIndices = std::vector<U32>{ 0, 0, 0 };
+	const auto meshes = batchImporter.ImportMeshes(meshIndices, settings);
+
+	ASSERT_EQ(meshes.size(), meshIndices.size());
+	for (const auto& mesh : meshes)
+	{
+		ASSERT_EQ(mesh.streams.size(), expected.streams.size());
+		for (auto i = 0u; i < mesh.streams.size(); i++)
+		{
+			EXPECT_EQ(mesh.streams[i].data, expected.streams[i].data);
+		}
+		EXPECT_EQ(mesh.indexStream, expected.indexStream);
+	}
+}
+
+TEST(AssetImporter, PostProcessSceneMatchesImportMesh)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto path = std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj";
+
+	const auto stream =
+		VerticesStreamDeclaration{ .hasPosition = true, .hasNormal = true, .hasTangentBitangent = true };
+	const auto settings = MeshImportSettings{ .applyOptimization = true, .verticesStreamDeclarations = { stream } };
+	AssetImporter singleImporter{ path };
+	const auto expected = singleImporter.ImportMesh(0, settings);
+
+	// Post-processing up front leaves nothing for the imports to apply, importing again must not change the result.
+	AssetImporter importer{ path };
+	importer.PostProcessScene(settings);
+	for (auto i = 0; i < 2; i++)
+	{
+		const auto meshData = importer.ImportMesh(0, settings);
+		ASSERT_EQ(meshData.streams.size(), expected.streams.size());
+		EXPECT_EQ(meshData.streams.front().data, expected.streams.front().data);
+		EXPECT_EQ(meshData.indexStream, expected.indexStream);
+		EXPECT_EQ(importer.HashMesh(0, settings), singleImporter.HashMesh(0, settings));
+	}
+}
+
+TEST(AssetImporter, OptimizedMeshHasBetterVertexCacheUtilization)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto path = std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj";
+	const auto streams = std::vector{ VerticesStreamDeclaration{ .hasPosition = true, .hasNormal = true } };
+
+	const auto ComputeStatistics = [&](const MeshData& meshData)
+	{
+		const auto indices = std::span{ reinterpret_cast<const U32*>(meshData.indexStream.data()),
+										meshData.indexStream.size() / sizeof(U32) };
+		const auto verticesCount = static_cast<U32>(meshData.streams[0].data.size() / (6 * sizeof(float)));
+		return Geometry::AnalyzeVertexCache(indices, verticesCount);
+	};
+
+	AssetImporter importer{ path };
+	const auto source = importer.ImportMesh(0, MeshImportSettings{ .verticesStreamDeclarations = streams });
+	const auto optimized =
+		importer.ImportMesh(0, MeshImportSettings{ .applyOptimization = true, .verticesStreamDeclarations = streams });
+	const auto before = ComputeStatistics(source);
+	const auto after = ComputeStatistics(optimized);
+	RecordProperty("acmr_before", std::to_string(before.acmr));
+	RecordProperty("acmr_after", std::to_string(after.acmr));
+	RecordProperty("atvr_before", std::to_string(before.atvr));
+	RecordProperty("atvr_after", std::to_string(after.atvr));
+
+	EXPECT_EQ(source.indexStream.size(), optimized.indexStream.size());
+	EXPECT_LE(optimized.streams[0].data.size(), source.streams[0].data.size());
+	EXPECT_LT(after.acmr, before.acmr);
+	EXPECT_LT(after.acmr, 0.8f);
+	EXPECT_LT(after.atvr, 1.5f);
+}
+
+TEST(AssetImporter, ImportMeshWithLodChain)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	const auto settings = MeshImportSettings{
+		.applyOptimization = true,
+		.verticesStreamDeclarations = { VerticesStreamDeclaration{ .hasPosition = true, .hasNormal = true } },
+		.simplification = { .levels = { MeshLodLevelSettings{ .targetRatio = 0.5f, .targetError = 0.05f },
+										MeshLodLevelSettings{ .targetRatio = 0.25f, .targetError = 0.05f } } }
+	};
+	const auto meshData = importer.ImportMesh(0, settings);
+	const auto verticesCount = static_cast<U32>(meshData.streams[0].data.size() / (6 * sizeof(float)));
+
+	ASSERT_EQ(meshData.lods.size(), 3);
+	auto indicesCount = 0u;
+	for (auto i = 0u; i < meshData.lods.size(); i++)
+	{
+		const auto& lod = meshData.lods[i];
+		EXPECT_EQ(lod.indicesOffset, indicesCount);
+		EXPECT_EQ(lod.indicesCount % 3, 0);
+		if (i > 0)
+		{
+			EXPECT_LT(lod.indicesCount, meshData.lods[i - 1].indicesCount);
+			EXPECT_GE(lod.error, meshData.lods[i - 1].error);
+		}
+		indicesCount += lod.indicesCount;
+	}
+	EXPECT_EQ(indicesCount * sizeof(U32), meshData.indexStream.size());
+
+	// Every LOD indexes the shared vertex stream.
+	const auto indices = std::span{ reinterpret_cast<const U32*>(meshData.indexStream.data()), indicesCount };
+	EXPECT_TRUE(std::ranges::all_of(indices, [&](U32 index) { return index < verticesCount; }));
+}
+
+TEST(AssetImporter, ImportMeshWithMeshlets)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	const auto settings = MeshImportSettings{
+		.applyOptimization = true,
+		.verticesStreamDeclarations = { VerticesStreamDeclaration{ .hasPosition = true } },
+		.simplification = { .levels = { MeshLodLevelSettings{ .targetRatio = 0.25f, .targetError = 0.05f } } },
+		.buildMeshlets = true
+	};
+	const auto meshData = importer.ImportMesh(0, settings);
+	const auto indices = std::span{ reinterpret_cast<const U32*>(meshData.indexStream.data()),
+									meshData.indexStream.size() / sizeof(U32) };
+
+	auto meshletsCount = 0u;
+	for (const auto& lod : meshData.lods)
+	{
+		EXPECT_EQ(lod.meshletOffset, meshletsCount);
+		meshletsCount += lod.meshletCount;
+
+		// The clusters of a LOD reference exactly its triangles.
+		auto lodTrianglesCount = 0u;
+		for (auto i = lod.meshletOffset; i < lod.meshletOffset + lod.meshletCount; i++)
+		{
+			lodTrianglesCount += meshData.meshlets.meshlets[i].triangleCount;
+		}
+		EXPECT_EQ(lodTrianglesCount * 3, lod.indicesCount);
+	}
+	EXPECT_EQ(meshletsCount, meshData.meshlets.meshlets.size());
+	EXPECT_FALSE(indices.empty());
+}
+
+TEST(AssetImporter, ImportMeshWithQuantizedAttributes)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	const auto floatSettings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+													   .hasPosition = true, .hasNormal = true } } };
+	const auto quantizedSettings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+														   .hasPosition = true,
+														   .hasNormal = true,
+														   .positionEncoding = PositionEncoding::unorm16,
+														   .normalEncoding = DirectionEncoding::octahedral16 } } };
+	const auto floatMesh = importer.ImportMesh(0, floatSettings);
+	const auto quantizedMesh = importer.ImportMesh(0, quantizedSettings);
+
+	const auto& descriptor = quantizedMesh.streams[0].streamDescriptor;
+	ASSERT_EQ(descriptor.attributes.size(), 2);
+	EXPECT_EQ(descriptor.attributes[0].format, AttributeFormat::unorm16x4);
+	EXPECT_EQ(descriptor.attributes[1].format, AttributeFormat::snorm16x2);
+	EXPECT_EQ(descriptor.attributes[1].offset, 8);
+	EXPECT_EQ(descriptor.attributes[0].stride, 12);
+	EXPECT_EQ(quantizedMesh.indexStream, floatMesh.indexStream);
+
+	const auto verticesCount = floatMesh.streams[0].data.size() / (6 * sizeof(float));
+	ASSERT_EQ(quantizedMesh.streams[0].data.size(), verticesCount * 12);
+	const auto maximumPositionError = 0.5f / 65535.0f * std::max({ descriptor.positionExtent.x,
+																   descriptor.positionExtent.y,
+																   descriptor.positionExtent.z });
+	for (auto i = 0u; i < verticesCount; i++)
+	{
+		auto position = Math::Vector3{};
+		auto normal = Math::Vector3{};
+		std::memcpy(&position, floatMesh.streams[0].data.data() + i * 24, sizeof(position));
+		std::memcpy(&normal, floatMesh.streams[0].data.data() + i * 24 + 12, sizeof(normal));
+
+		auto quantizedPosition = std::array<U16, 4>{};
+		auto quantizedNormal = std::array<I16, 2>{};
+		std::memcpy(quantizedPosition.data(), quantizedMesh.streams[0].data.data() + i * 12, 8);
+		std::memcpy(quantizedNormal.data(), quantizedMesh.streams[0].data.data() + i * 12 + 8, 4);
+
+		const auto decodedPosition =
+			descriptor.positionMinimum +
+			Math::Vector3{ quantizedPosition[0], quantizedPosition[1], quantizedPosition[2] } / 65535.0f *
+				descriptor.positionExtent;
+		EXPECT_LE(glm::length(decodedPosition - position), maximumPositionError * 2.0f);
+
+		const auto decodedNormal = Geometry::DecodeOctahedral(
+			Math::Vector2{ quantizedNormal[0] / 32767.0f, quantizedNormal[1] / 32767.0f });
+		if (glm::length(normal) > 0.0f)
+		{
+			EXPECT_GT(glm::dot(decodedNormal, glm::normalize(normal)), 0.9999f);
+		}
+	}
+}
+
+TEST(AssetImporter, StreamMeshMatchesImportMesh)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	const auto textureCoordinates = VerticesStreamDeclaration{
+		.hasTextureCoordinate0 = true, .textureCoordinateEncoding = TextureCoordinateEncoding::float16
+	};
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = {
+												  VerticesStreamDeclaration{ .hasPosition = true, .hasNormal = true },
+												  textureCoordinates },
+											  .compactIndices = true };
+	const auto meshData = importer.ImportMesh(0, settings);
+
+	// Small enough to split every stream into many chunks.
+	auto destination = std::vector<std::byte>(4000);
+	auto indexStream = StreamDataBuffer{};
+	auto vertexStreams = std::vector<StreamDataBuffer>(2);
+	const auto streamedMesh = importer.StreamMesh(0, settings, destination,
+												  [&](const MeshStreamChunk& chunk)
+												  {
+													  auto& stream = chunk.kind == MeshStreamKind::indices ?
+														  indexStream :
+														  vertexStreams[chunk.streamIndex];
+													  ASSERT_EQ(chunk.offset, stream.size());
+													  ASSERT_LE(chunk.size, destination.size());
+													  stream.insert(stream.end(), destination.begin(),
+																	destination.begin() + chunk.size);
+												  });
+
+	EXPECT_EQ(indexStream, meshData.indexStream);
+	EXPECT_EQ(streamedMesh.indexFormat, meshData.indexFormat);
+	EXPECT_EQ(streamedMesh.indicesCount * GetIndexSize(streamedMesh.indexFormat), meshData.indexStream.size());
+	ASSERT_EQ(streamedMesh.streamDescriptors.size(), meshData.streams.size());
+	for (auto i = 0u; i < meshData.streams.size(); i++)
+	{
+		EXPECT_EQ(vertexStreams[i], meshData.streams[i].data);
+		EXPECT_EQ(streamedMesh.streamDescriptors[i].attributes.front().stride,
+				  meshData.streams[i].streamDescriptor.attributes.front().stride);
+	}
+}
+
+TEST(AssetImporter, StreamMeshMemoryStaysBounded)
+{
+	// A binary PLY grid with 10M triangles, 5M vertices. Importing it whole would allocate ~300 MiB for the
+	// vertex and index streams on top of the scene.
+	constexpr auto quadsPerSide = 2237u;
+	constexpr auto verticesPerSide = quadsPerSide + 1;
+	const auto directory = std::filesystem::temp_directory_path() / "Framework_test_stream_mesh";
+	std::filesystem::create_directories(directory);
+	const auto meshPath = directory / "grid.ply";
+	{
+		auto file = std::ofstream{ meshPath, std::ios::binary };
+		file << "ply\nformat binary_little_endian 1.0\n"
+			 << "element vertex " << verticesPerSide * verticesPerSide << "\n"
+			 << "property float x\nproperty float y\nproperty float z\n"
+			 << "element face " << quadsPerSide * quadsPerSide * 2 << "\n"
+			 << "property list uchar int vertex_indices\nend_header\n";
+		for (auto y = 0u; y < verticesPerSide; y++)
+		{
+			for (auto x = 0u; x < verticesPerSide; x++)
+			{
+				const auto position = std::array{ static_cast<float>(x), static_cast<float>(y), 0.0f };
+				file.write(reinterpret_cast<const char*>(position.data()), sizeof(position));
+			}
+		}
+		for (auto y = 0u; y < quadsPerSide; y++)
+		{
+			for (auto x = 0u; x < quadsPerSide; x++)
+			{
+				const auto corner = static_cast<I32>(y * verticesPerSide + x);
+				for (const auto triangle : { std::array{ corner, corner + 1, corner + 1 + I32{ verticesPerSide } },
+											 std::array{ corner, corner + 1 + I32{ verticesPerSide },
+														 corner + I32{ verticesPerSide } } })
+				{
+					const auto count = char{ 3 };
+					file.write(&count, 1);
+					file.write(reinterpret_cast<const char*>(triangle.data()), sizeof(triangle));
+				}
+			}
+		}
+	}
+
+	{
+		AssetImporter importer{ meshPath };
+		ASSERT_TRUE(importer.HasLoadedScene());
+
+		const auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+													  .hasPosition = true,
+													  .positionEncoding = PositionEncoding::unorm16 } } };
+		auto destination = std::vector<std::byte>(1024 * 1024);
+		auto indicesCount = U64{ 0 };
+		auto verticesBytes = U64{ 0 };
+
+		const auto allocatedBytesBefore = Memory::threadAllocationStatistics.allocatedBytes;
+		const auto streamedMesh = importer.StreamMesh(0, settings, destination,
+													  [&](const MeshStreamChunk& chunk)
+													  {
+														  if (chunk.kind == MeshStreamKind::indices)
+														  {
+															  indicesCount += chunk.size / sizeof(U32);
+														  }
+														  else
+														  {
+															  verticesBytes += chunk.size;
+														  }
+													  });
+		const auto allocatedBytes = Memory::threadAllocationStatistics.allocatedBytes - allocatedBytesBefore;
+
+		EXPECT_EQ(indicesCount, U64{ quadsPerSide } * quadsPerSide * 6);
+		EXPECT_EQ(streamedMesh.indicesCount, indicesCount);
+		EXPECT_EQ(verticesBytes, U64{ streamedMesh.verticesCount } * 8);
+		// Everything the import allocates in total, which bounds its peak as well.
+		EXPECT_LT(allocatedBytes, 16ull * 1024 * 1024);
+	}
+	std::filesystem::remove_all(directory);
+}
+
+TEST(AssetImporter, ImportMeshWithWelding)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto meshPath = std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj";
+	AssetImporter importer{ meshPath };
+
+	// OBJ faces get their own vertices, welding brings them back to one per position and normal.
+	auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+											.hasPosition = true, .hasNormal = true } } };
+	const auto meshData = importer.ImportMesh(0, settings);
+	settings.weld = MeshWeldSettings{ .enabled = true, .positionEpsilon = 1e-6f, .normalEpsilon = 1e-3f };
+	const auto weldedMeshData = importer.ImportMesh(0, settings);
+
+	constexpr auto vertexSize = 6 * sizeof(float);
+	const auto verticesCount = meshData.streams[0].data.size() / vertexSize;
+	const auto weldedVerticesCount = weldedMeshData.streams[0].data.size() / vertexSize;
+	EXPECT_LT(weldedVerticesCount, verticesCount);
+	ASSERT_EQ(weldedMeshData.indexStream.size(), meshData.indexStream.size());
+
+	// Every corner still has its position.
+	const auto* indices = reinterpret_cast<const U32*>(meshData.indexStream.data());
+	const auto* weldedIndices = reinterpret_cast<const U32*>(weldedMeshData.indexStream.data());
+	for (auto i = 0u; i < meshData.indexStream.size() / sizeof(U32); i++)
+	{
+		ASSERT_LT(weldedIndices[i], weldedVerticesCount);
+		auto position = Math::Vector3{};
+		auto weldedPosition = Math::Vector3{};
+		std::memcpy(&position, meshData.streams[0].data.data() + indices[i] * vertexSize, sizeof(position));
+		std::memcpy(&weldedPosition, weldedMeshData.streams[0].data.data() + weldedIndices[i] * vertexSize,
+					sizeof(weldedPosition));
+		EXPECT_LE(glm::length(position - weldedPosition), 2e-6f);
+	}
+
+	// Identical content hashes the same from another importer, a different layout does not.
+	AssetImporter otherImporter{ meshPath };
+	const auto hash = importer.HashMesh(0, settings);
+	EXPECT_EQ(hash, otherImporter.HashMesh(0, settings));
+	settings.verticesStreamDeclarations.front().hasNormal = false;
+	EXPECT_NE(importer.HashMesh(0, settings), hash);
+	EXPECT_EQ(importer.HashMesh(0, settings), otherImporter.HashMesh(0, settings));
+}
+
+TEST(AssetImporter, ImportMeshWithCompactIndices)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+											.hasPosition = true, .hasNormal = true } },
+										.weld = MeshWeldSettings{ .enabled = true, .positionEpsilon = 1e-6f,
+																  .normalEpsilon = 1e-3f } };
+	const auto meshData = importer.ImportMesh(0, settings);
+	settings.compactIndices = true;
+	const auto compactMeshData = importer.ImportMesh(0, settings);
+
+	// The welded bunny fits in 16 bit indices, which keep their values.
+	ASSERT_LE(meshData.streams[0].data.size() / (6 * sizeof(float)), 65536);
+	EXPECT_EQ(meshData.indexFormat, IndexFormat::uint32);
+	ASSERT_EQ(compactMeshData.indexFormat, IndexFormat::uint16);
+	const auto indicesCount = meshData.indexStream.size() / sizeof(U32);
+	ASSERT_EQ(compactMeshData.indexStream.size(), indicesCount * sizeof(U16));
+	for (auto i = 0u; i < indicesCount; i++)
+	{
+		auto index = U32{};
+		auto compactIndex = U16{};
+		std::memcpy(&index, meshData.indexStream.data() + i * sizeof(U32), sizeof(U32));
+		std::memcpy(&compactIndex, compactMeshData.indexStream.data() + i * sizeof(U16), sizeof(U16));
+		ASSERT_EQ(compactIndex, index);
+	}
+	EXPECT_EQ(compactMeshData.streams[0].data, meshData.streams[0].data);
+}
+
+TEST(AssetImporter, EncodedMeshStreamsRoundTrip)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+
+	const auto settings = MeshImportSettings{
+		.applyOptimization = true,
+		.verticesStreamDeclarations = { VerticesStreamDeclaration{
+			.hasPosition = true,
+			.hasNormal = true,
+			.positionEncoding = PositionEncoding::unorm16,
+			.normalEncoding = DirectionEncoding::octahedral16 } },
+		.weld = MeshWeldSettings{ .enabled = true, .positionEpsilon = 1e-6f, .normalEpsilon = 1e-3f },
+		.compactIndices = true
+	};
+	const auto meshData = importer.ImportMesh(0, settings);
+	const auto indexSize = GetIndexSize(meshData.indexFormat);
+	const auto& vertexStream = meshData.streams[0];
+
+	const auto encodedIndices = Geometry::EncodeIndexBuffer(meshData.indexStream, indexSize);
+	const auto encodedVertices =
+		Geometry::EncodeVertexBuffer(vertexStream.data, vertexStream.streamDescriptor.attributes.front().stride);
+	EXPECT_LT(encodedIndices.size(), meshData.indexStream.size() / 2);
+	EXPECT_LT(encodedVertices.size(), vertexStream.data.size());
+
+	auto indexStream = StreamDataBuffer(meshData.indexStream.size());
+	EXPECT_TRUE(Geometry::DecodeIndexBuffer(indexStream, encodedIndices));
+	auto vertices = StreamDataBuffer(vertexStream.data.size());
+	EXPECT_TRUE(Geometry::DecodeVertexBuffer(vertices, encodedVertices));
+	EXPECT_EQ(vertices, vertexStream.data);
+
+	// Triangles may come back rotated, but cover the same corners in the same winding.
+	const auto readIndex = [&](const StreamDataBuffer& stream, std::size_t i)
+	{
+		auto index = U32{ 0 };
+		std::memcpy(&index, stream.data() + i * indexSize, indexSize);
+		return index;
+	};
+	for (auto i = 0u; i < meshData.indexStream.size() / indexSize; i += 3)
+	{
+		auto triangle = std::array{ readIndex(meshData.indexStream, i), readIndex(meshData.indexStream, i + 1),
+									readIndex(meshData.indexStream, i + 2) };
+		auto decodedTriangle =
+			std::array{ readIndex(indexStream, i), readIndex(indexStream, i + 1), readIndex(indexStream, i + 2) };
+		std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+		std::ranges::rotate(decodedTriangle, std::ranges::min_element(decodedTriangle));
+		ASSERT_EQ(decodedTriangle, triangle);
+	}
+}
+
+TEST(AssetImporter, CookedMeshesMatchImportMesh)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	const auto sourcePath = std::filesystem::path{ "cooked_bunny.obj" };
+	std::filesystem::copy_file(std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj", sourcePath,
+							   std::filesystem::copy_options::overwrite_existing);
+	std::filesystem::remove(GetCookedMeshesPath(sourcePath));
+
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+												  .hasPosition = true,
+												  .hasNormal = true,
+												  .positionEncoding = PositionEncoding::unorm16,
+												  .normalEncoding = DirectionEncoding::octahedral16 } },
+											  .compactIndices = true };
+	const auto container = LoadOrCookMeshes(sourcePath, settings);
+	ASSERT_TRUE(container.has_value());
+
+	AssetImporter importer{ sourcePath };
+	const auto meshUuids = GetCookedSceneMeshes(*container);
+	ASSERT_EQ(meshUuids.size(), importer.GetSceneInformation().meshCount);
+	for (auto meshIndex = 0u; meshIndex < meshUuids.size(); meshIndex++)
+	{
+		const auto entry = container->Find(meshUuids[meshIndex]);
+		ASSERT_NE(entry, nullptr);
+		const auto payloads = container->GetPayloads(*entry);
+		ASSERT_EQ(payloads.size(), 3);
+		const auto description = container->GetPayloadData(payloads[0]);
+		EXPECT_FALSE(ReadCookedMesh(description.first(description.size() - 1)).has_value());
+		const auto readMesh = ReadCookedMesh(description);
+		ASSERT_TRUE(readMesh.has_value());
+		const auto& cookedMesh = *readMesh;
+
+		const auto meshData = importer.ImportMesh(meshIndex, settings);
+		EXPECT_EQ(cookedMesh.contentHash, importer.HashMesh(meshIndex, settings));
+		EXPECT_EQ(cookedMesh.indexFormat, meshData.indexFormat);
+		EXPECT_EQ(cookedMesh.stride, meshData.streams.front().streamDescriptor.attributes.front().stride);
+		EXPECT_TRUE(std::ranges::equal(container->GetPayloadData(payloads[1]), meshData.indexStream));
+		EXPECT_TRUE(std::ranges::equal(container->GetPayloadData(payloads[2]), meshData.streams.front().data));
+	}
+
+	// An unchanged source is not cooked again.
+	const auto cookedTime = std::filesystem::last_write_time(GetCookedMeshesPath(sourcePath));
+	const auto reopened = LoadOrCookMeshes(sourcePath, settings);
+	ASSERT_TRUE(reopened.has_value());
+	EXPECT_EQ(std::filesystem::last_write_time(GetCookedMeshesPath(sourcePath)), cookedTime);
+	const auto cookedSourceHash = reopened->GetSourceHash();
+
+	// Other settings cook again instead of handing out meshes of another layout.
+	auto otherSettings = settings;
+	otherSettings.verticesStreamDeclarations.front().hasNormal = false;
+	const auto recooked = LoadOrCookMeshes(sourcePath, otherSettings);
+	ASSERT_TRUE(recooked.has_value());
+	EXPECT_NE(recooked->GetSourceHash(), cookedSourceHash);
+	const auto entry = recooked->Find(GetCookedSceneMeshes(*recooked).front());
+	ASSERT_NE(entry, nullptr);
+	auto cookedMesh = CookedMesh{};
+	std::memcpy(&cookedMesh, recooked->GetPayloadData(recooked->GetPayloads(*entry).front()).data(),
+				sizeof(cookedMesh));
+	EXPECT_EQ(cookedMesh.stride,
+			  importer.ImportMesh(0, otherSettings).streams.front().streamDescriptor.attributes.front().stride);
+
+	// Settings the content hash leaves out still give the meshes other uuids, the registry takes equal uuids for
+	// equal content.
+	auto wideIndicesSettings = settings;
+	wideIndicesSettings.compactIndices = false;
+	const auto wideIndices = LoadOrCookMeshes(sourcePath, wideIndicesSettings);
+	ASSERT_TRUE(wideIndices.has_value());
+	EXPECT_EQ(importer.HashMesh(0, wideIndicesSettings), importer.HashMesh(0, settings));
+	EXPECT_NE(GetCookedSceneMeshes(*wideIndices).front(), meshUuids.front());
+}
+
+TEST(AssetImporter, LoadAllAnimationsResamplesTranslationRotationAndScale)
+{
+	// One node moving and stretching along x over a second, keyed at its start and end.
+	const auto times = std::array{ 0.0f, 1.0f };
+	const auto translations = std::array{ 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f };
+	const auto rotations = std::array{ 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+	const auto scales = std::array{ 1.0f, 1.0f, 1.0f, 3.0f, 1.0f, 1.0f };
+	const auto directory = TemporaryDirectory{ "rtrg_moving_joint" };
+	{
+		auto binary = std::ofstream{ directory.path / "moving_joint.bin", std::ios::binary };
+		binary.write(reinterpret_cast<const char*>(times.data()), sizeof(times));
+		binary.write(reinterpret_cast<const char*>(translations.data()), sizeof(translations));
+		binary.write(reinterpret_cast<const char*>(rotations.data()), sizeof(rotations));
+		binary.write(reinterpret_cast<const char*>(scales.data()), sizeof(scales));
+	}
+	{
+		auto gltf = std::ofstream{ directory.path / "moving_joint.gltf" };
+		gltf << R"({
+			"asset": { "version": "2.0" },
+			"scene": 0,
+			"scenes": [ { "nodes": [ 0 ] } ],
+			"nodes": [ { "name": "joint" } ],
+			"buffers": [ { "byteLength": 88, "uri": "moving_joint.bin" } ],
+			"bufferViews": [
+				{ "buffer": 0, "byteOffset": 0, "byteLength": 8 },
+				{ "buffer": 0, "byteOffset": 8, "byteLength": 24 },
+				{ "buffer": 0, "byteOffset": 32, "byteLength": 32 },
+				{ "buffer": 0, "byteOffset": 64, "byteLength": 24 } ],
+			"accessors": [
+				{ "bufferView": 0, "componentType": 5126, "count": 2, "type": "SCALAR", "min": [ 0 ], "max": [ 1 ] },
+				{ "bufferView": 1, "componentType": 5126, "count": 2, "type": "VEC3" },
+				{ "bufferView": 2, "componentType": 5126, "count": 2, "type": "VEC4" },
+				{ "bufferView": 3, "componentType": 5126, "count": 2, "type": "VEC3" } ],
+			"animations": [ {
+				"name": "stretch",
+				"samplers": [ { "input": 0, "output": 1 }, { "input": 0, "output": 2 }, { "input": 0, "output": 3 } ],
+				"channels": [
+					{ "sampler": 0, "target": { "node": 0, "path": "translation" } },
+					{ "sampler": 1, "target": { "node": 0, "path": "rotation" } },
+					{ "sampler": 2, "target": { "node": 0, "path": "scale" } } ] } ]
+		})";
+	}
+
+	AssetImporter importer{ directory.path / "moving_joint.gltf" };
+	ASSERT_TRUE(importer.HasLoadedScene());
+	auto skeleton = Animation::Skeleton{};
+	skeleton.joints.emplace_back().name = "joint";
+
+	const auto dataSet = importer.LoadAllAnimations(skeleton, 10);
+	ASSERT_EQ(dataSet.animations.size(), 1);
+	const auto& clip = dataSet.animations.front();
+	EXPECT_EQ(clip.frames, 10);
+	ASSERT_EQ(dataSet.animationDatabase.size(), clip.frames);
+	for (auto frame = 0u; frame < clip.frames; frame++)
+	{
+		const auto time = static_cast<Float>(frame) / 10.0f;
+		EXPECT_NEAR(dataSet.animationDatabase[frame].translation.x, 2.0f * time, 1e-4f);
+		EXPECT_NEAR(dataSet.animationDatabase[frame].rotation.w, 1.0f, 1e-5f);
+		EXPECT_NEAR(dataSet.animationDatabase[frame].scale.x, 1.0f + 2.0f * time, 1e-4f);
+		EXPECT_NEAR(dataSet.animationDatabase[frame].scale.y, 1.0f, 1e-5f);
+	}
+}
+
+TEST(AssetImporter, ImportSkeletonWithSeveralRootJoints)
+{
+	// Two joints side by side below the scene root skin one triangle.
+	const auto positions = std::array{ 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	const auto joints = std::array<U8, 12>{ 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0 };
+	const auto weights = std::array{ 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.0f };
+	const auto directory = TemporaryDirectory{ "rtrg_several_root_joints" };
+	{
+		auto binary = std::ofstream{ directory.path / "two_roots.bin", std::ios::binary };
+		binary.write(reinterpret_cast<const char*>(positions.data()), sizeof(positions));
+		binary.write(reinterpret_cast<const char*>(joints.data()), sizeof(joints));
+		binary.write(reinterpret_cast<const char*>(weights.data()), sizeof(weights));
+	}
+	{
+		auto gltf = std::ofstream{ directory.path / "two_roots.gltf" };
+		gltf << R"({
+			"asset": { "version": "2.0" },
+			"scene": 0,
+			"scenes": [ { "nodes": [ 0, 1, 2 ] } ],
+			"nodes": [
+				{ "name": "body", "mesh": 0, "skin": 0 },
+				{ "name": "left", "translation": [ -1, 0, 0 ] },
+				{ "name": "right", "translation": [ 1, 0, 0 ] } ],
+			"skins": [ { "joints": [ 1, 2 ] } ],
+			"meshes": [ { "primitives": [ { "attributes": { "POSITION": 0, "JOINTS_0": 1, "WEIGHTS_0": 2 } } ] } ],
+			"buffers": [ { "byteLength": 96, "uri": "two_roots.bin" } ],
+			"bufferViews": [
+				{ "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+				{ "buffer": 0, "byteOffset": 36, "byteLength": 12 },
+				{ "buffer": 0, "byteOffset": 48, "byteLength": 48 } ],
+			"accessors": [
+				{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [ 0, 0, 0 ],
+				  "max": [ 1, 1, 0 ] },
+				{ "bufferView": 1, "componentType": 5121, "count": 3, "type": "VEC4" },
+				{ "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC4" } ]
+		})";
+	}
+
+	AssetImporter importer{ directory.path / "two_roots.gltf" };
+	ASSERT_TRUE(importer.HasLoadedScene());
+	ASSERT_TRUE(importer.HasBones(0));
+	const auto skeleton = importer.ImportSkeleton(0);
+
+	// The scene root joins both joints under a single root.
+	ASSERT_EQ(skeleton.joints.size(), 3);
+	EXPECT_TRUE(Animation::IsHierarchyOrdered(skeleton));
+	EXPECT_TRUE(Animation::HasPackedHierarchy(skeleton));
+	EXPECT_EQ(skeleton.parentIndices, (std::vector<I32>{ -1, 0, 0 }));
+	EXPECT_EQ((std::set{ skeleton.joints[1].name, skeleton.joints[2].name }),
+			  (std::set<std::string>{ "left", "right" }));
+}
+
+TEST(AssetImporter, ImportMeshNormalizesPartialSkinInfluences)
+{
+	// Vertices with one, two and three influences, the fourth one of the last vertex is below 1% and dropped.
+	const auto positions = std::array{ 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	const auto joints = std::array<U8, 12>{ 0, 0, 0, 0, 1, 2, 0, 0, 0, 1, 2, 3 };
+	const auto weights =
+		std::array{ 1.0f, 0.0f, 0.0f, 0.0f, 0.25f, 0.75f, 0.0f, 0.0f, 0.2f, 0.295f, 0.5f, 0.005f };
+	const auto directory = TemporaryDirectory{ "rtrg_partial_skin_influences" };
+	{
+		auto binary = std::ofstream{ directory.path / "partial_influences.bin", std::ios::binary };
+		binary.write(reinterpret_cast<const char*>(positions.data()), sizeof(positions));
+		binary.write(reinterpret_cast<const char*>(joints.data()), sizeof(joints));
+		binary.write(reinterpret_cast<const char*>(weights.data()), sizeof(weights));
+	}
+	{
+		auto gltf = std::ofstream{ directory.path / "partial_influences.gltf" };
+		gltf << R"({
+			"asset": { "version": "2.0" },
+			"scene": 0,
+			"scenes": [ { "nodes": [ 0, 1 ] } ],
+			"nodes": [
+				{ "name": "body", "mesh": 0, "skin": 0 },
+				{ "name": "hips", "children": [ 2, 3 ] },
+				{ "name": "left", "translation": [ -1, 0, 0 ], "children": [ 4 ] },
+				{ "name": "right", "translation": [ 1, 0, 0 ] },
+				{ "name": "tail", "translation": [ 0, -1, 0 ] } ],
+			"skins": [ { "joints": [ 1, 2, 3, 4 ] } ],
+			"meshes": [ { "primitives": [ { "attributes": { "POSITION": 0, "JOINTS_0": 1, "WEIGHTS_0": 2 } } ] } ],
+			"buffers": [ { "byteLength": 96, "uri": "partial_influences.bin" } ],
+			"bufferViews": [
+				{ "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+				{ "buffer": 0, "byteOffset": 36, "byteLength": 12 },
+				{ "buffer": 0, "byteOffset": 48, "byteLength": 48 } ],
+			"accessors": [
+				{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [ 0, 0, 0 ],
+				  "max": [ 1, 1, 0 ] },
+				{ "bufferView": 1, "componentType": 5121, "count": 3, "type": "VEC4" },
+				{ "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC4" } ]
+		})";
+	}
+
+	AssetImporter importer{ directory.path / "partial_influences.gltf" };
+	ASSERT_TRUE(importer.HasLoadedScene());
+	ASSERT_TRUE(importer.HasBones(0));
+	const auto skeleton = importer.ImportSkeleton(0);
+	const auto FindJoint = [&](std::string_view name)
+	{
+		const auto it = std::ranges::find(skeleton.joints, name, &Animation::Joint::name);
+		return static_cast<U8>(std::distance(skeleton.joints.begin(), it));
+	};
+	const auto hips = FindJoint("hips");
+	const auto left = FindJoint("left");
+	const auto right = FindJoint("right");
+	ASSERT_LT(std::max({ hips, left, right }), skeleton.joints.size());
+
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+												  .hasPosition = true, .hasJointsIndexAndWeights = true } } };
+	const auto meshData = importer.ImportMesh(0, settings);
+	const auto& attributes = meshData.streams[0].streamDescriptor.attributes;
+	const auto FindAttribute = [&](AttributeSemantic semantic)
+	{ return *std::ranges::find(attributes, semantic, &AttributeDescriptor::semantic); };
+	const auto positionAttribute = FindAttribute(AttributeSemantic::position);
+	const auto jointIndexAttribute = FindAttribute(AttributeSemantic::jointIndex);
+	const auto jointWeightAttribute = FindAttribute(AttributeSemantic::jointWeight);
+	ASSERT_EQ(jointWeightAttribute.format, AttributeFormat::float32x4);
+	const auto stride = positionAttribute.stride;
+	ASSERT_EQ(meshData.streams[0].data.size(), 3 * stride);
+
+	struct ExpectedInfluences
+	{
+		std::array<U8, 4> joints;
+		Math::Vector4 weights;
+	};
+	// Strongest influence first, unused slots keep joint 0 with no weight.
+	const auto expectedByVertex = std::array{
+		ExpectedInfluences{ { hips, 0, 0, 0 }, Math::Vector4{ 1.0f, 0.0f, 0.0f, 0.0f } },
+		ExpectedInfluences{ { right, left, 0, 0 }, Math::Vector4{ 0.75f, 0.25f, 0.0f, 0.0f } },
+		ExpectedInfluences{ { right, left, hips, 0 }, Math::Vector4{ 0.5f, 0.295f, 0.2f, 0.0f } / 0.995f }
+	};
+	for (auto i = 0u; i < 3; i++)
+	{
+		const auto* vertex = meshData.streams[0].data.data() + i * stride;
+		auto position = Math::Vector3{};
+		auto vertexJoints = std::array<U8, 4>{};
+		auto vertexWeights = Math::Vector4{};
+		std::memcpy(&position, vertex + positionAttribute.offset, sizeof(position));
+		std::memcpy(vertexJoints.data(), vertex + jointIndexAttribute.offset, sizeof(vertexJoints));
+		std::memcpy(&vertexWeights, vertex + jointWeightAttribute.offset, sizeof(vertexWeights));
+
+		const auto& expected = expectedByVertex[static_cast<U32>(position.x + 2.0f * position.y)];
+		EXPECT_EQ(vertexJoints, expected.joints);
+		EXPECT_NEAR(vertexWeights.x + vertexWeights.y + vertexWeights.z + vertexWeights.w, 1.0f, 1e-5f);
+		for (auto slot = 0; slot < 4; slot++)
+		{
+			EXPECT_NEAR(vertexWeights[slot], expected.weights[slot], 1e-5f);
+		}
+	}
+}
+
+TEST(AssetImporter, ImportMeshWithoutBonesHasNoInfluences)
+{
+	auto unitTest = testing::UnitTest::GetInstance();
+	AssetImporter importer{ std::filesystem::path(unitTest->original_working_dir()) / "bunny.obj" };
+	ASSERT_FALSE(importer.HasBones(0));
+
+	const auto settings = MeshImportSettings{ .verticesStreamDeclarations = { VerticesStreamDeclaration{
+												  .hasPosition = true, .hasJointsIndexAndWeights = true } } };
+	const auto meshData = importer.ImportMesh(0, settings);
+	const auto& attributes = meshData.streams[0].streamDescriptor.attributes;
+	ASSERT_EQ(attributes.size(), 3);
+	const auto stride = attributes.front().stride;
+	const auto jointsBegin = attributes[1].offset;
+	const auto& vertices = meshData.streams[0].data;
+	for (auto vertex = std::size_t{ 0 }; vertex < vertices.size(); vertex += stride)
+	{
+		const auto joints = std::span{ vertices }.subspan(vertex + jointsBegin, stride - jointsBegin);
+		ASSERT_TRUE(std::ranges::all_of(joints, [](std::byte value) { return value == std::byte{ 0 }; }));
+	}
+
+	auto destination = std::vector<std::byte>(4000);
+	auto streamedVertices = StreamDataBuffer{};
+	importer.StreamMesh(0, settings, destination,
+						[&](const MeshStreamChunk& chunk)
+						{
+							if (chunk.kind == MeshStreamKind::vertices)
+							{
+								streamedVertices.insert(streamedVertices.end(), destination.begin(),
+														destination.begin() + chunk.size);
+							}
+						});
+	EXPECT_EQ(streamedVertices, vertices);
+}
@@ -0,0 +1,501 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <MeshCodec.hpp>
+#include <MeshOptimizer.hpp>
+#include <MeshletBuilder.hpp>
+#include <VertexQuantization.hpp>
+
+using namespace Framework;
+using namespace Framework::Geometry;
+
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<Math::Vector3> positions;
+		std::vector<U32> indices;
+	};
+
+	// Regular grid with its triangles shuffled, the worst case for a post-transform cache.
+	TestMesh CreateShuffledGrid(U32 size)
+	{
+		auto mesh = TestMesh{};
+		for (auto y = 0u; y <= size; y++)
+		{
+			for (auto x = 0u; x <= size; x++)
+			{
+				mesh.positions.push_back(Math::Vector3{ static_cast<Float>(x), static_cast<Float>(y), 0.0f });
+			}
+		}
+
+		auto triangles = std::vector<std::array<U32, 3>>{};
+		for (auto y = 0u; y < size; y++)
+		{
+			for (auto x = 0u; x < size; x++)
+			{
+				const auto corner = y * (size + 1) + x;
+				triangles.push_back({ corner, corner + size + 1, corner + 1 });
+				triangles.push_back({ corner + 1, corner + size + 1, corner + size + 2 });
+			}
+		}
+		std::ranges::shuffle(triangles, std::mt19937{ 42 });
+		for (const auto& triangle : triangles)
+		{
+			mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+		}
+		return mesh;
+	}
+
+	template <typename Height>
+	TestMesh CreateHeightField(U32 size, Height&& height)
+	{
+		auto mesh = TestMesh{};
+		for (auto y = 0u; y <= size; y++)
+		{
+			for (auto x = 0u; x <= size; x++)
+			{
+				const auto u = static_cast<Float>(x) / static_cast<Float>(size);
+				const auto v = static_cast<Float>(y) / static_cast<Float>(size);
+				mesh.positions.push_back(Math::Vector3{ u, v, height(u, v) });
+			}
+		}
+		for (auto y = 0u; y < size; y++)
+		{
+			for (auto x = 0u; x < size; x++)
+			{
+				const auto corner = y * (size + 1) + x;
+				mesh.indices.insert(mesh.indices.end(), { corner, corner + size + 1, corner + 1, corner + 1,
+														  corner + size + 1, corner + size + 2 });
+			}
+		}
+		return mesh;
+	}
+
+	std::vector<std::array<U32, 3>> SortedTriangles(std::span<const U32> indices, std::span<const U32> newToOld = {})
+	{
+		auto triangles = std::vector<std::array<U32, 3>>{};
+		for (auto i = 0u; i < indices.size(); i += 3)
+		{
+			auto triangle = std::array{ indices[i], indices[i + 1], indices[i + 2] };
+			if (not newToOld.empty())
+			{
+				std::ranges::transform(triangle, triangle.begin(), [&](U32 index) { return newToOld[index]; });
+			}
+			// Rotation keeps the winding, so the smallest index is moved first.
+			std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+			triangles.push_back(triangle);
+		}
+		std::ranges::sort(triangles);
+		return triangles;
+	}
+} // namespace
+
+TEST(MeshOptimizer, VertexCacheOptimizationLowersAcmr)
+{
+	auto mesh = CreateShuffledGrid(64);
+	const auto verticesCount = static_cast<U32>(mesh.positions.size());
+	const auto before = AnalyzeVertexCache(mesh.indices, verticesCount);
+	const auto expectedTriangles = SortedTriangles(mesh.indices);
+
+	OptimizeVertexCache(mesh.indices, verticesCount);
+	const auto after = AnalyzeVertexCache(mesh.indices, verticesCount);
+
+	EXPECT_EQ(SortedTriangles(mesh.indices), expectedTriangles);
+	EXPECT_GT(before.acmr, 2.0f);
+	EXPECT_LT(after.acmr, 0.8f);
+	EXPECT_LT(after.atvr, 1.5f);
+}
+
+TEST(MeshOptimizer, OverdrawOptimizationStaysWithinAcmrBudget)
+{
+	auto mesh = CreateShuffledGrid(64);
+	const auto verticesCount = static_cast<U32>(mesh.positions.size());
+	OptimizeVertexCache(mesh.indices, verticesCount);
+	const auto vertexCacheOptimized = AnalyzeVertexCache(mesh.indices, verticesCount);
+	const auto expectedTriangles = SortedTriangles(mesh.indices);
+
+	OptimizeOverdraw(mesh.indices, mesh.positions, 1.05f);
+	const auto after = AnalyzeVertexCache(mesh.indices, verticesCount);
+
+	EXPECT_EQ(SortedTriangles(mesh.indices), expectedTriangles);
+	// Cluster borders cost a few extra misses on top of the per cluster budget.
+	EXPECT_LT(after.acmr, vertexCacheOptimized.acmr * 1.1f);
+}
+
+TEST(MeshOptimizer, VertexFetchOptimizationOrdersByFirstUse)
+{
+	auto mesh = CreateShuffledGrid(16);
+	const auto verticesCount = static_cast<U32>(mesh.positions.size());
+	// Keeps half of the shuffled triangles, so some vertices are no longer referenced.
+	mesh.indices.resize(mesh.indices.size() / 6 * 3);
+	const auto expectedTriangles = SortedTriangles(mesh.indices);
+
+	const auto newToOld = OptimizeVertexFetch(mesh.indices, verticesCount);
+
+	EXPECT_LT(newToOld.size(), verticesCount);
+	EXPECT_EQ(SortedTriangles(mesh.indices, newToOld), expectedTriangles);
+	auto nextNewVertex = 0u;
+	for (const auto index : mesh.indices)
+	{
+		EXPECT_LE(index, nextNewVertex);
+		nextNewVertex = std::max(nextNewVertex, index + 1);
+	}
+	EXPECT_EQ(nextNewVertex, newToOld.size());
+
+	const auto remapped = RemapVertices<Math::Vector3>(mesh.positions, 1, newToOld);
+	for (auto i = 0u; i < newToOld.size(); i++)
+	{
+		EXPECT_EQ(remapped[i], mesh.positions[newToOld[i]]);
+	}
+}
+
+TEST(MeshOptimizer, WeldVerticesMergesWithinEpsilon)
+{
+	// Two triangles sharing an edge, with the shared corners duplicated and slightly perturbed. Each vertex is a
+	// position and a texture coordinate.
+	const auto vertices = std::vector<Float>{
+		0.0f, 0.0f, 0.0f, 0.0f, 0.0f, //
+		1.0f, 0.0f, 0.0f, 1.0f, 0.0f, //
+		0.0f, 1.0f, 0.0f, 0.0f, 1.0f, //
+		1.00001f, 0.0f, 0.0f, 1.0f, 0.0f, //
+		1.0f, 1.0f, 0.0f, 1.0f, 1.0f, //
+		0.0f, 1.00001f, -0.0f, 0.0f, 1.0f, //
+		7.0f, 7.0f, 7.0f, 0.0f, 0.0f, // unreferenced
+	};
+	const auto epsilons = std::vector<Float>{ 1e-3f, 1e-3f, 1e-3f, 0.0f, 0.0f };
+	auto indices = std::vector<U32>{ 0, 1, 2, 3, 4, 5 };
+
+	const auto newToOldVertex = WeldVertices(indices, vertices, 5, epsilons);
+	EXPECT_EQ(newToOldVertex, (std::vector<U32>{ 0, 1, 2, 4 }));
+	EXPECT_EQ(indices, (std::vector<U32>{ 0, 1, 2, 1, 3, 2 }));
+
+	// Without a position tolerance only the exact copies would merge, a texture coordinate difference always splits.
+	auto exactIndices = std::vector<U32>{ 0, 1, 2, 3, 4, 5 };
+	EXPECT_EQ(WeldVertices(exactIndices, vertices, 5, std::vector<Float>(5, 0.0f)).size(), 6);
+
+	auto seamVertices = vertices;
+	seamVertices[3 * 5 + 3] = 0.5f;
+	auto seamIndices = std::vector<U32>{ 0, 1, 2, 3, 4, 5 };
+	EXPECT_EQ(WeldVertices(seamIndices, seamVertices, 5, epsilons).size(), 5);
+}
+
+TEST(MeshOptimizer, SimplifyFlatGridKeepsBorder)
+{
+	const auto mesh = CreateHeightField(32, [](Float, Float) { return 0.0f; });
+	const auto targetIndicesCount = static_cast<U32>(mesh.indices.size() / 4);
+
+	const auto simplified = Simplify(mesh.indices, mesh.positions, targetIndicesCount, 0.01f);
+
+	EXPECT_LE(simplified.indices.size(), targetIndicesCount);
+	EXPECT_GT(simplified.indices.size(), 0u);
+	EXPECT_LT(simplified.error, 1e-4f);
+
+	// Border vertices are locked, so the covered area stays the unit square.
+	auto area = 0.0f;
+	for (auto i = 0u; i < simplified.indices.size(); i += 3)
+	{
+		const auto& a = mesh.positions[simplified.indices[i]];
+		const auto& b = mesh.positions[simplified.indices[i + 1]];
+		const auto& c = mesh.positions[simplified.indices[i + 2]];
+		const auto normal = glm::cross(b - a, c - a);
+		EXPECT_LT(normal.z, 0.0f);
+		area += 0.5f * glm::length(normal);
+	}
+	EXPECT_NEAR(area, 1.0f, 1e-4f);
+}
+
+TEST(MeshOptimizer, SimplifyStopsAtTargetError)
+{
+	const auto mesh =
+		CreateHeightField(32, [](Float u, Float v) { return 0.05f * std::sin(12.0f * u) * std::cos(9.0f * v); });
+
+	const auto coarse = Simplify(mesh.indices, mesh.positions, 0, 0.01f);
+	const auto fine = Simplify(mesh.indices, mesh.positions, 0, 0.001f);
+
+	EXPECT_LE(coarse.error, 0.01f);
+	EXPECT_LE(fine.error, 0.001f);
+	EXPECT_LT(coarse.indices.size(), fine.indices.size());
+	EXPECT_LT(fine.indices.size(), mesh.indices.size());
+}
+
+TEST(MeshOptimizer, SimplifyPreservesSkinningBoundaries)
+{
+	const auto mesh = CreateHeightField(16, [](Float, Float) { return 0.0f; });
+	// Left half follows joint 0 and right half joint 1, the column in between is shared.
+	auto jointIndices = std::vector<std::array<U8, 4>>(mesh.positions.size());
+	auto jointWeights = std::vector<Math::Vector4>(mesh.positions.size());
+	for (auto vertex = 0u; vertex < mesh.positions.size(); vertex++)
+	{
+		const auto x = mesh.positions[vertex].x;
+		if (x == 0.5f)
+		{
+			jointIndices[vertex] = { 0, 1, 0, 0 };
+			jointWeights[vertex] = Math::Vector4{ 0.5f, 0.5f, 0.0f, 0.0f };
+		}
+		else
+		{
+			jointIndices[vertex] = { x < 0.5f ? U8{ 0 } : U8{ 1 }, 0, 0, 0 };
+			jointWeights[vertex] = Math::Vector4{ 1.0f, 0.0f, 0.0f, 0.0f };
+		}
+	}
+
+	auto attributes = SimplificationAttributes{};
+	attributes.jointIndices = jointIndices;
+	attributes.jointWeights = jointWeights;
+	const auto simplified = Simplify(mesh.indices, mesh.positions, 0, 0.1f, attributes);
+
+	EXPECT_LT(simplified.indices.size(), mesh.indices.size() / 4);
+	// No collapse merged the two halves, so every triangle stays on one side of the shared column.
+	for (auto i = 0u; i < simplified.indices.size(); i += 3)
+	{
+		auto minimum = 1.0f;
+		auto maximum = 0.0f;
+		for (auto corner = 0u; corner < 3; corner++)
+		{
+			minimum = std::min(minimum, mesh.positions[simplified.indices[i + corner]].x);
+			maximum = std::max(maximum, mesh.positions[simplified.indices[i + corner]].x);
+		}
+		EXPECT_TRUE(maximum <= 0.5f or minimum >= 0.5f);
+	}
+}
+
+TEST(MeshOptimizer, MeshletsCoverEveryTriangleOnce)
+{
+	const auto mesh = CreateHeightField(48, [](Float u, Float v) { return 0.2f * std::sin(6.0f * u + 3.0f * v); });
+
+	auto meshlets = Meshlets{};
+	BuildMeshlets(mesh.indices, mesh.positions, meshlets);
+
+	ASSERT_EQ(meshlets.meshlets.size(), meshlets.bounds.size());
+	auto covered = std::vector<U32>{};
+	for (auto i = 0u; i < meshlets.meshlets.size(); i++)
+	{
+		const auto& meshlet = meshlets.meshlets[i];
+		const auto& bounds = meshlets.bounds[i];
+		EXPECT_LE(meshlet.vertexCount, maxMeshletVertices);
+		EXPECT_LE(meshlet.triangleCount, maxMeshletTriangles);
+		EXPECT_GT(meshlet.triangleCount, 0u);
+
+		for (auto j = 0u; j < meshlet.triangleCount * 3; j++)
+		{
+			const auto local = meshlets.triangles[meshlet.triangleOffset + j];
+			ASSERT_LT(local, meshlet.vertexCount);
+			const auto vertex = meshlets.vertices[meshlet.vertexOffset + local];
+			covered.push_back(vertex);
+			EXPECT_LE(glm::length(mesh.positions[vertex] - bounds.center), bounds.radius * 1.0001f);
+		}
+	}
+	EXPECT_EQ(SortedTriangles(covered), SortedTriangles(mesh.indices));
+
+	// A regular grid fills clusters well, only the last ones of a strip may stay small.
+	EXPECT_LT(meshlets.meshlets.size(), mesh.indices.size() / 3 / maxMeshletTriangles * 2);
+}
+
+TEST(MeshOptimizer, MeshletConeCullingIsConservative)
+{
+	const auto mesh = CreateHeightField(32, [](Float u, Float v) { return 0.1f * std::sin(4.0f * u) * v; });
+
+	auto meshlets = Meshlets{};
+	BuildMeshlets(mesh.indices, mesh.positions, meshlets);
+
+	auto culledCount = 0u;
+	auto random = std::mt19937{ 7 };
+	auto distribution = std::uniform_real_distribution<Float>{ -3.0f, 3.0f };
+	for (auto sample = 0u; sample < 64; sample++)
+	{
+		const auto camera = Math::Vector3{ distribution(random), distribution(random), distribution(random) };
+		for (auto i = 0u; i < meshlets.meshlets.size(); i++)
+		{
+			if (not IsMeshletBackFacing(meshlets.bounds[i], camera))
+			{
+				continue;
+			}
+			culledCount++;
+
+			const auto& meshlet = meshlets.meshlets[i];
+			for (auto triangle = 0u; triangle < meshlet.triangleCount; triangle++)
+			{
+				const auto GetPosition = [&](U32 corner)
+				{
+					const auto local = meshlets.triangles[meshlet.triangleOffset + triangle * 3 + corner];
+					return mesh.positions[meshlets.vertices[meshlet.vertexOffset + local]];
+				};
+				const auto normal = glm::cross(GetPosition(1) - GetPosition(0), GetPosition(2) - GetPosition(0));
+				EXPECT_GE(glm::dot(GetPosition(0) - camera, normal), -1e-5f);
+			}
+		}
+	}
+	EXPECT_GT(culledCount, 0u);
+}
+
+TEST(MeshOptimizer, HalfFloatRoundTrip)
+{
+	for (const auto value : { 0.0f, -0.0f, 1.0f, -2.5f, 0.333f, 65504.0f, 6.1e-5f, 3.0e-7f })
+	{
+		const auto decoded = HalfToFloat(FloatToHalf(value));
+		EXPECT_NEAR(decoded, value, std::abs(value) / 1024.0f + 6.0e-8f) << value;
+	}
+	EXPECT_EQ(FloatToHalf(1.0f), 0x3C00);
+	EXPECT_EQ(FloatToHalf(-2.0f), 0xC000);
+	EXPECT_TRUE(std::isinf(HalfToFloat(FloatToHalf(1.0e6f))));
+
+	// Every half value is exactly representable as float.
+	for (auto half = 0u; half < 0x7C00u; half++)
+	{
+		ASSERT_EQ(FloatToHalf(HalfToFloat(static_cast<U16>(half))), half);
+	}
+}
+
+TEST(MeshOptimizer, OctahedralEncodingIsAccurate)
+{
+	auto random = std::mt19937{ 3 };
+	auto distribution = std::normal_distribution<Float>{};
+	auto maximumAngle16 = 0.0f;
+	auto maximumAngle8 = 0.0f;
+	for (auto sample = 0u; sample < 10000; sample++)
+	{
+		const auto direction =
+			glm::normalize(Math::Vector3{ distribution(random), distribution(random), distribution(random) });
+		const auto encoded = EncodeOctahedral(direction);
+		const auto decoded16 = DecodeOctahedral(Math::Vector2{ QuantizeSnorm16(encoded.x) / 32767.0f,
+															   QuantizeSnorm16(encoded.y) / 32767.0f });
+		const auto decoded8 = DecodeOctahedral(
+			Math::Vector2{ QuantizeSnorm8(encoded.x) / 127.0f, QuantizeSnorm8(encoded.y) / 127.0f });
+		maximumAngle16 = std::max(maximumAngle16, std::acos(std::min(glm::dot(direction, decoded16), 1.0f)));
+		maximumAngle8 = std::max(maximumAngle8, std::acos(std::min(glm::dot(direction, decoded8), 1.0f)));
+	}
+	EXPECT_LT(maximumAngle16, 1.0e-3f);
+	EXPECT_LT(maximumAngle8, 0.03f);
+
+	const auto axis = DecodeOctahedral(EncodeOctahedral(Math::Vector3{ 0.0f, 0.0f, -1.0f }));
+	EXPECT_NEAR(axis.z, -1.0f, 1e-6f);
+}
+
+TEST(MeshOptimizer, QuantizedJointWeightsSumToOne)
+{
+	auto random = std::mt19937{ 5 };
+	auto distribution = std::uniform_real_distribution<Float>{ 0.0f, 1.0f };
+	for (auto sample = 0u; sample < 1000; sample++)
+	{
+		auto weights = Math::Vector4{ distribution(random), distribution(random), distribution(random),
+									  distribution(random) };
+		weights /= weights.x + weights.y + weights.z + weights.w;
+		const auto quantized = QuantizeJointWeights(weights);
+		ASSERT_EQ(quantized[0] + quantized[1] + quantized[2] + quantized[3], 255);
+		for (auto i = 0; i < 4; i++)
+		{
+			EXPECT_NEAR(quantized[i] / 255.0f, weights[i], 2.0f / 255.0f);
+		}
+	}
+	EXPECT_EQ(QuantizeJointWeights(Math::Vector4{ 1.0f, 0.0f, 0.0f, 0.0f }), (std::array<U8, 4>{ 255, 0, 0, 0 }));
+}
+
+TEST(MeshOptimizer, QuantizedPositionsStayWithinHalfAStep)
+{
+	for (auto i = 0u; i <= 1000; i++)
+	{
+		const auto value = static_cast<Float>(i) / 1000.0f;
+		EXPECT_LE(std::abs(QuantizeUnorm16(value) / 65535.0f - value), 0.5f / 65535.0f + 1e-7f);
+	}
+	EXPECT_EQ(QuantizeUnorm16(-1.0f), 0);
+	EXPECT_EQ(QuantizeUnorm16(2.0f), 65535);
+}
+
+TEST(MeshOptimizer, IndexCodecRoundTrip)
+{
+	// Spans several blocks.
+	auto mesh = CreateShuffledGrid(100);
+	const auto verticesCount = static_cast<U32>(mesh.positions.size());
+	const auto shuffledTriangles = SortedTriangles(mesh.indices);
+	const auto shuffledEncoded = EncodeIndexBuffer(std::as_bytes(std::span{ mesh.indices }), sizeof(U32));
+
+	OptimizeVertexCache(mesh.indices, verticesCount);
+	const auto newToOld = OptimizeVertexFetch(mesh.indices, verticesCount);
+	const auto encoded = EncodeIndexBuffer(std::as_bytes(std::span{ mesh.indices }), sizeof(U32));
+	// Most triangles cost a single byte once optimized.
+	EXPECT_LT(encoded.size(), mesh.indices.size() / 3 * 2);
+	EXPECT_LT(encoded.size(), shuffledEncoded.size());
+
+	auto decoded = std::vector<U32>(mesh.indices.size());
+	EXPECT_TRUE(DecodeIndexBuffer(std::as_writable_bytes(std::span{ decoded }), encoded));
+	EXPECT_EQ(SortedTriangles(decoded, newToOld), shuffledTriangles);
+
+	auto shuffledDecoded = std::vector<U32>(mesh.indices.size());
+	EXPECT_TRUE(DecodeIndexBuffer(std::as_writable_bytes(std::span{ shuffledDecoded }), shuffledEncoded));
+	EXPECT_EQ(SortedTriangles(shuffledDecoded), shuffledTriangles);
+
+	// 16 bit indices decode to the same triangles.
+	auto compactIndices = std::vector<U16>(mesh.indices.begin(), mesh.indices.end());
+	const auto compactEncoded = EncodeIndexBuffer(std::as_bytes(std::span{ compactIndices }), sizeof(U16));
+	auto compactDecoded = std::vector<U16>(compactIndices.size());
+	EXPECT_TRUE(DecodeIndexBuffer(std::as_writable_bytes(std::span{ compactDecoded }), compactEncoded));
+	EXPECT_TRUE(std::ranges::equal(compactDecoded, decoded));
+}
+
+TEST(MeshOptimizer, VertexCodecRoundTrip)
+{
+	// Quantized positions of a smooth surface followed by a random byte, which has to survive as well.
+	const auto mesh = CreateHeightField(120, [](Float u, Float v) { return 0.5f + 0.25f * std::sin(6.0f * u * v); });
+	constexpr auto vertexSize = 4 * sizeof(U16) + 1;
+	auto vertices = std::vector<std::byte>(mesh.positions.size() * vertexSize);
+	auto random = std::mt19937{ 7 };
+	for (auto i = 0u; i < mesh.positions.size(); i++)
+	{
+		const auto position = std::array{ QuantizeUnorm16(mesh.positions[i].x), QuantizeUnorm16(mesh.positions[i].y),
+										  QuantizeUnorm16(mesh.positions[i].z), U16{ 0 } };
+		std::memcpy(vertices.data() + i * vertexSize, position.data(), sizeof(position));
+		vertices[i * vertexSize + sizeof(position)] = static_cast<std::byte>(random());
+	}
+
+	const auto encoded = EncodeVertexBuffer(vertices, vertexSize);
+	EXPECT_LT(encoded.size(), vertices.size() * 3 / 4);
+
+	auto decoded = std::vector<std::byte>(vertices.size());
+	EXPECT_TRUE(DecodeVertexBuffer(decoded, encoded));
+	EXPECT_EQ(decoded, vertices);
+}
+
+TEST(MeshOptimizer, CodecsRejectCorruptBuffers)
+{
+	auto mesh = CreateShuffledGrid(100);
+	const auto verticesCount = static_cast<U32>(mesh.positions.size());
+	OptimizeVertexCache(mesh.indices, verticesCount);
+	OptimizeVertexFetch(mesh.indices, verticesCount);
+	const auto encodedIndices = EncodeIndexBuffer(std::as_bytes(std::span{ mesh.indices }), sizeof(U32));
+	const auto encodedVertices = EncodeVertexBuffer(std::as_bytes(std::span{ mesh.positions }), sizeof(Math::Vector3));
+	auto indices = std::vector<U32>(mesh.indices.size());
+	auto vertices = std::vector<Math::Vector3>(mesh.positions.size());
+	const auto indexStream = std::as_writable_bytes(std::span{ indices });
+	const auto vertexStream = std::as_writable_bytes(std::span{ vertices });
+
+	// Every truncation fails, whether it cuts the header, the block table or the data of a block.
+	for (const auto size : { std::size_t{ 0 }, std::size_t{ 10 }, std::size_t{ 20 }, encodedIndices.size() - 1 })
+	{
+		EXPECT_FALSE(DecodeIndexBuffer(indexStream, std::span{ encodedIndices }.first(size)));
+	}
+	for (const auto size : { std::size_t{ 0 }, std::size_t{ 10 }, std::size_t{ 20 }, encodedVertices.size() - 1 })
+	{
+		EXPECT_FALSE(DecodeVertexBuffer(vertexStream, std::span{ encodedVertices }.first(size)));
+	}
+
+	// Buffers of the wrong codec or for another size.
+	EXPECT_FALSE(DecodeIndexBuffer(vertexStream, encodedVertices));
+	EXPECT_FALSE(DecodeVertexBuffer(indexStream, encodedIndices));
+	EXPECT_FALSE(DecodeIndexBuffer(indexStream.first(indexStream.size() - 3 * sizeof(U32)), encodedIndices));
+	EXPECT_FALSE(DecodeVertexBuffer(vertexStream.first(vertexStream.size() - sizeof(Math::Vector3)), encodedVertices));
+
+	// Block offsets pointing outside of the buffer.
+	auto corruptIndices = encodedIndices;
+	std::ranges::fill(std::span{ corruptIndices }.subspan(4 * sizeof(U32), sizeof(U32)), std::byte{ 0xFF });
+	EXPECT_FALSE(DecodeIndexBuffer(indexStream, corruptIndices));
+
+	EXPECT_TRUE(DecodeIndexBuffer(indexStream, encodedIndices));
+	EXPECT_TRUE(DecodeVertexBuffer(vertexStream, encodedVertices));
+}